@@ -89,6 +89,9 @@ void Helium::UpdateRotateComponentsTask::DefineContract( TaskContract &rContract
 {
 	rContract.ExecuteBefore<StandardDependencies::ProcessPhysics>();
 	rContract.ExecuteAfter<StandardDependencies::ReceiveInput>();
+
+	rContract.ReadsComponents<RotateComponent>();
+	rContract.WritesComponents<TransformComponent>();
 }
 
-HELIUM_DEFINE_TASK( UpdateRotateComponentsTask, (ForEachWorld< QueryComponents< RotateComponent, TransformComponent, UpdateRotateComponents > >), TickTypes::Gameplay )
+HELIUM_DEFINE_TASK( UpdateRotateComponentsTask, (ForEachWorld< ParallelQueryComponents< RotateComponent, TransformComponent, UpdateRotateComponents > >), TickTypes::Gameplay )
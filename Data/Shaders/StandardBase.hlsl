@@ -9,6 +9,7 @@
 //! @toggle_p NORMAL_MAP
 //! @select SPECULAR NONE SPECULAR_DIFFUSE_ALPHA SPECULAR_MAP
 //! @sysselect_v SKINNING NONE SKINNING_SMOOTH SKINNING_RIGID
+//! @systoggle_v INSTANCED
 //! @sysselect SHADOWS NONE SHADOWS_SIMPLE SHADOWS_PCF_DITHERED
 
 #include "Common.inl"
@@ -50,6 +51,11 @@ struct VertexInput
     float4 color        : COLOR;
 #endif
     float4 texCoord0    : TEXCOORD0;
+#if INSTANCED
+    float4 instanceTransform0 : TEXCOORD4;
+    float4 instanceTransform1 : TEXCOORD5;
+    float4 instanceTransform2 : TEXCOORD6;
+#endif
 };
 
 cbuffer ViewGlobalData
@@ -92,6 +98,9 @@ float4 main( VertexInput vIn, out VertexOutput vOut ) : POSITION
 #endif
 
 	matrix worldMatrix = matrix( partialSkinningMatrix, float4( 0, 0, 0, 1 ) );
+#elif INSTANCED
+    float3x4 instanceTransform = float3x4( vIn.instanceTransform0, vIn.instanceTransform1, vIn.instanceTransform2 );
+    matrix worldMatrix = matrix( instanceTransform, float4( 0, 0, 0, 1 ) );
 #else
     matrix worldMatrix = matrix( InstanceGlobalData.transform, float4( 0, 0, 0, 1 ) );
 #endif
@@ -37,6 +37,8 @@
 #include "Editor/Dialogs/PerforceWaitDialog.h"
 #include "Editor/Vault/VaultSettings.h"
 
+#include "Editor/Commands/CacheCompactCommand.h"
+#include "Editor/Commands/CookCommand.h"
 #include "Editor/Commands/ProfileDumpCommand.h"
 
 #include "Editor/Clipboard/ClipboardDataWrapper.h"
@@ -500,6 +502,14 @@ int Main( int argc, const char** argv )
 	success &= profileDumpCommand.Initialize( error );
 	success &= processor.RegisterCommand( &profileDumpCommand, error );
 
+	CacheCompactCommand cacheCompactCommand;
+	success &= cacheCompactCommand.Initialize( error );
+	success &= processor.RegisterCommand( &cacheCompactCommand, error );
+
+	CookCommand cookCommand;
+	success &= cookCommand.Initialize( error );
+	success &= processor.RegisterCommand( &cookCommand, error );
+
 	Helium::CommandLine::HelpCommand helpCommand;
 	helpCommand.SetOwner( &processor );
 	success &= helpCommand.Initialize( error );
@@ -0,0 +1,146 @@
+#include "EditorPch.h"
+#include "CacheCompactCommand.h"
+
+#include "Foundation/Log.h"
+#include "Foundation/FilePath.h"
+
+#include "Engine/AsyncLoader.h"
+#include "Engine/CacheManager.h"
+#include "Engine/FileLocations.h"
+
+using namespace Helium;
+using namespace Helium::Editor;
+
+CacheCompactCommand::CacheCompactCommand()
+	: Command( TXT( "cache-compact" ), TXT( "<PROJECT> [--stats] [--order <SCENE PATH>] <CACHE> [<CACHE> ...]" ), TXT( "Report dead space in the named caches of a project and compact them (only report with --stats), optionally laying entries out in the recorded load order of a scene" ) )
+{
+
+}
+
+static void PrintStats( const char* cacheName, const Cache::Stats& stats )
+{
+	uint64_t deadByteCount = ( stats.fileSize > stats.liveByteCount ? stats.fileSize - stats.liveByteCount : 0 );
+	float64_t deadByteRatio = ( stats.fileSize != 0 ? static_cast< float64_t >( deadByteCount ) / static_cast< float64_t >( stats.fileSize ) : 0.0 );
+
+	Log::Print(
+		TXT( "%s: %" ) PRIu32 TXT( " entries, %" ) PRIu64 TXT( " live bytes, %" ) PRIu64 TXT( " dead bytes (%.1f%% of %" ) PRIu64 TXT( " bytes)\n" ),
+		cacheName,
+		stats.entryCount,
+		stats.liveByteCount,
+		deadByteCount,
+		deadByteRatio * 100.0,
+		stats.fileSize );
+}
+
+bool CacheCompactCommand::Process( std::vector< std::string >::const_iterator& argsBegin, const std::vector< std::string >::const_iterator& argsEnd, std::string& error )
+{
+	if ( argsBegin == argsEnd )
+	{
+		error = TXT( "No project path specified" );
+		return false;
+	}
+
+	FilePath projectPath( *argsBegin );
+	++argsBegin;
+
+	bool statsOnly = false;
+	std::string orderPathString;
+	std::vector< std::string > cacheNames;
+	for ( ; argsBegin != argsEnd; ++argsBegin )
+	{
+		const std::string& arg = (*argsBegin);
+		if ( arg == TXT( "--stats" ) )
+		{
+			statsOnly = true;
+		}
+		else if ( arg == TXT( "--order" ) )
+		{
+			if ( ++argsBegin == argsEnd )
+			{
+				error = TXT( "No scene path specified for --order" );
+				return false;
+			}
+
+			orderPathString = *argsBegin;
+		}
+		else if ( arg.length() )
+		{
+			cacheNames.push_back( arg );
+		}
+	}
+
+	if ( cacheNames.empty() )
+	{
+		error = TXT( "No cache names specified" );
+		return false;
+	}
+
+	FileLocations::SetBaseDirectory( projectPath );
+	AsyncLoader::Startup();
+	CacheManager::Startup();
+
+	CacheManager* pCacheManager = CacheManager::GetInstance();
+	HELIUM_ASSERT( pCacheManager );
+
+	// Entries recorded in the scene's prefetch manifest are laid out in the order in which they were loaded.
+	DynamicArray< CacheManager::LoadRecord > loadRecords;
+	if ( !orderPathString.empty() )
+	{
+		AssetPath orderPath;
+		if ( !orderPath.Set( orderPathString.c_str() ) || !pCacheManager->LoadPrefetchManifest( orderPath, loadRecords ) )
+		{
+			Log::Warning( TXT( "No prefetch manifest found for %s, compacting without a load order\n" ), orderPathString.c_str() );
+		}
+	}
+
+	bool success = true;
+	for ( std::vector< std::string >::const_iterator itr = cacheNames.begin(); itr != cacheNames.end(); ++itr )
+	{
+		const char* cacheName = itr->c_str();
+
+		Cache* pCache = pCacheManager->GetCache( Name( cacheName ) );
+		if ( !pCache )
+		{
+			Log::Error( TXT( "Unable to open cache %s\n" ), cacheName );
+			success = false;
+			continue;
+		}
+
+		pCache->EnforceTocLoad();
+
+		Cache::Stats stats;
+		pCache->GetStats( stats );
+		PrintStats( cacheName, stats );
+
+		DynamicArray< AssetPath > loadOrder;
+		for ( size_t recordIndex = 0; recordIndex < loadRecords.GetSize(); ++recordIndex )
+		{
+			const CacheManager::LoadRecord& rRecord = loadRecords[ recordIndex ];
+			if ( rRecord.cacheName == pCache->GetName() )
+			{
+				loadOrder.Push( rRecord.path );
+			}
+		}
+
+		if ( statsOnly || ( stats.fileSize <= stats.liveByteCount && loadOrder.IsEmpty() ) )
+		{
+			continue;
+		}
+
+		if ( !pCache->Compact( loadOrder.GetData(), loadOrder.GetSize() ) )
+		{
+			Log::Error( TXT( "Failed to compact cache %s\n" ), cacheName );
+			success = false;
+			continue;
+		}
+
+		pCache->GetStats( stats );
+		PrintStats( cacheName, stats );
+	}
+
+	CacheManager::Shutdown();
+	AsyncLoader::Shutdown();
+	FileLocations::Shutdown();
+
+	return success;
+}
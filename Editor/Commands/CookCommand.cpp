@@ -0,0 +1,106 @@
+#include "EditorPch.h"
+#include "CookCommand.h"
+
+#include "Foundation/Log.h"
+#include "Foundation/FilePath.h"
+
+#include "Application/InitializerStack.h"
+
+#include "Engine/Asset.h"
+#include "Engine/AsyncLoader.h"
+#include "Engine/AssetLoader.h"
+#include "Engine/CacheManager.h"
+#include "Engine/FileLocations.h"
+#include "Engine/JobManager.h"
+
+#include "EngineJobs/EngineJobs.h"
+
+#include "GraphicsJobs/GraphicsJobs.h"
+
+#include "PcSupport/AssetPreprocessor.h"
+#include "PcSupport/LooseAssetLoader.h"
+
+#include "PreprocessingPc/PcPreprocessor.h"
+
+using namespace Helium;
+using namespace Helium::Editor;
+
+CookCommand::CookCommand()
+	: Command( TXT( "cook" ), TXT( "<PROJECT> <PACKAGE PATH> [<PACKAGE PATH> ...]" ), TXT( "Load and cache every asset in the given packages of a project (and their child packages) for all supported platforms" ) )
+{
+
+}
+
+bool CookCommand::Process( std::vector< std::string >::const_iterator& argsBegin, const std::vector< std::string >::const_iterator& argsEnd, std::string& error )
+{
+	if ( argsBegin == argsEnd )
+	{
+		error = TXT( "No project path specified" );
+		return false;
+	}
+
+	FilePath projectPath( *argsBegin );
+	++argsBegin;
+
+	DynamicArray< AssetPath > packagePaths;
+	for ( ; argsBegin != argsEnd; ++argsBegin )
+	{
+		const std::string& arg = (*argsBegin);
+		if ( !arg.length() )
+		{
+			continue;
+		}
+
+		AssetPath packagePath;
+		if ( !packagePath.Set( arg.c_str() ) || !packagePath.IsPackage() )
+		{
+			error = TXT( "Invalid package path: " ) + arg;
+			return false;
+		}
+
+		packagePaths.Push( packagePath );
+	}
+
+	if ( packagePaths.IsEmpty() )
+	{
+		error = TXT( "No package paths specified" );
+		return false;
+	}
+
+	FileLocations::SetBaseDirectory( projectPath );
+
+	// Make sure various module-specific heaps are initialized from the main thread before use.
+	InitEngineJobsDefaultHeap();
+	InitGraphicsJobsDefaultHeap();
+
+	// Resource preprocessing is spread across the job worker threads while cooking.
+	JobManager::Startup();
+
+	InitializerStack initializerStack;
+	initializerStack.Push( JobManager::Shutdown );
+	initializerStack.Push( FileLocations::Shutdown );
+	initializerStack.Push( Name::Shutdown );
+	initializerStack.Push( AssetPath::Shutdown );
+	initializerStack.Push( AsyncLoader::Startup, AsyncLoader::Shutdown );
+	initializerStack.Push( CacheManager::Startup, CacheManager::Shutdown );
+	initializerStack.Push( Reflect::ObjectRefCountSupport::Shutdown );
+	initializerStack.Push( Asset::Shutdown );
+	initializerStack.Push( AssetType::Shutdown );
+	initializerStack.Push( Reflect::Startup, Reflect::Shutdown );
+	initializerStack.Push( LooseAssetLoader::Startup, LooseAssetLoader::Shutdown );
+	initializerStack.Push( AssetPreprocessor::Startup, AssetPreprocessor::Shutdown );
+
+	AssetPreprocessor* pAssetPreprocessor = AssetPreprocessor::GetInstance();
+	HELIUM_ASSERT( pAssetPreprocessor );
+	pAssetPreprocessor->SetPlatformPreprocessor( Cache::PLATFORM_PC, new PcPreprocessor );
+
+	bool success = pAssetPreprocessor->CookPackages( packagePaths.GetData(), packagePaths.GetSize() );
+	if ( !success )
+	{
+		Log::Error( TXT( "Failed to cook one or more assets\n" ) );
+	}
+
+	initializerStack.Cleanup();
+
+	return success;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Application/CmdLineProcessor.h"
+
+namespace Helium
+{
+    namespace Editor
+    {
+        class CookCommand : public Helium::CommandLine::Command
+        {
+        public:
+            CookCommand();
+
+            virtual bool Process( std::vector< std::string >::const_iterator& argsBegin, const std::vector< std::string >::const_iterator& argsEnd, std::string& error ) override;
+        };
+    }
+}
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "Reflect/Object.h"
 #include "Graphics/BufferedDrawer.h"
 #include "Engine/PackageLoader.h"
+#include "Engine/AsyncLoader.h"
 
 using namespace Helium;
 using namespace Helium::Editor;
@@ -415,7 +416,9 @@ void EditorEngine::DoAssetManagerThread()
 		assetSyncUtil.Sync();
 		AssetLoader::GetInstance()->Tick();
 
-		if ( !m_bTerminateAssetManagerThread )
+		// Load requests waiting on file I/O are only made ready by a read completing, so sleep until the next one
+		// completes, falling back to a slow poll while no reads are pending.
+		if ( !m_bTerminateAssetManagerThread && !AsyncLoader::GetInstance()->WaitForCompletion() )
 		{
 			Thread::Sleep( 100 );
 		}
@@ -8,12 +8,17 @@
 #include "Foundation/FilePath.h"
 #include "Foundation/FileStream.h"
 #include "Foundation/StringConverter.h"
+#include "Foundation/HashMap.h"
 #include "Engine/CacheManager.h"
 #include "Engine/AssetLoader.h"
+#include "Engine/AsyncLoader.h"
 #include "Engine/PackageLoader.h"
 #include "Rendering/ShaderProfiles.h"
 #include "PcSupport/AssetPreprocessor.h"
 
+/// Name of the caches in which compiled shader code is stored by code hash.
+#define HELIUM_SHADER_VARIANT_CACHE_NAME TXT( "ShaderVariants" )
+
 HELIUM_IMPLEMENT_ASSET( Helium::ShaderVariantResourceHandler, EditorSupport, 0 );
 
 using namespace Helium;
@@ -245,14 +250,20 @@ bool ShaderVariantResourceHandler::CacheResource(
 		rPreprocessedData.bLoaded = true;
 	}
 
-//     DynamicArray< uint8_t > compiledCodeBuffer;
-//     DynamicArray< ShaderConstantBufferInfo > constantBuffers, pcSm4ConstantBuffers;
-//     DynamicArray< ShaderSamplerInfo > samplerInputs;
-//     DynamicArray< ShaderTextureInfo > textureInputs;
-	
-	Helium::StrongPtr<CompiledShaderData> spCompiledShaderData(new CompiledShaderData());
-	
-	CompiledShaderData &csd_pc_sm4 = *spCompiledShaderData;
+	// Set up a compile of each system option set for each shader profile in each supported target platform.
+	VariantSource variantSource;
+	variantSource.pHandler = this;
+	variantSource.pVariant = pVariant;
+	variantSource.shaderType = shaderType;
+	variantSource.pData = pShaderSource;
+	variantSource.size = size;
+
+	// PC shader model 4 is needed by every other target for reflection purposes, so it must always be built.
+	HELIUM_ASSERT( pAssetPreprocessor->GetPlatformPreprocessor( Cache::PLATFORM_PC ) );
+
+	DynamicArray< VariantCompile > compiles;
+	DynamicArray< size_t > pcSm4CompileIndices;
+	pcSm4CompileIndices.Reserve( systemOptionSetCount );
 
 	for( size_t systemOptionSetIndex = 0; systemOptionSetIndex < systemOptionSetCount; ++systemOptionSetIndex )
 	{
@@ -283,128 +294,209 @@ bool ShaderVariantResourceHandler::CacheResource(
 			pToken->definition = "1";
 		}
 
-		// Compile for PC shader model 4 first so that we can get the constant buffer information.
-		PlatformPreprocessor* pPreprocessor = pAssetPreprocessor->GetPlatformPreprocessor( Cache::PLATFORM_PC );
-		HELIUM_ASSERT( pPreprocessor );
+		pcSm4CompileIndices.Push( Invalid< size_t >() );
 
-		csd_pc_sm4.compiledCodeBuffer.Resize( 0 );
-		bool bCompiled = CompileShader(
-			pVariant,
-			pPreprocessor,
-			Cache::PLATFORM_PC,
-			ShaderProfile::PC_SM4,
-			shaderType,
-			pShaderSource,
-			size,
-			shaderTokens,
-			csd_pc_sm4.compiledCodeBuffer );
-		if( !bCompiled )
+		for( size_t platformIndex = 0; platformIndex < static_cast< size_t >( Cache::PLATFORM_MAX ); ++platformIndex )
+		{
+			PlatformPreprocessor* pPreprocessor = pAssetPreprocessor->GetPlatformPreprocessor(
+				static_cast< Cache::EPlatform >( platformIndex ) );
+			if( !pPreprocessor )
+			{
+				continue;
+			}
+
+			size_t shaderProfileCount = pPreprocessor->GetShaderProfileCount();
+			for( size_t shaderProfileIndex = 0; shaderProfileIndex < shaderProfileCount; ++shaderProfileIndex )
+			{
+				if( shaderProfileIndex == ShaderProfile::PC_SM4 && platformIndex == Cache::PLATFORM_PC )
+				{
+					pcSm4CompileIndices[ systemOptionSetIndex ] = compiles.GetSize();
+				}
+
+				VariantCompile* pCompile = compiles.New();
+				HELIUM_ASSERT( pCompile );
+				pCompile->pSource = &variantSource;
+				pCompile->pPreprocessor = pPreprocessor;
+				pCompile->platformIndex = platformIndex;
+				pCompile->shaderProfileIndex = shaderProfileIndex;
+				pCompile->systemOptionSetIndex = systemOptionSetIndex;
+				pCompile->tokens = shaderTokens;
+				pCompile->codeHash = 0;
+				SetInvalid( pCompile->sharedCompileIndex );
+				pCompile->bCompiled = false;
+				pCompile->bCached = false;
+			}
+		}
+
+		// Trim the system tokens off the shader token list for the next pass.
+		shaderTokens.Resize( userShaderTokenCount );
+	}
+
+	size_t compileCount = compiles.GetSize();
+
+	DynamicArray< VariantCompile* > pendingCompiles;
+	pendingCompiles.Reserve( compileCount );
+	for( size_t compileIndex = 0; compileIndex < compileCount; ++compileIndex )
+	{
+		pendingCompiles.Push( &compiles[ compileIndex ] );
+	}
+
+	// Preprocess each compile to get its code hash and look for its compiled code in the shader variant cache.
+	RunCompileJobs( PrepareCompileJobCallback, pendingCompiles.GetData(), pendingCompiles.GetSize() );
+
+	// Compile the code for each distinct code hash not found in the cache only once.
+	HashMap< uint64_t, size_t > codeHashCompileIndices;
+	pendingCompiles.Resize( 0 );
+	for( size_t compileIndex = 0; compileIndex < compileCount; ++compileIndex )
+	{
+		VariantCompile& rCompile = compiles[ compileIndex ];
+		if( rCompile.bCompiled )
+		{
+			continue;
+		}
+
+		if( rCompile.codeHash != 0 )
+		{
+			HashMap< uint64_t, size_t >::Iterator compileIterator = codeHashCompileIndices.Find( rCompile.codeHash );
+			if( compileIterator != codeHashCompileIndices.End() )
+			{
+				rCompile.sharedCompileIndex = compileIterator->Second();
+
+				continue;
+			}
+
+			codeHashCompileIndices.Insert(
+				compileIterator,
+				HashMap< uint64_t, size_t >::ValueType( rCompile.codeHash, compileIndex ) );
+		}
+
+		pendingCompiles.Push( &rCompile );
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		( TXT( "ShaderVariantResourceHandler: Compiling %" ) PRIuSZ TXT( " of %" ) PRIuSZ TXT( " shaders for " )
+		TXT( "\"%s\".\n" ) ),
+		pendingCompiles.GetSize(),
+		compileCount,
+		*pVariant->GetPath().ToString() );
+
+	RunCompileJobs( CompileJobCallback, pendingCompiles.GetData(), pendingCompiles.GetSize() );
+
+	for( size_t compileIndex = 0; compileIndex < compileCount; ++compileIndex )
+	{
+		VariantCompile& rCompile = compiles[ compileIndex ];
+		if( IsValid( rCompile.sharedCompileIndex ) )
+		{
+			const VariantCompile& rSharedCompile = compiles[ rCompile.sharedCompileIndex ];
+			rCompile.compiledCode = rSharedCompile.compiledCode;
+			rCompile.bCompiled = rSharedCompile.bCompiled;
+		}
+	}
+
+	SaveCompiledVariants( compiles );
+
+	// Gather the reflection information for each compiled shader and store it in the preprocessed data, using the
+	// constant buffer information from PC shader model 4 for each system option set.
+	Helium::StrongPtr<CompiledShaderData> spCompiledShaderData(new CompiledShaderData());
+	
+	CompiledShaderData &csd_pc_sm4 = *spCompiledShaderData;
+
+	size_t compileIndex = 0;
+	for( size_t systemOptionSetIndex = 0; systemOptionSetIndex < systemOptionSetCount; ++systemOptionSetIndex )
+	{
+		size_t compileStartIndex = compileIndex;
+		while( compileIndex < compileCount && compiles[ compileIndex ].systemOptionSetIndex == systemOptionSetIndex )
+		{
+			++compileIndex;
+		}
+
+		size_t pcSm4CompileIndex = pcSm4CompileIndices[ systemOptionSetIndex ];
+		HELIUM_ASSERT( IsValid( pcSm4CompileIndex ) );
+		VariantCompile& rPcSm4Compile = compiles[ pcSm4CompileIndex ];
+
+		if( !rPcSm4Compile.bCompiled )
 		{
 			HELIUM_TRACE(
 				TraceLevels::Error,
 				( TXT( "ShaderVariantResourceHandler: Failed to compile shader for PC shader model 4, which is " )
 				TXT( "needed for reflection purposes.  Additional shader targets will not be built.\n" ) ) );
+
+			continue;
 		}
-		else
+
+		PlatformPreprocessor* pPreprocessor = rPcSm4Compile.pPreprocessor;
+		HELIUM_ASSERT( pPreprocessor );
+
+		csd_pc_sm4.compiledCodeBuffer.Swap( rPcSm4Compile.compiledCode );
+		csd_pc_sm4.constantBuffers.Resize( 0 );
+		csd_pc_sm4.samplerInputs.Resize( 0 );
+		csd_pc_sm4.textureInputs.Resize( 0 );
+		bool bReadConstantBuffers = pPreprocessor->FillShaderReflectionData(
+			ShaderProfile::PC_SM4,
+			csd_pc_sm4.compiledCodeBuffer.GetData(),
+			csd_pc_sm4.compiledCodeBuffer.GetSize(),
+			csd_pc_sm4.constantBuffers,
+			csd_pc_sm4.samplerInputs,
+			csd_pc_sm4.textureInputs );
+		if( !bReadConstantBuffers )
 		{
-			csd_pc_sm4.constantBuffers.Resize( 0 );
-			csd_pc_sm4.samplerInputs.Resize( 0 );
-			csd_pc_sm4.textureInputs.Resize( 0 );
-			bool bReadConstantBuffers = pPreprocessor->FillShaderReflectionData(
-				ShaderProfile::PC_SM4,
-				csd_pc_sm4.compiledCodeBuffer.GetData(),
-				csd_pc_sm4.compiledCodeBuffer.GetSize(),
-				csd_pc_sm4.constantBuffers,
-				csd_pc_sm4.samplerInputs,
-				csd_pc_sm4.textureInputs );
-			if( !bReadConstantBuffers )
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				( TXT( "ShaderVariantResourceHandler: Failed to read reflection information for PC shader " )
+				TXT( "model 4.  Additional shader targets will not be built.\n" ) ) );
+
+			continue;
+		}
+
+		Resource::PreprocessedData& rPcPreprocessedData = pVariant->GetPreprocessedData( Cache::PLATFORM_PC );
+		DynamicArray< DynamicArray< uint8_t > >& rPcSubDataBuffers = rPcPreprocessedData.subDataBuffers;
+		DynamicArray< uint8_t >& rPcSm4SubDataBuffer =
+			rPcSubDataBuffers[ ShaderProfile::PC_SM4 * systemOptionSetCount + systemOptionSetIndex ];
+
+		Cache::WriteCacheObjectToBuffer( &csd_pc_sm4, rPcSm4SubDataBuffer);
+
+		for( size_t targetCompileIndex = compileStartIndex; targetCompileIndex < compileIndex; ++targetCompileIndex )
+		{
+			// Already cached PC shader model 4...
+			if( targetCompileIndex == pcSm4CompileIndex )
 			{
-				HELIUM_TRACE(
-					TraceLevels::Error,
-					( TXT( "ShaderVariantResourceHandler: Failed to read reflection information for PC shader " )
-					TXT( "model 4.  Additional shader targets will not be built.\n" ) ) );
+				continue;
 			}
-			else
+
+			VariantCompile& rCompile = compiles[ targetCompileIndex ];
+			if( !rCompile.bCompiled )
 			{
-				Resource::PreprocessedData& rPcPreprocessedData = pVariant->GetPreprocessedData(
-					Cache::PLATFORM_PC );
-				DynamicArray< DynamicArray< uint8_t > >& rPcSubDataBuffers = rPcPreprocessedData.subDataBuffers;
-				DynamicArray< uint8_t >& rPcSm4SubDataBuffer =
-					rPcSubDataBuffers[ ShaderProfile::PC_SM4 * systemOptionSetCount + systemOptionSetIndex ];
-
-				Cache::WriteCacheObjectToBuffer( &csd_pc_sm4, rPcSm4SubDataBuffer);
-				
-				// FOR EACH PLATFORM
-				for( size_t platformIndex = 0;
-					platformIndex < static_cast< size_t >( Cache::PLATFORM_MAX );
-					++platformIndex )
-				{
-					PlatformPreprocessor* pPreprocessor = pAssetPreprocessor->GetPlatformPreprocessor(
-						static_cast< Cache::EPlatform >( platformIndex ) );
-					if( !pPreprocessor )
-					{
-						continue;
-					}
-					
-					// GET PLATFORM'S SUBDATA BUFFER
-					Resource::PreprocessedData& rPreprocessedData = pVariant->GetPreprocessedData(
-						static_cast< Cache::EPlatform >( platformIndex ) );
-					DynamicArray< DynamicArray< uint8_t > >& rSubDataBuffers = rPreprocessedData.subDataBuffers;
-
-					size_t shaderProfileCount = pPreprocessor->GetShaderProfileCount();
-					for( size_t shaderProfileIndex = 0;
-						shaderProfileIndex < shaderProfileCount;
-						++shaderProfileIndex )
-					{
-						CompiledShaderData csd;
-						csd.GetRefCountProxy()->AddStrongRef(); // stack allocated object!!
-
-						// Already cached PC shader model 4...
-						if( shaderProfileIndex == ShaderProfile::PC_SM4 && platformIndex == Cache::PLATFORM_PC )
-						{
-							continue;
-						}
-
-						bCompiled = CompileShader(
-							pVariant,
-							pPreprocessor,
-							platformIndex,
-							shaderProfileIndex,
-							shaderType,
-							pShaderSource,
-							size,
-							shaderTokens,
-							csd.compiledCodeBuffer );
-						if( !bCompiled )
-						{
-							continue;
-						}
-
-						csd.constantBuffers = csd_pc_sm4.constantBuffers;
-						csd.samplerInputs.Resize( 0 );
-						csd.textureInputs.Resize( 0 );
-						bReadConstantBuffers = pPreprocessor->FillShaderReflectionData(
-							shaderProfileIndex,
-							csd.compiledCodeBuffer.GetData(),
-							csd.compiledCodeBuffer.GetSize(),
-							csd.constantBuffers,
-							csd.samplerInputs,
-							csd.textureInputs );
-						if( !bReadConstantBuffers )
-						{
-							continue;
-						}
-
-						DynamicArray< uint8_t >& rTargetSubDataBuffer =
-							rSubDataBuffers[ shaderProfileIndex * systemOptionSetCount + systemOptionSetIndex ];
-						Cache::WriteCacheObjectToBuffer( &csd, rTargetSubDataBuffer);
-					}
-				}
+				continue;
 			}
-		}
 
-		// Trim the system tokens off the shader token list for the next pass.
-		shaderTokens.Resize( userShaderTokenCount );
+			CompiledShaderData csd;
+			csd.GetRefCountProxy()->AddStrongRef(); // stack allocated object!!
+
+			csd.compiledCodeBuffer.Swap( rCompile.compiledCode );
+			csd.constantBuffers = csd_pc_sm4.constantBuffers;
+			csd.samplerInputs.Resize( 0 );
+			csd.textureInputs.Resize( 0 );
+			bReadConstantBuffers = rCompile.pPreprocessor->FillShaderReflectionData(
+				rCompile.shaderProfileIndex,
+				csd.compiledCodeBuffer.GetData(),
+				csd.compiledCodeBuffer.GetSize(),
+				csd.constantBuffers,
+				csd.samplerInputs,
+				csd.textureInputs );
+			if( !bReadConstantBuffers )
+			{
+				continue;
+			}
+
+			Resource::PreprocessedData& rPreprocessedData = pVariant->GetPreprocessedData(
+				static_cast< Cache::EPlatform >( rCompile.platformIndex ) );
+			DynamicArray< DynamicArray< uint8_t > >& rSubDataBuffers = rPreprocessedData.subDataBuffers;
+
+			DynamicArray< uint8_t >& rTargetSubDataBuffer =
+				rSubDataBuffers[ rCompile.shaderProfileIndex * systemOptionSetCount + systemOptionSetIndex ];
+			Cache::WriteCacheObjectToBuffer( &csd, rTargetSubDataBuffer);
+		}
 	}
 
 	allocator.Free( pShaderSource );
@@ -412,6 +504,166 @@ bool ShaderVariantResourceHandler::CacheResource(
 	return true;
 }
 
+/// Load compiled shader code from the shader variant cache of a platform.
+///
+/// @param[in]  platformIndex  Target platform index.
+/// @param[in]  codeHash       Hash of the preprocessed shader code and compile target.
+/// @param[out] rCompiledCode  Compiled shader code.
+///
+/// @return  True if compiled code was found for the given hash and loaded successfully, false if not.
+///
+/// @see SaveCompiledVariants()
+bool ShaderVariantResourceHandler::LoadCompiledVariant(
+	size_t platformIndex,
+	uint64_t codeHash,
+	DynamicArray< uint8_t >& rCompiledCode )
+{
+	HELIUM_ASSERT( platformIndex < static_cast< size_t >( Cache::PLATFORM_MAX ) );
+
+	rCompiledCode.Resize( 0 );
+
+	CacheManager* pCacheManager = CacheManager::GetInstance();
+	HELIUM_ASSERT( pCacheManager );
+
+	AssetPath path = GetCompiledVariantPath( codeHash );
+
+	Cache* pCache;
+	Cache::Entry entry;
+	{
+		MutexScopeLock scopeLock( m_compiledVariantLock );
+
+		pCache = pCacheManager->GetCache(
+			Name( HELIUM_SHADER_VARIANT_CACHE_NAME ),
+			static_cast< Cache::EPlatform >( platformIndex ) );
+		if( !pCache )
+		{
+			return false;
+		}
+
+		pCache->EnforceTocLoad();
+
+		const Cache::Entry* pEntry = pCache->FindEntry( path, 0 );
+		if( !pEntry || pEntry->size == 0 || pEntry->sourceHash != codeHash )
+		{
+			return false;
+		}
+
+		entry = *pEntry;
+	}
+
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	rCompiledCode.Resize( entry.size );
+
+	size_t loadId;
+	if( entry.storedSize < entry.size )
+	{
+		loadId = pAsyncLoader->QueueCompressedRequest(
+			rCompiledCode.GetData(),
+			pCache->GetCacheFileName(),
+			entry.offset,
+			entry.storedSize,
+			entry.size );
+	}
+	else
+	{
+		loadId = pAsyncLoader->QueueRequest(
+			rCompiledCode.GetData(),
+			pCache->GetCacheFileName(),
+			entry.offset,
+			entry.size );
+	}
+	HELIUM_ASSERT( IsValid( loadId ) );
+
+	size_t bytesRead = pAsyncLoader->SyncRequest( loadId );
+	if( bytesRead != entry.size )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			( TXT( "ShaderVariantResourceHandler: Failed to read compiled shader \"%s\" from cache \"%s\"; it " )
+			TXT( "will be recompiled.\n" ) ),
+			*path.ToString(),
+			*pCache->GetCacheFileName() );
+
+		rCompiledCode.Resize( 0 );
+
+		return false;
+	}
+
+	return true;
+}
+
+/// Store the code built by a set of shader compiles in the shader variant caches.
+///
+/// Only code that was compiled (not read from the cache or shared with another compile) and has a code hash is
+/// stored.  The entries for each platform are written in a single batch.
+///
+/// @param[in] rCompiles  Shader compiles.
+///
+/// @see LoadCompiledVariant()
+void ShaderVariantResourceHandler::SaveCompiledVariants( const DynamicArray< VariantCompile >& rCompiles )
+{
+	CacheManager* pCacheManager = CacheManager::GetInstance();
+	HELIUM_ASSERT( pCacheManager );
+
+	DynamicArray< Cache::EntryWrite > writes;
+
+	size_t compileCount = rCompiles.GetSize();
+	for( size_t platformIndex = 0; platformIndex < static_cast< size_t >( Cache::PLATFORM_MAX ); ++platformIndex )
+	{
+		writes.Resize( 0 );
+
+		for( size_t compileIndex = 0; compileIndex < compileCount; ++compileIndex )
+		{
+			const VariantCompile& rCompile = rCompiles[ compileIndex ];
+			if( rCompile.platformIndex != platformIndex ||
+				!rCompile.bCompiled ||
+				rCompile.bCached ||
+				rCompile.codeHash == 0 ||
+				IsValid( rCompile.sharedCompileIndex ) )
+			{
+				continue;
+			}
+
+			Cache::EntryWrite* pWrite = writes.New();
+			HELIUM_ASSERT( pWrite );
+			pWrite->path = GetCompiledVariantPath( rCompile.codeHash );
+			pWrite->subDataIndex = 0;
+			pWrite->pData = rCompile.compiledCode.GetData();
+			pWrite->timestamp = 0;
+			pWrite->sourceHash = rCompile.codeHash;
+			pWrite->size = static_cast< uint32_t >( rCompile.compiledCode.GetSize() );
+			pWrite->bCompress = true;
+		}
+
+		if( writes.IsEmpty() )
+		{
+			continue;
+		}
+
+		MutexScopeLock scopeLock( m_compiledVariantLock );
+
+		Cache* pCache = pCacheManager->GetCache(
+			Name( HELIUM_SHADER_VARIANT_CACHE_NAME ),
+			static_cast< Cache::EPlatform >( platformIndex ) );
+		if( !pCache )
+		{
+			continue;
+		}
+
+		pCache->EnforceTocLoad();
+
+		if( !pCache->CacheEntries( writes.GetData(), writes.GetSize() ) )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Warning,
+				TXT( "ShaderVariantResourceHandler: Failed to store compiled shaders in cache \"%s\".\n" ),
+				*pCache->GetCacheFileName() );
+		}
+	}
+}
+
 /// Begin asynchronous loading of a shader variant.
 ///
 /// @param[in] pShader          Parent shader resource.
@@ -621,6 +873,30 @@ bool ShaderVariantResourceHandler::TryFinishLoadVariantCallback(
 	return bFinished;
 }
 
+/// Get the path of the shader source file for a shader variant, for resolving shader includes.
+///
+/// @param[in]  pVariant         Shader variant.
+/// @param[out] rShaderFilePath  Shader source file path.
+///
+/// @return  True if the path was resolved successfully, false if not.
+bool ShaderVariantResourceHandler::GetShaderFilePath( ShaderVariant* pVariant, FilePath& rShaderFilePath )
+{
+	HELIUM_ASSERT( pVariant );
+
+	if ( !FileLocations::GetDataDirectory( rShaderFilePath ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "ShaderVariantResourceHandler: Failed to obtain data directory." ) );
+
+		return false;
+	}
+
+	rShaderFilePath += pVariant->GetPath().GetParent().ToFilePathString().GetData();
+
+	return true;
+}
+
 /// Helper function for compiling a shader for a specific profile.
 ///
 /// @param[in]  pVariant             Shader variant for which we are compiling.
@@ -659,17 +935,11 @@ bool ShaderVariantResourceHandler::CompileShader(
 #endif
 
 	FilePath shaderFilePath;
-	if ( !FileLocations::GetDataDirectory( shaderFilePath ) )
+	if( !GetShaderFilePath( pVariant, shaderFilePath ) )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			TXT( "ShaderVariantResourceHandler: Failed to obtain data directory." ) );
-
 		return false;
 	}
 
-	shaderFilePath += pVariant->GetPath().GetParent().ToFilePathString().GetData();
-
 	bool bCompileResult = pPreprocessor->CompileShader(
 		shaderFilePath,
 		shaderProfileIndex,
@@ -720,6 +990,143 @@ bool ShaderVariantResourceHandler::CompileShader(
 	return bCompileResult;
 }
 
+/// Get the path under which compiled shader code is stored in the shader variant caches.
+///
+/// @param[in] codeHash  Hash of the preprocessed shader code and compile target.
+///
+/// @return  Cache entry path.
+AssetPath ShaderVariantResourceHandler::GetCompiledVariantPath( uint64_t codeHash )
+{
+	char pathString[ 64 ];
+	StringPrint( pathString, TXT( "/" ) HELIUM_SHADER_VARIANT_CACHE_NAME TXT( ":%016" ) PRIx64, codeHash );
+
+	AssetPath path;
+	HELIUM_VERIFY( path.Set( pathString ) );
+
+	return path;
+}
+
+/// Run a job for each of a set of shader compiles, waiting for all of them to finish.
+///
+/// The jobs are run on the job worker threads if the job manager has been started, or on the calling thread if not.
+///
+/// @param[in] pJobFunction  Job callback, called with each compile.
+/// @param[in] ppCompiles    Compiles for which to run the job.
+/// @param[in] compileCount  Number of compiles in the given array.
+void ShaderVariantResourceHandler::RunCompileJobs(
+	JobFunc pJobFunction,
+	VariantCompile* const* ppCompiles,
+	size_t compileCount )
+{
+	HELIUM_ASSERT( pJobFunction );
+	HELIUM_ASSERT( ppCompiles || compileCount == 0 );
+
+	JobManager* pJobManager = JobManager::GetInstance();
+	if( !pJobManager || compileCount <= 1 )
+	{
+		for( size_t compileIndex = 0; compileIndex < compileCount; ++compileIndex )
+		{
+			pJobFunction( ppCompiles[ compileIndex ] );
+		}
+
+		return;
+	}
+
+	JobCounter compileCounter;
+	for( size_t compileIndex = 0; compileIndex < compileCount; ++compileIndex )
+	{
+		pJobManager->SpawnJob( pJobFunction, ppCompiles[ compileIndex ], &compileCounter );
+	}
+
+	pJobManager->WaitForCounter( compileCounter );
+}
+
+/// Job callback for preprocessing a shader compile, computing its code hash and looking up its compiled code in the
+/// shader variant cache.
+///
+/// @param[in] pData  Shader compile (VariantCompile instance).
+///
+/// @see CompileJobCallback()
+void ShaderVariantResourceHandler::PrepareCompileJobCallback( void* pData )
+{
+	VariantCompile* pCompile = static_cast< VariantCompile* >( pData );
+	HELIUM_ASSERT( pCompile );
+
+	const VariantSource* pSource = pCompile->pSource;
+	HELIUM_ASSERT( pSource );
+	HELIUM_ASSERT( pCompile->pPreprocessor );
+
+	FilePath shaderFilePath;
+	if( !GetShaderFilePath( pSource->pVariant, shaderFilePath ) )
+	{
+		return;
+	}
+
+	DynamicArray< uint8_t > preprocessedCode;
+	bool bPreprocessed = pCompile->pPreprocessor->PreprocessShader(
+		shaderFilePath,
+		pCompile->shaderProfileIndex,
+		pSource->shaderType,
+		pSource->pData,
+		pSource->size,
+		pCompile->tokens.GetData(),
+		pCompile->tokens.GetSize(),
+		preprocessedCode );
+	if( !bPreprocessed )
+	{
+		// The compile will report any errors.
+		return;
+	}
+
+	uint32_t target[] =
+	{
+		COMPILED_VARIANT_VERSION,
+		static_cast< uint32_t >( pCompile->platformIndex ),
+		static_cast< uint32_t >( pCompile->shaderProfileIndex ),
+		static_cast< uint32_t >( pSource->shaderType )
+	};
+
+	uint64_t codeHash = AssetPreprocessor::HashSourceData(
+		AssetPreprocessor::SOURCE_HASH_OFFSET_BASIS,
+		target,
+		sizeof( target ) );
+	codeHash = AssetPreprocessor::HashSourceData( codeHash, preprocessedCode.GetData(), preprocessedCode.GetSize() );
+	pCompile->codeHash = codeHash;
+
+	ShaderVariantResourceHandler* pHandler = pSource->pHandler;
+	HELIUM_ASSERT( pHandler );
+	if( pHandler->LoadCompiledVariant( pCompile->platformIndex, codeHash, pCompile->compiledCode ) )
+	{
+		pCompile->bCompiled = true;
+		pCompile->bCached = true;
+	}
+}
+
+/// Job callback for compiling a shader.
+///
+/// @param[in] pData  Shader compile (VariantCompile instance).
+///
+/// @see PrepareCompileJobCallback()
+void ShaderVariantResourceHandler::CompileJobCallback( void* pData )
+{
+	VariantCompile* pCompile = static_cast< VariantCompile* >( pData );
+	HELIUM_ASSERT( pCompile );
+
+	const VariantSource* pSource = pCompile->pSource;
+	HELIUM_ASSERT( pSource );
+
+	pCompile->bCompiled = CompileShader(
+		pSource->pVariant,
+		pCompile->pPreprocessor,
+		pCompile->platformIndex,
+		pCompile->shaderProfileIndex,
+		pSource->shaderType,
+		pSource->pData,
+		pSource->size,
+		pCompile->tokens,
+		pCompile->compiledCode );
+}
+
 /// Compute a hash value for a shader variant load request.
 ///
 /// @param[in] pRequest  Load request.
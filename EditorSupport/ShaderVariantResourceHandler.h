@@ -6,12 +6,19 @@
 
 #include "PcSupport/ResourceHandler.h"
 
+#include "Platform/Locks.h"
+#include "Engine/JobManager.h"
 #include "Graphics/Shader.h"
 #include "PcSupport/PlatformPreprocessor.h"
 
 namespace Helium
 {
     /// Resource handler for Shader resource types.
+    ///
+    /// Each system option set of a shader variant is compiled for every shader profile of every supported platform in
+    /// parallel on the job worker threads.  Compiles are identified by a hash of their preprocessed shader code and
+    /// compile target, so permutations that preprocess to the same code are only compiled once, and the compiled code
+    /// is stored by that hash in the "ShaderVariants" cache of each platform so that it can be reused by later cooks.
     class HELIUM_EDITOR_SUPPORT_API ShaderVariantResourceHandler : public ResourceHandler
     {
         HELIUM_DECLARE_ASSET( ShaderVariantResourceHandler, ResourceHandler );
@@ -19,6 +26,8 @@ namespace Helium
     public:
         /// Load request pool block size.
         static const size_t LOAD_REQUEST_POOL_BLOCK_SIZE = 8;
+        /// Version of the compiled shader code stored in the shader variant caches (changing it invalidates the caches).
+        static const uint32_t COMPILED_VARIANT_VERSION = 1;
 
         /// @name Construction/Destruction
         //@{
@@ -49,6 +58,50 @@ namespace Helium
             volatile int32_t requestCount;
         };
 
+        /// Shader source shared by the compiles performed while caching a shader variant.
+        struct VariantSource
+        {
+            /// Handler caching the shader variant.
+            ShaderVariantResourceHandler* pHandler;
+            /// Shader variant being cached.
+            ShaderVariant* pVariant;
+            /// Shader type.
+            RShader::EType shaderType;
+            /// Shader source data.
+            const void* pData;
+            /// Shader source size, in bytes.
+            size_t size;
+        };
+
+        /// Compile of a single system option set for a single shader profile.
+        struct VariantCompile
+        {
+            /// Shared shader source.
+            const VariantSource* pSource;
+            /// Target platform preprocessor.
+            PlatformPreprocessor* pPreprocessor;
+            /// Target platform index.
+            size_t platformIndex;
+            /// Shader profile index.
+            size_t shaderProfileIndex;
+            /// System option set index.
+            size_t systemOptionSetIndex;
+            /// Shader preprocessor tokens for the user and system options.
+            DynamicArray< PlatformPreprocessor::ShaderToken > tokens;
+
+            /// Hash of the preprocessed shader code and compile target (zero if the shader could not be preprocessed).
+            uint64_t codeHash;
+            /// Index of the compile with the same code hash that produces the code for this compile (invalid if this
+            /// compile produces its own code).
+            size_t sharedCompileIndex;
+            /// Compiled shader code.
+            DynamicArray< uint8_t > compiledCode;
+            /// True if the compiled code is available.
+            bool bCompiled;
+            /// True if the compiled code was read from the shader variant cache.
+            bool bCached;
+        };
+
         /// Shader variant load request hasher.
         class LoadRequestHash
         {
@@ -77,6 +130,9 @@ namespace Helium
         /// Load request lookup set.
         LoadRequestSetType m_loadRequestSet;
 
+        /// Mutex synchronizing access to the shader variant caches.
+        Mutex m_compiledVariantLock;
+
         /// @name Shader Variant Load Override Support
         //@{
         size_t BeginLoadVariant( Shader* pShader, RShader::EType shaderType, uint32_t userOptionIndex );
@@ -90,13 +146,26 @@ namespace Helium
         static bool TryFinishLoadVariantCallback( void* pCallbackData, size_t loadId, ShaderVariantPtr& rspVariant );
         //@}
 
+        /// @name Compiled Shader Variant Caching
+        //@{
+        bool LoadCompiledVariant( size_t platformIndex, uint64_t codeHash, DynamicArray< uint8_t >& rCompiledCode );
+        void SaveCompiledVariants( const DynamicArray< VariantCompile >& rCompiles );
+        //@}
+
         /// @name Private Static Utility Functions
         //@{
+        static bool GetShaderFilePath( ShaderVariant* pVariant, FilePath& rShaderFilePath );
         static bool CompileShader(
             ShaderVariant* pVariant, PlatformPreprocessor* pPreprocessor, size_t platformIndex,
             size_t shaderProfileIndex, RShader::EType shaderType, const void* pShaderSourceData,
             size_t shaderSourceSize, const DynamicArray< PlatformPreprocessor::ShaderToken >& rTokens,
             DynamicArray< uint8_t >& rCompiledCodeBuffer );
+
+        static AssetPath GetCompiledVariantPath( uint64_t codeHash );
+        static void RunCompileJobs( JobFunc pJobFunction, VariantCompile* const* ppCompiles, size_t compileCount );
+
+        static void PrepareCompileJobCallback( void* pData );
+        static void CompileJobCallback( void* pData );
         //@}
     };
 }
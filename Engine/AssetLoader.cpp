@@ -3,6 +3,7 @@
 
 #include "Platform/Thread.h"
 #include "Engine/Asset.h"
+#include "Engine/AsyncLoader.h"
 #include "Engine/PackageLoader.h"
 #include "Engine/FileLocations.h"
 
@@ -21,6 +22,9 @@ AssetTracker* AssetTracker::sm_pInstance = NULL;
 /// Constructor.
 AssetLoader::AssetLoader()
 : m_loadRequestPool( LOAD_REQUEST_POOL_BLOCK_SIZE )
+, m_progressCounter( 0 )
+, m_wakeProgressCount( 0 )
+, m_wakeIoCompletionCount( 0 )
 {
 }
 
@@ -102,13 +106,21 @@ size_t AssetLoader::BeginLoadObject( AssetPath path, bool forceReload )
 	HELIUM_ASSERT( !pRequest->spObject );
 	pRequest->spObject = pAsset;
 	pRequest->forceReload = forceReload;
+	pRequest->pBlockingRequest = NULL;
+	pRequest->blockingStateFlags = 0;
+	HELIUM_ASSERT( pRequest->dependents.IsEmpty() );
+	pRequest->waitState = WAIT_STATE_NONE;
 
 	ConcurrentHashMap< AssetPath, LoadRequest* >::Accessor requestAccessor;
 	if( m_loadRequestMap.Insert( requestAccessor, KeyValue< AssetPath, LoadRequest* >( path, pRequest ) ) )
 	{
-		// New load request was created, so tick it once to get the load process running.
+		// New load request was created, so tick it once to get the load process running, then schedule it based on
+		// what it is waiting for.
 		requestAccessor.Release();
+
+		int32_t previousStateFlags = pRequest->stateFlags;
 		TickLoadRequest( pRequest );
+		ScheduleRequest( pRequest, previousStateFlags, false );
 	}
 	else
 	{
@@ -173,6 +185,8 @@ bool AssetLoader::TryFinishLoad( size_t id, AssetPtr& rspObject )
 	int32_t newRequestCount = AtomicDecrementRelease( pRequest->requestCount );
 	if( newRequestCount == 0 )
 	{
+		HELIUM_ASSERT( pRequest->dependents.IsEmpty() );
+
 		pRequest->spObject.Release();
 		pRequest->resolver.Clear();
 
@@ -197,6 +211,9 @@ bool AssetLoader::TryFinishLoad( size_t id, AssetPtr& rspObject )
 
 /// Block the current thread while waiting for an object load request or package pre-load request to complete.
 ///
+/// The loader is ticked from the current thread until the request completes.  Whenever a tick fails to advance the
+/// request, the thread sleeps until the next async file read completes rather than ticking again right away.
+///
 /// Note that after a load request has completed, the request ID will no longer be valid.
 ///
 /// @param[in]  id         Load request ID.
@@ -206,13 +223,53 @@ bool AssetLoader::TryFinishLoad( size_t id, AssetPtr& rspObject )
 /// @see TryFinishLoad(), BeginLoadObject(), BeginPreloadPackage()
 void AssetLoader::FinishLoad( size_t id, AssetPtr& rspObject )
 {
+	HELIUM_ASSERT( IsValid( id ) );
+
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	LoadRequest* pRequest = m_loadRequestPool.GetObject( id );
+	HELIUM_ASSERT( pRequest );
+
 	while( !TryFinishLoad( id, rspObject ) )
 	{
+		int32_t stateFlags = pRequest->stateFlags;
+
 		Tick();
-		Thread::Yield();
+
+		// Only sleep if the request is stalled, most likely waiting on file I/O.
+		if( pRequest->stateFlags == stateFlags && !pAsyncLoader->WaitForCompletion() )
+		{
+			Thread::Yield();
+		}
 	}
 }
 
+/// Register a callback to be called once an object load request has completed.
+///
+/// The continuation takes over the load request: once the request completes, it is finished with TryFinishLoad()
+/// during the next Tick() and the callback is called with the loaded object on the ticking thread.  The request ID
+/// must not be used by the caller after registering the continuation.
+///
+/// @param[in] id         Load request ID.
+/// @param[in] pCallback  Callback to call once the load request has completed.
+/// @param[in] pUserData  User data to pass to the callback.
+///
+/// @see BeginLoadObject(), Tick()
+void AssetLoader::AddContinuation( size_t id, CONTINUATION_CALLBACK* pCallback, void* pUserData )
+{
+	HELIUM_ASSERT( IsValid( id ) );
+	HELIUM_ASSERT( pCallback );
+
+	MutexScopeLock scopeLock( m_continuationLock );
+
+	Continuation* pContinuation = m_continuations.New();
+	HELIUM_ASSERT( pContinuation );
+	pContinuation->loadId = id;
+	pContinuation->pCallback = pCallback;
+	pContinuation->pUserData = pUserData;
+}
+
 /// Load an object non-asynchronously.
 ///
 /// This is equivalent to calling BeginLoadObject() followed by FinishLoad() on the returned request ID.
@@ -265,63 +322,68 @@ bool AssetLoader::CacheObject( Asset* /*pObject*/, bool /*bEvictPlatformPreproce
 #endif  // HELIUM_TOOLS
 
 /// Update object loading.
+///
+/// Only load requests that are ready to make progress are ticked.  Requests made ready while ticking, such as those
+/// waiting on a request that just advanced, are ticked during the same update.
+///
+/// @see TickWorker()
 void AssetLoader::Tick()
 {
+	// Sample the wake counters before ticking the package loaders, so that any file read completing while they are
+	// ticked (after they have checked on it) still wakes the waiting requests on the next update.
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	uint32_t ioCompletionCount = pAsyncLoader->GetCompletedRequestCount();
+	int32_t progressCount = m_progressCounter;
+
 	// Tick package loaders first.
 	TickPackageLoaders();
 
-	// Build the list of object load requests to update this tick, incrementing the request count on each to prevent
-	// them from being released while we don't have a lock on the request hash map.
-	//HELIUM_ASSERT( m_loadRequestTickArray.IsEmpty() );
-	/// List of load requests to update in the current tick.
-	DynamicArray< LoadRequest* > m_loadRequestTickArray;
+	WakeWaitingRequests( ioCompletionCount, progressCount );
 
-	ConcurrentHashMap< AssetPath, LoadRequest* >::ConstAccessor loadRequestConstAccessor;
-	if( m_loadRequestMap.First( loadRequestConstAccessor ) )
+	LoadRequest* pRequest;
+	while( PopReadyRequest( pRequest, false ) )
 	{
-		do
-		{
-			LoadRequest* pRequest = loadRequestConstAccessor->Second();
-			HELIUM_ASSERT( pRequest );
-			AtomicIncrementUnsafe( pRequest->requestCount );
-			m_loadRequestTickArray.Add( pRequest );
-
-			++loadRequestConstAccessor;
-		} while( loadRequestConstAccessor.IsValid() );
+		TickReadyRequest( pRequest, false );
 	}
 
-	// Tick object load requests.
-	size_t loadRequestCount = m_loadRequestTickArray.GetSize();
-	for( size_t requestIndex = 0; requestIndex < loadRequestCount; ++requestIndex )
-	{
-		LoadRequest* pRequest = m_loadRequestTickArray[ requestIndex ];
-		HELIUM_ASSERT( pRequest );
-
-		TickLoadRequest( pRequest );
-
-		int32_t newRequestCount = AtomicDecrementRelease( pRequest->requestCount );
-		if( newRequestCount == 0 )
-		{
-			ConcurrentHashMap< AssetPath, LoadRequest* >::Accessor loadRequestAccessor;
-			if( m_loadRequestMap.Find( loadRequestAccessor, pRequest->path ) )
-			{
-				pRequest = loadRequestAccessor->Second();
-				HELIUM_ASSERT( pRequest );
-				if( pRequest->requestCount == 0 )
-				{
-					HELIUM_ASSERT( ( pRequest->stateFlags & LOAD_FLAG_FULLY_LOADED ) == LOAD_FLAG_FULLY_LOADED );
+	TickContinuations();
+}
 
-					pRequest->spObject.Release();
-					pRequest->resolver.Clear();
+/// Advance the linking and precaching of ready load requests from a worker thread.
+///
+/// This can be called from any number of threads alongside Tick().  Preloading, resource precaching and load
+/// finalization are always left to Tick(), as they may create renderer resources, so asset types only need to support
+/// linking and the work done by OnPrecacheReady() (such as resource preprocessing) off of the main thread.
+///
+/// @param[in] requestCountMax  Maximum number of load requests to tick.
+///
+/// @return  Number of load requests ticked.
+///
+/// @see Tick()
+size_t AssetLoader::TickWorker( size_t requestCountMax )
+{
+	size_t tickCount = 0;
 
-					m_loadRequestMap.Remove( loadRequestAccessor );
-					m_loadRequestPool.Release( pRequest );
-				}
-			}
-		}
+	LoadRequest* pRequest;
+	while( tickCount < requestCountMax && PopReadyRequest( pRequest, true ) )
+	{
+		TickReadyRequest( pRequest, true );
+		++tickCount;
 	}
 
-	//m_loadRequestTickArray.Resize( 0 );
+	return tickCount;
+}
+
+/// Report progress made by a package loader that was not triggered by an async file read completing (such as work
+/// finished on job worker threads).
+///
+/// Load requests waiting on file I/O or package loader progress are made ready again on the next Tick().  This can be
+/// called from any thread.
+void AssetLoader::NotifyPackageLoaderProgress()
+{
+	AtomicIncrementRelease( m_progressCounter );
 }
 
 /// Get the global object loader instance.
@@ -359,6 +421,249 @@ void AssetLoader::Shutdown()
 	}
 }
 
+/// Call the continuations of any load requests that have completed.
+///
+/// @see AddContinuation()
+void AssetLoader::TickContinuations()
+{
+	// Take the list of registered continuations so that callbacks are free to register new ones.
+	DynamicArray< Continuation > continuations;
+
+	{
+		MutexScopeLock scopeLock( m_continuationLock );
+		if( m_continuations.IsEmpty() )
+		{
+			return;
+		}
+
+		continuations = m_continuations;
+		m_continuations.Resize( 0 );
+	}
+
+	AssetPtr spObject;
+
+	size_t continuationCount = continuations.GetSize();
+	for( size_t continuationIndex = 0; continuationIndex < continuationCount; ++continuationIndex )
+	{
+		const Continuation& rContinuation = continuations[ continuationIndex ];
+		if( !TryFinishLoad( rContinuation.loadId, spObject ) )
+		{
+			MutexScopeLock scopeLock( m_continuationLock );
+			m_continuations.Push( rContinuation );
+
+			continue;
+		}
+
+		rContinuation.pCallback( rContinuation.pUserData, spObject );
+		spObject.Release();
+	}
+}
+
+/// Tick a load request taken from one of the ready queues and schedule it based on what it is waiting for.
+///
+/// @param[in] pRequest       Load request to update.
+/// @param[in] bWorkerThread  True if ticking from TickWorker(), false if ticking from Tick().
+void AssetLoader::TickReadyRequest( LoadRequest* pRequest, bool bWorkerThread )
+{
+	HELIUM_ASSERT( pRequest );
+
+	// Hold a reference to the request so that it is not released by TryFinishLoad() as soon as it has fully loaded.
+	AtomicIncrementAcquire( pRequest->requestCount );
+
+	int32_t previousStateFlags = pRequest->stateFlags;
+	TickLoadRequest( pRequest, bWorkerThread );
+	ScheduleRequest( pRequest, previousStateFlags, bWorkerThread );
+
+	ReleaseTickReference( pRequest );
+}
+
+/// Schedule a load request after it has been ticked.
+///
+/// Requests that advanced wake any requests waiting on them.  Requests that have not fully loaded are parked on the
+/// load request on which they stalled, or on file I/O if they did not stall on another request.
+///
+/// @param[in] pRequest            Load request that was just ticked.
+/// @param[in] previousStateFlags  State flags of the request before it was ticked.
+/// @param[in] bWorkerThread       True if the request was ticked from TickWorker(), false if not.
+void AssetLoader::ScheduleRequest( LoadRequest* pRequest, int32_t previousStateFlags, bool bWorkerThread )
+{
+	HELIUM_ASSERT( pRequest );
+
+	int32_t stateFlags = pRequest->stateFlags;
+	bool bAdvanced = ( ( ( stateFlags ^ previousStateFlags ) & ~LOAD_FLAG_IN_TICK ) != 0 );
+	if( bAdvanced )
+	{
+		AtomicIncrementRelease( m_progressCounter );
+	}
+
+	MutexScopeLock scopeLock( m_readyLock );
+
+	HELIUM_ASSERT( pRequest->waitState == WAIT_STATE_NONE );
+
+	if( bAdvanced )
+	{
+		size_t dependentCount = pRequest->dependents.GetSize();
+		for( size_t dependentIndex = 0; dependentIndex < dependentCount; ++dependentIndex )
+		{
+			LoadRequest* pDependent = pRequest->dependents[ dependentIndex ];
+			HELIUM_ASSERT( pDependent );
+			HELIUM_ASSERT( pDependent->waitState == WAIT_STATE_DEPENDENCY );
+			PushReadyRequest( pDependent );
+		}
+
+		pRequest->dependents.Resize( 0 );
+	}
+
+	if( ( stateFlags & LOAD_FLAG_FULLY_LOADED ) == LOAD_FLAG_FULLY_LOADED )
+	{
+		return;
+	}
+
+	// Worker threads leave preloading, resource precaching and load finalization to Tick().
+	if( bWorkerThread &&
+		( !( stateFlags & LOAD_FLAG_PRELOADED ) || ( stateFlags & ( LOAD_FLAG_PRECACHE_READY | LOAD_FLAG_PRECACHED ) ) ) )
+	{
+		PushReadyRequest( pRequest );
+
+		return;
+	}
+
+	LoadRequest* pBlockingRequest = pRequest->pBlockingRequest;
+	if( pBlockingRequest )
+	{
+		// Only park the request if the blocking request has not advanced since the stall was detected.
+		if( ( pBlockingRequest->stateFlags & ~LOAD_FLAG_IN_TICK ) != pRequest->blockingStateFlags )
+		{
+			PushReadyRequest( pRequest );
+
+			return;
+		}
+
+		pBlockingRequest->dependents.Push( pRequest );
+		pRequest->waitState = WAIT_STATE_DEPENDENCY;
+
+		return;
+	}
+
+	m_ioWaitRequests.Push( pRequest );
+	pRequest->waitState = WAIT_STATE_IO;
+}
+
+/// Take the next load request from the ready queues.
+///
+/// @param[out] rpRequest      Load request to tick.
+/// @param[in]  bWorkerThread  True to only take requests that are ready to be linked or precached.
+///
+/// @return  True if a request was taken, false if no requests are ready.
+bool AssetLoader::PopReadyRequest( LoadRequest*& rpRequest, bool bWorkerThread )
+{
+	MutexScopeLock scopeLock( m_readyLock );
+
+	DynamicArray< LoadRequest* >* pQueue = &m_readyWorkerRequests;
+	if( !bWorkerThread && !m_readyRequests.IsEmpty() )
+	{
+		pQueue = &m_readyRequests;
+	}
+
+	if( pQueue->IsEmpty() )
+	{
+		return false;
+	}
+
+	rpRequest = ( *pQueue )[ pQueue->GetSize() - 1 ];
+	HELIUM_ASSERT( rpRequest );
+	pQueue->Pop();
+
+	HELIUM_ASSERT( rpRequest->waitState == WAIT_STATE_READY );
+	rpRequest->waitState = WAIT_STATE_NONE;
+
+	return true;
+}
+
+/// Add a load request to the ready queue for its current load stage.
+///
+/// This must be called with the ready lock held.
+///
+/// @param[in] pRequest  Load request to queue.
+void AssetLoader::PushReadyRequest( LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	int32_t stateFlags = pRequest->stateFlags;
+	if( ( stateFlags & LOAD_FLAG_PRELOADED ) && !( stateFlags & ( LOAD_FLAG_PRECACHE_READY | LOAD_FLAG_PRECACHED ) ) )
+	{
+		m_readyWorkerRequests.Push( pRequest );
+	}
+	else
+	{
+		m_readyRequests.Push( pRequest );
+	}
+
+	pRequest->waitState = WAIT_STATE_READY;
+}
+
+/// Make the requests waiting for file I/O or package loader progress ready if any async file reads have completed or
+/// any load requests or package loaders have advanced since they were last woken.
+///
+/// @param[in] ioCompletionCount  Async loader completed request count, sampled before the package loaders were ticked.
+/// @param[in] progressCount      Progress counter value, sampled before the package loaders were ticked.
+void AssetLoader::WakeWaitingRequests( uint32_t ioCompletionCount, int32_t progressCount )
+{
+	MutexScopeLock scopeLock( m_readyLock );
+
+	if( ioCompletionCount == m_wakeIoCompletionCount && progressCount == m_wakeProgressCount )
+	{
+		return;
+	}
+
+	m_wakeIoCompletionCount = ioCompletionCount;
+	m_wakeProgressCount = progressCount;
+
+	size_t waitingCount = m_ioWaitRequests.GetSize();
+	for( size_t waitingIndex = 0; waitingIndex < waitingCount; ++waitingIndex )
+	{
+		LoadRequest* pRequest = m_ioWaitRequests[ waitingIndex ];
+		HELIUM_ASSERT( pRequest );
+		HELIUM_ASSERT( pRequest->waitState == WAIT_STATE_IO );
+		PushReadyRequest( pRequest );
+	}
+
+	m_ioWaitRequests.Resize( 0 );
+}
+
+/// Release the reference held on a load request while ticking it, releasing the request itself if it was the last
+/// reference.
+///
+/// @param[in] pRequest  Load request that was ticked.
+void AssetLoader::ReleaseTickReference( LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	int32_t newRequestCount = AtomicDecrementRelease( pRequest->requestCount );
+	if( newRequestCount != 0 )
+	{
+		return;
+	}
+
+	ConcurrentHashMap< AssetPath, LoadRequest* >::Accessor loadRequestAccessor;
+	if( m_loadRequestMap.Find( loadRequestAccessor, pRequest->path ) )
+	{
+		pRequest = loadRequestAccessor->Second();
+		HELIUM_ASSERT( pRequest );
+		if( pRequest->requestCount == 0 )
+		{
+			HELIUM_ASSERT( ( pRequest->stateFlags & LOAD_FLAG_FULLY_LOADED ) == LOAD_FLAG_FULLY_LOADED );
+			HELIUM_ASSERT( pRequest->dependents.IsEmpty() );
+
+			pRequest->spObject.Release();
+			pRequest->resolver.Clear();
+
+			m_loadRequestMap.Remove( loadRequestAccessor );
+			m_loadRequestPool.Release( pRequest );
+		}
+	}
+}
+
 /// @fn void AssetLoader::TickPackageLoaders()
 /// Tick all package loaders for the current AssetLoader tick.
 
@@ -381,13 +686,16 @@ void AssetLoader::OnLoadComplete( const AssetPath & /*path*/, Asset* /*pObject*/
 
 /// Update the given load request.
 ///
-/// @param[in] pRequest  Load request to update.
+/// @param[in] pRequest       Load request to update.
+/// @param[in] bWorkerThread  True to only perform linking and precaching, false to perform all load steps.
 ///
 /// @return  True if the load request has completed, false if it still requires time to process.
-bool AssetLoader::TickLoadRequest( LoadRequest* pRequest )
+bool AssetLoader::TickLoadRequest( LoadRequest* pRequest, bool bWorkerThread )
 {
 	HELIUM_ASSERT( pRequest );
 
+	pRequest->pBlockingRequest = NULL;
+
 	// Update preloading.
 	bool bLockedTick = false;
 
@@ -406,6 +714,11 @@ bool AssetLoader::TickLoadRequest( LoadRequest* pRequest )
 
 	if( !( pRequest->stateFlags & LOAD_FLAG_PRELOADED ) )
 	{
+		if( bWorkerThread )
+		{
+			return false;
+		}
+
 		LOCK_TICK();
 
 		if( !TickPreload( pRequest ) )
@@ -440,7 +753,7 @@ bool AssetLoader::TickLoadRequest( LoadRequest* pRequest )
 	{
 		LOCK_TICK();
 
-		if( !TickPrecache( pRequest ) )
+		if( !TickPrecache( pRequest, bWorkerThread ) )
 		{
 			UNLOCK_TICK();
 
@@ -454,6 +767,16 @@ bool AssetLoader::TickLoadRequest( LoadRequest* pRequest )
 
 	if( !( pRequest->stateFlags & LOAD_FLAG_LOADED ) )
 	{
+		if( bWorkerThread )
+		{
+			if( bLockedTick )
+			{
+				UNLOCK_TICK();
+			}
+
+			return false;
+		}
+
 		LOCK_TICK();
 
 		if( !TickFinalizeLoad( pRequest ) )
@@ -567,6 +890,9 @@ bool AssetLoader::TickLink( LoadRequest* pRequest )
 	{
 		if( !pRequest->resolver.ReadyToApplyFixups() )
 		{
+			pRequest->pBlockingRequest = m_loadRequestPool.GetObject( pRequest->resolver.m_BlockingLoadRequestId );
+			pRequest->blockingStateFlags = pRequest->resolver.m_BlockingStateFlags;
+
 			return false;
 		}
 		
@@ -583,10 +909,14 @@ bool AssetLoader::TickLink( LoadRequest* pRequest )
 
 /// Update resource precaching for the given object load request.
 ///
-/// @param[in] pRequest  Load request to update.
+/// The work preceding resource precaching (OnPrecacheReady()) can be performed from a worker thread, but resource
+/// precaching itself is only started and finished from Tick(), as it may create renderer resources.
+///
+/// @param[in] pRequest       Load request to update.
+/// @param[in] bWorkerThread  True if ticking from TickWorker(), false if ticking from Tick().
 ///
 /// @return  True if resource precaching still requires processing, false if not.
-bool AssetLoader::TickPrecache( LoadRequest* pRequest )
+bool AssetLoader::TickPrecache( LoadRequest* pRequest, bool bWorkerThread )
 {
 	HELIUM_ASSERT( pRequest );
 	HELIUM_ASSERT( !( pRequest->stateFlags & LOAD_FLAG_LOADED ) );
@@ -594,22 +924,35 @@ bool AssetLoader::TickPrecache( LoadRequest* pRequest )
 	Asset* pAsset = pRequest->spObject;
 	if( pAsset )
 	{
-		// TODO: SHouldn't this be in the linking phase?
-		if ( !pRequest->resolver.TryFinishPrecachingDependencies() )
+		if( !( pRequest->stateFlags & LOAD_FLAG_PRECACHE_READY ) )
 		{
-			return false;
-		}
+			// TODO: SHouldn't this be in the linking phase?
+			if ( !pRequest->resolver.TryFinishPrecachingDependencies() )
+			{
+				pRequest->pBlockingRequest = m_loadRequestPool.GetObject( pRequest->resolver.m_BlockingLoadRequestId );
+				pRequest->blockingStateFlags = pRequest->resolver.m_BlockingStateFlags;
 
-		pRequest->resolver.Clear();
+				return false;
+			}
 
-		// Perform any pre-precaching work (note that we don't precache anything for the default template object for
-		// a given type).
-		OnPrecacheReady( pAsset, pRequest->pPackageLoader );
+			pRequest->resolver.Clear();
+
+			// Perform any pre-precaching work (note that we don't precache anything for the default template object
+			// for a given type).
+			OnPrecacheReady( pAsset, pRequest->pPackageLoader );
+
+			AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_PRECACHE_READY );
+		}
 
 		if( !pAsset->GetAnyFlagSet( Asset::FLAG_BROKEN ) &&
 			!pAsset->IsDefaultTemplate() &&
 			pAsset->NeedsPrecacheResourceData() )
 		{
+			if( bWorkerThread )
+			{
+				return false;
+			}
+
 			if( !( pRequest->stateFlags & LOAD_FLAG_PRECACHE_STARTED ) )
 			{
 				if( !pAsset->BeginPrecacheResourceData() )
@@ -752,8 +1095,12 @@ bool Helium::AssetResolver::ReadyToApplyFixups()
 		// Retrieve the load request and test whether it has completed.
 		AssetLoader::LoadRequest* pRequest = AssetLoader::GetInstance()->m_loadRequestPool.GetObject( iter->m_LoadRequestId );
 
-		if ( !( pRequest->stateFlags & AssetLoader::LOAD_FLAG_PRELOADED ) )
+		// Record the flags that were tested, so that the request is not parked if the dependency advances after this.
+		int32_t stateFlags = pRequest->stateFlags;
+		if ( !( stateFlags & AssetLoader::LOAD_FLAG_PRELOADED ) )
 		{
+			m_BlockingLoadRequestId = iter->m_LoadRequestId;
+			m_BlockingStateFlags = stateFlags & ~AssetLoader::LOAD_FLAG_IN_TICK;
 			return false;
 		}
 	}
@@ -783,6 +1130,8 @@ void Helium::AssetResolver::ApplyFixups()
 void Helium::AssetResolver::Clear()
 {
 	m_Fixups.Clear();
+	SetInvalid( m_BlockingLoadRequestId );
+	m_BlockingStateFlags = 0;
 }
 
 bool Helium::AssetResolver::TryFinishPrecachingDependencies()
@@ -792,9 +1141,17 @@ bool Helium::AssetResolver::TryFinishPrecachingDependencies()
 	{
 		if ( IsValid( iter->m_LoadRequestId ) )
 		{
+			AssetLoader* pAssetLoader = AssetLoader::GetInstance();
+
+			// Record the flags before testing them, so that the request is not parked if the dependency advances
+			// after this.
+			int32_t stateFlags = pAssetLoader->m_loadRequestPool.GetObject( iter->m_LoadRequestId )->stateFlags;
+
 			AssetPtr asset;
-			if( !AssetLoader::GetInstance()->TryFinishLoad( iter->m_LoadRequestId, asset ) )
+			if( !pAssetLoader->TryFinishLoad( iter->m_LoadRequestId, asset ) )
 			{
+				m_BlockingLoadRequestId = iter->m_LoadRequestId;
+				m_BlockingStateFlags = stateFlags & ~AssetLoader::LOAD_FLAG_IN_TICK;
 				return false;
 			}
 		
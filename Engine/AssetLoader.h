@@ -2,6 +2,7 @@
 
 #include "Engine/Engine.h"
 
+#include "Platform/Locks.h"
 #include "Reflect/Translator.h"
 #include "Foundation/ConcurrentHashMap.h"
 #include "Foundation/ObjectPool.h"
@@ -33,6 +34,11 @@ namespace Helium
 		bool TryFinishPrecachingDependencies();
 		void Clear();
 
+		// Load request on which ReadyToApplyFixups() or TryFinishPrecachingDependencies() last returned false
+		size_t m_BlockingLoadRequestId;
+		// State flags of the blocking load request (excluding LOAD_FLAG_IN_TICK) as of when it was checked
+		int32_t m_BlockingStateFlags;
+
 		// Internal fixups that must be completed
 		struct Fixup
 		{
@@ -56,12 +62,26 @@ namespace Helium
 	};
 
 	/// Asynchronous object loading interface
+	///
+	/// Load requests are only ticked when something they are waiting on may have changed.  A request that stalls on a
+	/// dependency (another load request that must be preloaded before linking, or fully loaded before precaching) is
+	/// parked on that dependency and made ready again once the dependency advances.  Requests waiting on file I/O or
+	/// package loader work are parked until an async file read completes, another request advances, or a package
+	/// loader reports progress made without file I/O through NotifyPackageLoaderProgress().  Requests that are ready
+	/// for linking or for the work preceding resource precaching (OnPrecacheReady()) can additionally be ticked from
+	/// worker threads with TickWorker().
 	class HELIUM_ENGINE_API AssetLoader : NonCopyable
 	{
 	public:
 		/// Number of request objects to allocate in each block of the request pool.
 		static const size_t LOAD_REQUEST_POOL_BLOCK_SIZE = 64;
 
+		/// Load continuation callback, called from Tick() once the load request it was registered for has completed.
+		///
+		/// @param[in] pUserData  User data supplied when registering the continuation.
+		/// @param[in] rspObject  Loaded object, or a null reference if the object failed to load.
+		typedef void ( CONTINUATION_CALLBACK )( void* pUserData, const AssetPtr& rspObject );
+
 		friend AssetIdentifier;
 		friend AssetResolver;
 
@@ -76,6 +96,7 @@ namespace Helium
 		virtual size_t BeginLoadObject( AssetPath path, bool forceReload = false );
 		virtual bool TryFinishLoad( size_t id, AssetPtr& rspObject );
 		void FinishLoad( size_t id, AssetPtr& rspObject );
+		void AddContinuation( size_t id, CONTINUATION_CALLBACK* pCallback, void* pUserData = NULL );
 
 		bool LoadObject( AssetPath path, AssetPtr& rspObject, bool forceReload = false );
 
@@ -96,6 +117,9 @@ namespace Helium
 #endif
 
 		virtual void Tick();
+		size_t TickWorker( size_t requestCountMax = Invalid< size_t >() );
+
+		void NotifyPackageLoaderProgress();
 		//@}
 
 		/// @name Static Access
@@ -133,6 +157,22 @@ namespace Helium
 
 			/// Set if ticking is in progress.
 			LOAD_FLAG_IN_TICK = 1 << 6,
+
+			/// Set once the object is ready for resource precaching (OnPrecacheReady() has been called).
+			LOAD_FLAG_PRECACHE_READY = 1 << 7,
+		};
+
+		/// Load request scheduling states.
+		enum EWaitState
+		{
+			/// Not scheduled (being ticked or fully loaded).
+			WAIT_STATE_NONE,
+			/// Queued to be ticked.
+			WAIT_STATE_READY,
+			/// Waiting for another load request to advance.
+			WAIT_STATE_DEPENDENCY,
+			/// Waiting for file I/O or package loader progress.
+			WAIT_STATE_IO,
 		};
 
 		/// Asset load request information.
@@ -157,6 +197,26 @@ namespace Helium
 			AssetResolver resolver;
 
 			bool forceReload;
+
+			/// Load request on which the last tick stalled (null if it did not stall on another request).
+			LoadRequest* pBlockingRequest;
+			/// State flags of the blocking request as read when it was tested (see AssetResolver::m_BlockingStateFlags).
+			int32_t blockingStateFlags;
+			/// Load requests waiting for this request to advance (guarded by m_readyLock).
+			DynamicArray< LoadRequest* > dependents;
+			/// Scheduling state (guarded by m_readyLock).
+			EWaitState waitState;
+		};
+
+		/// Load continuation information.
+		struct Continuation
+		{
+			/// Load request ID.
+			size_t loadId;
+			/// Continuation callback.
+			CONTINUATION_CALLBACK* pCallback;
+			/// Continuation callback user data.
+			void* pUserData;
 		};
 
 		/// Load request hash map.
@@ -164,6 +224,28 @@ namespace Helium
 		/// Load request pool.
 		ObjectPool< LoadRequest > m_loadRequestPool;
 
+		/// Load requests ready to be ticked by Tick().
+		DynamicArray< LoadRequest* > m_readyRequests;
+		/// Load requests ready to be linked or prepared for precaching, which can be ticked by either Tick() or
+		/// TickWorker().
+		DynamicArray< LoadRequest* > m_readyWorkerRequests;
+		/// Load requests waiting for file I/O or package loader progress.
+		DynamicArray< LoadRequest* > m_ioWaitRequests;
+		/// Mutex synchronizing access to the request queues and each request's scheduling state.
+		Mutex m_readyLock;
+
+		/// Number of times any load request has advanced its load state.
+		volatile int32_t m_progressCounter;
+		/// Progress counter value when the requests waiting for I/O were last woken (guarded by m_readyLock).
+		int32_t m_wakeProgressCount;
+		/// Async loader completion count when the requests waiting for I/O were last woken (guarded by m_readyLock).
+		uint32_t m_wakeIoCompletionCount;
+
+		/// Registered load continuations.
+		DynamicArray< Continuation > m_continuations;
+		/// Mutex synchronizing access to the load continuation list.
+		Mutex m_continuationLock;
+
 		/// Singleton instance.
 		static AssetLoader* sm_pInstance;
 
@@ -180,11 +262,23 @@ namespace Helium
 
 		/// @name Load Process Updating
 		//@{
-		bool TickLoadRequest( LoadRequest* pRequest );
+		bool TickLoadRequest( LoadRequest* pRequest, bool bWorkerThread = false );
 		bool TickPreload( LoadRequest* pRequest );
 		bool TickLink( LoadRequest* pRequest );
-		bool TickPrecache( LoadRequest* pRequest );
+		bool TickPrecache( LoadRequest* pRequest, bool bWorkerThread );
 		bool TickFinalizeLoad( LoadRequest* pRequest );
+
+		void TickContinuations();
+		//@}
+
+		/// @name Load Request Scheduling
+		//@{
+		void TickReadyRequest( LoadRequest* pRequest, bool bWorkerThread );
+		void ScheduleRequest( LoadRequest* pRequest, int32_t previousStateFlags, bool bWorkerThread );
+		bool PopReadyRequest( LoadRequest*& rpRequest, bool bWorkerThread );
+		void PushReadyRequest( LoadRequest* pRequest );
+		void WakeWaitingRequests( uint32_t ioCompletionCount, int32_t progressCount );
+		void ReleaseTickReference( LoadRequest* pRequest );
 		//@}
 	};
 
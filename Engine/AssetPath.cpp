@@ -17,8 +17,7 @@ struct Helium::AssetPath::PendingLink
 
 using namespace Helium;
 
-AssetPath::TableBucket* AssetPath::sm_pTable = NULL;
-StackMemoryHeap<>* AssetPath::sm_pEntryMemoryHeap = NULL;
+AssetPath::TableShard* AssetPath::sm_pTableShards = NULL;
 ObjectPool<AssetPath::PendingLink> *AssetPath::sm_pPendingLinksPool = NULL;
 
 /// Parse the object path in the specified string and store it in this object.
@@ -504,11 +503,8 @@ void AssetPath::Shutdown()
 {
 	HELIUM_TRACE( TraceLevels::Info, TXT( "Shutting down AssetPath table.\n" ) );
 
-	delete [] sm_pTable;
-	sm_pTable = NULL;
-
-	delete sm_pEntryMemoryHeap;
-	sm_pEntryMemoryHeap = NULL;
+	delete [] sm_pTableShards;
+	sm_pTableShards = NULL;
 
 	delete sm_pPendingLinksPool;
 	sm_pPendingLinksPool = NULL;
@@ -849,40 +845,34 @@ bool AssetPath::Parse(
 
 /// Look up a table entry, adding it if it does not exist.
 ///
-/// This also handles lazy initialization of the path table and allocator.
+/// This also handles lazy initialization of the path table.
 ///
-/// @param[in] rEntry  Entry to locate or add.
+/// @param[in] rEntry  Entry to locate or add (its hash is computed here).
 ///
 /// @return  Pointer to the actual table entry.
 AssetPath::Entry* AssetPath::Add( const Entry& rEntry )
 {
-	// Lazily initialize the hash table.  Note that this is not inherently thread-safe, but there should always be
-	// at least one path created before any sub-threads are spawned.
-	if( !sm_pEntryMemoryHeap )
+	// Lazily initialize the table.  Note that this is not inherently thread-safe, but there should always be at least
+	// one path created before any sub-threads are spawned.
+	if( !sm_pTableShards )
 	{
-		sm_pEntryMemoryHeap = new StackMemoryHeap<>( STACK_HEAP_BLOCK_SIZE );
-		HELIUM_ASSERT( sm_pEntryMemoryHeap );
-
 		sm_pPendingLinksPool = new ObjectPool<PendingLink>( PENDING_LINKS_POOL_BLOCK_SIZE );
 		HELIUM_ASSERT( sm_pPendingLinksPool );
 
-		HELIUM_ASSERT( !sm_pTable );
-		sm_pTable = new TableBucket [ TABLE_BUCKET_COUNT ];
-		HELIUM_ASSERT( sm_pTable );
+		sm_pTableShards = new TableShard [ TABLE_SHARD_COUNT ];
+		HELIUM_ASSERT( sm_pTableShards );
 	}
 
-	HELIUM_ASSERT( sm_pTable );
+	Entry entry( rEntry );
+	entry.hash = ComputeEntryHash( entry );
 
-	// Compute the entry's hash table index and retrieve the corresponding bucket.
-	uint32_t bucketIndex = ComputeEntryStringHash( rEntry ) % TABLE_BUCKET_COUNT;
-	TableBucket& rBucket = sm_pTable[ bucketIndex ];
+	// The low bits of the hash select the shard, while the remaining bits select the slot within the shard.
+	TableShard& rShard = sm_pTableShards[ entry.hash & ( TABLE_SHARD_COUNT - 1 ) ];
 
-	// Locate the entry in the table.  If it does not exist, add it.
-	size_t entryCount = 0;
-	Entry* pTableEntry = rBucket.Find( rEntry, entryCount );
+	Entry* pTableEntry = rShard.Find( entry );
 	if( !pTableEntry )
 	{
-		pTableEntry = rBucket.Add( rEntry, entryCount );
+		pTableEntry = rShard.Add( entry );
 		HELIUM_ASSERT( pTableEntry );
 	}
 
@@ -932,13 +922,13 @@ void AssetPath::EntryToFilePathString( const Entry& rEntry, String& rString )
 	rString += rEntry.name.Get();
 }
 
-/// Compute a hash value for an object path entry based on the contents of the name strings (slow, should only be
-/// used internally when a string comparison is needed).
+/// Compute the hash value for an object path entry based on the contents of its name string, using the hash cached
+/// in its parent entry.
 ///
 /// @param[in] rEntry  Asset path entry.
 ///
 /// @return  Hash value.
-size_t AssetPath::ComputeEntryStringHash( const Entry& rEntry )
+size_t AssetPath::ComputeEntryHash( const Entry& rEntry )
 {
 	size_t hash = StringHash( rEntry.name.GetDirect() );
 	hash = ( ( hash * 33 ) ^ rEntry.instanceIndex );
@@ -950,8 +940,7 @@ size_t AssetPath::ComputeEntryStringHash( const Entry& rEntry )
 	Entry* pParent = rEntry.pParent;
 	if( pParent )
 	{
-		size_t parentHash = ComputeEntryStringHash( *pParent );
-		hash = ( ( hash * 33 ) ^ parentHash );
+		hash = ( ( hash * 33 ) ^ pParent->hash );
 	}
 
 	return hash;
@@ -965,78 +954,180 @@ size_t AssetPath::ComputeEntryStringHash( const Entry& rEntry )
 /// @return  True if the contents match, false if not.
 bool AssetPath::EntryContentsMatch( const Entry& rEntry0, const Entry& rEntry1 )
 {
-	return ( rEntry0.name == rEntry1.name &&
+	return ( rEntry0.hash == rEntry1.hash &&
+		rEntry0.name == rEntry1.name &&
 		rEntry0.instanceIndex == rEntry1.instanceIndex &&
 		( rEntry0.bPackage ? rEntry1.bPackage : !rEntry1.bPackage ) &&
 		rEntry0.pParent == rEntry1.pParent );
 }
 
-/// Find an existing object path entry in this table.
+/// Constructor.
+AssetPath::TableShard::TableShard()
+	: m_pTable( CreateSlotTable( TABLE_SHARD_SLOT_COUNT_MIN ) )
+	, m_entryCount( 0 )
+	, m_pEntryMemoryHeap( NULL )
+{
+}
+
+/// Destructor.
+AssetPath::TableShard::~TableShard()
+{
+	DestroySlotTable( m_pTable );
+
+	size_t retiredTableCount = m_retiredTables.GetSize();
+	for( size_t tableIndex = 0; tableIndex < retiredTableCount; ++tableIndex )
+	{
+		DestroySlotTable( m_retiredTables[ tableIndex ] );
+	}
+
+	delete m_pEntryMemoryHeap;
+}
+
+/// Find an existing object path entry in this shard.
 ///
-/// @param[in]  rEntry       Externally defined entry to match.
-/// @param[out] rEntryCount  Number of entries in this bucket when the search was performed.
+/// This does not lock the shard.
+///
+/// @param[in] rEntry  Externally defined entry to match (including its hash).
 ///
 /// @return  Table entry if found, null if not found.
 ///
 /// @see Add()
-AssetPath::Entry* AssetPath::TableBucket::Find( const Entry& rEntry, size_t& rEntryCount )
+AssetPath::Entry* AssetPath::TableShard::Find( const Entry& rEntry ) const
 {
-	ScopeReadLock readLock( m_lock );
+	size_t slotIndex;
 
-	Entry* const * ppTableEntries = m_entries.GetData();
-	size_t entryCount = m_entries.GetSize();
-	HELIUM_ASSERT( ppTableEntries || entryCount == 0 );
+	return FindSlot( m_pTable, rEntry, slotIndex );
+}
 
-	rEntryCount = entryCount;
+/// Add an object path entry to this shard if it does not already exist.
+///
+/// @param[in] rEntry  Externally defined entry to locate or add (including its hash).
+///
+/// @return  Pointer to the object path table entry.
+///
+/// @see Find()
+AssetPath::Entry* AssetPath::TableShard::Add( const Entry& rEntry )
+{
+	MutexScopeLock scopeLock( m_lock );
+
+	// Search again in case the entry was added since the lock-free lookup.
+	SlotTable* pTable = m_pTable;
 
-	for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	size_t slotIndex;
+	Entry* pTableEntry = FindSlot( pTable, rEntry, slotIndex );
+	if( pTableEntry )
 	{
-		Entry* pTableEntry = ppTableEntries[ entryIndex ];
-		HELIUM_ASSERT( pTableEntry );
-		if( EntryContentsMatch( rEntry, *pTableEntry ) )
+		return pTableEntry;
+	}
+
+	if( !m_pEntryMemoryHeap )
+	{
+		m_pEntryMemoryHeap = new StackMemoryHeap<>( STACK_HEAP_BLOCK_SIZE );
+		HELIUM_ASSERT( m_pEntryMemoryHeap );
+	}
+
+	Entry* pNewEntry = static_cast< Entry* >( m_pEntryMemoryHeap->Allocate( sizeof( Entry ) ) );
+	HELIUM_ASSERT( pNewEntry );
+	new( pNewEntry ) Entry( rEntry );
+
+	++m_entryCount;
+
+	// Keep the table at most half full, growing it into a new slot array before it is published.
+	size_t slotCount = pTable->slotMask + 1;
+	if( m_entryCount * 2 > slotCount )
+	{
+		SlotTable* pNewTable = CreateSlotTable( slotCount * 2 );
+		HELIUM_ASSERT( pNewTable );
+
+		for( size_t oldSlotIndex = 0; oldSlotIndex < slotCount; ++oldSlotIndex )
 		{
-			return pTableEntry;
+			Entry* pOldEntry = pTable->pSlots[ oldSlotIndex ];
+			if( pOldEntry )
+			{
+				HELIUM_VERIFY( !FindSlot( pNewTable, *pOldEntry, slotIndex ) );
+				pNewTable->pSlots[ slotIndex ] = pOldEntry;
+			}
 		}
+
+		HELIUM_VERIFY( !FindSlot( pNewTable, *pNewEntry, slotIndex ) );
+		pNewTable->pSlots[ slotIndex ] = pNewEntry;
+
+		m_retiredTables.Push( pTable );
+		AtomicExchangeRelease( m_pTable, pNewTable );
+	}
+	else
+	{
+		AtomicExchangeRelease( pTable->pSlots[ slotIndex ], pNewEntry );
 	}
 
-	return NULL;
+	return pNewEntry;
 }
 
-/// Add an object path entry to this table if it does not already exist.
+/// Allocate an empty slot array.
 ///
-/// @param[in] rEntry              Externally defined entry to locate or add.
-/// @param[in] previousEntryCount  Number of entries already checked during a previous Find() call (existing entries
-///                                are not expected to change).  In other words, the entry index from which to start
-///                                checking for any additional string entries that may have been added since the
-///                                previous Find() call.
+/// @param[in] slotCount  Number of slots (must be a power of two).
 ///
-/// @return  Pointer to the object path table entry.
+/// @return  Slot array.
 ///
-/// @see Find()
-AssetPath::Entry* AssetPath::TableBucket::Add( const Entry& rEntry, size_t previousEntryCount )
+/// @see DestroySlotTable()
+AssetPath::TableShard::SlotTable* AssetPath::TableShard::CreateSlotTable( size_t slotCount )
 {
-	ScopeWriteLock writeLock( m_lock );
+	HELIUM_ASSERT( slotCount != 0 && ( slotCount & ( slotCount - 1 ) ) == 0 );
+
+	SlotTable* pTable = new SlotTable;
+	HELIUM_ASSERT( pTable );
+	pTable->slotMask = slotCount - 1;
+	pTable->pSlots = new Entry* volatile [ slotCount ];
+	HELIUM_ASSERT( pTable->pSlots );
+	MemoryZero( const_cast< Entry** >( pTable->pSlots ), sizeof( Entry* ) * slotCount );
 
-	Entry* const * ppTableEntries = m_entries.GetData();
-	size_t entryCount = m_entries.GetSize();
-	HELIUM_ASSERT( ppTableEntries || entryCount == 0 );
-	HELIUM_ASSERT( previousEntryCount <= entryCount );
-	for( size_t entryIndex = previousEntryCount; entryIndex < entryCount; ++entryIndex )
+	return pTable;
+}
+
+/// Free a slot array.
+///
+/// @param[in] pTable  Slot array allocated using CreateSlotTable().
+///
+/// @see CreateSlotTable()
+void AssetPath::TableShard::DestroySlotTable( SlotTable* pTable )
+{
+	if( pTable )
 	{
-		Entry* pTableEntry = ppTableEntries[ entryIndex ];
-		HELIUM_ASSERT( pTableEntry );
-		if( EntryContentsMatch( rEntry, *pTableEntry ) )
-		{
-			return pTableEntry;
-		}
+		delete [] pTable->pSlots;
+		delete pTable;
 	}
+}
 
-	HELIUM_ASSERT( sm_pEntryMemoryHeap );
-	Entry* pNewEntry = static_cast< Entry* >( sm_pEntryMemoryHeap->Allocate( sizeof( Entry ) ) );
-	HELIUM_ASSERT( pNewEntry );
-	new( pNewEntry ) Entry( rEntry );
+/// Probe a slot array for an entry.
+///
+/// @param[in]  pTable      Slot array to search.
+/// @param[in]  rEntry      Entry to match (including its hash).
+/// @param[out] rSlotIndex  Index of the slot containing the entry if found, or the empty slot at which the search
+///                         ended if not found.
+///
+/// @return  Table entry if found, null if not found.
+AssetPath::Entry* AssetPath::TableShard::FindSlot( const SlotTable* pTable, const Entry& rEntry, size_t& rSlotIndex )
+{
+	HELIUM_ASSERT( pTable );
 
-	m_entries.Push( pNewEntry );
+	size_t slotMask = pTable->slotMask;
+	Entry* const volatile* pSlots = pTable->pSlots;
 
-	return pNewEntry;
+	for( size_t slotIndex = ( rEntry.hash / TABLE_SHARD_COUNT ) & slotMask; ; slotIndex = ( slotIndex + 1 ) & slotMask )
+	{
+		Entry* pSlotEntry = pSlots[ slotIndex ];
+		if( !pSlotEntry )
+		{
+			rSlotIndex = slotIndex;
+
+			return NULL;
+		}
+
+		if( EntryContentsMatch( rEntry, *pSlotEntry ) )
+		{
+			rSlotIndex = slotIndex;
+
+			return pSlotEntry;
+		}
+	}
 }
@@ -32,11 +32,18 @@ namespace Helium
 	class Asset;
 
 	/// Hashed object path name for fast lookups and comparisons.
+	///
+	/// Each unique path is interned once in a table split into TABLE_SHARD_COUNT shards.  Each shard is an
+	/// open-addressed hash table that is searched without locking, and only takes its lock to add new entries.  Each
+	/// entry caches its hash, computed from its own name and its parent's cached hash, so hashing a path never walks
+	/// its parents.
 	class HELIUM_ENGINE_API AssetPath
 	{
 	public:
-		/// Number of object path hash table buckets (prime numbers are recommended).
-		static const size_t TABLE_BUCKET_COUNT = 37;
+		/// Number of object path table shards (must be a power of two).
+		static const size_t TABLE_SHARD_COUNT = 64;
+		/// Initial number of slots in each object path table shard (must be a power of two).
+		static const size_t TABLE_SHARD_SLOT_COUNT_MIN = 64;
 		/// Asset path stack memory heap block size.
 		static const size_t STACK_HEAP_BLOCK_SIZE = sizeof( char ) * 8192;
 		/// Block size for pool of pending links
@@ -112,32 +119,64 @@ namespace Helium
 			uint32_t instanceIndex;
 			/// True if the object is a package.
 			bool bPackage;
+			/// Hash of the path contents.
+			size_t hash;
 		};
 
-		/// Asset path hash table bucket.
-		class TableBucket
+		/// Asset path table shard.
+		///
+		/// Slots are only ever filled in (entries are never removed), so lookups can probe the slots without locking.
+		/// Growing the table publishes a new slot array, and the old one is kept until shutdown in case a lookup is
+		/// still probing it.
+		class TableShard : NonCopyable
 		{
 		public:
+			/// @name Construction/Destruction
+			//@{
+			TableShard();
+			~TableShard();
+			//@}
+
 			/// @name Access
 			//@{
-			Entry* Find( const Entry& rEntry, size_t& rEntryCount );
-			Entry* Add( const Entry& rEntry, size_t previousEntryCount );
+			Entry* Find( const Entry& rEntry ) const;
+			Entry* Add( const Entry& rEntry );
 			//@}
 
 		private:
-			/// Array of entry pointers.
-			DynamicArray< Entry* > m_entries;
-			/// Read-write lock for synchronizing access.
-			ReadWriteLock m_lock;
+			/// Open-addressed slot array.
+			struct SlotTable
+			{
+				/// Slot index mask (number of slots minus one).
+				size_t slotMask;
+				/// Entry slots.
+				Entry* volatile* pSlots;
+			};
+
+			/// Current slot array.
+			SlotTable* volatile m_pTable;
+			/// Slot arrays replaced by a larger array (guarded by m_lock).
+			DynamicArray< SlotTable* > m_retiredTables;
+			/// Number of entries in the table (guarded by m_lock).
+			size_t m_entryCount;
+			/// Stack-based memory heap for entry allocations (guarded by m_lock).
+			StackMemoryHeap<>* m_pEntryMemoryHeap;
+			/// Mutex synchronizing additions to the table.
+			Mutex m_lock;
+
+			/// @name Private Static Utility Functions
+			//@{
+			static SlotTable* CreateSlotTable( size_t slotCount );
+			static void DestroySlotTable( SlotTable* pTable );
+			static Entry* FindSlot( const SlotTable* pTable, const Entry& rEntry, size_t& rSlotIndex );
+			//@}
 		};
 
 		/// Asset path entry.
 		Entry* m_pEntry;
 
-		/// Asset path hash table.
-		static TableBucket* sm_pTable;
-		/// Stack-based memory heap for object path entry allocations.
-		static StackMemoryHeap<>* sm_pEntryMemoryHeap;
+		/// Asset path table shards.
+		static TableShard* sm_pTableShards;
 		static ObjectPool<PendingLink> *sm_pPendingLinksPool;
 
 		/// @name Private Utility Functions
@@ -156,7 +195,7 @@ namespace Helium
 		static void EntryToString( const Entry& rEntry, String& rString );
 		static void EntryToFilePathString( const Entry& rEntry, String& rString );
 
-		static size_t ComputeEntryStringHash( const Entry& rEntry );
+		static size_t ComputeEntryHash( const Entry& rEntry );
 		static bool EntryContentsMatch( const Entry& rEntry0, const Entry& rEntry1 );
 		//@}
 	};
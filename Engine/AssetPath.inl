@@ -154,14 +154,15 @@ bool Helium::AssetPath::IsEmpty() const
 	return ( m_pEntry == NULL );
 }
 
-/// Compute a hash value for this object path (fast, should only be used with entries already in the object path
-/// table).
+/// Get the hash value for this object path.
+///
+/// The hash is cached when the path is first added to the object path table and is computed from the path contents,
+/// so it does not depend on where the path entry was allocated.
 ///
 /// @return  Hash value.
 size_t Helium::AssetPath::ComputeHash() const
 {
-	// Each AssetPath entry has a unique Entry pointer, so we can use the address itself as a hash.
-	return static_cast< size_t >( reinterpret_cast< uintptr_t >( m_pEntry ) );
+	return ( m_pEntry ? m_pEntry->hash : 0 );
 }
 
 /// Equality comparison operator.
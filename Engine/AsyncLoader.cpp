@@ -1,19 +1,49 @@
 #include "EnginePch.h"
 #include "Engine/AsyncLoader.h"
 
+#include "Engine/Cache.h"
 #include "Engine/FileLocations.h"
 #include "Foundation/FileStream.h"
+#include "Platform/Atomic.h"
+#include "Platform/Memory.h"
+
+#include <thread>
+
+#if HELIUM_OS_WIN
+#include "Platform/Encoding.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace Helium;
 
+#if HELIUM_OS_WIN
+// PrefetchVirtualMemory() is only available on Windows 8 and later, so it is looked up at runtime instead of being
+// linked against.  Its range type is only declared by the Windows headers when targeting Windows 8, so a layout
+// compatible copy is declared here.
+struct PREFETCH_MEMORY_RANGE
+{
+	void* pVirtualAddress;
+	size_t numberOfBytes;
+};
+
+typedef BOOL ( WINAPI PREFETCHVIRTUALMEMORY_FUNC )( HANDLE, ULONG_PTR, PREFETCH_MEMORY_RANGE*, ULONG );
+#endif
+
 static uint32_t g_InitCount = 0;
 AsyncLoader* AsyncLoader::sm_pInstance = NULL;
 
 /// Constructor.
 AsyncLoader::AsyncLoader()
 	: m_requestPool( REQUEST_POOL_BLOCK_SIZE )
-	, m_pThread( NULL )
-	, m_pWorker( NULL )
+	, m_wakeUpCondition( false, false )
+	, m_pendingRequestCount( 0 )
+	, m_completedRequestCount( 0 )
+	, m_sleepingWorkerCount( 0 )
+	, m_stopCounter( 0 )
 {
 }
 
@@ -23,54 +53,115 @@ AsyncLoader::~AsyncLoader()
 	Cleanup();
 }
 
-/// Initialize the async loader.
+/// Initialize the async loader and start its I/O worker threads.
+///
+/// This can be called again on an initialized loader to change the number of worker threads, provided no requests
+/// are pending.
+///
+/// @param[in] workerThreadCount  Number of I/O worker threads to create (clamped to between one and
+///                               FILE_STREAM_LIMIT).
 ///
 /// @return  True if initialization was sucessful, false if not.
 ///
-/// @see Cleanup()
-bool AsyncLoader::Initialize()
+/// @see Cleanup(), GetDefaultWorkerThreadCount()
+bool AsyncLoader::Initialize( uint32_t workerThreadCount )
 {
 	Cleanup();
 
-	// Start up the async loading thread.
-	m_pWorker = new LoadWorker;
-	HELIUM_ASSERT( m_pWorker );
+	workerThreadCount = Max< uint32_t >( workerThreadCount, 1 );
+	workerThreadCount = Min( workerThreadCount, static_cast< uint32_t >( FILE_STREAM_LIMIT ) );
 
-	m_pThread = new RunnableThread( m_pWorker );
-	HELIUM_ASSERT( m_pThread );
-	HELIUM_VERIFY( m_pThread->Start( TXT( "AsyncLoader - file loading" ) ) );
+	AtomicExchangeRelease( m_stopCounter, 0 );
+
+	// Start up the async loading threads.
+	m_workers.Reserve( workerThreadCount );
+	m_threads.Reserve( workerThreadCount );
+	for( uint32_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+	{
+		LoadWorker* pWorker = new LoadWorker( this );
+		HELIUM_ASSERT( pWorker );
+		m_workers.Push( pWorker );
+
+		RunnableThread* pThread = new RunnableThread( pWorker );
+		HELIUM_ASSERT( pThread );
+		HELIUM_VERIFY( pThread->Start( TXT( "AsyncLoader - file loading" ) ) );
+		m_threads.Push( pThread );
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "AsyncLoader::Initialize(): Started %" ) PRIu32 TXT( " file loading thread(s).\n" ),
+		workerThreadCount );
 
 	return true;
 }
 
 /// Shut down the async loader.
 ///
+/// Requests still queued when the loader is shut down are never processed.
+///
 /// @see Initialize()
 void AsyncLoader::Cleanup()
 {
-	if( m_pWorker )
+	AtomicExchangeRelease( m_stopCounter, 1 );
+	m_wakeUpCondition.Signal();
+
+	size_t threadCount = m_threads.GetSize();
+	for( size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex )
+	{
+		RunnableThread* pThread = m_threads[ threadIndex ];
+		HELIUM_ASSERT( pThread );
+		pThread->Join();
+		delete pThread;
+	}
+
+	m_threads.Clear();
+
+	size_t workerCount = m_workers.GetSize();
+	for( size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex )
+	{
+		delete m_workers[ workerIndex ];
+	}
+
+	m_workers.Clear();
+
+	ReleaseMappedFiles();
+
+	// Requests still waiting on prefetch reads are abandoned along with the rest of the queued requests.
+	size_t regionCount = m_prefetchRegions.GetSize();
+	for( size_t regionIndex = 0; regionIndex < regionCount; ++regionIndex )
 	{
-		m_pWorker->Stop();
+		PrefetchRegion* pRegion = m_prefetchRegions[ regionIndex ];
+		HELIUM_ASSERT( pRegion );
+		DefaultAllocator().Free( pRegion->pData );
+		delete pRegion;
 	}
 
-	if( m_pThread )
+	m_prefetchRegions.Clear();
+
+	MutexScopeLock scopeLock( m_completionLock );
+	HELIUM_ASSERT( m_completionWaiters.IsEmpty() );
+
+	size_t conditionCount = m_freeWaitConditions.GetSize();
+	for( size_t conditionIndex = 0; conditionIndex < conditionCount; ++conditionIndex )
 	{
-		m_pThread->Join();
-		delete m_pThread;
-		m_pThread = NULL;
+		delete m_freeWaitConditions[ conditionIndex ];
 	}
 
-	delete m_pWorker;
-	m_pWorker = NULL;
+	m_freeWaitConditions.Clear();
 }
 
 /// Queue an async load request.
 ///
-/// @param[in] pBuffer    Buffer in which to load data.
-/// @param[in] rFileName  FilePath name of the file from which to load.
-/// @param[in] offset     Byte offset within the file from which to load.
-/// @param[in] size       Number of bytes to read.
-/// @param[in] priority   Load priority.
+/// @param[in] pBuffer        Buffer in which to load data.
+/// @param[in] rFileName      FilePath name of the file from which to load.
+/// @param[in] offset         Byte offset within the file from which to load.
+/// @param[in] size           Number of bytes to read.
+/// @param[in] priority       Load priority.
+/// @param[in] pCallback      Optional callback to call on the I/O worker thread once the request has completed.  The
+///                           request must still be released with SyncRequest() or TrySyncRequest() (which will not
+///                           block once the callback has been called).
+/// @param[in] pCallbackData  User data to pass to the completion callback.
 ///
 /// @return  ID identifying the load request if queued successfully, invalid index if the request queue failed.
 ///
@@ -80,13 +171,75 @@ size_t AsyncLoader::QueueRequest(
 	const String& rFileName,
 	uint64_t offset,
 	size_t size,
-	EPriority priority )
+	EPriority priority,
+	COMPLETION_CALLBACK* pCallback,
+	void* pCallbackData )
+{
+	HELIUM_ASSERT( pBuffer );
+
+	return AddRequest( pBuffer, rFileName, offset, size, 0, priority, pCallback, pCallbackData );
+}
+
+/// Queue an async load request for compressed cache entry data.
+///
+/// The compressed data is decompressed into the output buffer by the I/O worker thread that reads it.  SyncRequest()
+/// and TrySyncRequest() report the number of decompressed bytes stored in the buffer.
+///
+/// @param[in] pBuffer         Buffer in which to store the decompressed data.
+/// @param[in] rFileName       FilePath name of the file from which to load.
+/// @param[in] offset          Byte offset within the file of the compressed data.
+/// @param[in] compressedSize  Size of the compressed data, in bytes.
+/// @param[in] size            Size of the output buffer.  If the decompressed data is larger than this, only as much
+///                            of it as fits in the buffer is stored.
+/// @param[in] priority        Load priority.
+/// @param[in] pCallback       Optional callback to call on the I/O worker thread once the request has completed.
+/// @param[in] pCallbackData   User data to pass to the completion callback.
+///
+/// @return  ID identifying the load request if queued successfully, invalid index if the request queue failed.
+///
+/// @see QueueRequest(), Cache::DecompressEntryData()
+size_t AsyncLoader::QueueCompressedRequest(
+	void* pBuffer,
+	const String& rFileName,
+	uint64_t offset,
+	size_t compressedSize,
+	size_t size,
+	EPriority priority,
+	COMPLETION_CALLBACK* pCallback,
+	void* pCallbackData )
 {
 	HELIUM_ASSERT( pBuffer );
+	HELIUM_ASSERT( size != 0 );
+
+	return AddRequest( pBuffer, rFileName, offset, compressedSize, size, priority, pCallback, pCallbackData );
+}
+
+/// Allocate and queue a load request.
+///
+/// @param[in] pBuffer           Output buffer.
+/// @param[in] rFileName         FilePath name of the file from which to load.
+/// @param[in] offset            Byte offset within the file from which to load.
+/// @param[in] size              Number of bytes to read.
+/// @param[in] decompressedSize  Size of the output buffer if the data read must be decompressed, zero if not.
+/// @param[in] priority          Load priority.
+/// @param[in] pCallback         Optional completion callback.
+/// @param[in] pCallbackData     User data to pass to the completion callback.
+///
+/// @return  ID identifying the load request if queued successfully, invalid index if the request queue failed.
+size_t AsyncLoader::AddRequest(
+	void* pBuffer,
+	const String& rFileName,
+	uint64_t offset,
+	size_t size,
+	size_t decompressedSize,
+	EPriority priority,
+	COMPLETION_CALLBACK* pCallback,
+	void* pCallbackData )
+{
 	HELIUM_ASSERT( static_cast< size_t >( priority ) < static_cast< size_t >( PRIORITY_MAX ) );
 
-	// Make sure the load worker is running.
-	if( !m_pWorker )
+	// Make sure the load workers are running.
+	if( m_workers.IsEmpty() )
 	{
 		return Invalid< size_t >();
 	}
@@ -98,12 +251,53 @@ size_t AsyncLoader::QueueRequest(
 	pRequest->fileName = rFileName;
 	pRequest->offset = offset;
 	pRequest->size = size;
+	pRequest->decompressedSize = decompressedSize;
 	pRequest->priority = priority;
+	pRequest->pCallback = pCallback;
+	pRequest->pCallbackData = pCallbackData;
+	pRequest->pWaitCondition = NULL;
+	pRequest->pPrefetchRegion = NULL;
+	SetInvalid( pRequest->queueIndex );
 
 	pRequest->bytesRead = 0;
 	AtomicExchangeRelease( pRequest->processedCounter, 0 );
 
-	m_pWorker->QueueRequest( pRequest );
+	bool bWaitingOnPrefetch = false;
+
+	{
+		// Prevent access to the load queues while an exclusive write lock is held.
+		ScopeReadLock nonExclusiveLock( m_writeLock );
+
+		AtomicIncrementAcquire( m_pendingRequestCount );
+
+		// Requests for buffered prefetch data (only used for files that could not be mapped) are serviced from memory,
+		// and are held back until the prefetch read completes.
+		{
+			MutexScopeLock prefetchLock( m_prefetchLock );
+
+			PrefetchRegion* pRegion = FindPrefetchRegion( rFileName, offset, size );
+			if( pRegion )
+			{
+				pRequest->pPrefetchRegion = pRegion;
+				if( !pRegion->bLoaded )
+				{
+					pRegion->waitingRequests.Push( pRequest );
+					bWaitingOnPrefetch = true;
+				}
+			}
+		}
+
+		if( !bWaitingOnPrefetch )
+		{
+			Locker< RequestQueues, SpinLock >::Handle handle ( m_requestQueues );
+			handle->queues[ priority ].Push( pRequest );
+		}
+	}
+
+	if( !bWaitingOnPrefetch )
+	{
+		WakeUpWorker();
+	}
 
 	size_t requestIndex = m_requestPool.GetIndex( pRequest );
 	HELIUM_ASSERT( IsValid( requestIndex ) );
@@ -111,6 +305,47 @@ size_t AsyncLoader::QueueRequest(
 	return requestIndex;
 }
 
+/// Block the current thread until the load request with the specified ID completes, without releasing the request
+/// information.
+///
+/// The thread sleeps until it is woken by the I/O worker that completes the request.  SyncRequest() or
+/// TrySyncRequest() must still be called afterwards to release the request (neither will block).
+///
+/// @param[in] id  Request ID.
+///
+/// @see SyncRequest(), TrySyncRequest()
+void AsyncLoader::WaitForRequest( size_t id )
+{
+	HELIUM_ASSERT( IsValid( id ) );
+
+	Request* pRequest = m_requestPool.GetObject( id );
+	HELIUM_ASSERT( pRequest );
+
+	if( pRequest->processedCounter != 0 )
+	{
+		return;
+	}
+
+	Condition* pCondition;
+
+	{
+		MutexScopeLock scopeLock( m_completionLock );
+		if( pRequest->processedCounter != 0 )
+		{
+			return;
+		}
+
+		HELIUM_ASSERT( !pRequest->pWaitCondition );
+		pCondition = AcquireWaitCondition();
+		pRequest->pWaitCondition = pCondition;
+	}
+
+	pCondition->Wait();
+
+	MutexScopeLock scopeLock( m_completionLock );
+	m_freeWaitConditions.Push( pCondition );
+}
+
 /// Block the current thread until the load request with the specified ID completes and release the request
 /// information.
 ///
@@ -126,14 +361,11 @@ size_t AsyncLoader::SyncRequest( size_t id )
 {
 	HELIUM_ASSERT( IsValid( id ) );
 
+	WaitForRequest( id );
+
 	Request* pRequest = m_requestPool.GetObject( id );
 	HELIUM_ASSERT( pRequest );
 
-	while( pRequest->processedCounter == 0 )
-	{
-		Thread::Yield();
-	}
-
 	size_t bytesRead = pRequest->bytesRead;
 	m_requestPool.Release( pRequest );
 
@@ -170,27 +402,115 @@ bool AsyncLoader::TrySyncRequest( size_t id, size_t& rBytesRead )
 	return true;
 }
 
+/// Cancel a load request that has not yet been picked up by a worker thread, releasing the request information.
+///
+/// After a successful call to this function, the given ID will no longer be valid.  If the request could not be
+/// cancelled, SyncRequest() or TrySyncRequest() must still be called to release it.
+///
+/// @param[in] id  Request ID.
+///
+/// @return  True if the request was still queued and has been cancelled, false if it is already being processed or
+///          has completed.
+///
+/// @see QueueRequest()
+bool AsyncLoader::CancelRequest( size_t id )
+{
+	HELIUM_ASSERT( IsValid( id ) );
+
+	Request* pRequest = m_requestPool.GetObject( id );
+	HELIUM_ASSERT( pRequest );
+
+	{
+		Locker< RequestQueues, SpinLock >::Handle handle ( m_requestQueues );
+
+		if( IsInvalid( pRequest->queueIndex ) )
+		{
+			return false;
+		}
+
+		handle->queues[ pRequest->priority ].Remove( pRequest );
+	}
+
+	{
+		MutexScopeLock scopeLock( m_completionLock );
+		RetireRequest();
+	}
+
+	m_requestPool.Release( pRequest );
+
+	return true;
+}
+
+/// Block the current thread until the next pending load request completes or is cancelled.
+///
+/// This is useful for threads that poll requests with TrySyncRequest() and have nothing else to do until one of them
+/// completes.  The thread sleeps until it is woken by the completion.
+///
+/// @return  True if the thread waited for a request to complete, false if no requests were pending.
+///
+/// @see Flush()
+bool AsyncLoader::WaitForCompletion()
+{
+	Condition* pCondition;
+
+	{
+		MutexScopeLock scopeLock( m_completionLock );
+		if( m_pendingRequestCount == 0 )
+		{
+			return false;
+		}
+
+		pCondition = AcquireWaitCondition();
+		m_completionWaiters.Push( pCondition );
+	}
+
+	pCondition->Wait();
+
+	MutexScopeLock scopeLock( m_completionLock );
+	m_freeWaitConditions.Push( pCondition );
+
+	return true;
+}
+
 /// Block the current thread until all pending load requests have completed.
 ///
 /// Note that this does not release any requests.  SyncRequest() or TrySyncRequest() must still be called for all
 /// pending requests in order to free any associated resources.
+///
+/// @see WaitForCompletion()
 void AsyncLoader::Flush()
 {
-	if( m_pWorker )
+	while( WaitForCompletion() )
 	{
-		m_pWorker->Flush();
 	}
 }
 
+/// Get the number of requests that have completed or been cancelled.
+///
+/// The count wraps around, so it should only be compared against previous values to check whether any requests have
+/// completed in the meantime.
+///
+/// @return  Number of completed requests.
+uint32_t AsyncLoader::GetCompletedRequestCount() const
+{
+	return static_cast< uint32_t >( m_completedRequestCount );
+}
+
 /// Lock async loading for writing to files that may be in use.
 ///
+/// This prevents other threads from queueing requests and flushes all pending requests.
+///
 /// @see Unlock()
 void AsyncLoader::Lock()
 {
-	if( m_pWorker )
-	{
-		m_pWorker->Lock();
-	}
+	m_writeLock.LockWrite();
+
+	Flush();
+
+	// Nothing is being read at this point, so release any open files and mapped views that would otherwise prevent
+	// writing to the files (or go stale once they are written).
+	ReleaseOpenFiles();
+	ReleaseMappedFiles();
 }
 
 /// Unlock a previous loader lock.
@@ -198,9 +518,164 @@ void AsyncLoader::Lock()
 /// @see Lock()
 void AsyncLoader::Unlock()
 {
-	if( m_pWorker )
+	m_writeLock.UnlockWrite();
+}
+
+/// Register a file to be read through a memory-mapped view instead of through file streams.
+///
+/// The file is mapped the first time a load request for it is serviced.  If the file cannot be mapped, requests for
+/// it fall back to regular file reads.
+///
+/// @param[in] rFileName  Name of the file to map.
+///
+/// @see UnmapFile()
+void AsyncLoader::MapFile( const String& rFileName )
+{
+	HELIUM_ASSERT( !rFileName.IsEmpty() );
+
+	MutexScopeLock scopeLock( m_mappedFileLock );
+
+	size_t mappedFileCount = m_mappedFiles.GetSize();
+	for( size_t mappedFileIndex = 0; mappedFileIndex < mappedFileCount; ++mappedFileIndex )
+	{
+		if( m_mappedFiles[ mappedFileIndex ].fileName == rFileName )
+		{
+			return;
+		}
+	}
+
+	MappedFile* pMappedFile = m_mappedFiles.New();
+	HELIUM_ASSERT( pMappedFile );
+	pMappedFile->fileName = rFileName;
+	pMappedFile->pData = NULL;
+	pMappedFile->size = 0;
+	pMappedFile->bMapAttempted = false;
+}
+
+/// Stop reading a file through a memory-mapped view, releasing the view if it has been mapped.
+///
+/// All pending requests for the file must have been synced before calling this function.
+///
+/// @param[in] rFileName  Name of the file previously registered with MapFile().
+///
+/// @see MapFile()
+void AsyncLoader::UnmapFile( const String& rFileName )
+{
+	MutexScopeLock scopeLock( m_mappedFileLock );
+
+	size_t mappedFileCount = m_mappedFiles.GetSize();
+	for( size_t mappedFileIndex = 0; mappedFileIndex < mappedFileCount; ++mappedFileIndex )
+	{
+		MappedFile& rMappedFile = m_mappedFiles[ mappedFileIndex ];
+		if( rMappedFile.fileName == rFileName )
+		{
+			if( rMappedFile.pData )
+			{
+				UnmapFileView( rMappedFile.pData, rMappedFile.size );
+			}
+
+			m_mappedFiles.Remove( mappedFileIndex );
+
+			return;
+		}
+	}
+}
+
+/// Bring a file range into memory ahead of the load requests for it.
+///
+/// Requests for files registered with MapFile() are serviced from the mapped view, so for those the operating system
+/// is only advised to page the range of the view in, and prefetches should be issued in file offset order.
+///
+/// Files that are not mapped, which includes files registered with MapFile() whose mapping failed, fall back to
+/// reading the range into a buffer with normal priority, in the order in which prefetches are issued.  Requests queued
+/// afterwards that fall entirely within the range are serviced from the buffer instead of reading from the file.
+/// Buffered data is held until ReleasePrefetches() is called.
+///
+/// @param[in] rFileName  Name of the file from which to read.
+/// @param[in] offset     Byte offset of the range within the file.
+/// @param[in] size       Size of the range, in bytes.
+///
+/// @return  True if the prefetch read was queued, false if not.
+///
+/// @see ReleasePrefetches()
+bool AsyncLoader::Prefetch( const String& rFileName, uint64_t offset, size_t size )
+{
+	HELIUM_ASSERT( !rFileName.IsEmpty() );
+	HELIUM_ASSERT( size != 0 );
+
+	const uint8_t* pMappedData;
+	uint64_t mappedSize;
+	if( GetMappedFile( rFileName, pMappedData, mappedSize ) )
+	{
+		if( offset >= mappedSize )
+		{
+			return false;
+		}
+
+		AdviseFileView( pMappedData, offset, static_cast< size_t >( Min< uint64_t >( size, mappedSize - offset ) ) );
+
+		return true;
+	}
+
+	PrefetchRegion* pRegion = new PrefetchRegion;
+	HELIUM_ASSERT( pRegion );
+	pRegion->fileName = rFileName;
+	pRegion->offset = offset;
+	pRegion->size = size;
+	pRegion->pData = static_cast< uint8_t* >( DefaultAllocator().Allocate( size ) );
+	HELIUM_ASSERT( pRegion->pData );
+	pRegion->bytesRead = 0;
+	pRegion->bLoaded = false;
+
+	// The region is only registered once its own read has been queued so that the read is not serviced from it.
+	size_t id = AddRequest( pRegion->pData, rFileName, offset, size, 0, PRIORITY_NORMAL, PrefetchCallback, pRegion );
+	if( IsInvalid( id ) )
+	{
+		DefaultAllocator().Free( pRegion->pData );
+		delete pRegion;
+
+		return false;
+	}
+
+	MutexScopeLock scopeLock( m_prefetchLock );
+	m_prefetchRegions.Push( pRegion );
+
+	return true;
+}
+
+/// Release all prefetched data.
+///
+/// Requests for prefetched ranges that are still pending are completed first, so this blocks until all pending
+/// requests have completed.  Requests queued afterwards are read from their files as usual.
+///
+/// @see Prefetch()
+void AsyncLoader::ReleasePrefetches()
+{
+	DynamicArray< PrefetchRegion* > regions;
+
+	{
+		MutexScopeLock scopeLock( m_prefetchLock );
+		regions = m_prefetchRegions;
+		m_prefetchRegions.Clear();
+	}
+
+	size_t regionCount = regions.GetSize();
+	if( regionCount == 0 )
+	{
+		return;
+	}
+
+	Flush();
+
+	for( size_t regionIndex = 0; regionIndex < regionCount; ++regionIndex )
 	{
-		m_pWorker->Unlock();
+		PrefetchRegion* pRegion = regions[ regionIndex ];
+		HELIUM_ASSERT( pRegion );
+		HELIUM_ASSERT( pRegion->bLoaded );
+		HELIUM_ASSERT( pRegion->waitingRequests.IsEmpty() );
+
+		DefaultAllocator().Free( pRegion->pData );
+		delete pRegion;
 	}
 }
 
@@ -224,7 +699,7 @@ void AsyncLoader::Startup()
 		HELIUM_ASSERT( !sm_pInstance );
 		sm_pInstance = new AsyncLoader;
 		HELIUM_ASSERT( sm_pInstance );
-		if ( !HELIUM_VERIFY( sm_pInstance->Initialize() ) )
+		if ( !HELIUM_VERIFY( sm_pInstance->Initialize( GetDefaultWorkerThreadCount() ) ) )
 		{
 			Shutdown();
 		}
@@ -245,138 +720,870 @@ void AsyncLoader::Shutdown()
 	}
 }
 
-/// Constructor.
-AsyncLoader::LoadWorker::LoadWorker()
-	: m_wakeUpCondition( false, false )
-	, m_stopCounter( 0 )
-	, m_processingCounter( 0 )
+/// Get the default number of I/O worker threads to create.
+///
+/// @return  Default worker thread count.
+uint32_t AsyncLoader::GetDefaultWorkerThreadCount()
 {
-}
+	uint32_t hardwareThreadCount = static_cast< uint32_t >( std::thread::hardware_concurrency() );
+	if( hardwareThreadCount == 0 )
+	{
+		return DEFAULT_WORKER_THREAD_COUNT;
+	}
 
-/// Destructor.
-AsyncLoader::LoadWorker::~LoadWorker()
-{
+	return Min( hardwareThreadCount, static_cast< uint32_t >( DEFAULT_WORKER_THREAD_COUNT ) );
 }
 
-/// Execute the async loading work.
-void AsyncLoader::LoadWorker::Run()
+/// Pop the next request to service, along with any queued requests that can be read with it in a single read.
+///
+/// The oldest request of the highest priority is taken first.  Queued requests of any priority for the ranges
+/// immediately before or after it in the same file are then added, up to COALESCED_READ_SIZE_MAX bytes in total.
+///
+/// @param[out] rRequests  Requests to service, sorted by offset.
+///
+/// @return  True if any requests were popped, false if all queues were empty.
+bool AsyncLoader::PopRequests( DynamicArray< Request* >& rRequests )
 {
-	BufferedStream* pBufferedStream = new BufferedStream;
-	HELIUM_ASSERT( pBufferedStream );
+	rRequests.Resize( 0 );
 
-	while( m_stopCounter == 0 )
-	{
-		AtomicExchangeAcquire( m_processingCounter, 1 );
+	Locker< RequestQueues, SpinLock >::Handle handle ( m_requestQueues );
 
-		Request* pRequest;
-		{
-			Locker< DynamicArray< Request* >, SpinLock >::Handle handle ( m_requestQueue );
-			pRequest = handle->IsEmpty() ? NULL : handle->Pop();
-		}
-		if( !pRequest )
+	Request* pFirstRequest = NULL;
+	for( size_t priorityIndex = PRIORITY_MAX; priorityIndex-- > 0; )
+	{
+		RequestQueue& rQueue = handle->queues[ priorityIndex ];
+		if( rQueue.count != 0 )
 		{
-			// Queue is empty, so sleep until notified.
-			AtomicExchangeRelease( m_processingCounter, 0 );
-			m_wakeUpCondition.Wait();
+			pFirstRequest = rQueue.requests[ rQueue.head ];
+			rQueue.Remove( pFirstRequest );
 
-			continue;
+			break;
 		}
+	}
 
-		HELIUM_ASSERT( pRequest );
+	if( !pFirstRequest )
+	{
+		return false;
+	}
 
-		FileStream* pFileStream = FileStream::OpenFileStream( pRequest->fileName, FileStream::MODE_READ );
-		if( !pFileStream )
-		{
-			SetInvalid( pRequest->bytesRead );
-		}
-		else
-		{
-			pRequest->bytesRead = 0;
+	rRequests.Push( pFirstRequest );
 
-			pBufferedStream->Open( pFileStream );
-			int64_t offset = pBufferedStream->Seek( pRequest->offset, SeekOrigins::Begin );
-			if( static_cast< uint64_t >( offset ) == pRequest->offset )
-			{
-				pRequest->bytesRead = pBufferedStream->Read( pRequest->pBuffer, 1, pRequest->size );
-			}
+	// Requests serviced from prefetched data do not need to be read.
+	if( pFirstRequest->pPrefetchRegion )
+	{
+		return true;
+	}
 
-			pBufferedStream->Open( NULL );
+	uint64_t startOffset = pFirstRequest->offset;
+	uint64_t endOffset = startOffset + pFirstRequest->size;
 
-			delete pFileStream;
+	bool bExtended = true;
+	while( bExtended )
+	{
+		bExtended = false;
+
+		for( size_t priorityIndex = 0; priorityIndex < PRIORITY_MAX; ++priorityIndex )
+		{
+			// Removing requests only clears their entries, so the scan can continue past them.
+			RequestQueue& rQueue = handle->queues[ priorityIndex ];
+			size_t queueSize = rQueue.requests.GetSize();
+			size_t scanCount = 0;
+			for( size_t queueIndex = rQueue.head;
+				queueIndex < queueSize && scanCount < COALESCE_SCAN_LIMIT;
+				++queueIndex )
+			{
+				Request* pRequest = rQueue.requests[ queueIndex ];
+				if( !pRequest )
+				{
+					continue;
+				}
+
+				++scanCount;
+
+				if( pRequest->pPrefetchRegion ||
+					endOffset - startOffset + pRequest->size > COALESCED_READ_SIZE_MAX ||
+					pRequest->fileName != pFirstRequest->fileName )
+				{
+					continue;
+				}
+
+				if( pRequest->offset == endOffset )
+				{
+					endOffset += pRequest->size;
+				}
+				else if( pRequest->offset + pRequest->size == startOffset )
+				{
+					startOffset = pRequest->offset;
+				}
+				else
+				{
+					continue;
+				}
+
+				rRequests.Push( pRequest );
+				rQueue.Remove( pRequest );
+
+				bExtended = true;
+			}
 		}
+	}
+
+	// Sort the requests by offset (the list is short and mostly sorted already).
+	size_t requestCount = rRequests.GetSize();
+	for( size_t requestIndex = 1; requestIndex < requestCount; ++requestIndex )
+	{
+		Request* pRequest = rRequests[ requestIndex ];
+
+		size_t insertIndex = requestIndex;
+		while( insertIndex > 0 && rRequests[ insertIndex - 1 ]->offset > pRequest->offset )
+		{
+			rRequests[ insertIndex ] = rRequests[ insertIndex - 1 ];
+			--insertIndex;
+		}
+
+		rRequests[ insertIndex ] = pRequest;
+	}
+
+	return true;
+}
+
+/// Get whether any requests are waiting in the queues.
+///
+/// @return  True if any queue is non-empty, false if not.
+bool AsyncLoader::HasQueuedRequests()
+{
+	Locker< RequestQueues, SpinLock >::Handle handle ( m_requestQueues );
+	for( size_t priorityIndex = 0; priorityIndex < PRIORITY_MAX; ++priorityIndex )
+	{
+		if( handle->queues[ priorityIndex ].count != 0 )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/// Wake up an idle worker thread, if any are sleeping.
+void AsyncLoader::WakeUpWorker()
+{
+	if( m_sleepingWorkerCount != 0 )
+	{
+		m_wakeUpCondition.Signal();
+	}
+}
+
+/// Flag a request as processed, waking any threads blocking on it and calling its completion callback.
+///
+/// @param[in] pRequest  Request that has been processed.
+void AsyncLoader::CompleteRequest( Request* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	// The request may be released as soon as it is flagged as processed, so grab everything needed for the callback
+	// first.
+	COMPLETION_CALLBACK* pCallback = pRequest->pCallback;
+	void* pCallbackData = pRequest->pCallbackData;
+	size_t bytesRead = pRequest->bytesRead;
+	size_t id = m_requestPool.GetIndex( pRequest );
+
+	{
+		MutexScopeLock scopeLock( m_completionLock );
 
 		AtomicExchangeRelease( pRequest->processedCounter, 1 );
 
-		Thread::Yield();
+		Condition* pWaitCondition = pRequest->pWaitCondition;
+		if( pWaitCondition )
+		{
+			pRequest->pWaitCondition = NULL;
+			pWaitCondition->Signal();
+		}
+
+		if( !pCallback )
+		{
+			RetireRequest();
+
+			return;
+		}
 	}
 
-	AtomicExchangeRelease( m_processingCounter, 0 );
+	// The request is only retired once the callback has returned so that threads waiting in WaitForCompletion() or
+	// Flush() also wait for the callback.
+	pCallback( pCallbackData, id, bytesRead );
 
-	delete pBufferedStream;
+	MutexScopeLock scopeLock( m_completionLock );
+	RetireRequest();
 }
 
-/// Request the load worker to stop processing and return at the next possible opportunity.
-void AsyncLoader::LoadWorker::Stop()
+/// Decrement the pending request count and wake all threads blocking in WaitForCompletion().
+///
+/// This must be called with the completion lock held.
+void AsyncLoader::RetireRequest()
 {
-	AtomicExchangeRelease( m_stopCounter, 1 );
-	m_wakeUpCondition.Signal();
+	AtomicDecrementRelease( m_pendingRequestCount );
+	AtomicIncrementRelease( m_completedRequestCount );
+
+	size_t waiterCount = m_completionWaiters.GetSize();
+	for( size_t waiterIndex = 0; waiterIndex < waiterCount; ++waiterIndex )
+	{
+		m_completionWaiters[ waiterIndex ]->Signal();
+	}
+
+	m_completionWaiters.Resize( 0 );
 }
 
-/// Queue an async load request.
+/// Get a condition with which to block the current thread, reusing a previously allocated condition if possible.
 ///
-/// @param[in] pRequest  Request to queue.  Note that the @c processedCounter value should be set to 0 prior to
-///                      calling this function (the worker thread will set it to 1 once the request has been
-///                      processed).
+/// This must be called with the completion lock held.  The condition should be returned to m_freeWaitConditions
+/// once the thread has been woken.
 ///
-/// @see Flush()
-void AsyncLoader::LoadWorker::QueueRequest( Request* pRequest )
+/// @return  Auto-reset wait condition.
+Condition* AsyncLoader::AcquireWaitCondition()
+{
+	size_t freeConditionCount = m_freeWaitConditions.GetSize();
+	if( freeConditionCount == 0 )
+	{
+		Condition* pCondition = new Condition( false, false );
+		HELIUM_ASSERT( pCondition );
+
+		return pCondition;
+	}
+
+	Condition* pCondition = m_freeWaitConditions[ freeConditionCount - 1 ];
+	m_freeWaitConditions.Pop();
+
+	return pCondition;
+}
+
+/// Find the prefetched range containing a file range.
+///
+/// This must be called with the prefetch lock held.
+///
+/// @param[in] rFileName  File name.
+/// @param[in] offset     Offset of the range within the file.
+/// @param[in] size       Size of the range, in bytes.
+///
+/// @return  Prefetched range containing the entire file range, or null if no prefetched range contains it.
+AsyncLoader::PrefetchRegion* AsyncLoader::FindPrefetchRegion(
+	const String& rFileName,
+	uint64_t offset,
+	size_t size ) const
+{
+	size_t regionCount = m_prefetchRegions.GetSize();
+	for( size_t regionIndex = 0; regionIndex < regionCount; ++regionIndex )
+	{
+		PrefetchRegion* pRegion = m_prefetchRegions[ regionIndex ];
+		HELIUM_ASSERT( pRegion );
+		if( offset >= pRegion->offset &&
+			offset + size <= pRegion->offset + pRegion->size &&
+			pRegion->fileName == rFileName )
+		{
+			return pRegion;
+		}
+	}
+
+	return NULL;
+}
+
+/// Flag a buffered prefetch read (for a file that is not mapped) as complete and queue the requests waiting on it.
+///
+/// @param[in] pRegion    Prefetched range.
+/// @param[in] id         ID of the prefetch read request.
+/// @param[in] bytesRead  Number of bytes read into the prefetch buffer.
+void AsyncLoader::CompletePrefetch( PrefetchRegion* pRegion, size_t id, size_t bytesRead )
+{
+	HELIUM_ASSERT( pRegion );
+
+	// Nothing else holds the ID of the prefetch read, so it is released here.
+	m_requestPool.Release( m_requestPool.GetObject( id ) );
+
+	{
+		MutexScopeLock scopeLock( m_prefetchLock );
+
+		pRegion->bytesRead = bytesRead;
+		pRegion->bLoaded = true;
+
+		if( pRegion->waitingRequests.IsEmpty() )
+		{
+			return;
+		}
+
+		Locker< RequestQueues, SpinLock >::Handle handle ( m_requestQueues );
+
+		size_t requestCount = pRegion->waitingRequests.GetSize();
+		for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+		{
+			Request* pRequest = pRegion->waitingRequests[ requestIndex ];
+			HELIUM_ASSERT( pRequest );
+			handle->queues[ pRequest->priority ].Push( pRequest );
+		}
+
+		pRegion->waitingRequests.Clear();
+	}
+
+	WakeUpWorker();
+}
+
+/// Get the mapped view of a file registered for memory-mapped reads, mapping it if necessary.
+///
+/// @param[in]  rFileName  File name.
+/// @param[out] rpData     Mapped file contents.
+/// @param[out] rSize      Size of the mapped view, in bytes.
+///
+/// @return  True if the file is mapped, false if it was not registered with MapFile() or could not be mapped.
+bool AsyncLoader::GetMappedFile( const String& rFileName, const uint8_t*& rpData, uint64_t& rSize )
+{
+	MutexScopeLock scopeLock( m_mappedFileLock );
+
+	size_t mappedFileCount = m_mappedFiles.GetSize();
+	for( size_t mappedFileIndex = 0; mappedFileIndex < mappedFileCount; ++mappedFileIndex )
+	{
+		MappedFile& rMappedFile = m_mappedFiles[ mappedFileIndex ];
+		if( rMappedFile.fileName != rFileName )
+		{
+			continue;
+		}
+
+		if( !rMappedFile.bMapAttempted )
+		{
+			rMappedFile.bMapAttempted = true;
+			rMappedFile.pData = MapFileView( rFileName, rMappedFile.size );
+			if( !rMappedFile.pData )
+			{
+				HELIUM_TRACE(
+					TraceLevels::Warning,
+					TXT( "AsyncLoader::GetMappedFile(): Failed to map \"%s\" into memory.  Falling back to file reads.\n" ),
+					*rFileName );
+			}
+		}
+
+		rpData = rMappedFile.pData;
+		rSize = rMappedFile.size;
+
+		return ( rpData != NULL );
+	}
+
+	return false;
+}
+
+/// Release all mapped file views.
+///
+/// Files remain registered for memory-mapped reads and are mapped again the next time they are read.
+void AsyncLoader::ReleaseMappedFiles()
+{
+	MutexScopeLock scopeLock( m_mappedFileLock );
+
+	size_t mappedFileCount = m_mappedFiles.GetSize();
+	for( size_t mappedFileIndex = 0; mappedFileIndex < mappedFileCount; ++mappedFileIndex )
+	{
+		MappedFile& rMappedFile = m_mappedFiles[ mappedFileIndex ];
+		if( rMappedFile.pData )
+		{
+			UnmapFileView( rMappedFile.pData, rMappedFile.size );
+		}
+
+		rMappedFile.pData = NULL;
+		rMappedFile.size = 0;
+		rMappedFile.bMapAttempted = false;
+	}
+}
+
+/// Close the file streams held open by each worker thread.
+///
+/// This must only be called while no requests are pending.
+void AsyncLoader::ReleaseOpenFiles()
+{
+	HELIUM_ASSERT( m_pendingRequestCount == 0 );
+
+	size_t workerCount = m_workers.GetSize();
+	for( size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex )
+	{
+		LoadWorker* pWorker = m_workers[ workerIndex ];
+		HELIUM_ASSERT( pWorker );
+		pWorker->CloseFiles();
+	}
+}
+
+/// Map the entire contents of a file into memory for reading.
+///
+/// @param[in]  rFileName  Name of the file to map.
+/// @param[out] rSize      Size of the file, in bytes.
+///
+/// @return  Pointer to the mapped file contents, or null if the file could not be mapped.
+///
+/// @see UnmapFileView()
+const uint8_t* AsyncLoader::MapFileView( const String& rFileName, uint64_t& rSize )
+{
+	rSize = 0;
+
+#if HELIUM_OS_WIN
+	std::wstring wideFileName;
+	if( !ConvertString( *rFileName, wideFileName ) )
+	{
+		return NULL;
+	}
+
+	HANDLE hFile = ::CreateFileW(
+		wideFileName.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL );
+	if( hFile == INVALID_HANDLE_VALUE )
+	{
+		return NULL;
+	}
+
+	LARGE_INTEGER fileSize;
+	if( !::GetFileSizeEx( hFile, &fileSize ) || fileSize.QuadPart <= 0 ||
+		static_cast< uint64_t >( fileSize.QuadPart ) > static_cast< uint64_t >( SIZE_MAX ) )
+	{
+		::CloseHandle( hFile );
+
+		return NULL;
+	}
+
+	// The view keeps the mapping (and file) open, so the handles are not needed once it has been created.
+	HANDLE hMapping = ::CreateFileMappingW( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	::CloseHandle( hFile );
+	if( !hMapping )
+	{
+		return NULL;
+	}
+
+	const uint8_t* pData = static_cast< const uint8_t* >( ::MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ) );
+	::CloseHandle( hMapping );
+	if( !pData )
+	{
+		return NULL;
+	}
+
+	rSize = static_cast< uint64_t >( fileSize.QuadPart );
+#else
+	int fileDescriptor = ::open( *rFileName, O_RDONLY );
+	if( fileDescriptor < 0 )
+	{
+		return NULL;
+	}
+
+	struct stat fileStatus;
+	if( ::fstat( fileDescriptor, &fileStatus ) != 0 || fileStatus.st_size <= 0 ||
+		static_cast< uint64_t >( fileStatus.st_size ) > static_cast< uint64_t >( SIZE_MAX ) )
+	{
+		::close( fileDescriptor );
+
+		return NULL;
+	}
+
+	void* pView = ::mmap( NULL, static_cast< size_t >( fileStatus.st_size ), PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+	::close( fileDescriptor );
+	if( pView == MAP_FAILED )
+	{
+		return NULL;
+	}
+
+	const uint8_t* pData = static_cast< const uint8_t* >( pView );
+	rSize = static_cast< uint64_t >( fileStatus.st_size );
+#endif
+
+	return pData;
+}
+
+/// Release a view created by MapFileView().
+///
+/// @param[in] pData  Mapped file contents.
+/// @param[in] size   Size of the mapped view, in bytes.
+///
+/// @see MapFileView()
+void AsyncLoader::UnmapFileView( const uint8_t* pData, uint64_t size )
+{
+	HELIUM_ASSERT( pData );
+
+#if HELIUM_OS_WIN
+	HELIUM_UNREF( size );
+	::UnmapViewOfFile( pData );
+#else
+	::munmap( const_cast< uint8_t* >( pData ), static_cast< size_t >( size ) );
+#endif
+}
+
+/// Advise the operating system that a range of a view created by MapFileView() will be read soon.
+///
+/// @param[in] pData   Mapped file contents.
+/// @param[in] offset  Byte offset of the range within the file.
+/// @param[in] size    Size of the range, in bytes.
+///
+/// @see MapFileView()
+void AsyncLoader::AdviseFileView( const uint8_t* pData, uint64_t offset, size_t size )
+{
+	HELIUM_ASSERT( pData );
+
+#if HELIUM_OS_WIN
+	// Without PrefetchVirtualMemory() (prior to Windows 8), the view is simply paged in as it is read.
+	static PREFETCHVIRTUALMEMORY_FUNC* const pPrefetchVirtualMemory = reinterpret_cast< PREFETCHVIRTUALMEMORY_FUNC* >(
+		::GetProcAddress( ::GetModuleHandleW( L"kernel32.dll" ), "PrefetchVirtualMemory" ) );
+	if( pPrefetchVirtualMemory )
+	{
+		PREFETCH_MEMORY_RANGE range;
+		range.pVirtualAddress = const_cast< uint8_t* >( pData + offset );
+		range.numberOfBytes = size;
+		pPrefetchVirtualMemory( ::GetCurrentProcess(), 1, &range, 0 );
+	}
+#else
+	// The advised range must start on a page boundary (the view itself always does).
+	static const uint64_t pageSize = static_cast< uint64_t >( ::sysconf( _SC_PAGESIZE ) );
+	uint64_t pageOffset = offset - offset % pageSize;
+	::madvise(
+		const_cast< uint8_t* >( pData + pageOffset ),
+		static_cast< size_t >( offset - pageOffset ) + size,
+		MADV_WILLNEED );
+#endif
+}
+
+/// Completion callback for prefetch reads.
+///
+/// @param[in] pUserData  Prefetched range.
+/// @param[in] id         ID of the prefetch read request.
+/// @param[in] bytesRead  Number of bytes read.
+void AsyncLoader::PrefetchCallback( void* pUserData, size_t id, size_t bytesRead )
+{
+	HELIUM_ASSERT( sm_pInstance );
+	sm_pInstance->CompletePrefetch( static_cast< PrefetchRegion* >( pUserData ), id, bytesRead );
+}
+
+/// Constructor.
+AsyncLoader::RequestQueue::RequestQueue()
+	: head( 0 )
+	, count( 0 )
+{
+}
+
+/// Add a request to the end of this queue.
+///
+/// @param[in] pRequest  Request to queue.
+void AsyncLoader::RequestQueue::Push( Request* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+	HELIUM_ASSERT( IsInvalid( pRequest->queueIndex ) );
+
+	// Drop the null entries once they make up at least half of the queue, so that each removal has an amortized
+	// constant cost.
+	size_t entryCount = requests.GetSize();
+	if( entryCount - count >= count )
+	{
+		size_t liveIndex = 0;
+		for( size_t entryIndex = head; entryIndex < entryCount; ++entryIndex )
+		{
+			Request* pQueuedRequest = requests[ entryIndex ];
+			if( pQueuedRequest )
+			{
+				pQueuedRequest->queueIndex = liveIndex;
+				requests[ liveIndex ] = pQueuedRequest;
+				++liveIndex;
+			}
+		}
+
+		HELIUM_ASSERT( liveIndex == count );
+		requests.Resize( count );
+		head = 0;
+	}
+
+	pRequest->queueIndex = requests.GetSize();
+	requests.Push( pRequest );
+	++count;
+}
+
+/// Take a request out of this queue.
+///
+/// This only clears the request's entry, so the indices of the other entries remain valid.
+///
+/// @param[in] pRequest  Queued request to remove.
+void AsyncLoader::RequestQueue::Remove( Request* pRequest )
 {
 	HELIUM_ASSERT( pRequest );
-	HELIUM_ASSERT( pRequest->processedCounter == 0 );
 
-	// Prevent access to the load queue while an exclusive write lock is held.
-	ScopeReadLock nonExclusiveLock( m_writeLock );
+	size_t entryIndex = pRequest->queueIndex;
+	HELIUM_ASSERT( entryIndex < requests.GetSize() );
+	HELIUM_ASSERT( requests[ entryIndex ] == pRequest );
 
+	requests[ entryIndex ] = NULL;
+	SetInvalid( pRequest->queueIndex );
+	--count;
+
+	size_t entryCount = requests.GetSize();
+	while( head < entryCount && !requests[ head ] )
 	{
-		Locker< DynamicArray< Request* >, SpinLock >::Handle handle ( m_requestQueue );
-		handle->Push( pRequest );
+		++head;
 	}
+}
 
-	m_wakeUpCondition.Signal();
+/// Constructor.
+///
+/// @param[in] pLoader  Owning async loader.
+AsyncLoader::LoadWorker::LoadWorker( AsyncLoader* pLoader )
+	: m_pLoader( pLoader )
+{
+	HELIUM_ASSERT( pLoader );
 }
 
-/// Block the current thread until all pending load requests have completed.
+/// Destructor.
+AsyncLoader::LoadWorker::~LoadWorker()
+{
+	CloseFiles();
+}
+
+/// Execute the async loading work.
+void AsyncLoader::LoadWorker::Run()
+{
+	AsyncLoader* pLoader = m_pLoader;
+	HELIUM_ASSERT( pLoader );
+
+	while( pLoader->m_stopCounter == 0 )
+	{
+		if( pLoader->PopRequests( m_requests ) )
+		{
+			// The wake-up condition coalesces signals, so pass it on if there is still work for other workers.
+			if( pLoader->HasQueuedRequests() )
+			{
+				pLoader->WakeUpWorker();
+			}
+
+			ProcessRequests();
+
+			continue;
+		}
+
+		// Register as sleeping before checking the queues one last time so that a request queued in between is
+		// guaranteed to signal the wake-up condition.
+		AtomicIncrementAcquire( pLoader->m_sleepingWorkerCount );
+		if( pLoader->m_stopCounter == 0 && !pLoader->HasQueuedRequests() )
+		{
+			pLoader->m_wakeUpCondition.Wait();
+		}
+
+		AtomicDecrementRelease( pLoader->m_sleepingWorkerCount );
+	}
+
+	// Pass the shutdown signal on to any other workers still sleeping.
+	pLoader->m_wakeUpCondition.Signal();
+}
+
+/// Close all file streams held open by this worker.
 ///
-/// @see QueueRequest()
-void AsyncLoader::LoadWorker::Flush()
+/// This must not be called while the worker is servicing requests.
+void AsyncLoader::LoadWorker::CloseFiles()
+{
+	size_t openFileCount = m_openFiles.GetSize();
+	for( size_t openFileIndex = 0; openFileIndex < openFileCount; ++openFileIndex )
+	{
+		delete m_openFiles[ openFileIndex ].pStream;
+	}
+
+	m_openFiles.Clear();
+}
+
+/// Service the requests popped for the current read.
+///
+/// Requests for memory-mapped files are copied directly out of the mapped view.  Otherwise, a single uncompressed
+/// request is read directly into its output buffer, while coalesced and compressed requests are read into a scratch
+/// buffer with a single read and copied or decompressed out to each request's output buffer.
+void AsyncLoader::LoadWorker::ProcessRequests()
+{
+	size_t requestCount = m_requests.GetSize();
+	HELIUM_ASSERT( requestCount != 0 );
+
+	Request* pFirstRequest = m_requests[ 0 ];
+	HELIUM_ASSERT( pFirstRequest );
+	Request* pLastRequest = m_requests[ requestCount - 1 ];
+	HELIUM_ASSERT( pLastRequest );
+
+	if( pFirstRequest->pPrefetchRegion )
+	{
+		HELIUM_ASSERT( requestCount == 1 );
+		ProcessPrefetchedRequest( pFirstRequest );
+
+		return;
+	}
+
+	const uint8_t* pMappedData;
+	uint64_t mappedSize;
+	if( m_pLoader->GetMappedFile( pFirstRequest->fileName, pMappedData, mappedSize ) )
+	{
+		ProcessMappedRequests( pMappedData, mappedSize );
+
+		return;
+	}
+
+	uint64_t readOffset = pFirstRequest->offset;
+	size_t readSize = static_cast< size_t >( pLastRequest->offset + pLastRequest->size - readOffset );
+
+	void* pReadBuffer = pFirstRequest->pBuffer;
+	if( requestCount > 1 || pFirstRequest->decompressedSize != 0 )
+	{
+		m_readBuffer.Resize( readSize );
+		pReadBuffer = m_readBuffer.GetData();
+	}
+
+	size_t bytesRead = 0;
+
+	FileStream* pFileStream = GetFileStream( pFirstRequest->fileName );
+	if( !pFileStream )
+	{
+		SetInvalid( bytesRead );
+	}
+	else
+	{
+		int64_t offset = pFileStream->Seek( readOffset, SeekOrigins::Begin );
+		if( static_cast< uint64_t >( offset ) == readOffset )
+		{
+			bytesRead = pFileStream->Read( pReadBuffer, 1, readSize );
+		}
+	}
+
+	if( pReadBuffer == pFirstRequest->pBuffer )
+	{
+		pFirstRequest->bytesRead = bytesRead;
+		m_pLoader->CompleteRequest( pFirstRequest );
+
+		return;
+	}
+
+	for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+	{
+		Request* pRequest = m_requests[ requestIndex ];
+		HELIUM_ASSERT( pRequest );
+
+		if( IsInvalid( bytesRead ) )
+		{
+			SetInvalid( pRequest->bytesRead );
+		}
+		else
+		{
+			size_t requestStart = static_cast< size_t >( pRequest->offset - readOffset );
+			size_t requestBytesRead = ( bytesRead > requestStart ? Min( bytesRead - requestStart, pRequest->size ) : 0 );
+			CopyRequestData( pRequest, m_readBuffer.GetData() + requestStart, requestBytesRead );
+		}
+
+		m_pLoader->CompleteRequest( pRequest );
+	}
+}
+
+/// Service the requests popped for the current read by copying directly out of a memory-mapped file view.
+///
+/// @param[in] pData  Mapped file contents.
+/// @param[in] size   Size of the mapped view, in bytes.
+void AsyncLoader::LoadWorker::ProcessMappedRequests( const uint8_t* pData, uint64_t size )
 {
-	bool isEmpty;
+	HELIUM_ASSERT( pData );
+
+	size_t requestCount = m_requests.GetSize();
+	for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
 	{
-		Locker< DynamicArray< Request* >, SpinLock >::Handle handle ( m_requestQueue );
-		isEmpty = handle->IsEmpty();
+		Request* pRequest = m_requests[ requestIndex ];
+		HELIUM_ASSERT( pRequest );
+
+		size_t bytesRead = 0;
+		if( pRequest->offset < size )
+		{
+			bytesRead = static_cast< size_t >( Min( static_cast< uint64_t >( pRequest->size ), size - pRequest->offset ) );
+		}
+
+		CopyRequestData( pRequest, pData + pRequest->offset, bytesRead );
+		m_pLoader->CompleteRequest( pRequest );
 	}
+}
+
+/// Service a request by copying out of the buffered prefetch data containing it (only used for files that are not
+/// mapped).
+///
+/// @param[in] pRequest  Request being serviced.
+void AsyncLoader::LoadWorker::ProcessPrefetchedRequest( Request* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	PrefetchRegion* pRegion = pRequest->pPrefetchRegion;
+	HELIUM_ASSERT( pRegion );
+	HELIUM_ASSERT( pRegion->bLoaded );
 
-	while( m_processingCounter != 0 && !isEmpty )
+	if( IsInvalid( pRegion->bytesRead ) )
 	{
-		Thread::Yield();
+		SetInvalid( pRequest->bytesRead );
 	}
+	else
+	{
+		size_t regionStart = static_cast< size_t >( pRequest->offset - pRegion->offset );
+		size_t bytesRead = ( pRegion->bytesRead > regionStart ? Min( pRegion->bytesRead - regionStart, pRequest->size ) : 0 );
+		CopyRequestData( pRequest, pRegion->pData + regionStart, bytesRead );
+	}
+
+	m_pLoader->CompleteRequest( pRequest );
 }
 
-/// Acquire an exclusive lock for writing to files and flush the async loader queue.
+/// Copy the data read for a request into its output buffer, decompressing it if necessary.
 ///
-/// @see Unlock()
-void AsyncLoader::LoadWorker::Lock()
+/// @param[in] pRequest  Request being serviced.
+/// @param[in] pData     Data read for the request.
+/// @param[in] size      Number of bytes read for the request.
+void AsyncLoader::LoadWorker::CopyRequestData( Request* pRequest, const uint8_t* pData, size_t size )
 {
-	// Prevent other threads from queueing requests or writing out data while we have a write lock.
-	m_writeLock.LockWrite();
+	HELIUM_ASSERT( pRequest );
 
-	Flush();
+	if( pRequest->decompressedSize == 0 )
+	{
+		MemoryCopy( pRequest->pBuffer, pData, size );
+		pRequest->bytesRead = size;
+
+		return;
+	}
+
+	size_t bytesDecompressed = 0;
+	if( size == pRequest->size )
+	{
+		bytesDecompressed = Cache::DecompressEntryData( pData, size, pRequest->pBuffer, pRequest->decompressedSize );
+	}
+
+	pRequest->bytesRead = ( IsValid( bytesDecompressed ) ? bytesDecompressed : 0 );
 }
 
-/// Release an exclusive lock for writing to files.
+/// Get an open file stream for reading from the given file, reusing a cached stream if possible.
 ///
-/// @see Lock()
-void AsyncLoader::LoadWorker::Unlock()
+/// @param[in] rFileName  File name.
+///
+/// @return  File stream, or null if the file could not be opened.
+FileStream* AsyncLoader::LoadWorker::GetFileStream( const String& rFileName )
 {
-	m_writeLock.UnlockWrite();
+	size_t openFileCount = m_openFiles.GetSize();
+	for( size_t openFileIndex = openFileCount; openFileIndex-- > 0; )
+	{
+		if( m_openFiles[ openFileIndex ].fileName == rFileName )
+		{
+			// Move the stream to the end of the list to mark it as the most recently used.
+			OpenFile openFile = m_openFiles[ openFileIndex ];
+			m_openFiles.Remove( openFileIndex );
+			m_openFiles.Push( openFile );
+
+			return openFile.pStream;
+		}
+	}
+
+	FileStream* pFileStream = FileStream::OpenFileStream( rFileName, FileStream::MODE_READ );
+	if( !pFileStream )
+	{
+		return NULL;
+	}
+
+	if( openFileCount >= FILE_HANDLE_CACHE_SIZE )
+	{
+		delete m_openFiles[ 0 ].pStream;
+		m_openFiles.Remove( 0 );
+	}
+
+	OpenFile* pOpenFile = m_openFiles.New();
+	HELIUM_ASSERT( pOpenFile );
+	pOpenFile->fileName = rFileName;
+	pOpenFile->pStream = pFileStream;
+
+	return pFileStream;
 }
@@ -21,14 +21,44 @@
 
 namespace Helium
 {
+	class FileStream;
+
 	/// Async loading manager.
+	///
+	/// Load requests are placed in a queue for their priority and serviced by a pool of I/O worker threads, each of
+	/// which always takes the oldest request of the highest priority available.  Queued requests for adjacent ranges of
+	/// the same file are coalesced with the request being serviced into a single read.
+	///
+	/// Each worker keeps the files it has recently read from open between requests.  Files registered with MapFile()
+	/// are instead mapped into memory once and shared by all workers, so each request is serviced with a single copy
+	/// out of the mapped view.  Open files and mapped views are released whenever the loader is locked for writing.
+	///
+	/// Threads blocking on requests sleep until they are woken by the worker completing the request, and an optional
+	/// callback can be supplied with each request to be notified of its completion without polling.
+	///
+	/// Compressed cache entries are decompressed by the worker servicing the request directly into the request's output
+	/// buffer, spreading decompression across all of the worker threads.
+	///
+	/// File ranges can be prefetched ahead of the requests for them (see Prefetch()).  Prefetches of mapped files only
+	/// ask the operating system to page in the range of the mapped view.  Files that are not mapped (such as when
+	/// mapping a file registered with MapFile() fails) fall back to reading the range into a buffer instead.  Requests
+	/// falling entirely within a buffered range are serviced by copying out of it, waiting for the prefetch read to
+	/// complete first if necessary, so they never issue reads of their own.
 	class HELIUM_ENGINE_API AsyncLoader : NonCopyable
 	{
 	public:
 		/// Request pool block size.
 		static const size_t REQUEST_POOL_BLOCK_SIZE = 128;
-		/// Maximum number of open file streams.
+		/// Maximum number of I/O worker threads.
 		static const size_t FILE_STREAM_LIMIT = 16;
+		/// Number of file streams each I/O worker thread keeps open between requests.
+		static const size_t FILE_HANDLE_CACHE_SIZE = 4;
+		/// Default number of I/O worker threads.
+		static const uint32_t DEFAULT_WORKER_THREAD_COUNT = 4;
+		/// Maximum number of bytes to read at once when coalescing adjacent requests.
+		static const size_t COALESCED_READ_SIZE_MAX = 512 * 1024;
+		/// Maximum number of requests to examine in each queue when looking for requests to coalesce.
+		static const size_t COALESCE_SCAN_LIMIT = 64;
 
 		/// Load request priority.
 		enum EPriority
@@ -44,9 +74,18 @@ namespace Helium
 			PRIORITY_LAST = PRIORITY_MAX - 1
 		};
 
+		/// Request completion callback, called on the I/O worker thread that serviced the request.
+		///
+		/// The request is not considered pending by Flush() and WaitForCompletion() until the callback returns.
+		///
+		/// @param[in] pUserData  User data supplied with the request.
+		/// @param[in] id         Request ID.
+		/// @param[in] bytesRead  Number of bytes read (see SyncRequest()).
+		typedef void ( COMPLETION_CALLBACK )( void* pUserData, size_t id, size_t bytesRead );
+
 		/// @name Initialization
 		//@{
-		bool Initialize();
+		bool Initialize( uint32_t workerThreadCount );
 		void Cleanup();
 		//@}
 
@@ -54,24 +93,48 @@ namespace Helium
 		//@{
 		size_t QueueRequest(
 			void* pBuffer, const String& rFileName, uint64_t offset, size_t size,
-			EPriority priority = PRIORITY_NORMAL );
+			EPriority priority = PRIORITY_NORMAL, COMPLETION_CALLBACK* pCallback = NULL, void* pCallbackData = NULL );
+		size_t QueueCompressedRequest(
+			void* pBuffer, const String& rFileName, uint64_t offset, size_t compressedSize, size_t size,
+			EPriority priority = PRIORITY_NORMAL, COMPLETION_CALLBACK* pCallback = NULL, void* pCallbackData = NULL );
+		void WaitForRequest( size_t id );
 		size_t SyncRequest( size_t id );
 		bool TrySyncRequest( size_t id, size_t& rBytesRead );
+		bool CancelRequest( size_t id );
 
+		bool WaitForCompletion();
 		void Flush();
 
+		uint32_t GetCompletedRequestCount() const;
+
 		void Lock();
 		void Unlock();
 		//@}
 
+		/// @name Memory-mapped Files
+		//@{
+		void MapFile( const String& rFileName );
+		void UnmapFile( const String& rFileName );
+		//@}
+
+		/// @name Prefetching
+		//@{
+		bool Prefetch( const String& rFileName, uint64_t offset, size_t size );
+		void ReleasePrefetches();
+		//@}
+
 		/// @name Static Access
 		//@{
 		static AsyncLoader* GetInstance();
 		static void Startup();
 		static void Shutdown();
+
+		static uint32_t GetDefaultWorkerThreadCount();
 		//@}
 
 	private:
+		struct PrefetchRegion;
+
 		/// Async load request data.
 		struct Request
 		{
@@ -83,22 +146,102 @@ namespace Helium
 			uint64_t offset;
 			/// Number of bytes to read.
 			size_t size;
+			/// Size of the output buffer if the data read is compressed and must be decompressed into the buffer (zero
+			/// if the data is read directly into the buffer).
+			size_t decompressedSize;
 			/// Priority.
 			EPriority priority;
 
+			/// Completion callback.
+			COMPLETION_CALLBACK* pCallback;
+			/// Completion callback user data.
+			void* pCallbackData;
+			/// Condition signaled on completion if a thread is blocking on this request (guarded by m_completionLock).
+			Condition* pWaitCondition;
+			/// Prefetched range from which the request data is copied instead of being read (null if it is read).
+			PrefetchRegion* pPrefetchRegion;
+			/// Index of this request in the entries of its priority queue (invalid if it is not queued, guarded by
+			/// m_requestQueues).
+			size_t queueIndex;
+
 			/// Number of bytes read.
 			volatile size_t bytesRead;
 			/// Set to a non-zero value once this request has been processed.
 			volatile int32_t processedCounter;
 		};
 
+		/// Memory-mapped file information.
+		struct MappedFile
+		{
+			/// File name.
+			String fileName;
+			/// Mapped file contents (null if the file has not been mapped yet or could not be mapped).
+			const uint8_t* pData;
+			/// Size of the mapped view, in bytes.
+			uint64_t size;
+			/// True if mapping the file has been attempted since the loader was last locked for writing.
+			bool bMapAttempted;
+		};
+
+		/// File range buffered by Prefetch() for a file that is not mapped.
+		struct PrefetchRegion
+		{
+			/// File name.
+			String fileName;
+			/// Offset of the range within the file.
+			uint64_t offset;
+			/// Size of the range, in bytes.
+			size_t size;
+			/// Prefetched data.
+			uint8_t* pData;
+			/// Number of bytes read into the prefetch buffer (valid once the prefetch read has completed).
+			size_t bytesRead;
+			/// True once the prefetch read has completed.
+			bool bLoaded;
+			/// Requests waiting for the prefetch read to complete.
+			DynamicArray< Request* > waitingRequests;
+		};
+
+		/// Queue of load requests of a single priority.
+		///
+		/// Requests taken out of the queue leave a null entry behind instead of shifting the entries after them, so
+		/// popping the oldest request and cancelling a request take constant time.  Null entries are dropped by
+		/// compacting the queue on the next push once they make up at least half of its entries.
+		struct RequestQueue
+		{
+			/// Queued requests, in the order in which they were queued (null for requests no longer queued).
+			DynamicArray< Request* > requests;
+			/// Index of the oldest queued request (equal to the entry count if the queue is empty).
+			size_t head;
+			/// Number of queued requests.
+			size_t count;
+
+			/// @name Construction/Destruction
+			//@{
+			RequestQueue();
+			//@}
+
+			/// @name Queue Management
+			//@{
+			void Push( Request* pRequest );
+			void Remove( Request* pRequest );
+			//@}
+		};
+
+		/// Queued load requests for each priority.
+		struct RequestQueues
+		{
+			/// Request queue for each priority.
+			RequestQueue queues[ PRIORITY_MAX ];
+		};
+
 		/// Async loading thread runnable.
 		class LoadWorker : public Runnable
 		{
 		public:
 			/// @name Construction/Destruction
 			//@{
-			LoadWorker();
+			LoadWorker( AsyncLoader* pLoader );
 			virtual ~LoadWorker();
 			//@}
 
@@ -107,42 +250,80 @@ namespace Helium
 			virtual void Run();
 			//@}
 
-			/// @name External Thread Control
+			/// @name File Handle Cache
 			//@{
-			void Stop();
+			void CloseFiles();
 			//@}
 
-			/// @name External Request Queue Control
-			//@{
-			void QueueRequest( Request* pRequest );
-			void Flush();
+		private:
+			/// Cached open file stream.
+			struct OpenFile
+			{
+				/// File name.
+				String fileName;
+				/// File stream.
+				FileStream* pStream;
+			};
 
-			void Lock();
-			void Unlock();
-			//@}
+			/// Owning async loader.
+			AsyncLoader* m_pLoader;
+			/// Requests being serviced by the current read, sorted by offset.
+			DynamicArray< Request* > m_requests;
+			/// Buffer for coalesced reads.
+			DynamicArray< uint8_t > m_readBuffer;
+			/// Open file streams, ordered from least to most recently used.
+			DynamicArray< OpenFile > m_openFiles;
 
-		private:
-			/// Async load request queue.
-			Locker< DynamicArray< Request* >, SpinLock > m_requestQueue;
-			/// Condition used to wake up the worker thread when load requests are queued (or when it should shut down).
-			Condition m_wakeUpCondition;
-
-			/// Read-write lock used for synchronization of external file writes.
-			ReadWriteLock m_writeLock;
-
-			/// Non-zero if this thread should stop when next possible, zero if it should continue.
-			volatile int32_t m_stopCounter;
-			/// Non-zero if this thread is currently processing a load request.
-			volatile int32_t m_processingCounter;
+			/// @name Private Utility Functions
+			//@{
+			void ProcessRequests();
+			void ProcessMappedRequests( const uint8_t* pData, uint64_t size );
+			void ProcessPrefetchedRequest( Request* pRequest );
+			void CopyRequestData( Request* pRequest, const uint8_t* pData, size_t size );
+			FileStream* GetFileStream( const String& rFileName );
+			//@}
 		};
 
 		/// Pool of async load request objects.
 		ObjectPool< Request > m_requestPool;
 
-		/// Async loading thread.
-		RunnableThread* m_pThread;
-		/// Async loading thread worker.
-		LoadWorker* m_pWorker;
+		/// Async load request queues.
+		Locker< RequestQueues, SpinLock > m_requestQueues;
+		/// Condition used to wake up idle worker threads when load requests are queued (or when they should shut down).
+		Condition m_wakeUpCondition;
+		/// Read-write lock used for synchronization of external file writes.
+		ReadWriteLock m_writeLock;
+
+		/// Files registered for memory-mapped reads.
+		DynamicArray< MappedFile > m_mappedFiles;
+		/// Mutex synchronizing access to the memory-mapped file list.
+		Mutex m_mappedFileLock;
+
+		/// File ranges buffered by Prefetch() (only used for files that are not mapped).
+		DynamicArray< PrefetchRegion* > m_prefetchRegions;
+		/// Mutex synchronizing access to the prefetched ranges and their waiting requests.
+		Mutex m_prefetchLock;
+
+		/// Async loading thread workers.
+		DynamicArray< LoadWorker* > m_workers;
+		/// Async loading threads.
+		DynamicArray< RunnableThread* > m_threads;
+
+		/// Mutex synchronizing request completion with threads blocking on requests.
+		Mutex m_completionLock;
+		/// Conditions of threads blocking until any request completes (guarded by m_completionLock).
+		DynamicArray< Condition* > m_completionWaiters;
+		/// Conditions available for blocking threads (guarded by m_completionLock).
+		DynamicArray< Condition* > m_freeWaitConditions;
+
+		/// Number of requests queued or in progress.
+		volatile int32_t m_pendingRequestCount;
+		/// Number of requests completed or cancelled since startup (wraps around).
+		volatile int32_t m_completedRequestCount;
+		/// Number of worker threads currently sleeping on the wake-up condition.
+		volatile int32_t m_sleepingWorkerCount;
+		/// Non-zero if the worker threads should stop when next possible, zero if they should continue.
+		volatile int32_t m_stopCounter;
 
 		/// Singleton instance.
 		static AsyncLoader* sm_pInstance;
@@ -152,5 +333,34 @@ namespace Helium
 		AsyncLoader();
 		~AsyncLoader();
 		//@}
+
+		/// @name Private Utility Functions
+		//@{
+		size_t AddRequest(
+			void* pBuffer, const String& rFileName, uint64_t offset, size_t size, size_t decompressedSize,
+			EPriority priority, COMPLETION_CALLBACK* pCallback, void* pCallbackData );
+		bool PopRequests( DynamicArray< Request* >& rRequests );
+		bool HasQueuedRequests();
+		void WakeUpWorker();
+		void CompleteRequest( Request* pRequest );
+		void RetireRequest();
+		Condition* AcquireWaitCondition();
+
+		PrefetchRegion* FindPrefetchRegion( const String& rFileName, uint64_t offset, size_t size ) const;
+		void CompletePrefetch( PrefetchRegion* pRegion, size_t id, size_t bytesRead );
+
+		bool GetMappedFile( const String& rFileName, const uint8_t*& rpData, uint64_t& rSize );
+		void ReleaseMappedFiles();
+		void ReleaseOpenFiles();
+		//@}
+
+		/// @name Private Static Utility Functions
+		//@{
+		static const uint8_t* MapFileView( const String& rFileName, uint64_t& rSize );
+		static void UnmapFileView( const uint8_t* pData, uint64_t size );
+		static void AdviseFileView( const uint8_t* pData, uint64_t offset, size_t size );
+
+		static void PrefetchCallback( void* pUserData, size_t id, size_t bytesRead );
+		//@}
 	};
 }
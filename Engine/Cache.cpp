@@ -1,7 +1,9 @@
 #include "EnginePch.h"
 #include "Engine/Cache.h"
 
+#include "Foundation/FilePath.h"
 #include "Foundation/FileStream.h"
+#include "Foundation/HashMap.h"
 #include "Foundation/MemoryStream.h"
 #include "Foundation/StringConverter.h"
 
@@ -9,6 +11,10 @@
 #include "Engine/FileLocations.h"
 #include "Engine/AsyncLoader.h"
 
+#include <algorithm>
+
+#include <zlib.h>
+
 #define USE_BSON_FOR_CACHE_FORMAT 0
 #define USE_JSON_FOR_CACHE_FORMAT 1
 
@@ -32,8 +38,42 @@ using namespace Helium;
 static const uint32_t TOC_MAGIC = 0xcac4e70c;
 /// TOC header magic number (byte-swapped).
 static const uint32_t TOC_MAGIC_SWAPPED = 0x0ce7c4ca;
-/// Cache format version number.
-const uint32_t Cache::sm_Version = 0;
+/// Minimum number of TOC journal records allowed before the TOC is compacted.
+static const size_t TOC_JOURNAL_COMPACTION_THRESHOLD = 256;
+/// Size of the buffer used when copying entry data during cache compaction.
+static const size_t COMPACTION_COPY_BUFFER_SIZE = 1024 * 1024;
+/// Multiplier used to spread entry key hashes across the TOC index (2^64 divided by the golden ratio).
+static const uint64_t TOC_INDEX_HASH_MULTIPLIER = 0x9e3779b97f4a7c15;
+
+/// Get the smallest number of bytes used by a single TOC entry record (an entry with an empty AssetPath string).
+///
+/// @param[in] version  Cache format version number.
+///
+/// @return  Minimum size of a TOC entry record, in bytes.
+static size_t GetMinimumTocEntrySize( uint32_t version )
+{
+	// AssetPath string size, sub-data index, offset, timestamp, and size.
+	size_t size = sizeof( uint16_t ) + sizeof( uint32_t ) + sizeof( uint64_t ) + sizeof( int64_t ) + sizeof( uint32_t );
+
+	// Stored size.
+	if( version >= 2 )
+	{
+		size += sizeof( uint32_t );
+	}
+
+	// Source hash.
+	if( version >= 3 )
+	{
+		size += sizeof( uint64_t );
+	}
+
+	return size;
+}
+
+/// Cache format version number (version 1 adds the journal of entry updates following the TOC entry list, version 2
+/// adds the stored size of each entry for compressed entries, version 3 adds the hash of the source content from which
+/// each entry was built).
+const uint32_t Cache::sm_Version = 3;
 
 /// Constructor.
 Cache::Cache()
@@ -43,7 +83,14 @@ Cache::Cache()
 , m_asyncLoadId( Invalid< size_t >() )
 , m_pTocBuffer( NULL )
 , m_tocSize( Invalid< uint32_t >() )
+, m_tocJournalRecordCount( Invalid< size_t >() )
+, m_pTocEntries( NULL )
+, m_tocEntryCount( 0 )
+, m_pTocIndex( NULL )
+, m_tocIndexSlotCount( 0 )
+, m_tocIndexShift( 0 )
 , m_pEntryPool( NULL )
+, m_addedEntryCount( 0 )
 {
 }
 
@@ -98,6 +145,11 @@ bool Cache::Initialize( Name name, EPlatform platform, const char* pTocFileName,
 
 	m_tocSize = static_cast< uint32_t >( tocSize64 );
 
+	// Cache entries are read with many small requests, so read them straight out of a memory-mapped view.
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+	pAsyncLoader->MapFile( m_cacheFileName );
+
 	HELIUM_ASSERT( !m_pEntryPool );
 	m_pEntryPool = new ObjectPool< Entry >( ENTRY_POOL_BLOCK_SIZE );
 	HELIUM_ASSERT( m_pEntryPool );
@@ -113,9 +165,6 @@ void Cache::Shutdown()
 	m_name = NULL_NAME;
 	m_platform = PLATFORM_INVALID;
 
-	m_tocFileName.Clear();
-	m_cacheFileName.Clear();
-
 	if( IsValid( m_asyncLoadId ) )
 	{
 		AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
@@ -125,14 +174,26 @@ void Cache::Shutdown()
 		SetInvalid( m_asyncLoadId );
 	}
 
+	if( !m_cacheFileName.IsEmpty() )
+	{
+		AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+		if( pAsyncLoader )
+		{
+			pAsyncLoader->UnmapFile( m_cacheFileName );
+		}
+	}
+
+	m_tocFileName.Clear();
+	m_cacheFileName.Clear();
+
 	DefaultAllocator().Free( m_pTocBuffer );
 	m_pTocBuffer = NULL;
 	SetInvalid( m_tocSize );
+	SetInvalid( m_tocJournalRecordCount );
 
 	m_bTocLoaded = false;
 
-	m_entries.Clear();
-	m_entryMap.Clear();
+	ClearEntries();
 
 	delete m_pEntryPool;
 	m_pEntryPool = NULL;
@@ -267,18 +328,7 @@ bool Cache::TryFinishLoadToc()
 
 		if( !bFinalizeResult )
 		{
-			HELIUM_ASSERT( m_pEntryPool );
-
-			size_t entryCount = m_entries.GetSize();
-			for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
-			{
-				Entry* pEntry = m_entries[ entryIndex ];
-				HELIUM_ASSERT( pEntry );
-				m_pEntryPool->Release( pEntry );
-			}
-
-			m_entries.Clear();
-			m_entryMap.Clear();
+			ClearEntries();
 		}
 	}
 
@@ -298,16 +348,23 @@ void Cache::EnforceTocLoad()
 
 		if( BeginLoadToc() )
 		{
-			while( !TryFinishLoadToc() )
-			{
-				Thread::Yield();
-			}
+			AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+			HELIUM_ASSERT( pAsyncLoader );
+
+			pAsyncLoader->WaitForRequest( m_asyncLoadId );
+			HELIUM_VERIFY( TryFinishLoadToc() );
 		}
 	}
 }
 
 /// Search for a cache entry with the given object path name.
 ///
+/// Entries loaded from the TOC are found in the TOC index without taking any locks.  The entry hash map is only
+/// searched if entries have been added to the cache since its TOC was loaded.
+///
+/// This can be called while other threads are caching entries.  Entries are published fully written and are not
+/// modified afterwards, so the returned entry is either the state before or after a concurrent update of it.
+///
 /// @param[in] path          Asset path.
 /// @param[in] subDataIndex  Sub-data index associated with the cached data.
 ///
@@ -318,6 +375,12 @@ const Cache::Entry* Cache::FindEntry( AssetPath path, uint32_t subDataIndex ) co
 	key.path = path;
 	key.subDataIndex = subDataIndex;
 
+	Entry* pTocEntry = FindTocIndexEntry( key );
+	if( pTocEntry || m_addedEntryCount == 0 )
+	{
+		return pTocEntry;
+	}
+
 	EntryMapType::ConstAccessor mapAccessor;
 	if( !m_entryMap.Find( mapAccessor, key ) )
 	{
@@ -337,195 +400,241 @@ const Cache::Entry* Cache::FindEntry( AssetPath path, uint32_t subDataIndex ) co
 /// @param[in] pData         Data to cache.
 /// @param[in] timestamp     Timestamp value to associate with the entry in the cache.
 /// @param[in] size          Number of bytes to cache.
+/// @param[in] bCompress     True to store the data compressed if doing so makes it smaller.
+/// @param[in] sourceHash    Hash of the source content from which the data was built (zero if unknown).
 ///
 /// @return  True if the cache was updated successfully, false if not.
+///
+/// @see CacheEntries()
 bool Cache::CacheEntry(
 					   AssetPath path,
 					   uint32_t subDataIndex,
 					   const void* pData,
 					   int64_t timestamp,
-					   uint32_t size )
+					   uint32_t size,
+					   bool bCompress,
+					   uint64_t sourceHash )
 {
-	HELIUM_ASSERT( pData || size == 0 );
-
-	Status status;
-	status.Read( m_cacheFileName.GetData() );
-	int64_t cacheFileSize = status.m_Size;
-	uint64_t entryOffset = ( cacheFileSize == -1 ? 0 : static_cast< uint64_t >( cacheFileSize ) );
+	EntryWrite write;
+	write.path = path;
+	write.subDataIndex = subDataIndex;
+	write.pData = pData;
+	write.timestamp = timestamp;
+	write.sourceHash = sourceHash;
+	write.size = size;
+	write.bCompress = bCompress;
+
+	return CacheEntries( &write, 1 );
+}
 
+/// Add or update a batch of entries in the cache.
+///
+/// The cache file is opened once for the entire batch, and a single record per entry is appended to the TOC
+/// journal instead of rewriting the entire TOC.  Entries flagged for compression are compressed before being written,
+/// but are stored uncompressed if compression does not make them any smaller.  The TOC is compacted (rewritten from the current entry list) once
+/// the journal grows larger than the entry list itself, keeping the cost of caching linear in the number of entries.
+///
+/// Each entry is only published (to FindEntry() and the entry list) once its data has been written successfully.
+/// Updates to existing entries are written to a new Entry that replaces the original, which is retired rather than
+/// freed since other threads may still be reading it.
+///
+/// @param[in] pWrites     Entries to cache.
+/// @param[in] writeCount  Number of entries to cache.
+///
+/// @return  True if all entries were cached successfully, false if any errors occurred.
+///
+/// @see CacheEntry()
+bool Cache::CacheEntries( const EntryWrite* pWrites, size_t writeCount )
+{
+	HELIUM_ASSERT( pWrites || writeCount == 0 );
 	HELIUM_ASSERT( m_pEntryPool );
-	Entry* pEntryUpdate = m_pEntryPool->Allocate();
-	HELIUM_ASSERT( pEntryUpdate );
-	pEntryUpdate->offset = entryOffset;
-	pEntryUpdate->timestamp = timestamp;
-	pEntryUpdate->path = path;
-	pEntryUpdate->subDataIndex = subDataIndex;
-	pEntryUpdate->size = size;
-
-	uint64_t originalOffset = 0;
-	int64_t originalTimestamp = 0;
-	uint32_t originalSize = 0;
 
-	EntryKey key;
-	key.path = path;
-	key.subDataIndex = subDataIndex;
+	if( writeCount == 0 )
+	{
+		return true;
+	}
 
-	EntryMapType::Accessor entryAccessor;
-	bool bNewEntry = m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntryUpdate ) );
-	if( bNewEntry )
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	pAsyncLoader->Lock();
+
+	FileStream* pCacheStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_WRITE, false );
+	if( !pCacheStream )
 	{
-		HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Adding \"%s\" to cache \"%s\".\n" ), *path.ToString(), *m_cacheFileName );
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open cache \"%s\" for writing.\n" ), *m_cacheFileName );
 
-		m_entries.Push( pEntryUpdate );
+		pAsyncLoader->Unlock();
+
+		return false;
 	}
-	else
-	{
-		HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Updating \"%s\" in cache \"%s\".\n" ), *path.ToString(), *m_cacheFileName );
 
-		m_pEntryPool->Release( pEntryUpdate );
+	Status status;
+	status.Read( m_cacheFileName.GetData() );
+	int64_t cacheFileSize = status.m_Size;
+	uint64_t appendOffset = ( cacheFileSize == -1 ? 0 : static_cast< uint64_t >( cacheFileSize ) );
 
-		pEntryUpdate = entryAccessor->Second();
-		HELIUM_ASSERT( pEntryUpdate );
+	bool bCacheSuccess = true;
+
+	DynamicArray< Entry* > updatedEntries;
+	updatedEntries.Reserve( writeCount );
 
-		originalOffset = pEntryUpdate->offset;
-		originalTimestamp = pEntryUpdate->timestamp;
-		originalSize = pEntryUpdate->size;
+	DynamicArray< uint8_t > compressedData;
 
-		if( originalSize < size )
+	for( size_t writeIndex = 0; writeIndex < writeCount; ++writeIndex )
+	{
+		const EntryWrite& rWrite = pWrites[ writeIndex ];
+		HELIUM_ASSERT( rWrite.pData || rWrite.size == 0 );
+
+		const void* pStoredData = rWrite.pData;
+		uint32_t storedSize = rWrite.size;
+		if( rWrite.bCompress &&
+			CompressEntryData( rWrite.pData, rWrite.size, compressedData ) &&
+			compressedData.GetSize() < rWrite.size )
 		{
-			pEntryUpdate->offset = entryOffset;
+			pStoredData = compressedData.GetData();
+			storedSize = static_cast< uint32_t >( compressedData.GetSize() );
 		}
-		else
+
+		EntryKey key;
+		key.path = rWrite.path;
+		key.subDataIndex = rWrite.subDataIndex;
+
+		EntryMapType::Accessor entryAccessor;
+
+		size_t tocIndexSlot;
+		SetInvalid( tocIndexSlot );
+		Entry* pOriginalEntry = FindTocIndexEntry( key, &tocIndexSlot );
+		if( !pOriginalEntry && m_entryMap.Find( entryAccessor, key ) )
 		{
-			entryOffset = originalOffset;
+			pOriginalEntry = entryAccessor->Second();
+			HELIUM_ASSERT( pOriginalEntry );
 		}
 
-		pEntryUpdate->timestamp = timestamp;
-		pEntryUpdate->size = size;
-	}
-
-	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
-	HELIUM_ASSERT( pAsyncLoader );
+		Entry* pEntryUpdate = m_pEntryPool->Allocate();
+		HELIUM_ASSERT( pEntryUpdate );
+		pEntryUpdate->offset = appendOffset;
+		pEntryUpdate->timestamp = rWrite.timestamp;
+		pEntryUpdate->sourceHash = rWrite.sourceHash;
+		pEntryUpdate->path = rWrite.path;
+		pEntryUpdate->subDataIndex = rWrite.subDataIndex;
+		pEntryUpdate->size = rWrite.size;
+		pEntryUpdate->storedSize = storedSize;
+		pEntryUpdate->listIndex = static_cast< uint32_t >( m_entries.GetSize() );
+
+		if( pOriginalEntry )
+		{
+			HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Updating \"%s\" in cache \"%s\".\n" ), *rWrite.path.ToString(), *m_cacheFileName );
 
-	pAsyncLoader->Lock();
+			// Reuse the original space in the cache file if the new data fits.
+			if( pOriginalEntry->storedSize >= storedSize )
+			{
+				pEntryUpdate->offset = pOriginalEntry->offset;
+			}
 
-	bool bCacheSuccess = true;
+			pEntryUpdate->listIndex = pOriginalEntry->listIndex;
+		}
+		else
+		{
+			HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Adding \"%s\" to cache \"%s\".\n" ), *rWrite.path.ToString(), *m_cacheFileName );
+		}
 
-	FileStream* pCacheStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_WRITE, false );
-	if( !pCacheStream )
-	{
-		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open cache \"%s\" for writing.\n" ), *m_cacheFileName );
+		uint64_t entryOffset = pEntryUpdate->offset;
 
-		bCacheSuccess = false;
-	}
-	else
-	{
 		HELIUM_TRACE(
 			TraceLevels::Info,
-			TXT( "Cache: Caching \"%s\" to \"%s\" (%" ) PRIu32 TXT( " bytes @ offset %" ) PRIu64 TXT( ").\n" ),
-			*path.ToString(),
+			( TXT( "Cache: Caching \"%s\" to \"%s\" (%" ) PRIu32 TXT( " bytes, %" ) PRIu32 TXT( " stored @ offset %" )
+			PRIu64 TXT( ").\n" ) ),
+			*rWrite.path.ToString(),
 			*m_cacheFileName,
-			size,
+			rWrite.size,
+			storedSize,
 			entryOffset );
 
+		bool bWriteSuccess = false;
+
 		uint64_t seekOffset = static_cast< uint64_t >( pCacheStream->Seek(
 			static_cast< int64_t >( entryOffset ),
 			SeekOrigins::Begin ) );
 		if( seekOffset != entryOffset )
 		{
 			HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Cache file offset seek failed.\n" ) );
-
-			if( bNewEntry )
-			{
-				m_entries.Pop();
-				m_entryMap.Remove( entryAccessor );
-				m_pEntryPool->Release( pEntryUpdate );
-			}
-			else
-			{
-				pEntryUpdate->offset = originalOffset;
-				pEntryUpdate->timestamp = originalTimestamp;
-				pEntryUpdate->size = originalSize;
-			}
-
-			bCacheSuccess = false;
 		}
 		else
 		{
-			size_t writeSize = pCacheStream->Write( pData, 1, size );
-			if( writeSize != size )
+			size_t writeSize = pCacheStream->Write( pStoredData, 1, storedSize );
+			if( writeSize != storedSize )
 			{
 				HELIUM_TRACE(
 					TraceLevels::Error,
 					( TXT( "Cache: Failed to write %" ) PRIu32 TXT( " bytes to cache \"%s\" (%" ) PRIuSZ
 					TXT( " bytes written).\n" ) ),
-					size,
+					storedSize,
 					*m_cacheFileName,
 					writeSize );
+			}
+			else
+			{
+				bWriteSuccess = true;
+			}
+		}
+
+		if( !bWriteSuccess )
+		{
+			m_pEntryPool->Release( pEntryUpdate );
+
+			bCacheSuccess = false;
+
+			continue;
+		}
 
-				if( bNewEntry )
-				{
-					m_entries.Pop();
-					m_entryMap.Remove( entryAccessor );
-					m_pEntryPool->Release( pEntryUpdate );
-				}
-				else
-				{
-					pEntryUpdate->offset = originalOffset;
-					pEntryUpdate->timestamp = originalTimestamp;
-					pEntryUpdate->size = originalSize;
-				}
-
-				bCacheSuccess = false;
+		// Publish the entry now that its data is in place.
+		if( pOriginalEntry )
+		{
+			if( IsValid( tocIndexSlot ) )
+			{
+				AtomicExchangeRelease( m_pTocIndex[ tocIndexSlot ], pEntryUpdate );
 			}
 			else
 			{
-				HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Rewriting TOC file \"%s\".\n" ), *m_tocFileName );
-
-				FileStream* pTocStream = FileStream::OpenFileStream( m_tocFileName, FileStream::MODE_WRITE, true );
-				if( !pTocStream )
-				{
-					HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open TOC \"%s\" for writing.\n" ), *m_tocFileName );
-				}
-				else
-				{
-					BufferedStream* pBufferedStream = new BufferedStream( pTocStream );
-					HELIUM_ASSERT( pBufferedStream );
-
-					pBufferedStream->Write( &TOC_MAGIC, sizeof( TOC_MAGIC ), 1 );
-					pBufferedStream->Write( &sm_Version, sizeof( sm_Version ), 1 );
-
-					uint32_t entryCount = static_cast< uint32_t >( m_entries.GetSize() );
-					pBufferedStream->Write( &entryCount, sizeof( entryCount ), 1 );
-
-					String entryPath;
-					uint_fast32_t entryCountFast = entryCount;
-					for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
-					{
-						Entry* pEntry = m_entries[ entryIndex ];
-						HELIUM_ASSERT( pEntry );
-
-						pEntry->path.ToString( entryPath );
-						HELIUM_ASSERT( entryPath.GetSize() < UINT16_MAX );
-						uint16_t pathSize = static_cast< uint16_t >( entryPath.GetSize() );
-						pBufferedStream->Write( &pathSize, sizeof( pathSize ), 1 );
-
-						pBufferedStream->Write( *entryPath, sizeof( char ), pathSize );
-
-						pBufferedStream->Write( &pEntry->subDataIndex, sizeof( pEntry->subDataIndex ), 1 );
-
-						pBufferedStream->Write( &pEntry->offset, sizeof( pEntry->offset ), 1 );
-						pBufferedStream->Write( &pEntry->timestamp, sizeof( pEntry->timestamp ), 1 );
-						pBufferedStream->Write( &pEntry->size, sizeof( pEntry->size ), 1 );
-					}
-
-					delete pBufferedStream;
-					delete pTocStream;
-				}
+				entryAccessor->Second() = pEntryUpdate;
 			}
+
+			HELIUM_ASSERT( m_entries[ pEntryUpdate->listIndex ] == pOriginalEntry );
+			m_entries[ pEntryUpdate->listIndex ] = pEntryUpdate;
+			m_retiredEntries.Push( pOriginalEntry );
+		}
+		else
+		{
+			m_entries.Push( pEntryUpdate );
+			HELIUM_VERIFY( m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntryUpdate ) ) );
+			AtomicIncrementRelease( m_addedEntryCount );
+		}
+
+		if( entryOffset == appendOffset )
+		{
+			appendOffset += storedSize;
 		}
 
-		delete pCacheStream;
+		updatedEntries.Push( pEntryUpdate );
+	}
+
+	delete pCacheStream;
+
+	if( !updatedEntries.IsEmpty() )
+	{
+		// Append the updates to the TOC journal, or rewrite the TOC if the journal cannot be appended to or has grown
+		// large enough that loading it would cost more than a rewrite.
+		if( IsInvalid( m_tocJournalRecordCount ) ||
+			m_tocJournalRecordCount + updatedEntries.GetSize() >
+			Max( TOC_JOURNAL_COMPACTION_THRESHOLD, m_entries.GetSize() ) )
+		{
+			WriteToc();
+		}
+		else
+		{
+			AppendTocJournal( updatedEntries );
+		}
 	}
 
 	pAsyncLoader->Unlock();
@@ -533,203 +642,960 @@ bool Cache::CacheEntry(
 	return bCacheSuccess;
 }
 
-/// Finalize the TOC loading process.
+/// Get statistics on the space used by this cache.
 ///
-/// Note that this does not free any resources on a failed load (the caller is responsible for such clean-up work).
+/// @param[out] rStats  Cache statistics.
 ///
-/// @return  True if the TOC load was successful, false if not.
-bool Cache::FinalizeTocLoad()
+/// @see Compact()
+void Cache::GetStats( Stats& rStats ) const
 {
-	HELIUM_ASSERT( m_pTocBuffer );
+	rStats.entryCount = GetEntryCount();
+	rStats.liveByteCount = 0;
 
-	const uint8_t* pTocCurrent = m_pTocBuffer;
-	const uint8_t* pTocMax = pTocCurrent + m_tocSize;
+	size_t entryCount = m_entries.GetSize();
+	for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	{
+		const Entry* pEntry = m_entries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
+		rStats.liveByteCount += pEntry->storedSize;
+	}
 
-	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
+	Status status;
+	status.Read( m_cacheFileName.GetData() );
+	rStats.fileSize = ( status.m_Size == -1 ? 0 : static_cast< uint64_t >( status.m_Size ) );
+}
 
-	// Validate the TOC header.
-	uint32_t magic;
-	if( !CheckedTocRead( MemoryCopy, magic, TXT( "the header magic" ), pTocCurrent, pTocMax ) )
+/// Rewrite the cache file with only its live entries stored contiguously, reclaiming the space left behind by
+/// updated entries, and rewrite the TOC to match.
+///
+/// Entries are written in the given load order first (all sub-data for each path together), followed by all
+/// remaining entries in their current order within the cache file.  The compacted data and its TOC are written to
+/// temporary files alongside the originals and then renamed over them, so the live files are never partially
+/// rewritten.
+///
+/// @param[in] pLoadOrder      Asset paths in the order in which they are expected to be loaded (can be null).
+/// @param[in] loadOrderCount  Number of paths in the load order.
+///
+/// @return  True if the cache was compacted successfully, false if not.
+///
+/// @see GetStats()
+bool Cache::Compact( const AssetPath* pLoadOrder, size_t loadOrderCount )
+{
+	HELIUM_ASSERT( pLoadOrder || loadOrderCount == 0 );
+	HELIUM_ASSERT( m_bTocLoaded );
+
+	// Build the new entry order.
+	HashMap< AssetPath, size_t > loadOrderRanks;
+	for( size_t loadOrderIndex = 0; loadOrderIndex < loadOrderCount; ++loadOrderIndex )
 	{
-		return false;
+		HashMap< AssetPath, size_t >::Iterator rankIterator;
+		loadOrderRanks.Insert(
+			rankIterator,
+			HashMap< AssetPath, size_t >::ValueType( pLoadOrder[ loadOrderIndex ], loadOrderIndex ) );
 	}
 
-	LOAD_VALUE_CALLBACK* pLoadFunction = NULL;
-	if( magic == TOC_MAGIC )
+	size_t entryCount = m_entries.GetSize();
+
+	DynamicArray< CompactionEntry > compactionEntries;
+	compactionEntries.Reserve( entryCount );
+	for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Info,
-			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (no byte swapping).\n" ),
-			*m_tocFileName );
+		Entry* pEntry = m_entries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
 
-		pLoadFunction = MemoryCopy;
+		CompactionEntry* pCompactionEntry = compactionEntries.New();
+		HELIUM_ASSERT( pCompactionEntry );
+		pCompactionEntry->pEntry = pEntry;
+		SetInvalid( pCompactionEntry->loadOrderRank );
+
+		HashMap< AssetPath, size_t >::Iterator rankIterator = loadOrderRanks.Find( pEntry->path );
+		if( rankIterator != loadOrderRanks.End() )
+		{
+			pCompactionEntry->loadOrderRank = rankIterator->Second();
+		}
 	}
-	else if( magic == TOC_MAGIC_SWAPPED )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Info,
-			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (byte swapping is necessary).\n" ),
-			*m_tocFileName );
-		HELIUM_TRACE(
-			TraceLevels::Warning,
-			( TXT( "Cache::TryFinishLoadToc(): Cache for TOC \"%s\" uses byte swapping, which may incur " )
-			TXT( "performance penalties.\n" ) ),
-			*m_tocFileName );
 
-		pLoadFunction = ReverseByteOrder;
+	std::sort( compactionEntries.GetData(), compactionEntries.GetData() + entryCount );
+
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	pAsyncLoader->Lock();
+
+	String compactFileName = m_cacheFileName;
+	compactFileName += TXT( ".compact" );
+
+	bool bCompactSuccess = false;
+
+	// Copy the live entries to the temporary file.
+	DynamicArray< uint8_t > copyBuffer;
+
+	FileStream* pCacheStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_READ );
+	FileStream* pCompactStream = FileStream::OpenFileStream( compactFileName, FileStream::MODE_WRITE, true );
+	if( !pCacheStream || !pCompactStream )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache::Compact(): Failed to open \"%s\" for compaction.\n" ), *m_cacheFileName );
 	}
 	else
 	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" has invalid file magic.\n" ),
-			*m_tocFileName );
+		bCompactSuccess = true;
 
-		return false;
-	}
+		uint64_t compactOffset = 0;
+		for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+		{
+			CompactionEntry& rCompactionEntry = compactionEntries[ entryIndex ];
+			const Entry* pEntry = rCompactionEntry.pEntry;
 
-	uint32_t version;
-	if( !CheckedTocRead( pLoadFunction, version, TXT( "the cache version number" ), pTocCurrent, pTocMax ) )
-	{
-		return false;
-	}
+			int64_t seekOffset = pCacheStream->Seek( static_cast< int64_t >( pEntry->offset ), SeekOrigins::Begin );
+			if( static_cast< uint64_t >( seekOffset ) != pEntry->offset ||
+				!CopyStreamData( *pCacheStream, *pCompactStream, pEntry->storedSize, copyBuffer ) )
+			{
+				HELIUM_TRACE(
+					TraceLevels::Error,
+					TXT( "Cache::Compact(): Failed to copy \"%s\" (sub-data %" ) PRIu32 TXT( ") from \"%s\".\n" ),
+					*pEntry->path.ToString(),
+					pEntry->subDataIndex,
+					*m_cacheFileName );
 
-	if( version > sm_Version )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			( TXT( "Cache::FinalizeTocLoad(): Cache version number (%" ) PRIu32 TXT( ") exceeds the maximum " )
-			TXT( "supported version (%" ) PRIu32 TXT( ").\n" ) ),
-			version,
-			sm_Version );
+				bCompactSuccess = false;
 
-		return false;
-	}
+				break;
+			}
 
-	// Read the numbers of entries in the cache.
-	uint32_t entryCount;
-	bool bReadResult = CheckedTocRead(
-		pLoadFunction,
-		entryCount,
-		TXT( "the number of entries in the cache" ),
-		pTocCurrent,
-		pTocMax );
-	if( !bReadResult )
-	{
-		return false;
+			rCompactionEntry.compactOffset = compactOffset;
+			compactOffset += pEntry->storedSize;
+		}
 	}
 
-	// Load the entry information.
-	EntryKey key;
+	delete pCacheStream;
+	delete pCompactStream;
 
-	uint_fast32_t entryCountFast = entryCount;
-	m_entries.Reserve( entryCountFast );
-	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	// Write the TOC for the compacted data to a temporary file as well, so that neither of the live files is modified
+	// until both replacements have been written out in full.
+	String compactTocFileName = m_tocFileName;
+	compactTocFileName += TXT( ".compact" );
+
+	DynamicArray< Entry* > originalEntries;
+	if( bCompactSuccess )
 	{
-		uint16_t entryPathSize;
-		bReadResult = CheckedTocRead(
-			pLoadFunction,
-			entryPathSize,
-			TXT( "entry AssetPath string size" ),
-			pTocCurrent,
-			pTocMax );
-		if( !bReadResult )
+		originalEntries = m_entries;
+
+		for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
 		{
-			return false;
+			CompactionEntry& rCompactionEntry = compactionEntries[ entryIndex ];
+			rCompactionEntry.originalOffset = rCompactionEntry.pEntry->offset;
+			rCompactionEntry.pEntry->offset = rCompactionEntry.compactOffset;
+			rCompactionEntry.pEntry->listIndex = static_cast< uint32_t >( entryIndex );
+			m_entries[ entryIndex ] = rCompactionEntry.pEntry;
 		}
 
-		uint_fast16_t entryPathSizeFast = entryPathSize;
-
-		StackMemoryHeap<>::Marker stackMarker( rStackHeap );
-		char* pPathString = static_cast< char* >( rStackHeap.Allocate(
-			sizeof( char ) * ( entryPathSizeFast + 1 ) ) );
-		HELIUM_ASSERT( pPathString );
-		pPathString[ entryPathSizeFast ] = TXT( '\0' );
+		uint32_t compactTocSize = 0;
+		bCompactSuccess = WriteTocFile( compactTocFileName, compactTocSize );
 
-		for( uint_fast16_t characterIndex = 0; characterIndex < entryPathSizeFast; ++characterIndex )
+		// Replace the cache file first.  If that fails, the live files are left untouched.
+		if( bCompactSuccess && !MoveFileOver( compactFileName, m_cacheFileName ) )
 		{
-			bReadResult = CheckedTocRead(
-				pLoadFunction,
-				pPathString[ characterIndex ],
-				TXT( "entry AssetPath string character" ),
-				pTocCurrent,
-				pTocMax );
-			if( !bReadResult )
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				TXT( "Cache::Compact(): Failed to replace \"%s\" with \"%s\".\n" ),
+				*m_cacheFileName,
+				*compactFileName );
+
+			bCompactSuccess = false;
+		}
+
+		if( bCompactSuccess )
+		{
+			// The cache file now holds the compacted data, so the TOC must be replaced as well.  If the temporary TOC
+			// cannot be moved into place, fall back to rewriting it directly.
+			if( MoveFileOver( compactTocFileName, m_tocFileName ) )
+			{
+				m_tocSize = compactTocSize;
+				m_tocJournalRecordCount = 0;
+			}
+			else
+			{
+				HELIUM_TRACE(
+					TraceLevels::Warning,
+					TXT( "Cache::Compact(): Failed to replace \"%s\" with \"%s\", rewriting it instead.\n" ),
+					*m_tocFileName,
+					*compactTocFileName );
+
+				FilePath( *compactTocFileName ).Delete();
+				bCompactSuccess = WriteToc();
+			}
+		}
+		else
+		{
+			// Restore the original entry order and offsets, which still match the live files.
+			for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+			{
+				CompactionEntry& rCompactionEntry = compactionEntries[ entryIndex ];
+				rCompactionEntry.pEntry->offset = rCompactionEntry.originalOffset;
+			}
+
+			m_entries = originalEntries;
+			for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
 			{
-				return false;
+				m_entries[ entryIndex ]->listIndex = static_cast< uint32_t >( entryIndex );
 			}
 		}
+	}
+
+	if( !bCompactSuccess )
+	{
+		FilePath( *compactFileName ).Delete();
+		FilePath( *compactTocFileName ).Delete();
+	}
+
+	pAsyncLoader->Unlock();
+
+	return bCompactSuccess;
+}
+
+/// Rewrite the TOC file from the current entry list, discarding the TOC journal.
+///
+/// This must be called while the AsyncLoader is locked.
+///
+/// @return  True if the TOC was written successfully, false if not.
+///
+/// @see AppendTocJournal()
+bool Cache::WriteToc()
+{
+	HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Rewriting TOC file \"%s\".\n" ), *m_tocFileName );
+
+	SetInvalid( m_tocJournalRecordCount );
+
+	uint32_t tocSize = 0;
+	if( !WriteTocFile( m_tocFileName, tocSize ) )
+	{
+		return false;
+	}
+
+	m_tocSize = tocSize;
+	m_tocJournalRecordCount = 0;
+
+	return true;
+}
+
+/// Write a TOC for the current entry list to the specified file, replacing any existing contents.
+///
+/// This must be called while the AsyncLoader is locked.
+///
+/// @param[in]  rFileName  Name of the file to which the TOC should be written.
+/// @param[out] rTocSize   Size of the TOC written, in bytes.
+///
+/// @return  True if the TOC was written successfully, false if not.
+///
+/// @see WriteToc()
+bool Cache::WriteTocFile( const String& rFileName, uint32_t& rTocSize ) const
+{
+	DynamicArray< uint8_t > tocBuffer;
+	DynamicMemoryStream tocStream( &tocBuffer );
+
+	tocStream.Write( &TOC_MAGIC, sizeof( TOC_MAGIC ), 1 );
+	tocStream.Write( &sm_Version, sizeof( sm_Version ), 1 );
+
+	uint32_t entryCount = static_cast< uint32_t >( m_entries.GetSize() );
+	tocStream.Write( &entryCount, sizeof( entryCount ), 1 );
+
+	String entryPath;
+	uint_fast32_t entryCountFast = entryCount;
+	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	{
+		Entry* pEntry = m_entries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
+		WriteTocEntry( tocStream, *pEntry, entryPath );
+	}
+
+	FileStream* pTocStream = FileStream::OpenFileStream( rFileName, FileStream::MODE_WRITE, true );
+	if( !pTocStream )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open TOC \"%s\" for writing.\n" ), *rFileName );
+
+		return false;
+	}
+
+	size_t tocSize = tocBuffer.GetSize();
+	size_t writeSize = pTocStream->Write( tocBuffer.GetData(), 1, tocSize );
+	delete pTocStream;
+
+	if( writeSize != tocSize )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to write TOC \"%s\".\n" ), *rFileName );
+
+		return false;
+	}
+
+	rTocSize = static_cast< uint32_t >( tocSize );
+
+	return true;
+}
+
+/// Append records for the given entries to the TOC journal.
+///
+/// This must be called while the AsyncLoader is locked.  If the journal cannot be appended to, the TOC is rewritten
+/// instead.
+///
+/// @param[in] rEntries  Entries that have been added or updated.
+///
+/// @return  True if the TOC was updated successfully, false if not.
+///
+/// @see WriteToc()
+bool Cache::AppendTocJournal( const DynamicArray< Entry* >& rEntries )
+{
+	HELIUM_ASSERT( IsValid( m_tocJournalRecordCount ) );
+	HELIUM_ASSERT( IsValid( m_tocSize ) );
+
+	DynamicArray< uint8_t > journalBuffer;
+	DynamicMemoryStream journalStream( &journalBuffer );
+
+	String entryPath;
+	size_t entryCount = rEntries.GetSize();
+	for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	{
+		Entry* pEntry = rEntries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
+		WriteTocEntry( journalStream, *pEntry, entryPath );
+	}
+
+	size_t journalSize = journalBuffer.GetSize();
+	if( static_cast< uint64_t >( m_tocSize ) + journalSize >= UINT32_MAX )
+	{
+		return WriteToc();
+	}
+
+	FileStream* pTocStream = FileStream::OpenFileStream( m_tocFileName, FileStream::MODE_WRITE, false );
+	if( !pTocStream )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open TOC \"%s\" for writing.\n" ), *m_tocFileName );
+
+		return WriteToc();
+	}
+
+	size_t writeSize = 0;
+	int64_t seekOffset = pTocStream->Seek( static_cast< int64_t >( m_tocSize ), SeekOrigins::Begin );
+	if( static_cast< uint64_t >( seekOffset ) == m_tocSize )
+	{
+		writeSize = pTocStream->Write( journalBuffer.GetData(), 1, journalSize );
+	}
+
+	delete pTocStream;
+
+	if( writeSize != journalSize )
+	{
+		HELIUM_TRACE( TraceLevels::Warning, TXT( "Cache: Failed to append to TOC \"%s\".\n" ), *m_tocFileName );
+
+		return WriteToc();
+	}
+
+	m_tocSize += static_cast< uint32_t >( journalSize );
+	m_tocJournalRecordCount += entryCount;
+
+	return true;
+}
+
+/// Write the TOC record for a cache entry.
+///
+/// @param[in] rStream      Stream to which the record should be written.
+/// @param[in] rEntry       Cache entry.
+/// @param[in] rEntryPath   Scratch string used for converting the entry path.
+void Cache::WriteTocEntry( Stream& rStream, const Entry& rEntry, String& rEntryPath )
+{
+	rEntry.path.ToString( rEntryPath );
+	HELIUM_ASSERT( rEntryPath.GetSize() < UINT16_MAX );
+	uint16_t pathSize = static_cast< uint16_t >( rEntryPath.GetSize() );
+	rStream.Write( &pathSize, sizeof( pathSize ), 1 );
+
+	rStream.Write( *rEntryPath, sizeof( char ), pathSize );
+
+	rStream.Write( &rEntry.subDataIndex, sizeof( rEntry.subDataIndex ), 1 );
+
+	rStream.Write( &rEntry.offset, sizeof( rEntry.offset ), 1 );
+	rStream.Write( &rEntry.timestamp, sizeof( rEntry.timestamp ), 1 );
+	rStream.Write( &rEntry.size, sizeof( rEntry.size ), 1 );
+	rStream.Write( &rEntry.storedSize, sizeof( rEntry.storedSize ), 1 );
+	rStream.Write( &rEntry.sourceHash, sizeof( rEntry.sourceHash ), 1 );
+}
+
+/// Finalize the TOC loading process.
+///
+/// Note that this does not free any resources on a failed load (the caller is responsible for such clean-up work).
+///
+/// @return  True if the TOC load was successful, false if not.
+bool Cache::FinalizeTocLoad()
+{
+	HELIUM_ASSERT( m_pTocBuffer );
+
+	const uint8_t* pTocCurrent = m_pTocBuffer;
+	const uint8_t* pTocMax = pTocCurrent + m_tocSize;
+
+	// Validate the TOC header.
+	uint32_t magic;
+	if( !CheckedTocRead( MemoryCopy, magic, TXT( "the header magic" ), pTocCurrent, pTocMax ) )
+	{
+		return false;
+	}
+
+	LOAD_VALUE_CALLBACK* pLoadFunction = NULL;
+	if( magic == TOC_MAGIC )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (no byte swapping).\n" ),
+			*m_tocFileName );
+
+		pLoadFunction = MemoryCopy;
+	}
+	else if( magic == TOC_MAGIC_SWAPPED )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (byte swapping is necessary).\n" ),
+			*m_tocFileName );
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			( TXT( "Cache::TryFinishLoadToc(): Cache for TOC \"%s\" uses byte swapping, which may incur " )
+			TXT( "performance penalties.\n" ) ),
+			*m_tocFileName );
+
+		pLoadFunction = ReverseByteOrder;
+	}
+	else
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" has invalid file magic.\n" ),
+			*m_tocFileName );
+
+		return false;
+	}
+
+	uint32_t version;
+	if( !CheckedTocRead( pLoadFunction, version, TXT( "the cache version number" ), pTocCurrent, pTocMax ) )
+	{
+		return false;
+	}
+
+	if( version > sm_Version )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			( TXT( "Cache::FinalizeTocLoad(): Cache version number (%" ) PRIu32 TXT( ") exceeds the maximum " )
+			TXT( "supported version (%" ) PRIu32 TXT( ").\n" ) ),
+			version,
+			sm_Version );
+
+		return false;
+	}
+
+	// Read the numbers of entries in the cache.
+	uint32_t entryCount;
+	bool bReadResult = CheckedTocRead(
+		pLoadFunction,
+		entryCount,
+		TXT( "the number of entries in the cache" ),
+		pTocCurrent,
+		pTocMax );
+	if( !bReadResult )
+	{
+		return false;
+	}
+
+	// Make sure the entry count is plausible for the size of the TOC before allocating anything for the entries.
+	size_t minimumEntrySize = GetMinimumTocEntrySize( version );
+	HELIUM_ASSERT( minimumEntrySize != 0 );
+	if( entryCount > static_cast< size_t >( pTocMax - pTocCurrent ) / minimumEntrySize )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			( TXT( "Cache::FinalizeTocLoad(): Entry count (%" ) PRIu32 TXT( ") in TOC \"%s\" exceeds the number of " )
+			TXT( "entries that fit in the remaining TOC data.\n" ) ),
+			entryCount,
+			*m_tocFileName );
+
+		return false;
+	}
+
+	// Load the entry information.
+	AssetPath entryPath;
+	uint32_t entrySubDataIndex;
+	uint64_t entryOffset;
+	int64_t entryTimestamp;
+	uint32_t entrySize;
+	uint32_t entryStoredSize;
+	uint64_t entrySourceHash;
+
+	EntryKey key;
+
+	// Entries from the TOC entry list are all allocated at once and never move, so they can be searched through the
+	// TOC index without locking once loading has completed.
+	HELIUM_ASSERT( !m_pTocEntries );
+	m_pTocEntries = new Entry [ entryCount ];
+	HELIUM_ASSERT( m_pTocEntries );
+	m_tocEntryCount = entryCount;
+
+	InitializeTocIndex( entryCount );
+
+	uint_fast32_t entryCountFast = entryCount;
+	m_entries.Reserve( entryCountFast );
+	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	{
+		bReadResult = ReadTocEntry(
+			pLoadFunction,
+			version,
+			pTocCurrent,
+			pTocMax,
+			entryPath,
+			entrySubDataIndex,
+			entryOffset,
+			entryTimestamp,
+			entrySize,
+			entryStoredSize,
+			entrySourceHash );
+		if( !bReadResult )
+		{
+			return false;
+		}
 
-		AssetPath entryPath;
-		if( !entryPath.Set( pPathString ) )
+		Entry* pEntry = &m_pTocEntries[ entryIndex ];
+		pEntry->path = entryPath;
+		pEntry->subDataIndex = entrySubDataIndex;
+		pEntry->offset = entryOffset;
+		pEntry->timestamp = entryTimestamp;
+		pEntry->sourceHash = entrySourceHash;
+		pEntry->size = entrySize;
+		pEntry->storedSize = entryStoredSize;
+		pEntry->listIndex = static_cast< uint32_t >( entryIndex );
+
+		if( !AddTocIndexEntry( pEntry ) )
 		{
 			HELIUM_TRACE(
 				TraceLevels::Error,
-				TXT( "Cache::FinalizeTocLoad(): Failed to set AssetPath for entry %" ) PRIuFAST16 TXT( ".\n" ),
-				entryIndex );
+				( TXT( "Cache::FinalizeTocLoad(): Duplicate entry found for AssetPath \"%s\", sub-data %" ) PRIu32
+				TXT( ".\n" ) ),
+				*entryPath.ToString(),
+				entrySubDataIndex );
 
 			return false;
 		}
 
-		uint32_t entrySubDataIndex;
-		bReadResult = CheckedTocRead(
+		m_entries.Add( pEntry );
+	}
+
+	// Apply the journal records appended after the entry list, in order.  A truncated record at the end of the
+	// journal (from an interrupted append) is discarded.
+	size_t journalRecordCount = 0;
+	bool bJournalValid = true;
+	while( pTocCurrent < pTocMax )
+	{
+		bReadResult = ReadTocEntry(
 			pLoadFunction,
-			entrySubDataIndex,
-			TXT( "entry sub-data index" ),
+			version,
 			pTocCurrent,
-			pTocMax );
+			pTocMax,
+			entryPath,
+			entrySubDataIndex,
+			entryOffset,
+			entryTimestamp,
+			entrySize,
+			entryStoredSize,
+			entrySourceHash );
 		if( !bReadResult )
 		{
-			return false;
+			HELIUM_TRACE(
+				TraceLevels::Warning,
+				TXT( "Cache::FinalizeTocLoad(): Discarding truncated journal record in TOC \"%s\".\n" ),
+				*m_tocFileName );
+
+			bJournalValid = false;
+
+			break;
 		}
 
 		key.path = entryPath;
 		key.subDataIndex = entrySubDataIndex;
 
-		EntryMapType::ConstAccessor entryAccessor;
-		if( m_entryMap.Find( entryAccessor, key ) )
+		Entry* pEntry = FindTocIndexEntry( key );
+		if( !pEntry )
+		{
+			EntryMapType::Accessor entryAccessor;
+			if( m_entryMap.Find( entryAccessor, key ) )
+			{
+				pEntry = entryAccessor->Second();
+				HELIUM_ASSERT( pEntry );
+			}
+			else
+			{
+				pEntry = m_pEntryPool->Allocate();
+				HELIUM_ASSERT( pEntry );
+				pEntry->path = entryPath;
+				pEntry->subDataIndex = entrySubDataIndex;
+				pEntry->listIndex = static_cast< uint32_t >( m_entries.GetSize() );
+
+				m_entries.Add( pEntry );
+
+				HELIUM_VERIFY( m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntry ) ) );
+				AtomicIncrementRelease( m_addedEntryCount );
+			}
+		}
+
+		pEntry->offset = entryOffset;
+		pEntry->timestamp = entryTimestamp;
+		pEntry->sourceHash = entrySourceHash;
+		pEntry->size = entrySize;
+		pEntry->storedSize = entryStoredSize;
+
+		++journalRecordCount;
+	}
+
+	// New journal records are always written in native byte order using the current record format, so the TOC will
+	// need to be rewritten before it can be appended to if it was byte swapped, used an older format, or ended with a
+	// truncated record.
+	if( bJournalValid && pLoadFunction == MemoryCopy && version == sm_Version )
+	{
+		m_tocJournalRecordCount = journalRecordCount;
+	}
+
+	return true;
+}
+
+/// Read a single entry record from the cache TOC.
+///
+/// @param[in]  pLoadFunction    Function to use for reading values.
+/// @param[in]  version          TOC format version number.
+/// @param[in]  rpTocCurrent     Pointer to the current offset within the TOC file buffer.
+/// @param[in]  pTocMax          Pointer to the end of the TOC file buffer.
+/// @param[out] rPath            Entry asset path.
+/// @param[out] rSubDataIndex    Entry sub-data index.
+/// @param[out] rOffset          Entry offset.
+/// @param[out] rTimestamp       Entry timestamp.
+/// @param[out] rSize            Entry size.
+/// @param[out] rStoredSize      Size of the entry data as stored in the cache file.
+/// @param[out] rSourceHash      Hash of the source content from which the entry was built.
+///
+/// @return  True if the record was read successfully, false if not.
+bool Cache::ReadTocEntry(
+						 LOAD_VALUE_CALLBACK* pLoadFunction,
+						 uint32_t version,
+						 const uint8_t*& rpTocCurrent,
+						 const uint8_t* pTocMax,
+						 AssetPath& rPath,
+						 uint32_t& rSubDataIndex,
+						 uint64_t& rOffset,
+						 int64_t& rTimestamp,
+						 uint32_t& rSize,
+						 uint32_t& rStoredSize,
+						 uint64_t& rSourceHash )
+{
+	uint16_t entryPathSize;
+	bool bReadResult = CheckedTocRead(
+		pLoadFunction,
+		entryPathSize,
+		TXT( "entry AssetPath string size" ),
+		rpTocCurrent,
+		pTocMax );
+	if( !bReadResult )
+	{
+		return false;
+	}
+
+	uint_fast16_t entryPathSizeFast = entryPathSize;
+
+	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
+	StackMemoryHeap<>::Marker stackMarker( rStackHeap );
+	char* pPathString = static_cast< char* >( rStackHeap.Allocate( sizeof( char ) * ( entryPathSizeFast + 1 ) ) );
+	HELIUM_ASSERT( pPathString );
+	pPathString[ entryPathSizeFast ] = TXT( '\0' );
+
+	for( uint_fast16_t characterIndex = 0; characterIndex < entryPathSizeFast; ++characterIndex )
+	{
+		bReadResult = CheckedTocRead(
+			pLoadFunction,
+			pPathString[ characterIndex ],
+			TXT( "entry AssetPath string character" ),
+			rpTocCurrent,
+			pTocMax );
+		if( !bReadResult )
+		{
+			return false;
+		}
+	}
+
+	if( !rPath.Set( pPathString ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::FinalizeTocLoad(): Failed to set AssetPath for entry \"%s\".\n" ),
+			pPathString );
+
+		return false;
+	}
+
+	bReadResult =
+		CheckedTocRead( pLoadFunction, rSubDataIndex, TXT( "entry sub-data index" ), rpTocCurrent, pTocMax ) &&
+		CheckedTocRead( pLoadFunction, rOffset, TXT( "entry offset" ), rpTocCurrent, pTocMax ) &&
+		CheckedTocRead( pLoadFunction, rTimestamp, TXT( "entry timestamp" ), rpTocCurrent, pTocMax ) &&
+		CheckedTocRead( pLoadFunction, rSize, TXT( "entry size" ), rpTocCurrent, pTocMax );
+	if( !bReadResult )
+	{
+		return false;
+	}
+
+	// Entries written before version 2 were never compressed.
+	rStoredSize = rSize;
+	if( version >= 2 )
+	{
+		if( !CheckedTocRead( pLoadFunction, rStoredSize, TXT( "entry stored size" ), rpTocCurrent, pTocMax ) )
+		{
+			return false;
+		}
+
+		if( rStoredSize > rSize )
 		{
 			HELIUM_TRACE(
 				TraceLevels::Error,
-				( TXT( "Cache::FinalizeTocLoad(): Duplicate entry found for AssetPath \"%s\", sub-data %" ) PRIu32
-				TXT( ".\n" ) ),
-				pPathString,
-				entrySubDataIndex );
+				TXT( "Cache::FinalizeTocLoad(): Entry \"%s\" has a stored size larger than its data size.\n" ),
+				pPathString );
 
 			return false;
 		}
+	}
 
-		uint64_t entryOffset;
-		if( !CheckedTocRead( pLoadFunction, entryOffset, TXT( "entry offset" ), pTocCurrent, pTocMax ) )
+	// Entries written before version 3 have no source hash, so they will be rebuilt when next cached.
+	rSourceHash = 0;
+	if( version >= 3 )
+	{
+		if( !CheckedTocRead( pLoadFunction, rSourceHash, TXT( "entry source hash" ), rpTocCurrent, pTocMax ) )
 		{
 			return false;
 		}
+	}
+
+	return true;
+}
 
-		int64_t entryTimestamp;
-		if( !CheckedTocRead( pLoadFunction, entryTimestamp, TXT( "entry timestamp" ), pTocCurrent, pTocMax ) )
+/// Release all cache entries and clear the entry lookup tables.
+void Cache::ClearEntries()
+{
+	for( size_t arrayIndex = 0; arrayIndex < 2; ++arrayIndex )
+	{
+		const DynamicArray< Entry* >& rEntries = ( arrayIndex == 0 ? m_entries : m_retiredEntries );
+
+		size_t entryCount = rEntries.GetSize();
+		for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+		{
+			Entry* pEntry = rEntries[ entryIndex ];
+			HELIUM_ASSERT( pEntry );
+
+			// Entries loaded from the TOC entry list are freed with the rest of their block.
+			if( pEntry < m_pTocEntries || pEntry >= m_pTocEntries + m_tocEntryCount )
+			{
+				HELIUM_ASSERT( m_pEntryPool );
+				m_pEntryPool->Release( pEntry );
+			}
+		}
+	}
+
+	m_entries.Clear();
+	m_retiredEntries.Clear();
+	m_entryMap.Clear();
+	m_addedEntryCount = 0;
+
+	delete [] m_pTocIndex;
+	m_pTocIndex = NULL;
+	m_tocIndexSlotCount = 0;
+	m_tocIndexShift = 0;
+
+	delete [] m_pTocEntries;
+	m_pTocEntries = NULL;
+	m_tocEntryCount = 0;
+}
+
+/// Allocate an empty TOC index large enough to hold the given number of entries.
+///
+/// The index is sized to the smallest power of two leaving at least half of its slots empty, keeping linear probe
+/// sequences short.
+///
+/// @param[in] entryCount  Number of entries that will be added to the index.
+///
+/// @see AddTocIndexEntry(), FindTocIndexEntry()
+void Cache::InitializeTocIndex( size_t entryCount )
+{
+	delete [] m_pTocIndex;
+	m_pTocIndex = NULL;
+	m_tocIndexSlotCount = 0;
+	m_tocIndexShift = 0;
+
+	if( entryCount == 0 )
+	{
+		return;
+	}
+
+	uint32_t slotBits = 1;
+	while( ( static_cast< size_t >( 1 ) << slotBits ) < entryCount * 2 )
+	{
+		++slotBits;
+	}
+
+	size_t slotCount = static_cast< size_t >( 1 ) << slotBits;
+	m_pTocIndex = new Entry* volatile [ slotCount ];
+	HELIUM_ASSERT( m_pTocIndex );
+	MemoryZero( const_cast< Entry** >( m_pTocIndex ), slotCount * sizeof( Entry* ) );
+	m_tocIndexSlotCount = slotCount;
+
+	m_tocIndexShift = 64 - slotBits;
+}
+
+/// Add an entry to the TOC index.
+///
+/// @param[in] pEntry  Entry to add.
+///
+/// @return  True if the entry was added, false if an entry with the same path and sub-data index already exists.
+///
+/// @see InitializeTocIndex(), FindTocIndexEntry()
+bool Cache::AddTocIndexEntry( Entry* pEntry )
+{
+	HELIUM_ASSERT( pEntry );
+	HELIUM_ASSERT( m_pTocIndex );
+
+	EntryKey key;
+	key.path = pEntry->path;
+	key.subDataIndex = pEntry->subDataIndex;
+
+	size_t slotMask = m_tocIndexSlotCount - 1;
+	for( size_t slotIndex = GetTocIndexSlot( key ); ; slotIndex = ( slotIndex + 1 ) & slotMask )
+	{
+		Entry* pSlotEntry = m_pTocIndex[ slotIndex ];
+		if( !pSlotEntry )
+		{
+			m_pTocIndex[ slotIndex ] = pEntry;
+
+			return true;
+		}
+
+		if( pSlotEntry->path == key.path && pSlotEntry->subDataIndex == key.subDataIndex )
 		{
 			return false;
 		}
+	}
+}
+
+/// Search the TOC index for an entry loaded from the TOC entry list.
+///
+/// @param[in]  rKey        Entry key.
+/// @param[out] pSlotIndex  If not null and the entry is found, set to the index of the slot holding it.
+///
+/// @return  Matching entry if found, null if not.
+///
+/// @see AddTocIndexEntry()
+Cache::Entry* Cache::FindTocIndexEntry( const EntryKey& rKey, size_t* pSlotIndex ) const
+{
+	if( !m_pTocIndex )
+	{
+		return NULL;
+	}
+
+	size_t slotMask = m_tocIndexSlotCount - 1;
+	Entry* const volatile* pSlots = m_pTocIndex;
+
+	for( size_t slotIndex = GetTocIndexSlot( rKey ); ; slotIndex = ( slotIndex + 1 ) & slotMask )
+	{
+		Entry* pSlotEntry = pSlots[ slotIndex ];
+		if( !pSlotEntry )
+		{
+			return NULL;
+		}
+
+		if( pSlotEntry->path == rKey.path && pSlotEntry->subDataIndex == rKey.subDataIndex )
+		{
+			if( pSlotIndex )
+			{
+				*pSlotIndex = slotIndex;
+			}
+
+			return pSlotEntry;
+		}
+	}
+}
+
+/// Compute the home slot of an entry key in the TOC index.
+///
+/// Asset path hashes are derived from entry addresses, so their low bits are mostly constant.  The hash is spread
+/// with a Fibonacci multiply and the slot is taken from its high bits instead.
+///
+/// @param[in] rKey  Entry key.
+///
+/// @return  Index of the first slot to probe.
+size_t Cache::GetTocIndexSlot( const EntryKey& rKey ) const
+{
+	uint64_t hash = static_cast< uint64_t >( EntryKeyHash()( rKey ) ) * TOC_INDEX_HASH_MULTIPLIER;
+
+	return static_cast< size_t >( hash >> m_tocIndexShift );
+}
+
+/// Copy data from one stream to another in fixed-size chunks.
+///
+/// @param[in] rSource       Stream from which to read.
+/// @param[in] rDestination  Stream to which to write.
+/// @param[in] size          Number of bytes to copy.
+/// @param[in] rBuffer       Scratch buffer to use for copying.
+///
+/// @return  True if all data was copied, false if a read or write failed.
+bool Cache::CopyStreamData( Stream& rSource, Stream& rDestination, uint64_t size, DynamicArray< uint8_t >& rBuffer )
+{
+	rBuffer.Resize( COMPACTION_COPY_BUFFER_SIZE );
 
-		uint32_t entrySize;
-		if( !CheckedTocRead( pLoadFunction, entrySize, TXT( "entry size" ), pTocCurrent, pTocMax ) )
+	while( size != 0 )
+	{
+		size_t copySize = static_cast< size_t >( Min( size, static_cast< uint64_t >( COMPACTION_COPY_BUFFER_SIZE ) ) );
+		if( rSource.Read( rBuffer.GetData(), 1, copySize ) != copySize ||
+			rDestination.Write( rBuffer.GetData(), 1, copySize ) != copySize )
 		{
 			return false;
 		}
 
-		Entry* pEntry = m_pEntryPool->Allocate();
-		HELIUM_ASSERT( pEntry );
-		pEntry->path = entryPath;
-		pEntry->subDataIndex = entrySubDataIndex;
-		pEntry->offset = entryOffset;
-		pEntry->timestamp = entryTimestamp;
-		pEntry->size = entrySize;
+		size -= copySize;
+	}
 
-		m_entries.Add( pEntry );
+	return true;
+}
+
+/// Replace one file with another by renaming it over the destination.
+///
+/// @param[in] rSourceFileName       Name of the file to move.
+/// @param[in] rDestinationFileName  Name of the file to replace.
+///
+/// @return  True if the destination file was replaced, false if not.
+bool Cache::MoveFileOver( const String& rSourceFileName, const String& rDestinationFileName )
+{
+	FilePath sourcePath( *rSourceFileName );
+	FilePath destinationPath( *rDestinationFileName );
+	if( sourcePath.Move( destinationPath ) )
+	{
+		return true;
+	}
 
-		HELIUM_VERIFY( m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntry ) ) );
+	// Not all platforms allow renaming over an existing file, so move the destination out of the way first and restore
+	// it if the source still cannot be moved into place.
+	String backupFileName = rDestinationFileName;
+	backupFileName += TXT( ".old" );
+	FilePath backupPath( *backupFileName );
+	backupPath.Delete();
+	if( !destinationPath.Move( backupPath ) )
+	{
+		return false;
 	}
 
+	if( !sourcePath.Move( destinationPath ) )
+	{
+		backupPath.Move( destinationPath );
+
+		return false;
+	}
+
+	backupPath.Delete();
+
 	return true;
 }
 
@@ -773,6 +1639,26 @@ bool Cache::CheckedTocRead(
 	return true;
 }
 
+/// Less-than comparison, ordering entries by load order rank, then sub-data index, then current offset.
+///
+/// @param[in] rOther  Compaction entry with which to compare.
+///
+/// @return  True if this entry should be written before the given entry, false if not.
+bool Cache::CompactionEntry::operator<( const CompactionEntry& rOther ) const
+{
+	if( loadOrderRank != rOther.loadOrderRank )
+	{
+		return ( loadOrderRank < rOther.loadOrderRank );
+	}
+
+	if( IsValid( loadOrderRank ) && pEntry->subDataIndex != rOther.pEntry->subDataIndex )
+	{
+		return ( pEntry->subDataIndex < rOther.pEntry->subDataIndex );
+	}
+
+	return ( pEntry->offset < rOther.pEntry->offset );
+}
+
 /// Equality comparison.
 ///
 /// @param[in] rOther  Entry key with which to compare.
@@ -797,6 +1683,95 @@ size_t Cache::EntryKeyHash::operator()( const EntryKey& rKey ) const
 	return hash;
 }
 
+/// Compress cache entry data.
+///
+/// @param[in]  pSource       Data to compress.
+/// @param[in]  sourceSize    Number of bytes to compress.
+/// @param[out] rDestination  Compressed data.
+///
+/// @return  True if the data was compressed successfully, false if not.
+///
+/// @see DecompressEntryData()
+bool Cache::CompressEntryData( const void* pSource, size_t sourceSize, DynamicArray< uint8_t >& rDestination )
+{
+	HELIUM_ASSERT( pSource || sourceSize == 0 );
+
+	uLongf compressedSize = compressBound( static_cast< uLong >( sourceSize ) );
+	rDestination.Resize( compressedSize );
+
+	int result = compress2(
+		rDestination.GetData(),
+		&compressedSize,
+		static_cast< const Bytef* >( pSource ),
+		static_cast< uLong >( sourceSize ),
+		Z_BEST_COMPRESSION );
+	if( result != Z_OK )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "Cache::CompressEntryData(): Failed to compress %" ) PRIuSZ TXT( " bytes (error %d).\n" ),
+			sourceSize,
+			result );
+
+		rDestination.Resize( 0 );
+
+		return false;
+	}
+
+	rDestination.Resize( compressedSize );
+
+	return true;
+}
+
+/// Decompress cache entry data.
+///
+/// If the destination buffer is smaller than the decompressed data, only as much of the data as fits is
+/// decompressed.
+///
+/// @param[in] pSource          Compressed data.
+/// @param[in] sourceSize       Size of the compressed data, in bytes.
+/// @param[in] pDestination     Buffer in which to store the decompressed data.
+/// @param[in] destinationSize  Size of the destination buffer, in bytes.
+///
+/// @return  Number of bytes decompressed, or an invalid index if the compressed data is corrupt.
+///
+/// @see CompressEntryData()
+size_t Cache::DecompressEntryData( const void* pSource, size_t sourceSize, void* pDestination, size_t destinationSize )
+{
+	HELIUM_ASSERT( pSource || sourceSize == 0 );
+	HELIUM_ASSERT( pDestination || destinationSize == 0 );
+
+	z_stream stream;
+	MemoryZero( &stream, sizeof( stream ) );
+	stream.next_in = const_cast< Bytef* >( static_cast< const Bytef* >( pSource ) );
+	stream.avail_in = static_cast< uInt >( sourceSize );
+	stream.next_out = static_cast< Bytef* >( pDestination );
+	stream.avail_out = static_cast< uInt >( destinationSize );
+
+	if( inflateInit( &stream ) != Z_OK )
+	{
+		return Invalid< size_t >();
+	}
+
+	int result = inflate( &stream, Z_FINISH );
+	size_t decompressedSize = stream.total_out;
+	inflateEnd( &stream );
+
+	// Running out of output space is expected when only part of the data is requested.
+	if( result != Z_STREAM_END && !( result == Z_BUF_ERROR && stream.avail_out == 0 ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::DecompressEntryData(): Failed to decompress %" ) PRIuSZ TXT( " bytes (error %d).\n" ),
+			sourceSize,
+			result );
+
+		return Invalid< size_t >();
+	}
+
+	return decompressedSize;
+}
+
 #if HELIUM_TOOLS
 void Helium::Cache::WriteCacheObjectToBuffer( Reflect::Object* _object, DynamicArray< uint8_t > &_buffer )
 {
@@ -10,6 +10,8 @@
 
 namespace Helium
 {
+	class Stream;
+
 	/// Serialization cache interface.
 	class HELIUM_ENGINE_API Cache : NonCopyable
 	{
@@ -35,12 +37,18 @@ namespace Helium
 
 		/// Cache entry information.  Note that the members of this struct are organized as such so as to reduce memory
 		/// overhead from padding each value.
+		///
+		/// Apart from cache compaction, entries are never modified once they can be found with Cache::FindEntry().
+		/// Updating a cached entry publishes a new Entry in its place, so pointers returned by FindEntry() remain
+		/// valid (if stale) until the cache is shut down.
 		struct Entry
 		{
 			/// Entry offset.
 			uint64_t offset;
 			/// Entry timestamp.
 			int64_t timestamp;
+			/// Hash of the source content from which the entry data was built (zero if unknown).
+			uint64_t sourceHash;
 
 			/// Entry path name.
 			AssetPath path;
@@ -49,6 +57,40 @@ namespace Helium
 
 			/// Entry size.
 			uint32_t size;
+			/// Size of the entry data as stored in the cache file (less than the entry size if the data is compressed).
+			uint32_t storedSize;
+			/// Index of the entry in the cache entry list (see Cache::GetEntry()).
+			uint32_t listIndex;
+		};
+
+		/// Cache space usage statistics.
+		struct Stats
+		{
+			/// Number of entries in the cache.
+			uint32_t entryCount;
+			/// Total size of all entries, in bytes.
+			uint64_t liveByteCount;
+			/// Size of the cache file, in bytes (the space not used by live entries is dead).
+			uint64_t fileSize;
+		};
+
+		/// Cache entry data to write with CacheEntries().
+		struct EntryWrite
+		{
+			/// Entry path name.
+			AssetPath path;
+			/// Sub-data index.
+			uint32_t subDataIndex;
+			/// Data to cache.
+			const void* pData;
+			/// Entry timestamp.
+			int64_t timestamp;
+			/// Hash of the source content from which the data was built (zero if unknown).
+			uint64_t sourceHash;
+			/// Number of bytes to cache.
+			uint32_t size;
+			/// True to store the data compressed if doing so makes it smaller.
+			bool bCompress;
 		};
 
 		/// @name Construction/Destruction
@@ -84,7 +126,22 @@ namespace Helium
 		inline const Entry& GetEntry( uint32_t index ) const;
 		const Entry* FindEntry( AssetPath path, uint32_t subDataIndex ) const;
 
-		bool CacheEntry( AssetPath path, uint32_t subDataIndex, const void* pData, int64_t timestamp, uint32_t size );
+		bool CacheEntry(
+			AssetPath path, uint32_t subDataIndex, const void* pData, int64_t timestamp, uint32_t size,
+			bool bCompress = false, uint64_t sourceHash = 0 );
+		bool CacheEntries( const EntryWrite* pWrites, size_t writeCount );
+		//@}
+
+		/// @name Maintenance
+		//@{
+		void GetStats( Stats& rStats ) const;
+		bool Compact( const AssetPath* pLoadOrder = NULL, size_t loadOrderCount = 0 );
+		//@}
+
+		/// @name Entry Compression
+		//@{
+		static bool CompressEntryData( const void* pSource, size_t sourceSize, DynamicArray< uint8_t >& rDestination );
+		static size_t DecompressEntryData( const void* pSource, size_t sourceSize, void* pDestination, size_t destinationSize );
 		//@}
 
 #if HELIUM_TOOLS
@@ -121,6 +178,24 @@ namespace Helium
 			//@}
 		};
 
+		/// Cache entry ordering information used during compaction.
+		struct CompactionEntry
+		{
+			/// Cache entry.
+			Entry* pEntry;
+			/// Index of the entry path in the compaction load order (invalid if not in the load order).
+			size_t loadOrderRank;
+			/// Offset of the entry in the compacted cache file.
+			uint64_t compactOffset;
+			/// Offset of the entry in the cache file prior to compaction.
+			uint64_t originalOffset;
+
+			/// @name Overloaded Operators
+			//@{
+			bool operator<( const CompactionEntry& rOther ) const;
+			//@}
+		};
+
 		/// Cache entry hash map type.
 		typedef ConcurrentHashMap< EntryKey, Entry*, EntryKeyHash > EntryMapType;
 
@@ -144,21 +219,66 @@ namespace Helium
 		uint8_t* m_pTocBuffer;
 		/// Size of the TOC, in bytes.
 		uint32_t m_tocSize;
-
-		/// Cache entry pool.
+		/// Number of journal records following the TOC entry list (invalid if the TOC must be rewritten before it can
+		/// be appended to).
+		size_t m_tocJournalRecordCount;
+
+		/// Cache entries loaded from the TOC entry list, allocated as a single contiguous block.
+		Entry* m_pTocEntries;
+		/// Number of entries allocated in m_pTocEntries.
+		size_t m_tocEntryCount;
+		/// Open-addressed lookup table of the entries loaded from the TOC entry list.  Slots are never added once the
+		/// TOC has been loaded, and updated entries are published into their existing slots atomically, so it can be
+		/// searched without locking.
+		Entry* volatile* m_pTocIndex;
+		/// Number of slots in m_pTocIndex (zero or a power of two).
+		size_t m_tocIndexSlotCount;
+		/// Number of bits by which entry key hashes are shifted to compute their slot in m_pTocIndex.
+		uint32_t m_tocIndexShift;
+
+		/// Pool for entries added or updated after the TOC entry list was loaded.
 		ObjectPool< Entry >* m_pEntryPool;
 		/// Cache entry information.
 		DynamicArray< Entry* > m_entries;
-		/// Entry lookup hash map.
+		/// Lookup hash map for entries added after the TOC entry list was loaded.
 		EntryMapType m_entryMap;
+		/// Number of entries inserted into m_entryMap (checked by FindEntry() before searching the map).
+		volatile int32_t m_addedEntryCount;
+		/// Entries replaced by updates, kept until the entries are cleared since FindEntry() callers may still
+		/// reference them.
+		DynamicArray< Entry* > m_retiredEntries;
 
 		/// @name Loading Utility Functions
 		//@{
 		bool FinalizeTocLoad();
+		void ClearEntries();
+		bool ReadTocEntry(
+			LOAD_VALUE_CALLBACK* pLoadFunction, uint32_t version, const uint8_t*& rpTocCurrent, const uint8_t* pTocMax,
+			AssetPath& rPath, uint32_t& rSubDataIndex, uint64_t& rOffset, int64_t& rTimestamp, uint32_t& rSize,
+			uint32_t& rStoredSize, uint64_t& rSourceHash );
+		//@}
+
+		/// @name TOC Index Utility Functions
+		//@{
+		void InitializeTocIndex( size_t entryCount );
+		bool AddTocIndexEntry( Entry* pEntry );
+		Entry* FindTocIndexEntry( const EntryKey& rKey, size_t* pSlotIndex = NULL ) const;
+		size_t GetTocIndexSlot( const EntryKey& rKey ) const;
+		//@}
+
+		/// @name Writing Utility Functions
+		//@{
+		bool WriteToc();
+		bool WriteTocFile( const String& rFileName, uint32_t& rTocSize ) const;
+		bool AppendTocJournal( const DynamicArray< Entry* >& rEntries );
 		//@}
 
 		/// @name Private Static Utility Functions
 		//@{
+		static void WriteTocEntry( Stream& rStream, const Entry& rEntry, String& rEntryPath );
+		static bool CopyStreamData( Stream& rSource, Stream& rDestination, uint64_t size, DynamicArray< uint8_t >& rBuffer );
+		static bool MoveFileOver( const String& rSourceFileName, const String& rDestinationFileName );
+
 		template< typename T > static bool CheckedTocRead(
 			LOAD_VALUE_CALLBACK* pLoadFunction, T& rValue, const char* pDescription, const uint8_t*& rpTocCurrent,
 			const uint8_t* pTocMax );
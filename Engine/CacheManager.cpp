@@ -3,17 +3,100 @@
 
 #include "Platform/Process.h"
 #include "Foundation/FilePath.h"
+#include "Foundation/MemoryStream.h"
 #include "Engine/Asset.h"
+#include "Engine/AsyncLoader.h"
 #include "Engine/FileLocations.h"
 
+#include <algorithm>
+
+/// Name of the cache in which prefetch manifests are stored.
+#define HELIUM_PREFETCH_CACHE_NAME TXT( "Prefetch" )
+
 using namespace Helium;
 
 static uint32_t g_InitCount = 0;
 CacheManager* CacheManager::sm_pInstance = NULL;
 
+namespace
+{
+	/// Cache entry range resolved from a load record for prefetching.
+	struct PrefetchRange
+	{
+		/// Cache containing the entry.
+		const Cache* pCache;
+		/// Entry offset.
+		uint64_t offset;
+		/// Size of the entry data as stored in the cache file.
+		uint64_t size;
+
+		/// Sort ranges by cache, then by offset.
+		bool operator<( const PrefetchRange& rOther ) const
+		{
+			return ( pCache != rOther.pCache ? pCache < rOther.pCache : offset < rOther.offset );
+		}
+	};
+
+	/// Read a value from a prefetch manifest buffer.
+	///
+	/// @param[out]    rValue     Value read.
+	/// @param[in,out] rpCurrent  Current read position, advanced past the value if it was read.
+	/// @param[in]     pEnd       End of the manifest buffer.
+	///
+	/// @return  True if the value was read, false if the buffer was too small.
+	template< typename T >
+	bool ReadManifestValue( T& rValue, const uint8_t*& rpCurrent, const uint8_t* pEnd )
+	{
+		if( static_cast< size_t >( pEnd - rpCurrent ) < sizeof( T ) )
+		{
+			return false;
+		}
+
+		MemoryCopy( &rValue, rpCurrent, sizeof( T ) );
+		rpCurrent += sizeof( T );
+
+		return true;
+	}
+
+	/// Read a string stored as a 16-bit length followed by its characters from a prefetch manifest buffer.
+	///
+	/// @param[out]    rString    String read.
+	/// @param[in,out] rpCurrent  Current read position, advanced past the string if it was read.
+	/// @param[in]     pEnd       End of the manifest buffer.
+	///
+	/// @return  True if the string was read, false if the buffer was too small.
+	bool ReadManifestString( String& rString, const uint8_t*& rpCurrent, const uint8_t* pEnd )
+	{
+		uint16_t stringSize;
+		if( !ReadManifestValue( stringSize, rpCurrent, pEnd ) ||
+			static_cast< size_t >( pEnd - rpCurrent ) < stringSize * sizeof( char ) )
+		{
+			return false;
+		}
+
+		rString = String( reinterpret_cast< const char* >( rpCurrent ), stringSize );
+		rpCurrent += stringSize * sizeof( char );
+
+		return true;
+	}
+
+	/// Write a string as a 16-bit length followed by its characters to a prefetch manifest stream.
+	///
+	/// @param[in] rStream  Stream to which to write.
+	/// @param[in] rString  String to write.
+	void WriteManifestString( Stream& rStream, const String& rString )
+	{
+		HELIUM_ASSERT( rString.GetSize() < UINT16_MAX );
+		uint16_t stringSize = static_cast< uint16_t >( rString.GetSize() );
+		rStream.Write( &stringSize, sizeof( stringSize ), 1 );
+		rStream.Write( *rString, sizeof( char ), stringSize );
+	}
+}
+
 /// Constructor.
 CacheManager::CacheManager( const FilePath& rBaseDirectory )
 	: m_cachePool( CACHE_POOL_BLOCK_SIZE )
+	, m_bLoadRecording( false )
 {
 	m_platformDataDirectories[ Cache::PLATFORM_PC ] = rBaseDirectory.Data();
 	m_platformDataDirectories[ Cache::PLATFORM_PC ] += TXT( "DataPC/" );
@@ -113,6 +196,365 @@ const String& CacheManager::GetPlatformDataDirectory( Cache::EPlatform platform
 	return m_platformDataDirectories[ platform ];
 }
 
+/// Begin recording the cache entries read.
+///
+/// Each entry is recorded the first time it is read, so the recorded load order can be saved as a prefetch manifest
+/// once loading has finished.  Data loaded from in-memory preprocessed data in tools builds is not recorded.
+///
+/// @see EndLoadRecording(), RecordEntryLoad(), SavePrefetchManifest()
+void CacheManager::BeginLoadRecording()
+{
+	MutexScopeLock scopeLock( m_loadRecordLock );
+
+	HELIUM_ASSERT( !m_bLoadRecording );
+	m_loadRecords.Resize( 0 );
+	m_recordedEntries.Clear();
+	m_bLoadRecording = true;
+}
+
+/// Stop recording the cache entries read.
+///
+/// @param[out] rRecords  Cache entries read since recording began, in the order in which they were first read.
+///
+/// @see BeginLoadRecording()
+void CacheManager::EndLoadRecording( DynamicArray< LoadRecord >& rRecords )
+{
+	MutexScopeLock scopeLock( m_loadRecordLock );
+
+	HELIUM_ASSERT( m_bLoadRecording );
+	m_bLoadRecording = false;
+
+	rRecords = m_loadRecords;
+	m_loadRecords.Clear();
+	m_recordedEntries.Clear();
+}
+
+/// Record the read of a cache entry if load order recording is active.
+///
+/// @param[in] pCache  Cache containing the entry.
+/// @param[in] pEntry  Entry being read.
+///
+/// @see BeginLoadRecording()
+void CacheManager::RecordEntryLoad( const Cache* pCache, const Cache::Entry* pEntry )
+{
+	HELIUM_ASSERT( pCache );
+	HELIUM_ASSERT( pEntry );
+
+	if( !m_bLoadRecording )
+	{
+		return;
+	}
+
+	MutexScopeLock scopeLock( m_loadRecordLock );
+
+	if( !m_bLoadRecording )
+	{
+		return;
+	}
+
+	HashMap< const Cache::Entry*, size_t >::Iterator entryIterator;
+	if( !m_recordedEntries.Insert(
+		entryIterator,
+		HashMap< const Cache::Entry*, size_t >::ValueType( pEntry, m_loadRecords.GetSize() ) ) )
+	{
+		return;
+	}
+
+	LoadRecord* pRecord = m_loadRecords.New();
+	HELIUM_ASSERT( pRecord );
+	pRecord->cacheName = pCache->GetName();
+	pRecord->path = pEntry->path;
+	pRecord->subDataIndex = pEntry->subDataIndex;
+}
+
+/// Save a recorded load order as the prefetch manifest for an asset.
+///
+/// Manifests are stored in the "Prefetch" cache under the path of the asset whose load was recorded.  Entries are
+/// identified by cache name, path and sub-data index rather than file offset, so manifests remain usable after the
+/// caches they reference are rewritten or compacted.
+///
+/// @param[in] path      Path of the asset whose load was recorded.
+/// @param[in] rRecords  Recorded load order.
+///
+/// @return  True if the manifest was saved successfully, false if not.
+///
+/// @see LoadPrefetchManifest()
+bool CacheManager::SavePrefetchManifest( AssetPath path, const DynamicArray< LoadRecord >& rRecords )
+{
+	HELIUM_ASSERT( !path.IsEmpty() );
+
+	Cache* pPrefetchCache = GetCache( Name( HELIUM_PREFETCH_CACHE_NAME ) );
+	if( !pPrefetchCache )
+	{
+		return false;
+	}
+
+	pPrefetchCache->EnforceTocLoad();
+
+	DynamicArray< uint8_t > manifestBuffer;
+	DynamicMemoryStream manifestStream( &manifestBuffer );
+
+	uint32_t recordCount = static_cast< uint32_t >( rRecords.GetSize() );
+	manifestStream.Write( &recordCount, sizeof( recordCount ), 1 );
+
+	// The manifest is stamped with the newest of the entries it lists.
+	int64_t timestamp = INT64_MIN;
+
+	String recordString;
+	for( uint32_t recordIndex = 0; recordIndex < recordCount; ++recordIndex )
+	{
+		const LoadRecord& rRecord = rRecords[ recordIndex ];
+
+		recordString = *rRecord.cacheName;
+		WriteManifestString( manifestStream, recordString );
+
+		rRecord.path.ToString( recordString );
+		WriteManifestString( manifestStream, recordString );
+
+		manifestStream.Write( &rRecord.subDataIndex, sizeof( rRecord.subDataIndex ), 1 );
+
+		Cache* pCache = GetCache( rRecord.cacheName );
+		const Cache::Entry* pEntry = ( pCache ? pCache->FindEntry( rRecord.path, rRecord.subDataIndex ) : NULL );
+		if( pEntry && pEntry->timestamp > timestamp )
+		{
+			timestamp = pEntry->timestamp;
+		}
+	}
+
+	bool bResult = pPrefetchCache->CacheEntry(
+		path,
+		0,
+		manifestBuffer.GetData(),
+		timestamp,
+		static_cast< uint32_t >( manifestBuffer.GetSize() ) );
+	if( !bResult )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "CacheManager::SavePrefetchManifest(): Failed to cache the prefetch manifest for \"%s\".\n" ),
+			*path.ToString() );
+
+		return false;
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "CacheManager::SavePrefetchManifest(): Saved %" ) PRIu32 TXT( " entries for \"%s\".\n" ),
+		recordCount,
+		*path.ToString() );
+
+	return true;
+}
+
+/// Load the prefetch manifest saved for an asset.
+///
+/// @param[in]  path      Path of the asset whose manifest to load.
+/// @param[out] rRecords  Load order stored in the manifest.
+///
+/// @return  True if a manifest exists for the asset and was loaded successfully, false if not.
+///
+/// @see SavePrefetchManifest(), BeginPrefetch()
+bool CacheManager::LoadPrefetchManifest( AssetPath path, DynamicArray< LoadRecord >& rRecords )
+{
+	HELIUM_ASSERT( !path.IsEmpty() );
+
+	rRecords.Resize( 0 );
+
+	Cache* pPrefetchCache = GetCache( Name( HELIUM_PREFETCH_CACHE_NAME ) );
+	if( !pPrefetchCache )
+	{
+		return false;
+	}
+
+	pPrefetchCache->EnforceTocLoad();
+
+	const Cache::Entry* pEntry = pPrefetchCache->FindEntry( path, 0 );
+	if( !pEntry || pEntry->size == 0 )
+	{
+		return false;
+	}
+
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	DynamicArray< uint8_t > manifestBuffer;
+	manifestBuffer.Resize( pEntry->size );
+
+	size_t loadId;
+	if( pEntry->storedSize < pEntry->size )
+	{
+		loadId = pAsyncLoader->QueueCompressedRequest(
+			manifestBuffer.GetData(),
+			pPrefetchCache->GetCacheFileName(),
+			pEntry->offset,
+			pEntry->storedSize,
+			pEntry->size );
+	}
+	else
+	{
+		loadId = pAsyncLoader->QueueRequest(
+			manifestBuffer.GetData(),
+			pPrefetchCache->GetCacheFileName(),
+			pEntry->offset,
+			pEntry->size );
+	}
+	HELIUM_ASSERT( IsValid( loadId ) );
+
+	size_t bytesRead = pAsyncLoader->SyncRequest( loadId );
+	if( bytesRead != pEntry->size )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "CacheManager::LoadPrefetchManifest(): Failed to read the prefetch manifest for \"%s\".\n" ),
+			*path.ToString() );
+
+		return false;
+	}
+
+	const uint8_t* pCurrent = manifestBuffer.GetData();
+	const uint8_t* pEnd = pCurrent + bytesRead;
+
+	uint32_t recordCount;
+	if( !ReadManifestValue( recordCount, pCurrent, pEnd ) )
+	{
+		return false;
+	}
+
+	rRecords.Reserve( recordCount );
+
+	String recordString;
+	for( uint32_t recordIndex = 0; recordIndex < recordCount; ++recordIndex )
+	{
+		LoadRecord record;
+		if( !ReadManifestString( recordString, pCurrent, pEnd ) )
+		{
+			break;
+		}
+
+		record.cacheName.Set( *recordString );
+
+		if( !ReadManifestString( recordString, pCurrent, pEnd ) ||
+			!record.path.Set( recordString ) ||
+			!ReadManifestValue( record.subDataIndex, pCurrent, pEnd ) )
+		{
+			break;
+		}
+
+		rRecords.Push( record );
+	}
+
+	if( rRecords.GetSize() != recordCount )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "CacheManager::LoadPrefetchManifest(): Prefetch manifest for \"%s\" is corrupt.\n" ),
+			*path.ToString() );
+
+		rRecords.Resize( 0 );
+
+		return false;
+	}
+
+	return true;
+}
+
+/// Begin prefetching the cache entries listed in a recorded load order.
+///
+/// The entries are sorted by file offset and adjacent entries are merged into reads of up to PREFETCH_READ_SIZE_MAX
+/// bytes, which are all issued immediately.  Loads of the prefetched entries issued afterwards are serviced from
+/// memory once the reads covering them complete.  Entries that are no longer cached are skipped.
+///
+/// @param[in] rRecords  Load order to prefetch.
+///
+/// @see EndPrefetch(), LoadPrefetchManifest()
+void CacheManager::BeginPrefetch( const DynamicArray< LoadRecord >& rRecords )
+{
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	DynamicArray< PrefetchRange > ranges;
+	ranges.Reserve( rRecords.GetSize() );
+
+	size_t recordCount = rRecords.GetSize();
+	for( size_t recordIndex = 0; recordIndex < recordCount; ++recordIndex )
+	{
+		const LoadRecord& rRecord = rRecords[ recordIndex ];
+
+		Cache* pCache = GetCache( rRecord.cacheName );
+		if( !pCache )
+		{
+			continue;
+		}
+
+		pCache->EnforceTocLoad();
+
+		const Cache::Entry* pEntry = pCache->FindEntry( rRecord.path, rRecord.subDataIndex );
+		if( !pEntry || pEntry->storedSize == 0 )
+		{
+			continue;
+		}
+
+		PrefetchRange* pRange = ranges.New();
+		HELIUM_ASSERT( pRange );
+		pRange->pCache = pCache;
+		pRange->offset = pEntry->offset;
+		pRange->size = pEntry->storedSize;
+	}
+
+	std::sort( ranges.GetData(), ranges.GetData() + ranges.GetSize() );
+
+	size_t rangeCount = ranges.GetSize();
+	size_t readCount = 0;
+	for( size_t rangeIndex = 0; rangeIndex < rangeCount; )
+	{
+		const PrefetchRange& rFirstRange = ranges[ rangeIndex ];
+		uint64_t readStart = rFirstRange.offset;
+		uint64_t readEnd = readStart + rFirstRange.size;
+
+		for( ++rangeIndex; rangeIndex < rangeCount; ++rangeIndex )
+		{
+			const PrefetchRange& rRange = ranges[ rangeIndex ];
+			uint64_t rangeEnd = Max( readEnd, rRange.offset + rRange.size );
+			if( rRange.pCache != rFirstRange.pCache ||
+				rRange.offset > readEnd + PREFETCH_GAP_MAX ||
+				rangeEnd - readStart > PREFETCH_READ_SIZE_MAX )
+			{
+				break;
+			}
+
+			readEnd = rangeEnd;
+		}
+
+		if( pAsyncLoader->Prefetch(
+			rFirstRange.pCache->GetCacheFileName(),
+			readStart,
+			static_cast< size_t >( readEnd - readStart ) ) )
+		{
+			++readCount;
+		}
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Debug,
+		TXT( "CacheManager::BeginPrefetch(): Prefetching %" ) PRIuSZ TXT( " entries in %" ) PRIuSZ TXT( " reads.\n" ),
+		rangeCount,
+		readCount );
+}
+
+/// Release all data prefetched using BeginPrefetch().
+///
+/// This should be called once the loads covered by the prefetch have been issued, and blocks until all pending
+/// loads have completed.
+///
+/// @see BeginPrefetch()
+void CacheManager::EndPrefetch()
+{
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	pAsyncLoader->ReleasePrefetches();
+}
+
 /// Get the singleton CacheManager instance.
 ///
 /// @return  Pointer to the CacheManager instance.
@@ -3,6 +3,8 @@
 #include "Engine/Cache.h"
 
 #include "Foundation/FilePath.h"
+#include "Foundation/HashMap.h"
+#include "Platform/Locks.h"
 
 /// Cache table of contents file extension.
 #define HELIUM_CACHE_TOC_EXTENSION TXT( "cachetoc" )
@@ -12,12 +14,32 @@
 namespace Helium
 {
 	/// Manager for object and resource serialization caches.
+	///
+	/// The cache manager can also record the cache entries read while loading (such as while loading a scene), save
+	/// the recorded load order as a prefetch manifest, and play a manifest back by reading all of the entries it lists up
+	/// front, in file offset order, so that the individual loads issued afterwards are serviced from memory.
 	class HELIUM_ENGINE_API CacheManager : NonCopyable
 	{
 	public:
 		/// Number of cache objects per cache pool block.
 		static const size_t CACHE_POOL_BLOCK_SIZE = 4;
 
+		/// Maximum size of a single read issued when prefetching.
+		static const size_t PREFETCH_READ_SIZE_MAX = 4 * 1024 * 1024;
+		/// Maximum gap between cache entries read through when merging them into a single prefetch read.
+		static const size_t PREFETCH_GAP_MAX = 64 * 1024;
+
+		/// Cache entry read while recording the load order.
+		struct LoadRecord
+		{
+			/// Name of the cache containing the entry.
+			Name cacheName;
+			/// Entry path name.
+			AssetPath path;
+			/// Sub-data index.
+			uint32_t subDataIndex;
+		};
+
 		/// @name Cache Access
 		//@{
 		Cache* GetCache( Name name, Cache::EPlatform platform = Cache::PLATFORM_INVALID );
@@ -28,6 +50,24 @@ namespace Helium
 		const String& GetPlatformDataDirectory( Cache::EPlatform platform = Cache::PLATFORM_INVALID );
 		//@}
 
+		/// @name Load Order Recording
+		//@{
+		void BeginLoadRecording();
+		void EndLoadRecording( DynamicArray< LoadRecord >& rRecords );
+		inline bool IsLoadRecording() const;
+
+		void RecordEntryLoad( const Cache* pCache, const Cache::Entry* pEntry );
+		//@}
+
+		/// @name Prefetching
+		//@{
+		bool SavePrefetchManifest( AssetPath path, const DynamicArray< LoadRecord >& rRecords );
+		bool LoadPrefetchManifest( AssetPath path, DynamicArray< LoadRecord >& rRecords );
+
+		void BeginPrefetch( const DynamicArray< LoadRecord >& rRecords );
+		void EndPrefetch();
+		//@}
+
 		/// @name Static Access
 		//@{
 		static CacheManager* GetInstance();
@@ -49,6 +89,15 @@ namespace Helium
 		/// Cache lookup tables.
 		ConcurrentHashMap< Name, Cache* > m_cacheMaps[ Cache::PLATFORM_MAX ];
 
+		/// Cache entries read since load order recording began, in the order in which they were first read.
+		DynamicArray< LoadRecord > m_loadRecords;
+		/// Cache entries already recorded.
+		HashMap< const Cache::Entry*, size_t > m_recordedEntries;
+		/// Mutex synchronizing access to the recorded load order.
+		Mutex m_loadRecordLock;
+		/// True if load order recording is active.
+		volatile bool m_bLoadRecording;
+
 		/// Singleton instance.
 		static CacheManager* sm_pInstance;
 
@@ -59,3 +108,5 @@ namespace Helium
 		//@}
 	};
 }
+
+#include "Engine/CacheManager.inl"
@@ -0,0 +1,9 @@
+/// Get whether the cache entries read are currently being recorded.
+///
+/// @return  True if load order recording is active, false if not.
+///
+/// @see BeginLoadRecording(), EndLoadRecording()
+bool Helium::CacheManager::IsLoadRecording() const
+{
+    return m_bLoadRecording;
+}
@@ -242,6 +242,10 @@ size_t CachePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 			TXT( "CachePackageLoader::BeginLoadObject(): Issuing async load of property data for \"%s\".\n" ),
 			*path.ToString() );
 
+		CacheManager* pCacheManager = CacheManager::GetInstance();
+		HELIUM_ASSERT( pCacheManager );
+		pCacheManager->RecordEntryLoad( m_pCache, pEntry );
+
 		size_t entrySize = pEntry->size;
 		pRequest->pAsyncLoadBuffer = static_cast< uint8_t* >( DefaultAllocator().Allocate( entrySize ) );
 		HELIUM_ASSERT( pRequest->pAsyncLoadBuffer );
@@ -249,11 +253,23 @@ size_t CachePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 		AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
 		HELIUM_ASSERT( pAsyncLoader );
 
-		pRequest->asyncLoadId = pAsyncLoader->QueueRequest(
-			pRequest->pAsyncLoadBuffer,
-			m_pCache->GetCacheFileName(),
-			pEntry->offset,
-			entrySize );
+		if( pEntry->storedSize < entrySize )
+		{
+			pRequest->asyncLoadId = pAsyncLoader->QueueCompressedRequest(
+				pRequest->pAsyncLoadBuffer,
+				m_pCache->GetCacheFileName(),
+				pEntry->offset,
+				pEntry->storedSize,
+				entrySize );
+		}
+		else
+		{
+			pRequest->asyncLoadId = pAsyncLoader->QueueRequest(
+				pRequest->pAsyncLoadBuffer,
+				m_pCache->GetCacheFileName(),
+				pEntry->offset,
+				entrySize );
+		}
 		HELIUM_ASSERT( IsValid( pRequest->asyncLoadId ) );
 	}
 
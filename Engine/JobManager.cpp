@@ -0,0 +1,390 @@
+#include "EnginePch.h"
+#include "Engine/JobManager.h"
+
+#include "Platform/Atomic.h"
+
+#include <thread>
+
+using namespace Helium;
+
+static uint32_t g_InitCount = 0;
+JobManager* JobManager::sm_pInstance = NULL;
+
+/// Constructor.
+JobManager::JobManager()
+	: m_wakeUpCondition( false, false )
+	, m_sleepingWorkerCount( 0 )
+	, m_stopCounter( 0 )
+{
+}
+
+/// Destructor.
+JobManager::~JobManager()
+{
+	Cleanup();
+}
+
+/// Initialize the job manager and start its worker threads.
+///
+/// @param[in] workerThreadCount  Number of worker threads to create.  If this is zero, spawned jobs will only be run
+///                               by threads waiting on them.
+///
+/// @return  True if initialization was successful, false if not.
+///
+/// @see Cleanup()
+bool JobManager::Initialize( uint32_t workerThreadCount )
+{
+	Cleanup();
+
+	if( workerThreadCount > MAX_WORKER_THREAD_COUNT )
+	{
+		workerThreadCount = MAX_WORKER_THREAD_COUNT;
+	}
+
+	AtomicExchangeRelease( m_stopCounter, 0 );
+
+	// Create all workers before starting any threads so that stealing never sees a partially filled worker list.
+	m_workers.Reserve( workerThreadCount );
+	for( uint32_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+	{
+		Worker* pWorker = new Worker( this, workerIndex );
+		HELIUM_ASSERT( pWorker );
+		m_workers.Push( pWorker );
+	}
+
+	m_threads.Reserve( workerThreadCount );
+	for( uint32_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+	{
+		RunnableThread* pThread = new RunnableThread( m_workers[ workerIndex ] );
+		HELIUM_ASSERT( pThread );
+		HELIUM_VERIFY( pThread->Start( TXT( "JobManager - worker" ) ) );
+		m_threads.Push( pThread );
+	}
+
+	HELIUM_TRACE( TraceLevels::Info, TXT( "JobManager: Started %" ) PRIu32 TXT( " worker threads.\n" ), workerThreadCount );
+
+	return true;
+}
+
+/// Stop all worker threads and shut down the job manager.
+///
+/// All jobs must have completed prior to calling this function.
+///
+/// @see Initialize()
+void JobManager::Cleanup()
+{
+	AtomicExchangeRelease( m_stopCounter, 1 );
+	m_wakeUpCondition.Signal();
+
+	size_t threadCount = m_threads.GetSize();
+	for( size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex )
+	{
+		RunnableThread* pThread = m_threads[ threadIndex ];
+		HELIUM_ASSERT( pThread );
+		pThread->Join();
+		delete pThread;
+	}
+
+	m_threads.Clear();
+
+	size_t workerCount = m_workers.GetSize();
+	for( size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex )
+	{
+		delete m_workers[ workerIndex ];
+	}
+
+	m_workers.Clear();
+
+	HELIUM_ASSERT( !HasPendingJobs() );
+}
+
+/// Queue a job for execution.
+///
+/// @param[in] pFunc     Callback to run.
+/// @param[in] pData     Data to pass to the callback.
+/// @param[in] pCounter  Optional counter to increment now and decrement once the job has completed.
+///
+/// @see WaitForCounter()
+void JobManager::SpawnJob( JobFunc pFunc, void* pData, JobCounter* pCounter )
+{
+	HELIUM_ASSERT( pFunc );
+
+	if( pCounter )
+	{
+		AtomicIncrementAcquire( pCounter->m_PendingCount );
+	}
+
+	Job job;
+	job.pFunc = pFunc;
+	job.pData = pData;
+	job.pCounter = pCounter;
+
+	Worker* pWorker = static_cast< Worker* >( m_currentWorker.GetPointer() );
+	JobQueue& rQueue = ( pWorker ? pWorker->GetQueue() : m_sharedQueue );
+	{
+		JobQueue::Handle handle ( rQueue );
+		handle->Push( job );
+	}
+
+	WakeUpWorker();
+}
+
+/// Run a single pending job on the current thread, if one is available.
+///
+/// @return  True if a job was run, false if no jobs were pending.
+bool JobManager::TryRunJob()
+{
+	Job job;
+	if( !PopJob( static_cast< Worker* >( m_currentWorker.GetPointer() ), job ) )
+	{
+		return false;
+	}
+
+	RunJob( job );
+
+	return true;
+}
+
+/// Block the current thread until all jobs spawned with the given counter have completed.
+///
+/// Pending jobs are run on the current thread while waiting.
+///
+/// @param[in] rCounter  Counter on which to wait.
+void JobManager::WaitForCounter( JobCounter& rCounter )
+{
+	while( !rCounter.IsDone() )
+	{
+		if( !TryRunJob() )
+		{
+			Thread::Yield();
+		}
+	}
+}
+
+/// Get the singleton JobManager instance.
+///
+/// @return  Pointer to the JobManager instance, or null if it has not been started.
+///
+/// @see Startup(), Shutdown()
+JobManager* JobManager::GetInstance()
+{
+	return sm_pInstance;
+}
+
+/// Create the singleton JobManager instance.
+///
+/// @param[in] workerThreadCount  Number of worker threads to create, or zero to use the default count.
+///
+/// @see GetInstance(), GetDefaultWorkerThreadCount()
+void JobManager::Startup( uint32_t workerThreadCount )
+{
+	if ( ++g_InitCount == 1 )
+	{
+		if( workerThreadCount == 0 )
+		{
+			workerThreadCount = GetDefaultWorkerThreadCount();
+		}
+
+		HELIUM_ASSERT( !sm_pInstance );
+		sm_pInstance = new JobManager;
+		HELIUM_ASSERT( sm_pInstance );
+		if ( !HELIUM_VERIFY( sm_pInstance->Initialize( workerThreadCount ) ) )
+		{
+			Shutdown();
+		}
+	}
+}
+
+/// Destroy the singleton JobManager instance.
+///
+/// @see GetInstance()
+void JobManager::Shutdown()
+{
+	if ( --g_InitCount == 0 )
+	{
+		HELIUM_ASSERT( sm_pInstance );
+		sm_pInstance->Cleanup();
+		delete sm_pInstance;
+		sm_pInstance = NULL;
+	}
+}
+
+/// Get the default number of worker threads to create.
+///
+/// One hardware thread is left for the thread spawning jobs, as it runs jobs itself while waiting on them.
+///
+/// @return  Default worker thread count.
+uint32_t JobManager::GetDefaultWorkerThreadCount()
+{
+	uint32_t hardwareThreadCount = static_cast< uint32_t >( std::thread::hardware_concurrency() );
+	if( hardwareThreadCount <= 1 )
+	{
+		return 0;
+	}
+
+	return Min( hardwareThreadCount - 1, MAX_WORKER_THREAD_COUNT );
+}
+
+/// Pop the next job to run on the current thread.
+///
+/// Jobs are taken from the worker's own queue first, then from the shared queue, and finally stolen from other
+/// workers.
+///
+/// @param[in]  pWorker  Worker running on the current thread, or null if this is not a worker thread.
+/// @param[out] rJob     Job to run.
+///
+/// @return  True if a job was found, false if all queues were empty.
+bool JobManager::PopJob( Worker* pWorker, Job& rJob )
+{
+	if( pWorker )
+	{
+		JobQueue::Handle handle ( pWorker->GetQueue() );
+		if( !handle->IsEmpty() )
+		{
+			rJob = handle->Pop();
+
+			return true;
+		}
+	}
+
+	{
+		JobQueue::Handle handle ( m_sharedQueue );
+		if( !handle->IsEmpty() )
+		{
+			rJob = handle->GetElement( 0 );
+			handle->Remove( 0 );
+
+			return true;
+		}
+	}
+
+	// Start stealing from the next worker along so that idle workers spread out over the other queues.
+	size_t workerCount = m_workers.GetSize();
+	size_t startIndex = ( pWorker ? pWorker->GetIndex() + 1 : 0 );
+	for( size_t victimOffset = 0; victimOffset < workerCount; ++victimOffset )
+	{
+		Worker* pVictim = m_workers[ ( startIndex + victimOffset ) % workerCount ];
+		if( pVictim == pWorker )
+		{
+			continue;
+		}
+
+		// Steal the oldest job, as it is the most likely to spawn further work of its own.
+		JobQueue::Handle handle ( pVictim->GetQueue() );
+		if( !handle->IsEmpty() )
+		{
+			rJob = handle->GetElement( 0 );
+			handle->Remove( 0 );
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/// Get whether any jobs are queued.
+///
+/// @return  True if any queue is non-empty, false if not.
+bool JobManager::HasPendingJobs()
+{
+	{
+		JobQueue::Handle handle ( m_sharedQueue );
+		if( !handle->IsEmpty() )
+		{
+			return true;
+		}
+	}
+
+	size_t workerCount = m_workers.GetSize();
+	for( size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex )
+	{
+		JobQueue::Handle handle ( m_workers[ workerIndex ]->GetQueue() );
+		if( !handle->IsEmpty() )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/// Run a job and signal its completion.
+///
+/// @param[in] rJob  Job to run.
+void JobManager::RunJob( const Job& rJob )
+{
+	HELIUM_ASSERT( rJob.pFunc );
+	rJob.pFunc( rJob.pData );
+
+	if( rJob.pCounter )
+	{
+		AtomicDecrementRelease( rJob.pCounter->m_PendingCount );
+	}
+}
+
+/// Wake up an idle worker, if any are sleeping.
+void JobManager::WakeUpWorker()
+{
+	if( m_sleepingWorkerCount != 0 )
+	{
+		m_wakeUpCondition.Signal();
+	}
+}
+
+/// Constructor.
+///
+/// @param[in] pManager  Owning job manager.
+/// @param[in] index     Index of this worker in the manager's worker list.
+JobManager::Worker::Worker( JobManager* pManager, uint32_t index )
+	: m_pManager( pManager )
+	, m_index( index )
+{
+	HELIUM_ASSERT( pManager );
+}
+
+/// Destructor.
+JobManager::Worker::~Worker()
+{
+}
+
+/// Run jobs until the job manager is shut down.
+void JobManager::Worker::Run()
+{
+	JobManager* pManager = m_pManager;
+	HELIUM_ASSERT( pManager );
+
+	pManager->m_currentWorker.SetPointer( this );
+
+	Job job;
+	while( pManager->m_stopCounter == 0 )
+	{
+		if( pManager->PopJob( this, job ) )
+		{
+			// The wake-up condition coalesces signals, so pass it on if there is still work for other workers.
+			if( pManager->HasPendingJobs() )
+			{
+				pManager->WakeUpWorker();
+			}
+
+			pManager->RunJob( job );
+
+			continue;
+		}
+
+		// Register as sleeping before checking the queues one last time so that a job spawned in between is
+		// guaranteed to signal the wake-up condition.
+		AtomicIncrementAcquire( pManager->m_sleepingWorkerCount );
+		if( pManager->m_stopCounter == 0 && !pManager->HasPendingJobs() )
+		{
+			pManager->m_wakeUpCondition.Wait();
+		}
+
+		AtomicDecrementRelease( pManager->m_sleepingWorkerCount );
+	}
+
+	// Pass the shutdown signal on to any other workers still sleeping.
+	pManager->m_wakeUpCondition.Signal();
+
+	pManager->m_currentWorker.SetPointer( NULL );
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Platform/Condition.h"
+#include "Platform/Locks.h"
+#include "Platform/Thread.h"
+
+#include "Foundation/DynamicArray.h"
+
+#include "Engine/Engine.h"
+
+namespace Helium
+{
+	/// Callback executed to run a job.
+	typedef void (*JobFunc)( void* pData );
+
+	/// Counter tracking the completion of a group of jobs.
+	///
+	/// The counter is incremented when a job is spawned with it and decremented once that job has finished running,
+	/// so it reaches zero once every job in the group has completed.
+	struct JobCounter
+	{
+		/// Number of jobs spawned with this counter that have not yet completed.
+		volatile int32_t m_PendingCount;
+
+		/// @name Construction/Destruction
+		//@{
+		inline JobCounter();
+		//@}
+
+		/// @name Status
+		//@{
+		inline bool IsDone() const;
+		//@}
+	};
+
+	/// Pool of worker threads for running short-lived jobs in parallel.
+	///
+	/// Each worker owns a job queue.  Jobs spawned from a worker thread are pushed onto that worker's queue and popped
+	/// back off in LIFO order, while idle workers steal from the opposite end of other queues.  Jobs spawned from any
+	/// other thread are placed in a shared queue.  Threads waiting on a JobCounter run pending jobs until the counter
+	/// reaches zero, so waiting never blocks progress on the work being waited on.
+	class HELIUM_ENGINE_API JobManager : NonCopyable
+	{
+	public:
+		/// Maximum number of worker threads.
+		static const uint32_t MAX_WORKER_THREAD_COUNT = 64;
+
+		/// @name Initialization
+		//@{
+		bool Initialize( uint32_t workerThreadCount );
+		void Cleanup();
+		//@}
+
+		/// @name Job Management
+		//@{
+		void SpawnJob( JobFunc pFunc, void* pData, JobCounter* pCounter = NULL );
+		bool TryRunJob();
+		void WaitForCounter( JobCounter& rCounter );
+
+		inline uint32_t GetWorkerThreadCount() const;
+		//@}
+
+		/// @name Static Access
+		//@{
+		static JobManager* GetInstance();
+		static void Startup( uint32_t workerThreadCount = 0 );
+		static void Shutdown();
+
+		static uint32_t GetDefaultWorkerThreadCount();
+		//@}
+
+	private:
+		/// Queued job data.
+		struct Job
+		{
+			/// Callback to execute.
+			JobFunc pFunc;
+			/// Data to pass to the callback.
+			void* pData;
+			/// Counter to decrement once the job has completed (can be null).
+			JobCounter* pCounter;
+		};
+
+		/// Job queue.
+		typedef Locker< DynamicArray< Job >, SpinLock > JobQueue;
+
+		/// Worker thread runnable.
+		class Worker : public Runnable
+		{
+		public:
+			/// @name Construction/Destruction
+			//@{
+			Worker( JobManager* pManager, uint32_t index );
+			virtual ~Worker();
+			//@}
+
+			/// @name Runnable Interface
+			//@{
+			virtual void Run();
+			//@}
+
+			/// @name Job Queue Access
+			//@{
+			inline uint32_t GetIndex() const;
+			inline JobQueue& GetQueue();
+			//@}
+
+		private:
+			/// Owning job manager.
+			JobManager* m_pManager;
+			/// Index of this worker in the manager's worker list.
+			uint32_t m_index;
+			/// Jobs spawned from this worker's thread.
+			JobQueue m_queue;
+		};
+
+		/// Worker runnables.
+		DynamicArray< Worker* > m_workers;
+		/// Worker threads.
+		DynamicArray< RunnableThread* > m_threads;
+
+		/// Jobs spawned from threads that are not workers.
+		JobQueue m_sharedQueue;
+		/// Condition used to wake up idle workers when jobs are queued (or when they should shut down).
+		Condition m_wakeUpCondition;
+		/// Thread-local pointer to the Worker running on the current thread (null for non-worker threads).
+		ThreadLocalPointer m_currentWorker;
+
+		/// Number of workers currently sleeping on the wake-up condition.
+		volatile int32_t m_sleepingWorkerCount;
+		/// Non-zero if the workers should stop when next possible, zero if they should continue.
+		volatile int32_t m_stopCounter;
+
+		/// Singleton instance.
+		static JobManager* sm_pInstance;
+
+		/// @name Construction/Destruction
+		//@{
+		JobManager();
+		~JobManager();
+		//@}
+
+		/// @name Private Utility Functions
+		//@{
+		bool PopJob( Worker* pWorker, Job& rJob );
+		bool HasPendingJobs();
+		void RunJob( const Job& rJob );
+		void WakeUpWorker();
+		//@}
+	};
+}
+
+#include "Engine/JobManager.inl"
@@ -0,0 +1,37 @@
+/// Constructor.
+Helium::JobCounter::JobCounter()
+	: m_PendingCount( 0 )
+{
+}
+
+/// Get whether all jobs spawned with this counter have completed.
+///
+/// @return  True if no jobs are pending, false if any are still queued or running.
+bool Helium::JobCounter::IsDone() const
+{
+	return ( m_PendingCount == 0 );
+}
+
+/// Get the number of worker threads owned by this manager.
+///
+/// @return  Worker thread count.
+uint32_t Helium::JobManager::GetWorkerThreadCount() const
+{
+	return static_cast< uint32_t >( m_workers.GetSize() );
+}
+
+/// Get the index of this worker in the job manager's worker list.
+///
+/// @return  Worker index.
+uint32_t Helium::JobManager::Worker::GetIndex() const
+{
+	return m_index;
+}
+
+/// Get the queue of jobs spawned from this worker's thread.
+///
+/// @return  Reference to the job queue.
+Helium::JobManager::JobQueue& Helium::JobManager::Worker::GetQueue()
+{
+	return m_queue;
+}
@@ -36,6 +36,17 @@ Name Resource::GetCacheName() const
 	return Name( NULL_NAME );
 }
 
+/// Get whether the sub-data of this resource should be compressed when it is cached.
+///
+/// Compressed sub-data takes less space on disk, but must be decompressed when loaded, so this should only be
+/// enabled for resource types whose sub-data compresses well and is large enough for disk bandwidth to dominate.
+///
+/// @return  True if resource sub-data should be compressed, false if not.
+bool Resource::ShouldCompressSubData() const
+{
+	return false;
+}
+
 /// Get the size of the specified sub-data of this resource.
 ///
 /// @param[in] subDataIndex  Resource sub-data index.
@@ -133,6 +144,8 @@ size_t Resource::BeginLoadSubData( void* pBuffer, uint32_t subDataIndex, size_t
 		return Invalid< size_t >();
 	}
 
+	pCacheManager->RecordEntryLoad( pCache, pCacheEntry );
+
 	// Begin an asynchronous load.
 	size_t subDataSize = pCacheEntry->size;
 	size_t loadSize = Min( subDataSize, loadSizeMax );
@@ -140,7 +153,21 @@ size_t Resource::BeginLoadSubData( void* pBuffer, uint32_t subDataIndex, size_t
 	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
 	HELIUM_ASSERT( pAsyncLoader );
 
-	size_t loadId = pAsyncLoader->QueueRequest( pBuffer, pCache->GetCacheFileName(), pCacheEntry->offset, loadSize );
+	size_t loadId;
+	if( pCacheEntry->storedSize < pCacheEntry->size )
+	{
+		// Compressed sub-data is decompressed straight into the destination buffer by the loader.
+		loadId = pAsyncLoader->QueueCompressedRequest(
+			pBuffer,
+			pCache->GetCacheFileName(),
+			pCacheEntry->offset,
+			pCacheEntry->storedSize,
+			loadSize );
+	}
+	else
+	{
+		loadId = pAsyncLoader->QueueRequest( pBuffer, pCache->GetCacheFileName(), pCacheEntry->offset, loadSize );
+	}
 
 	return loadId;
 }
@@ -171,3 +198,25 @@ bool Resource::TryFinishLoadSubData( size_t loadId )
 
 	return bFinished;
 }
+
+/// Block until an asynchronous sub-data load request has completed.
+///
+/// @param[in] loadId  ID associated with the load request.
+///
+/// @see TryFinishLoadSubData()
+void Resource::FinishLoadSubData( size_t loadId )
+{
+	HELIUM_ASSERT( IsValid( loadId ) );
+
+#if HELIUM_TOOLS
+	if( loadId == static_cast< size_t >( -2 ) )
+	{
+		return;
+	}
+#endif
+
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	pAsyncLoader->SyncRequest( loadId );
+}
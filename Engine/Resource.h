@@ -50,6 +50,7 @@ namespace Helium
 		/// @name Resource Caching Support
 		//@{
 		virtual Name GetCacheName() const;
+		virtual bool ShouldCompressSubData() const;
 		//@}
 
 #if HELIUM_TOOLS
@@ -66,6 +67,7 @@ namespace Helium
 		size_t GetSubDataSize( uint32_t subDataIndex ) const;
 		size_t BeginLoadSubData( void* pBuffer, uint32_t subDataIndex, size_t loadSizeMax = Invalid< size_t >() );
 		bool TryFinishLoadSubData( size_t loadId );
+		void FinishLoadSubData( size_t loadId );
 		//@}
 
 	private:
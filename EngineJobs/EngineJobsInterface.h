@@ -2,6 +2,7 @@
 
 #include "Platform/Assert.h"
 #include "Foundation/Functions.h"
+#include "Engine/JobManager.h"
 #include "EngineJobs/EngineJobs.h"
 #include "EngineJobs/EngineJobsTypes.h"
 
@@ -22,7 +23,8 @@ public:
         size_t count;
         /// [in] Function object for checking whether the first element should be sorted before the second element.
         CompareFunction compare;
-        /// [in] Sub-division size at which to run the remainder of the sort within a single job.
+        /// [in] Sub-division size at which to run the remainder of the sort within a single job (larger partitions
+        ///      are sorted in parallel using the JobManager worker threads).
         size_t singleJobCount;
 
         /// @name Construction/Destruction
@@ -54,6 +56,52 @@ private:
     Parameters m_parameters;
 };
 
+/// Stable least-significant-digit radix sort of key/value pairs by their 64-bit keys.
+class HELIUM_ENGINE_JOBS_API RadixSortJob : Helium::NonCopyable
+{
+public:
+    class Parameters
+    {
+    public:
+        /// [inout] Pointer to the first entry to sort.
+        RadixSortEntry* pBase;
+        /// [in] Scratch buffer with room for at least as many entries as are being sorted.
+        RadixSortEntry* pScratch;
+        /// [in] Number of entries to sort.
+        size_t count;
+        /// [in] Fewest entries to give each job (larger arrays are counted and scattered in parallel using the
+        ///      JobManager worker threads).
+        size_t singleJobCount;
+
+        /// @name Construction/Destruction
+        //@{
+        inline Parameters();
+        //@}
+    };
+
+    /// @name Construction/Destruction
+    //@{
+    inline RadixSortJob();
+    inline ~RadixSortJob();
+    //@}
+
+    /// @name Parameters
+    //@{
+    inline Parameters& GetParameters();
+    inline const Parameters& GetParameters() const;
+    inline void SetParameters( const Parameters& rParameters );
+    //@}
+
+    /// @name Job Execution
+    //@{
+    void Run();
+    inline static void RunCallback( void* pJob );
+    //@}
+
+private:
+    Parameters m_parameters;
+};
+
 }  // namespace Helium
 
 #include "EngineJobs/EngineJobsInterface.inl"
@@ -19,4 +19,13 @@ namespace Helium
     /// @param[in] pElement0  First element to swap.
     /// @param[in] pElement1  Second element to swap.
     typedef void ( *SORT_SWAP_FUNC )( void* pElement0, void* pElement1 );
+
+    /// Key/value pair sorted by RadixSortJob.
+    struct RadixSortEntry
+    {
+        /// Sort key.
+        uint64_t key;
+        /// Value associated with the key.
+        size_t value;
+    };
 }
@@ -0,0 +1,231 @@
+#include "EngineJobsPch.h"
+#include "EngineJobs/EngineJobsInterface.h"
+
+#include "Platform/Memory.h"
+#include "Foundation/DynamicArray.h"
+
+/// Number of bits sorted in each radix sort pass.
+static const size_t RADIX_SORT_DIGIT_BITS = 8;
+/// Number of buckets for each radix sort digit.
+static const size_t RADIX_SORT_BUCKET_COUNT = 1 << RADIX_SORT_DIGIT_BITS;
+/// Number of radix sort digits in a 64-bit key.
+static const size_t RADIX_SORT_DIGIT_COUNT = 64 / RADIX_SORT_DIGIT_BITS;
+
+using namespace Helium;
+
+/// Range of entries counted and scattered by a single radix sort job.
+struct RadixSortBlock
+{
+    /// Entries being read by the current pass.
+    const RadixSortEntry* pSource;
+    /// Entries being written by the current pass.
+    RadixSortEntry* pDestination;
+    /// Index of the first entry in the block.
+    size_t startIndex;
+    /// Index one past the last entry in the block.
+    size_t endIndex;
+    /// Bucket counts of each digit for the entries in the block, replaced with the destination offset of each bucket
+    /// before the pass over that digit.
+    size_t* pHistograms;
+    /// Bit shift of the digit sorted by the current pass.
+    size_t shift;
+};
+
+/// Gather the histograms of every digit for the entries in a block.
+///
+/// @param[in] pData  RadixSortBlock to count.
+static void CountRadixSortBlockDigits( void* pData )
+{
+    RadixSortBlock* pBlock = static_cast< RadixSortBlock* >( pData );
+    HELIUM_ASSERT( pBlock );
+
+    const RadixSortEntry* pSource = pBlock->pSource;
+    size_t* pHistograms = pBlock->pHistograms;
+    for( size_t entryIndex = pBlock->startIndex; entryIndex < pBlock->endIndex; ++entryIndex )
+    {
+        uint64_t key = pSource[ entryIndex ].key;
+        for( size_t digitIndex = 0; digitIndex < RADIX_SORT_DIGIT_COUNT; ++digitIndex )
+        {
+            ++pHistograms[
+                digitIndex * RADIX_SORT_BUCKET_COUNT +
+                ( ( key >> ( digitIndex * RADIX_SORT_DIGIT_BITS ) ) & ( RADIX_SORT_BUCKET_COUNT - 1 ) ) ];
+        }
+    }
+}
+
+/// Regather the histogram of the digit sorted by the current pass for the entries now in a block.
+///
+/// @param[in] pData  RadixSortBlock to count.
+static void CountRadixSortBlockDigit( void* pData )
+{
+    RadixSortBlock* pBlock = static_cast< RadixSortBlock* >( pData );
+    HELIUM_ASSERT( pBlock );
+
+    const RadixSortEntry* pSource = pBlock->pSource;
+    size_t shift = pBlock->shift;
+    size_t* pHistogram = pBlock->pHistograms + ( shift / RADIX_SORT_DIGIT_BITS ) * RADIX_SORT_BUCKET_COUNT;
+    MemoryZero( pHistogram, RADIX_SORT_BUCKET_COUNT * sizeof( size_t ) );
+
+    for( size_t entryIndex = pBlock->startIndex; entryIndex < pBlock->endIndex; ++entryIndex )
+    {
+        ++pHistogram[ ( pSource[ entryIndex ].key >> shift ) & ( RADIX_SORT_BUCKET_COUNT - 1 ) ];
+    }
+}
+
+/// Scatter the entries in a block to their destination for the current pass.
+///
+/// @param[in] pData  RadixSortBlock to scatter.
+static void ScatterRadixSortBlock( void* pData )
+{
+    RadixSortBlock* pBlock = static_cast< RadixSortBlock* >( pData );
+    HELIUM_ASSERT( pBlock );
+
+    const RadixSortEntry* pSource = pBlock->pSource;
+    RadixSortEntry* pDestination = pBlock->pDestination;
+    size_t shift = pBlock->shift;
+    size_t* pOffsets = pBlock->pHistograms + ( shift / RADIX_SORT_DIGIT_BITS ) * RADIX_SORT_BUCKET_COUNT;
+    for( size_t entryIndex = pBlock->startIndex; entryIndex < pBlock->endIndex; ++entryIndex )
+    {
+        const RadixSortEntry& rEntry = pSource[ entryIndex ];
+        pDestination[ pOffsets[ ( rEntry.key >> shift ) & ( RADIX_SORT_BUCKET_COUNT - 1 ) ]++ ] = rEntry;
+    }
+}
+
+/// Run a callback for every block, spreading the blocks across the JobManager worker threads.
+///
+/// @param[in] pJobManager  Job manager to use (can be null if there is only one block).
+/// @param[in] rBlocks      Blocks to process.
+/// @param[in] pCallback    Callback to run for each block.
+static void RunRadixSortBlocks( JobManager* pJobManager, DynamicArray< RadixSortBlock >& rBlocks, JobFunc pCallback )
+{
+    size_t blockCount = rBlocks.GetSize();
+    if( blockCount == 1 )
+    {
+        pCallback( &rBlocks[ 0 ] );
+
+        return;
+    }
+
+    HELIUM_ASSERT( pJobManager );
+
+    JobCounter counter;
+    for( size_t blockIndex = 1; blockIndex < blockCount; ++blockIndex )
+    {
+        pJobManager->SpawnJob( pCallback, &rBlocks[ blockIndex ], &counter );
+    }
+
+    pCallback( &rBlocks[ 0 ] );
+    pJobManager->WaitForCounter( counter );
+}
+
+/// Sort an array of key/value pairs by key.
+///
+/// The histograms for every digit are gathered in a single pass over the keys, and digits whose value is the same for
+/// every key are skipped entirely, so keys that only use a few of their bits cost only as many passes as they need.
+/// Entries with equal keys keep their relative order.
+///
+/// Arrays of more than twice the single job count are split into contiguous blocks, one per thread, whose histograms
+/// are gathered and whose entries are scattered in parallel on the JobManager worker threads.  Each block writes to
+/// its own range of every bucket, so the sort remains stable.  Once the entries have been reordered, the blocks
+/// recount the digit of each further pass before scattering.
+void RadixSortJob::Run()
+{
+    size_t count = m_parameters.count;
+    if( count <= 1 )
+    {
+        return;
+    }
+
+    RadixSortEntry* pSource = m_parameters.pBase;
+    HELIUM_ASSERT( pSource );
+    RadixSortEntry* pDestination = m_parameters.pScratch;
+    HELIUM_ASSERT( pDestination );
+
+    size_t singleJobCount = Max< size_t >( m_parameters.singleJobCount, 1 );
+
+    JobManager* pJobManager = JobManager::GetInstance();
+    size_t blockCount = 1;
+    if( pJobManager && count > singleJobCount * 2 )
+    {
+        blockCount = Min< size_t >( pJobManager->GetWorkerThreadCount() + 1, count / singleJobCount );
+    }
+
+    const size_t histogramsSize = RADIX_SORT_DIGIT_COUNT * RADIX_SORT_BUCKET_COUNT;
+
+    DynamicArray< size_t > histograms;
+    histograms.Resize( blockCount * histogramsSize );
+    MemoryZero( histograms.GetData(), histograms.GetSize() * sizeof( size_t ) );
+
+    DynamicArray< RadixSortBlock > blocks;
+    blocks.Resize( blockCount );
+    for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+    {
+        RadixSortBlock& rBlock = blocks[ blockIndex ];
+        rBlock.startIndex = count * blockIndex / blockCount;
+        rBlock.endIndex = count * ( blockIndex + 1 ) / blockCount;
+        rBlock.pHistograms = histograms.GetData() + blockIndex * histogramsSize;
+        rBlock.pSource = pSource;
+        rBlock.pDestination = pDestination;
+        rBlock.shift = 0;
+    }
+
+    RunRadixSortBlocks( pJobManager, blocks, CountRadixSortBlockDigits );
+
+    bool bReordered = false;
+    for( size_t digitIndex = 0; digitIndex < RADIX_SORT_DIGIT_COUNT; ++digitIndex )
+    {
+        size_t shift = digitIndex * RADIX_SORT_DIGIT_BITS;
+        size_t histogramOffset = digitIndex * RADIX_SORT_BUCKET_COUNT;
+
+        // Passes over a digit shared by every key would not change the order.
+        size_t firstBucketIndex = static_cast< size_t >( ( pSource[ 0 ].key >> shift ) & ( RADIX_SORT_BUCKET_COUNT - 1 ) );
+        size_t firstBucketCount = 0;
+        for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+        {
+            firstBucketCount += blocks[ blockIndex ].pHistograms[ histogramOffset + firstBucketIndex ];
+        }
+
+        if( firstBucketCount == count )
+        {
+            continue;
+        }
+
+        for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+        {
+            RadixSortBlock& rBlock = blocks[ blockIndex ];
+            rBlock.pSource = pSource;
+            rBlock.pDestination = pDestination;
+            rBlock.shift = shift;
+        }
+
+        // Totals per bucket do not depend on the order of the entries, but each block's share of them does, so the
+        // block histograms are only valid for the first pass that reorders the entries.
+        if( blockCount > 1 && bReordered )
+        {
+            RunRadixSortBlocks( pJobManager, blocks, CountRadixSortBlockDigit );
+        }
+
+        // Each block's entries go after those of the earlier blocks within every bucket.
+        size_t offset = 0;
+        for( size_t bucketIndex = 0; bucketIndex < RADIX_SORT_BUCKET_COUNT; ++bucketIndex )
+        {
+            for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+            {
+                size_t& rBucket = blocks[ blockIndex ].pHistograms[ histogramOffset + bucketIndex ];
+                size_t bucketCount = rBucket;
+                rBucket = offset;
+                offset += bucketCount;
+            }
+        }
+
+        RunRadixSortBlocks( pJobManager, blocks, ScatterRadixSortBlock );
+
+        Swap( pSource, pDestination );
+        bReordered = true;
+    }
+
+    if( pSource != m_parameters.pBase )
+    {
+        MemoryCopy( m_parameters.pBase, pSource, count * sizeof( RadixSortEntry ) );
+    }
+}
@@ -66,11 +66,14 @@ namespace Helium
 
     /// Recursively sort an array of elements.
     ///
-    /// @param[in] pContext  Context in which this job is running.
+    /// Arrays larger than the single job count are partitioned on the calling thread, after which the lower partition
+    /// is handed to the JobManager worker pool while the upper partition is sorted in place, recursing in the same way
+    /// until partitions are small enough to be finished by a single job.  The sort falls back to a single-threaded
+    /// quicksort if no worker threads are available.
     template< typename T, typename CompareFunction >
     void SortJob< T, CompareFunction >::Run()
     {
-		size_t count = m_parameters.count;
+        size_t count = m_parameters.count;
         if( count <= 1 )
         {
             return;
@@ -80,7 +83,42 @@ namespace Helium
         HELIUM_ASSERT( pBase );
 
         CompareFunction& rCompare = m_parameters.compare;
-        
-		_Quicksort( pBase, count, rCompare );
+
+        // Partitioning requires at least three elements.
+        size_t singleJobCount = Max< size_t >( m_parameters.singleJobCount, 2 );
+
+        JobManager* pJobManager = JobManager::GetInstance();
+        if( count <= singleJobCount || !pJobManager || pJobManager->GetWorkerThreadCount() == 0 )
+        {
+            _Quicksort( pBase, count, rCompare );
+
+            return;
+        }
+
+        size_t pivotIndex = _Partition( pBase, count, rCompare );
+
+        SortJob lowerJob;
+        lowerJob.m_parameters = m_parameters;
+        lowerJob.m_parameters.count = pivotIndex;
+
+        SortJob upperJob;
+        upperJob.m_parameters = m_parameters;
+        upperJob.m_parameters.pBase = pBase + pivotIndex + 1;
+        upperJob.m_parameters.count = count - pivotIndex - 1;
+
+        JobCounter counter;
+        if( lowerJob.m_parameters.count > singleJobCount )
+        {
+            pJobManager->SpawnJob( RunCallback, &lowerJob, &counter );
+        }
+        else
+        {
+            lowerJob.Run();
+        }
+
+        upperJob.Run();
+
+        // Waiting runs other pending jobs, so child sorts spawned by the worker threads are never starved.
+        pJobManager->WaitForCounter( counter );
     }
 }
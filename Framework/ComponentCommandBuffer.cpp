@@ -0,0 +1,70 @@
+#include "FrameworkPch.h"
+#include "Framework/ComponentCommandBuffer.h"
+
+#include "Platform/Thread.h"
+
+using namespace Helium;
+
+// Command buffer of the parallel query callback running on each thread
+static ThreadLocalPointer g_CurrentComponentCommandBuffer;
+
+void ComponentCommandBuffer::Allocate( Components::TypeId type, Components::IHasComponents *pOwner, ComponentCollection &rCollection )
+{
+	Command *pCommand = m_Commands.New();
+	pCommand->m_Component.Reset();
+	pCommand->m_Owner = pOwner;
+	pCommand->m_Collection = &rCollection;
+	pCommand->m_TypeId = type;
+}
+
+void ComponentCommandBuffer::AllocateSibling( Components::TypeId type, Component *pSibling )
+{
+	HELIUM_ASSERT( pSibling );
+
+	ComponentCollection *pCollection = pSibling->GetComponentCollection();
+	HELIUM_ASSERT( pCollection );
+
+	Allocate( type, pSibling->GetOwner(), *pCollection );
+}
+
+void ComponentCommandBuffer::Free( Component *pComponent )
+{
+	HELIUM_ASSERT( pComponent );
+
+	Command *pCommand = m_Commands.New();
+	pCommand->m_Component = ComponentHandleBase( pComponent );
+	pCommand->m_Owner = NULL;
+	pCommand->m_Collection = NULL;
+	pCommand->m_TypeId = Invalid<Components::TypeId>();
+}
+
+void ComponentCommandBuffer::Execute( ComponentManager &rManager )
+{
+	for (DynamicArray<Command>::Iterator iter = m_Commands.Begin();
+		iter != m_Commands.End(); ++iter)
+	{
+		if ( iter->m_Collection )
+		{
+			rManager.Allocate( iter->m_TypeId, iter->m_Owner, *iter->m_Collection );
+			continue;
+		}
+
+		// Skip components that were already freed (by an earlier command, for instance)
+		if ( Component *pComponent = iter->m_Component.Resolve() )
+		{
+			pComponent->FreeComponent();
+		}
+	}
+
+	Clear();
+}
+
+ComponentCommandBuffer* ComponentCommandBuffer::GetCurrent()
+{
+	return static_cast<ComponentCommandBuffer *>( g_CurrentComponentCommandBuffer.GetPointer() );
+}
+
+void ComponentCommandBuffer::SetCurrent( ComponentCommandBuffer *pBuffer )
+{
+	g_CurrentComponentCommandBuffer.SetPointer( pBuffer );
+}
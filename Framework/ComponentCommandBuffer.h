@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Framework/Framework.h"
+#include "Framework/Components.h"
+
+namespace Helium
+{
+	//! Records structural changes to components (allocating and freeing) so they can be applied later from a single
+	//! thread. Callbacks run by ParallelQueryComponents must not allocate or free components directly; they record the
+	//! change in ComponentCommandBuffer::GetCurrent() instead, and it is applied once every callback has returned.
+	//! Entity::DeferredDestroy() only sets a flag on the entity, so it is already safe to call from those callbacks.
+	class HELIUM_FRAMEWORK_API ComponentCommandBuffer
+	{
+	public:
+		void                     Allocate( Components::TypeId type, Components::IHasComponents *pOwner, ComponentCollection &rCollection );
+		void                     AllocateSibling( Components::TypeId type, Component *pSibling );
+		void                     Free( Component *pComponent );
+
+		template <class T> void  Allocate( Components::IHasComponents *pOwner, ComponentCollection &rCollection );
+		template <class T> void  AllocateSibling( Component *pSibling );
+
+		void                     Execute( ComponentManager &rManager );
+		inline bool              IsEmpty() const;
+		inline void              Clear();
+
+		static ComponentCommandBuffer* GetCurrent();
+		static void                    SetCurrent( ComponentCommandBuffer *pBuffer );
+
+	private:
+		struct Command
+		{
+			ComponentHandleBase          m_Component;   //< Component to free, or an empty handle to allocate
+			Components::IHasComponents*  m_Owner;
+			ComponentCollection*         m_Collection;
+			Components::TypeId           m_TypeId;
+		};
+
+		DynamicArray<Command> m_Commands;
+	};
+}
+
+#include "Framework/ComponentCommandBuffer.inl"
@@ -0,0 +1,24 @@
+namespace Helium
+{
+	template <class T>
+	void ComponentCommandBuffer::Allocate( Components::IHasComponents *pOwner, ComponentCollection &rCollection )
+	{
+		Allocate( Components::GetType<T>(), pOwner, rCollection );
+	}
+
+	template <class T>
+	void ComponentCommandBuffer::AllocateSibling( Component *pSibling )
+	{
+		AllocateSibling( Components::GetType<T>(), pSibling );
+	}
+
+	bool ComponentCommandBuffer::IsEmpty() const
+	{
+		return m_Commands.IsEmpty();
+	}
+
+	void ComponentCommandBuffer::Clear()
+	{
+		m_Commands.Resize( 0 );
+	}
+}
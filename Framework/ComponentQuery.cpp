@@ -1,103 +1,338 @@
 
 #include "FrameworkPch.h"
 #include "Framework/ComponentQuery.h"
-#include <limits>
-#include <vector>
+#include "Framework/ComponentCommandBuffer.h"
+#include "Engine/JobManager.h"
 
 using namespace Helium;
 
-struct FoundComponentList
+void Helium::QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback emit_tuple_callback)
 {
-	Component *m_Component;
-	size_t m_TypeIndex;
-	size_t m_Count;
-	Components::TypeId m_TypeId;
-};
+	// If no types to query, do nothing
+	if (!typesCount)
+	{
+		return;
+	}
+
+	// Use the manager's cached query for this type list, creating it on first use
+	rManager.GetCachedQuery( types, typesCount )->ForEach( emit_tuple_callback );
+}
 
-bool SortFoundComponentList(const FoundComponentList &lhs, const FoundComponentList &rhs)
+// Adapts a callback without context to the context callback signature. The context is the callback itself.
+void CallTupleCallback(DynamicArray<Component *> &tuple, void *pContext)
 {
-	return lhs.m_Count < rhs.m_Count;
+	(*static_cast<const ComponentTupleCallback *>(pContext))(tuple);
 }
 
-void EmitTuples(DynamicArray<Component *> &tuple, std::vector<FoundComponentList> &found_components, size_t type_index, ComponentTupleCallback emit_tuple_callback)
+void EmitExpandedTuples(
+	DynamicArray<Component *> &tuple, 
+	ComponentCollection &collection, 
+	const Components::TypeId *types, 
+	size_t type_index, 
+	ComponentTupleContextCallback emit_tuple_callback,
+	void *pContext)
 {
-	Component *c = found_components[ type_index ].m_Component;
-	HELIUM_ASSERT( c );
-	do
+	// Every component implementing the queried type
+	const DynamicArray< Components::TypeId > &implementing_types = Components::GetTypeData( types[type_index] )->m_ImplementingTypes;
+	for (DynamicArray< Components::TypeId >::ConstIterator iter = implementing_types.Begin();
+		iter != implementing_types.End(); ++iter)
 	{
-		tuple[found_components[type_index].m_TypeIndex] = c;
-		
-		if (type_index < found_components.size() - 1)
+		for (Component *c = collection.GetFirst( *iter ); c; c = Components::Pool::GetPool( c )->GetNext( c ))
 		{
-			EmitTuples(tuple, found_components, ++type_index, emit_tuple_callback);
+			tuple[type_index] = c;
+
+			if (type_index < tuple.GetSize() - 1)
+			{
+				EmitExpandedTuples(tuple, collection, types, type_index + 1, emit_tuple_callback, pContext);
+			}
+			else
+			{
+				emit_tuple_callback(tuple, pContext);
+			}
 		}
-		else
+	}
+}
+
+ComponentQuery::ComponentQuery( ComponentManager &rManager, const Components::TypeId *types, size_t typesCount )
+	: m_Manager( rManager )
+	, m_RemovedCount( 0 )
+{
+	HELIUM_ASSERT( typesCount );
+
+	m_Types.Reserve( typesCount );
+	for (size_t type_index = 0; type_index < typesCount; ++type_index)
+	{
+		m_Types.Push( types[type_index] );
+	}
+
+	// Registering also seeds the query with the collections that already match
+	m_Manager.RegisterQuery( *this );
+}
+
+ComponentQuery::~ComponentQuery()
+{
+	m_Manager.UnregisterQuery( *this );
+}
+
+void ComponentQuery::ForEach( ComponentTupleCallback emit_tuple_callback ) const
+{
+	size_t typesCount = m_Types.GetSize();
+
+	DynamicArray<Component *> tuple;
+	tuple.Resize(typesCount);
+
+	// Callbacks may allocate and free components on any collection, which moves rows around. Walk a snapshot of the
+	// matching collections instead, so each is visited once, collections that stop matching are skipped, and
+	// collections that start matching are left for the next iteration. Until a row is removed, rows stay in place.
+	DynamicArray<ComponentCollection *> collections( m_Collections );
+	uint32_t removed_count = m_RemovedCount;
+
+	for (size_t index = 0; index < collections.GetSize(); ++index)
+	{
+		size_t row = index;
+		if (removed_count != m_RemovedCount)
 		{
-			emit_tuple_callback(tuple);
+			HashMap<ComponentCollection *, uint32_t>::ConstIterator lookup_iter = m_RowLookup.Find( collections[index] );
+			if (lookup_iter == m_RowLookup.End())
+			{
+				continue;
+			}
+
+			row = lookup_iter->Second();
+		}
+
+		if (m_Expanded[row])
+		{
+			EmitExpandedTuples(tuple, *m_Collections[row], m_Types.GetData(), 0, CallTupleCallback, &emit_tuple_callback);
+			continue;
 		}
-	} 
-	while ( ( c = c->GetNextComponent() ) );
+
+		Component * const *pMatch = GetMatch( row );
+		for (size_t type_index = 0; type_index < typesCount; ++type_index)
+		{
+			tuple[type_index] = pMatch[type_index];
+		}
+
+		emit_tuple_callback(tuple);
+	}
 }
 
-void Helium::QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback emit_tuple_callback)
+void ComponentQuery::ForEachInRange( size_t startIndex, size_t endIndex, ComponentTupleContextCallback emit_tuple_callback, void *pContext ) const
 {
-	// If no types to query, do nothing
-	if (!typesCount)
+	HELIUM_ASSERT( startIndex <= endIndex && endIndex <= GetMatchCount() );
+	size_t typesCount = m_Types.GetSize();
+
+	DynamicArray<Component *> tuple;
+	tuple.Resize(typesCount);
+
+	// Rows must not change while a range is being walked, so walk it front to back
+	for (size_t row = startIndex; row < endIndex; ++row)
 	{
-		return;
-	}
-	
-	// Prepare the structure that will help us emit all permutations of found components
-	std::vector<FoundComponentList> found_components;
-	found_components.resize(typesCount);
-	
-	// Find the component with the least instances
-	for (size_t index = 0; index < typesCount; ++index)
-	{
-		found_components[index].m_TypeIndex = index;
-		found_components[index].m_TypeId = types[index];
-		found_components[index].m_Count = rManager.CountAllocatedComponentsThatImplement(types[index]);
-		
-		// Bail if any component type doesn't exist
-		if (!found_components[index].m_Count)
+		if (m_Expanded[row])
 		{
-			return;
+			EmitExpandedTuples(tuple, *m_Collections[row], m_Types.GetData(), 0, emit_tuple_callback, pContext);
+			continue;
 		}
+
+		Component * const *pMatch = GetMatch( row );
+		for (size_t type_index = 0; type_index < typesCount; ++type_index)
+		{
+			tuple[type_index] = pMatch[type_index];
+		}
+
+		emit_tuple_callback(tuple, pContext);
 	}
+}
+
+void ComponentQuery::UpdateCollection( ComponentCollection &rCollection )
+{
+	size_t typesCount = m_Types.GetSize();
+
+	HashMap<ComponentCollection *, uint32_t>::Iterator lookup_iter = m_RowLookup.Find( &rCollection );
+	bool was_matched = ( lookup_iter != m_RowLookup.End() );
 
-	// Sort the types by commonality
-	std::sort(found_components.begin(), found_components.end(), SortFoundComponentList);
-	
-	const DynamicArray< Components::TypeId > &implementing_types = Components::GetTypeData( found_components[0].m_TypeId )->m_ImplementingTypes;
-	
-	// For every component
-	for ( ComponentIteratorBase iterator(rManager, implementing_types); iterator.GetBaseComponent(); iterator.Advance() )
+	// Find the first component of each queried type, and whether any type has more than one
+	size_t row = was_matched ? lookup_iter->Second() : GetMatchCount();
+	if (!was_matched)
 	{
-		Component *outer_component = iterator.GetBaseComponent();
+		m_Matches.Resize( ( row + 1 ) * typesCount );
+	}
 
-		found_components[0].m_Component = outer_component;
+	Component **pMatch = m_Matches.GetData() + row * typesCount;
+	bool expanded = false;
+	bool matches = true;
+	for (size_t type_index = 0; type_index < typesCount && matches; ++type_index)
+	{
+		pMatch[type_index] = NULL;
 
-		ComponentCollection *collection = outer_component->GetComponentCollection();
-		HELIUM_ASSERT(collection);
-		
-		// Walk the other types we need components of
-		bool emit_tuples = true;
-		for (size_t type_index = 1; type_index < found_components.size(); ++type_index)
+		const DynamicArray< Components::TypeId > &implementing_types = Components::GetTypeData( m_Types[type_index] )->m_ImplementingTypes;
+		for (DynamicArray< Components::TypeId >::ConstIterator iter = implementing_types.Begin();
+			iter != implementing_types.End(); ++iter)
 		{
-			found_components[type_index].m_Component = collection->GetFirst( found_components[type_index].m_TypeId );
-			if ( !found_components[type_index].m_Component )
+			Component *pComponent = rCollection.GetFirst( *iter );
+			if (!pComponent)
+			{
+				continue;
+			}
+
+			if (pMatch[type_index] || IsValid<Components::ComponentIndex>( pComponent->GetInlineData().m_Next ))
+			{
+				expanded = true;
+			}
+
+			if (!pMatch[type_index])
 			{
-				emit_tuples = false;
-				break;
+				pMatch[type_index] = pComponent;
 			}
 		}
-		
-		if (emit_tuples)
+
+		matches = ( pMatch[type_index] != NULL );
+	}
+
+	if (matches)
+	{
+		if (!was_matched)
+		{
+			m_Collections.Push( &rCollection );
+			m_Expanded.Push( expanded );
+			m_RowLookup.Insert( lookup_iter, HashMap<ComponentCollection *, uint32_t>::ValueType( &rCollection, static_cast<uint32_t>( row ) ) );
+		}
+		else
+		{
+			m_Expanded[row] = expanded;
+		}
+	}
+	else if (was_matched)
+	{
+		RemoveMatch( row );
+	}
+	else
+	{
+		m_Matches.Resize( row * typesCount );
+	}
+}
+
+void ComponentQuery::RemoveMatch( size_t index )
+{
+	size_t typesCount = m_Types.GetSize();
+	size_t last_index = GetMatchCount() - 1;
+
+	m_RowLookup.Remove( m_Collections[index] );
+
+	// Keep rows packed by moving the last row into the hole
+	if (index != last_index)
+	{
+		for (size_t type_index = 0; type_index < typesCount; ++type_index)
+		{
+			m_Matches[index * typesCount + type_index] = m_Matches[last_index * typesCount + type_index];
+		}
+
+		m_Collections[index] = m_Collections[last_index];
+		m_Expanded[index] = m_Expanded[last_index];
+
+		HashMap<ComponentCollection *, uint32_t>::Iterator lookup_iter = m_RowLookup.Find( m_Collections[index] );
+		HELIUM_ASSERT( lookup_iter != m_RowLookup.End() );
+		lookup_iter->Second() = static_cast<uint32_t>( index );
+	}
+
+	m_Matches.Resize( last_index * typesCount );
+	m_Collections.Pop();
+	m_Expanded.Pop();
+
+	++m_RemovedCount;
+}
+
+// Matches are handed out to jobs in multiples of this many rows, so each job's rows start on a fresh cache line
+static const size_t PARALLEL_QUERY_ROW_GRANULARITY = 8;
+// Fewest matches a job is given, below which the dispatch overhead outweighs the work
+static const size_t PARALLEL_QUERY_MIN_ROWS_PER_JOB = 64;
+
+struct ParallelQueryJob
+{
+	const ComponentQuery*          m_pQuery;
+	size_t                         m_StartIndex;
+	size_t                         m_EndIndex;
+	ComponentTupleContextCallback  m_Callback;
+	void*                          m_pContext;
+	ComponentCommandBuffer         m_Commands;
+};
+
+static void RunParallelQueryJob( ParallelQueryJob &rJob )
+{
+	// Jobs may run while this thread waits on another query's jobs, so restore whichever buffer was current
+	ComponentCommandBuffer *pPreviousCommands = ComponentCommandBuffer::GetCurrent();
+	ComponentCommandBuffer::SetCurrent( &rJob.m_Commands );
+
+	rJob.m_pQuery->ForEachInRange( rJob.m_StartIndex, rJob.m_EndIndex, rJob.m_Callback, rJob.m_pContext );
+
+	ComponentCommandBuffer::SetCurrent( pPreviousCommands );
+}
+
+static void ParallelQueryJobFunc( void *pData )
+{
+	RunParallelQueryJob( *static_cast<ParallelQueryJob *>( pData ) );
+}
+
+void Helium::ParallelQueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleContextCallback emit_tuple_callback, void *pContext)
+{
+	if (!typesCount)
+	{
+		return;
+	}
+
+	const ComponentQuery *pQuery = rManager.GetCachedQuery( types, typesCount );
+	size_t matchCount = pQuery->GetMatchCount();
+	if (!matchCount)
+	{
+		return;
+	}
+
+	// Split into about four ranges per thread so that stealing can even out uneven callbacks
+	JobManager *pJobManager = JobManager::GetInstance();
+	size_t threadCount = pJobManager ? pJobManager->GetWorkerThreadCount() + 1 : 1;
+	size_t rowsPerJob = ( matchCount + threadCount * 4 - 1 ) / ( threadCount * 4 );
+	rowsPerJob = Max( rowsPerJob, PARALLEL_QUERY_MIN_ROWS_PER_JOB );
+	rowsPerJob = ( rowsPerJob + PARALLEL_QUERY_ROW_GRANULARITY - 1 ) & ~( PARALLEL_QUERY_ROW_GRANULARITY - 1 );
+	size_t jobCount = ( matchCount + rowsPerJob - 1 ) / rowsPerJob;
+
+	DynamicArray<ParallelQueryJob> jobs;
+	jobs.Resize( jobCount );
+	for (size_t job_index = 0; job_index < jobCount; ++job_index)
+	{
+		ParallelQueryJob &rJob = jobs[job_index];
+		rJob.m_pQuery = pQuery;
+		rJob.m_StartIndex = job_index * rowsPerJob;
+		rJob.m_EndIndex = Min( rJob.m_StartIndex + rowsPerJob, matchCount );
+		rJob.m_Callback = emit_tuple_callback;
+		rJob.m_pContext = pContext;
+	}
+
+	rManager.BeginParallelQuery();
+
+	if (jobCount == 1 || threadCount == 1)
+	{
+		for (size_t job_index = 0; job_index < jobCount; ++job_index)
+		{
+			RunParallelQueryJob( jobs[job_index] );
+		}
+	}
+	else
+	{
+		JobCounter counter;
+		for (size_t job_index = 1; job_index < jobCount; ++job_index)
 		{
-			DynamicArray<Component *> tuple;
-			tuple.Resize(typesCount);
-			tuple[found_components[0].m_TypeIndex] = outer_component;
-			EmitTuples(tuple, found_components, 1, emit_tuple_callback);
+			pJobManager->SpawnJob( ParallelQueryJobFunc, &jobs[job_index], &counter );
 		}
+
+		RunParallelQueryJob( jobs[0] );
+		pJobManager->WaitForCounter( counter );
+	}
+
+	rManager.EndParallelQuery();
+
+	// Sync point: apply structural changes in job order so the result does not depend on scheduling
+	for (size_t job_index = 0; job_index < jobCount; ++job_index)
+	{
+		jobs[job_index].m_Commands.Execute( rManager );
 	}
 }
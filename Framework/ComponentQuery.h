@@ -3,13 +3,53 @@
 
 #include "Framework/Framework.h"
 #include "Foundation/DynamicArray.h"
+#include "Foundation/HashMap.h"
 #include "Framework/Components.h"
 
 namespace Helium
 {
 	typedef void (*ComponentTupleCallback)(DynamicArray<Component *> &tuple);
+	typedef void (*ComponentTupleContextCallback)(DynamicArray<Component *> &tuple, void *pContext);
 	
 	void HELIUM_FRAMEWORK_API QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback callback);
+
+	// Runs the callback for every match on the job manager's workers. Callbacks must not allocate or free components
+	// directly; they record those changes in ComponentCommandBuffer::GetCurrent(), which are applied before returning.
+	void HELIUM_FRAMEWORK_API ParallelQueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleContextCallback callback, void *pContext);
+
+	//! Persistent query for every component collection holding all of a set of component types (or types implementing
+	//! them). The query registers with its ComponentManager and is updated as components are allocated and freed, so
+	//! iterating it walks a packed array of matches without searching pools or allocating.
+	class HELIUM_FRAMEWORK_API ComponentQuery
+	{
+	public:
+		ComponentQuery( ComponentManager &rManager, const Components::TypeId *types, size_t typesCount );
+		~ComponentQuery();
+
+		inline size_t                     GetTypeCount() const;
+		inline const Components::TypeId*  GetTypes() const;
+		inline bool                       HasTypes( const Components::TypeId *types, size_t typesCount ) const;
+
+		inline size_t                     GetMatchCount() const;
+		inline Component * const *        GetMatch( size_t index ) const;
+		inline bool                       IsMatchExpanded( size_t index ) const;
+		inline ComponentCollection*       GetMatchCollection( size_t index ) const;
+
+		void                              ForEach( ComponentTupleCallback callback ) const;
+		void                              ForEachInRange( size_t startIndex, size_t endIndex, ComponentTupleContextCallback callback, void *pContext ) const;
+		void                              UpdateCollection( ComponentCollection &rCollection );
+
+	private:
+		void                              RemoveMatch( size_t index );
+
+		ComponentManager&                          m_Manager;
+		DynamicArray<Components::TypeId>           m_Types;
+		DynamicArray<Component *>                  m_Matches;      //< Packed rows holding the first component of each queried type
+		DynamicArray<ComponentCollection *>        m_Collections;  //< Collection owning each row
+		DynamicArray<bool>                         m_Expanded;     //< Rows with several components of a queried type, which emit every combination
+		HashMap<ComponentCollection *, uint32_t>   m_RowLookup;
+		uint32_t                                   m_RemovedCount; //< Rows removed so far, so ForEach can tell when rows have moved
+	};
 	
 	template <class A, class B, void (*F)(A *, B *)>
 	void TupleHandler(DynamicArray<Component *> &components)
@@ -27,4 +67,39 @@ namespace Helium
 			static_cast<B *>(components[1]), 
 			static_cast<C *>(components[2]));
 	}
+
+	template <class A, void (*F)(A *)>
+	void ParallelTupleHandler(DynamicArray<Component *> &components, void *pContext)
+	{
+		F(
+			static_cast<A *>(components[0]));
+	}
+
+	template <class A, class B, void (*F)(A *, B *)>
+	void ParallelTupleHandler(DynamicArray<Component *> &components, void *pContext)
+	{
+		F(
+			static_cast<A *>(components[0]), 
+			static_cast<B *>(components[1]));
+	}
+	
+	template <class A, class B, class C, void (*F)(A *, B *, C *)>
+	void ParallelTupleHandler(DynamicArray<Component *> &components, void *pContext)
+	{
+		F(
+			static_cast<A *>(components[0]), 
+			static_cast<B *>(components[1]), 
+			static_cast<C *>(components[2]));
+	}
+
+	template <class T, class A, class B, void (*F)(const T &, A *, B *)>
+	void ContextTupleHandler(DynamicArray<Component *> &components, void *pContext)
+	{
+		F(
+			*static_cast<const T *>(pContext),
+			static_cast<A *>(components[0]), 
+			static_cast<B *>(components[1]));
+	}
 }
+
+#include "Framework/ComponentQuery.inl"
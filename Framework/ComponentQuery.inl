@@ -0,0 +1,51 @@
+namespace Helium
+{
+	size_t ComponentQuery::GetTypeCount() const
+	{
+		return m_Types.GetSize();
+	}
+
+	const Components::TypeId* ComponentQuery::GetTypes() const
+	{
+		return m_Types.GetData();
+	}
+
+	bool ComponentQuery::HasTypes( const Components::TypeId *types, size_t typesCount ) const
+	{
+		if ( typesCount != m_Types.GetSize() )
+		{
+			return false;
+		}
+
+		for ( size_t i = 0; i < typesCount; ++i )
+		{
+			if ( types[ i ] != m_Types[ i ] )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	size_t ComponentQuery::GetMatchCount() const
+	{
+		return m_Collections.GetSize();
+	}
+
+	Component * const * ComponentQuery::GetMatch( size_t index ) const
+	{
+		HELIUM_ASSERT( index < GetMatchCount() );
+		return m_Matches.GetData() + index * m_Types.GetSize();
+	}
+
+	bool ComponentQuery::IsMatchExpanded( size_t index ) const
+	{
+		return m_Expanded[ index ];
+	}
+
+	ComponentCollection* ComponentQuery::GetMatchCollection( size_t index ) const
+	{
+		return m_Collections[ index ];
+	}
+}
@@ -1,9 +1,12 @@
 
 #include "FrameworkPch.h"
 #include "Framework/Components.h"
+#include "Framework/ComponentQuery.h"
 #include "Framework/SystemDefinition.h"
 
 #include "Foundation/Numeric.h"
+#include "Platform/Exception.h"
+#include "Platform/Locks.h"
 #include "Reflect/TranslatorDeduction.h"
 #include "Engine/Asset.h"
 
@@ -23,8 +26,9 @@ Helium::DynamicMemoryHeap      Components::g_ComponentAllocator;
 int32_t                    g_ComponentsInitCount = 0;
 int32_t                    g_ComponentManagerInstanceCount = 0;
 DynamicArray<TypeData *>   g_ComponentTypes;
-ComponentPtrBase*          g_ComponentPtrRegistry[COMPONENT_PTR_CHECK_FREQUENCY];
-uint16_t                   g_ComponentProcessPendingDeletesCallCount = 0;
+Pool*                      Components::g_ComponentPoolTable[MAX_COMPONENT_POOL_COUNT];
+Mutex                      g_ComponentPoolTableLock; // Worlds may be created and destroyed on different threads
+uint32_t                   g_ComponentPoolCreationCount = 0;
 
 ComponentRegistrar<Helium::Component, void> Helium::Component::s_ComponentRegistrar("Helium::Component");
 
@@ -180,6 +184,40 @@ Pool* Pool::CreatePool( ComponentManager *pComponentManager, const TypeData &rTy
 	pool->m_ComponentSize = componentSize;
 	pool->m_FirstUnallocatedIndex = 0;
 	pool->m_ComponentOffset = rTypeData.GetOffsetOfComponent();
+	pool->m_PoolId = Invalid<uint16_t>();
+
+	// Start each pool's generations at a different value so that handles into a destroyed pool are unlikely to match
+	// a new pool that reuses its id
+	GenerationIndex first_generation;
+	{
+		MutexScopeLock scopeLock( g_ComponentPoolTableLock );
+
+		for (uint16_t pool_id = 0; pool_id < MAX_COMPONENT_POOL_COUNT; ++pool_id)
+		{
+			if (!g_ComponentPoolTable[pool_id])
+			{
+				g_ComponentPoolTable[pool_id] = pool;
+				pool->m_PoolId = pool_id;
+				break;
+			}
+		}
+
+		first_generation = ++g_ComponentPoolCreationCount << 16;
+	}
+
+	// Handles to components of a pool without an id could never resolve, so running out of ids is fatal even in
+	// release builds
+	if ( pool->m_PoolId == Invalid<uint16_t>() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Components::Pool::CreatePool - More than %d component pools exist at once (creating pool for type %s)\n" ),
+			MAX_COMPONENT_POOL_COUNT,
+			rTypeData.m_Structure->m_Name );
+
+		DestroyPool( pool );
+		throw Exception( TXT( "More than %d component pools exist at once" ), MAX_COMPONENT_POOL_COUNT );
+	}
 		
 	pool->m_Roster.Resize( count );
 
@@ -197,9 +235,9 @@ Pool* Pool::CreatePool( ComponentManager *pComponentManager, const TypeData &rTy
 		component->m_InlineData.m_Next = Invalid<ComponentIndex>();
 		component->m_InlineData.m_Previous = Invalid<ComponentIndex>();
 		component->m_InlineData.m_Delete = false;
-		component->m_InlineData.m_Generation = 0;
 		pool->m_ParallelData[i].m_Collection = NULL;
 		pool->m_ParallelData[i].m_RosterIndex = i;
+		pool->m_ParallelData[i].m_Generation = first_generation;
 
 		HELIUM_ASSERT( Pool::GetPool( component ) == pool );
 		HELIUM_ASSERT( Pool::GetPool( component )->GetComponentIndex( component ) == i );
@@ -226,6 +264,13 @@ void Pool::DestroyPool( Pool *pPool )
 			pPool->m_Type->m_Structure->m_Name);
 	}
 
+	if (pPool->m_PoolId != Invalid<uint16_t>())
+	{
+		MutexScopeLock scopeLock( g_ComponentPoolTableLock );
+		HELIUM_ASSERT( g_ComponentPoolTable[pPool->m_PoolId] == pPool );
+		g_ComponentPoolTable[pPool->m_PoolId] = NULL;
+	}
+
 	HELIUM_DELETE_A( g_ComponentAllocator, pPool->m_ParallelData );
 	pPool->~Pool();
 	g_ComponentAllocator.FreeAligned( pPool );
@@ -264,6 +309,7 @@ void Pool::RemoveFromChain(Component *_component, ComponentIndex index)
 		return;
 	}
 
+	ComponentCollection *pCollection = m_ParallelData[ index ].m_Collection;
 	ComponentIndex previous_index = GetPreviousIndex( index );
 
 	Component *pNextComponent = GetComponent( _component->m_InlineData.m_Next );
@@ -294,11 +340,14 @@ void Pool::RemoveFromChain(Component *_component, ComponentIndex index)
 	_component->m_InlineData.m_Next = Invalid<uint16_t>();
 	//m_ParallelData[ index ].m_Previous = Invalid<uint16_t>();
 	_component->m_InlineData.m_Previous = Invalid<uint16_t>();
+
+	m_ComponentManager->UpdateQueries( *pCollection, m_TypeId );
 }
 
 Component* Pool::Allocate( IHasComponents *owner, ComponentCollection &collection )
 {
 	// Null owner is allowed
+	HELIUM_ASSERT_MSG( !m_ComponentManager->IsParallelQueryActive(), TXT( "Components must be allocated through ComponentCommandBuffer::GetCurrent() during a parallel query" ) );
 
 	// Do we have a free component to allocate?
 	if (m_FirstUnallocatedIndex >= m_Roster.GetSize())
@@ -337,11 +386,14 @@ Component* Pool::Allocate( IHasComponents *owner, ComponentCollection &collectio
 	m_Type->Construct( component );
 	HELIUM_ASSERT( component->m_InlineData.m_OffsetToPoolStart);
 
+	m_ComponentManager->UpdateQueries( collection, m_TypeId );
+
 	return component;
 }
 
 void Pool::Free( Component *component )
 {
+	HELIUM_ASSERT_MSG( !m_ComponentManager->IsParallelQueryActive(), TXT( "Components must be freed through ComponentCommandBuffer::GetCurrent() during a parallel query" ) );
 	ComponentIndex index = GetComponentIndex( component );
 	
 	// Component is already freed or component doesn't have a good handle for some reason
@@ -351,7 +403,7 @@ void Pool::Free( Component *component )
 	RemoveFromChain( component, index );
 	
 	// Increment generation to invalidate old handles
-	++component->m_InlineData.m_Generation;
+	++m_ParallelData[ index ].m_Generation;
 	component->m_InlineData.m_Delete = false;
 	component->m_InlineData.m_Owner = NULL;
 
@@ -410,7 +462,10 @@ void Helium::Components::Pool::SpewRosterToTty()
 
 Helium::ComponentManager::ComponentManager(World *pWorld)
 	: m_World(pWorld)
+	, m_ParallelQueryCount(0)
 {
+	m_QueriesByType.Resize( g_ComponentTypes.GetSize() );
+
 	for (DynamicArray<TypeData *>::Iterator iter = g_ComponentTypes.Begin();
 		iter != g_ComponentTypes.End(); ++iter)
 	{
@@ -422,7 +477,13 @@ Helium::ComponentManager::ComponentManager(World *pWorld)
 
 Helium::ComponentManager::~ComponentManager()
 {
-	Tick(); // Process pending deletes if necessary
+	for (DynamicArray<ComponentQuery *>::Iterator iter = m_CachedQueries.Begin();
+		iter != m_CachedQueries.End(); ++iter)
+	{
+		delete *iter;
+	}
+
+	m_CachedQueries.Clear();
 
 	for (DynamicArray<Pool *>::Iterator iter = m_Pools.Begin();
 		iter != m_Pools.End(); ++iter)
@@ -445,102 +506,108 @@ Helium::ComponentManager::~ComponentManager()
 	m_Pools.Clear();
 }
 
-void Helium::Components::Tick()
+void Helium::ComponentManager::RegisterQuery( ComponentQuery &rQuery )
 {
-	++g_ComponentProcessPendingDeletesCallCount;
+	MutexScopeLock scopeLock( m_QueryRegistrationLock );
 
-	// Look at our registry of component ptrs, we may need to force some of them to invalidate (a ptr must be checked
-	// at least once every 256 frames in case the generation counter overlaps)
-	uint32_t registry_index = g_ComponentProcessPendingDeletesCallCount % COMPONENT_PTR_CHECK_FREQUENCY;
-	ComponentPtrBase *component_ptr = g_ComponentPtrRegistry[registry_index];
-
-	// Double-check that the component head index is set
-	HELIUM_ASSERT(!component_ptr || component_ptr->m_ComponentPtrRegistryHeadIndex == registry_index);
+	for (size_t i = 0; i < rQuery.GetTypeCount(); ++i)
+	{
+		const DynamicArray<TypeId> &implementing_types = GetTypeData( rQuery.GetTypes()[ i ] )->m_ImplementingTypes;
+		for (DynamicArray<TypeId>::ConstIterator iter = implementing_types.Begin();
+			iter != implementing_types.End(); ++iter)
+		{
+			// A query naming the same type twice only needs to hear about it once
+			DynamicArray<ComponentQuery *> &rQueries = m_QueriesByType[ *iter ];
+			if ( rQueries.IsEmpty() || rQueries.GetLast() != &rQuery )
+			{
+				rQueries.Push( &rQuery );
+			}
+		}
+	}
 
-	while (component_ptr)
+	// Seed with the collections that already match while still holding the lock, so that no change is missed or
+	// applied concurrently. Any match holds a component implementing the first type.
+	const DynamicArray<TypeId> &implementing_types = GetTypeData( rQuery.GetTypes()[ 0 ] )->m_ImplementingTypes;
+	for (DynamicArray<TypeId>::ConstIterator iter = implementing_types.Begin();
+		iter != implementing_types.End(); ++iter)
 	{
-		// Don't do the check until we get our next pointer, as a failed check will splice out the ptr from our doubly
-		// linked list.
-		ComponentPtrBase *component_ptr_to_check = component_ptr;
-		component_ptr = component_ptr->GetNextComponetPtr();
-		component_ptr_to_check->Check();
+		const Pool *pPool = GetPool( *iter );
+		if ( !pPool )
+		{
+			continue;
+		}
+
+		for (ComponentIndex i = 0; i < pPool->GetAllocatedCount(); ++i)
+		{
+			ComponentCollection *pCollection = pPool->GetComponentCollection( pPool->GetComponentByRosterIndex( i ) );
+			HELIUM_ASSERT( pCollection );
+			rQuery.UpdateCollection( *pCollection );
+		}
 	}
-	
-	// Even after we evict components, we still need to verify that we either have no component or the head component
-	// has a properly set index
-	HELIUM_ASSERT(
-		!g_ComponentPtrRegistry[registry_index] || 
-		g_ComponentPtrRegistry[registry_index]->m_ComponentPtrRegistryHeadIndex == registry_index);
 }
 
-void Helium::ComponentManager::RegisterComponentPtr( ComponentPtrBase &pPtr )
+void Helium::ComponentManager::UnregisterQuery( ComponentQuery &rQuery )
 {
-	uint16_t registry_index = g_ComponentProcessPendingDeletesCallCount % COMPONENT_PTR_CHECK_FREQUENCY;
-	pPtr.m_Next = g_ComponentPtrRegistry[registry_index];
-	
-	if (pPtr.m_Next)
+	MutexScopeLock scopeLock( m_QueryRegistrationLock );
+
+	for (DynamicArray< DynamicArray<ComponentQuery *> >::Iterator typeIter = m_QueriesByType.Begin();
+		typeIter != m_QueriesByType.End(); ++typeIter)
 	{
-		// Make the current head component's previous pointer point to the new component, and clear the head component index
-		HELIUM_ASSERT(pPtr.m_Next->m_ComponentPtrRegistryHeadIndex == registry_index);
-		pPtr.m_Next->m_Previous = &pPtr;
-		pPtr.m_Next->m_ComponentPtrRegistryHeadIndex = Helium::Invalid<uint16_t>();
+		for (size_t i = 0; i < typeIter->GetSize(); ++i)
+		{
+			if ( typeIter->GetElement( i ) == &rQuery )
+			{
+				typeIter->Remove( i );
+				break;
+			}
+		}
 	}
-
-	pPtr.m_ComponentPtrRegistryHeadIndex = registry_index;
-	g_ComponentPtrRegistry[registry_index] = &pPtr;
 }
 
-size_t Helium::ComponentManager::CountAllocatedComponentsThatImplement( Components::TypeId typeId ) const
+ComponentQuery* Helium::ComponentManager::GetCachedQuery( const TypeId *types, size_t typesCount )
 {
-	TypeData *pTypeData = g_ComponentTypes[ typeId ];
+	// Held while a new query seeds itself, so a concurrent task asking for the same types waits for it
+	MutexScopeLock scopeLock( m_CachedQueryLock );
 
-	size_t count = 0;
-	for (DynamicArray< TypeId >::Iterator iter = pTypeData->m_ImplementingTypes.Begin();
-		iter != pTypeData->m_ImplementingTypes.End(); ++iter)
+	for (DynamicArray<ComponentQuery *>::Iterator iter = m_CachedQueries.Begin();
+		iter != m_CachedQueries.End(); ++iter)
 	{
-		count += m_Pools[ *iter ]->GetAllocatedCount();
+		if ( (*iter)->HasTypes( types, typesCount ) )
+		{
+			return *iter;
+		}
 	}
 
-	return count;
+	ComponentQuery *pQuery = new ComponentQuery( *this, types, typesCount );
+	m_CachedQueries.Push( pQuery );
+
+	return pQuery;
 }
 
-void Helium::ComponentPtrBase::Unlink() const
+void Helium::ComponentManager::UpdateQueries( ComponentCollection &rCollection, TypeId typeId )
 {
-	// If we are the head node in the component ptr registry, we need to point it to the new head
-	if (m_ComponentPtrRegistryHeadIndex != Helium::Invalid<uint16_t>())
-	{
-		ComponentPtrBase *current_head = g_ComponentPtrRegistry[m_ComponentPtrRegistryHeadIndex];
-		HELIUM_ASSERT(current_head == this);
-		HELIUM_ASSERT(!m_Previous);
+	MutexScopeLock scopeLock( m_QueryRegistrationLock );
 
-		// If this new node is legit, mark it as a head node
-		if (m_Next)
-		{
-			g_ComponentPtrRegistry[m_ComponentPtrRegistryHeadIndex] = m_Next;
-			m_Next->m_ComponentPtrRegistryHeadIndex = m_ComponentPtrRegistryHeadIndex;
-			m_Next->m_Previous = NULL;
-		}
-		else
-		{
-			g_ComponentPtrRegistry[m_ComponentPtrRegistryHeadIndex] = NULL;
-		}
-
-		// Unmark ourself as a head node
-		m_ComponentPtrRegistryHeadIndex = Helium::Invalid<uint16_t>();
-	} 
-	// Unlink ourself from doubly linked list of component ptrs
-	else if (m_Previous)
+	DynamicArray<ComponentQuery *> &rQueries = m_QueriesByType[ typeId ];
+	for (DynamicArray<ComponentQuery *>::Iterator iter = rQueries.Begin();
+		iter != rQueries.End(); ++iter)
 	{
-		m_Previous->m_Next = m_Next;
+		(*iter)->UpdateCollection( rCollection );
 	}
+}
 
-	if (m_Next)
+size_t Helium::ComponentManager::CountAllocatedComponentsThatImplement( Components::TypeId typeId ) const
+{
+	TypeData *pTypeData = g_ComponentTypes[ typeId ];
+
+	size_t count = 0;
+	for (DynamicArray< TypeId >::Iterator iter = pTypeData->m_ImplementingTypes.Begin();
+		iter != pTypeData->m_ImplementingTypes.End(); ++iter)
 	{
-		m_Next->m_Previous = m_Previous;
+		count += m_Pools[ *iter ]->GetAllocatedCount();
 	}
 
-	m_Previous = 0;
-	m_Next = 0;
+	return count;
 }
 
 #if HELIUM_TOOLS
@@ -7,6 +7,8 @@
 #include "Reflect/Object.h"
 #include "Foundation/Map.h"
 #include "Foundation/SmartPtr.h"
+#include "Platform/Atomic.h"
+#include "Platform/Locks.h"
 #include "Framework/Framework.h"
 
 
@@ -55,7 +57,6 @@
 	Helium::Components::ComponentRegistrar<__Type, __Type::ComponentBase> __Type::s_ComponentRegistrar(#__Type, __Count); \
 	HELIUM_DEFINE_DERIVED_STRUCT( __Type )
 
-#define HELIUM_COMPONENT_PTR_CHECK_FREQUENCY (256)
 #define HELIUM_COMPONENT_POOL_ALIGN_SIZE (32)
 #define HELIUM_COMPONENT_POOL_ALIGN_SIZE_MASK (~(POOL_ALIGN_SIZE-1))
 
@@ -66,6 +67,7 @@ namespace Helium
 	class Component;
 	class World;
 	class ComponentPtrBase;
+	class ComponentQuery;
 	class SystemDefinition;
 
 	namespace Components
@@ -89,9 +91,11 @@ namespace Helium
 		typedef uint16_t TypeId;
 		typedef uint16_t ComponentIndex;
 		typedef uint16_t ComponentSizeType;
-		typedef uint8_t GenerationIndex;
+		typedef uint32_t GenerationIndex;
 
-		const static uint32_t COMPONENT_PTR_CHECK_FREQUENCY = 256;
+		//! Maximum number of pools (component types times worlds) alive at once. Handles name pools by slot in a table
+		//! of this size, so creating a pool once every slot is taken throws an exception.
+		const static uint16_t MAX_COMPONENT_POOL_COUNT = 4096;
 		const static uintptr_t POOL_ALIGN_SIZE = 32;
 		const static uintptr_t POOL_ALIGN_SIZE_MASK = ~(POOL_ALIGN_SIZE-1);
 		
@@ -158,7 +162,6 @@ namespace Helium
 			uint16_t         m_OffsetToPoolStart;
 			ComponentIndex   m_Next;
 			ComponentIndex   m_Previous;
-			GenerationIndex  m_Generation;
 			bool             m_Delete;
 		};
 		
@@ -166,6 +169,7 @@ namespace Helium
 		{
 			ComponentCollection*  m_Collection;
 			ComponentIndex        m_RosterIndex;
+			GenerationIndex       m_Generation;  //< Incremented whenever the component is freed, invalidating old handles
 		};
 		
 		struct HELIUM_FRAMEWORK_API Pool
@@ -174,8 +178,11 @@ namespace Helium
 			static Pool*               CreatePool( ComponentManager *pComponentManager, const TypeData &rTypeData, ComponentIndex count );
 			static void                DestroyPool( Pool *pPool );
 			static inline Pool*        GetPool( const Component *component );
+			static inline Pool*        GetPoolById( uint16_t poolId );
 									   
 			inline TypeId              GetTypeId() const;
+			inline uint16_t            GetPoolId() const;
+			inline ComponentIndex      GetCapacity() const;
 			inline ComponentManager*   GetComponentManager() const;
 			inline World*              GetWorld() const;
 			inline Component*          GetComponent(ComponentIndex index) const;
@@ -219,11 +226,14 @@ namespace Helium
 			TypeId                     m_TypeId;
 			ComponentSizeType          m_ComponentSize;
 			ComponentIndex             m_FirstUnallocatedIndex;
+			uint16_t                   m_PoolId;
 		};
+
+		// Live pools by pool id. Written when pools are created and destroyed, read without locking by handles.
+		HELIUM_FRAMEWORK_API extern Pool* g_ComponentPoolTable[ MAX_COMPONENT_POOL_COUNT ];
 		
 		HELIUM_FRAMEWORK_API void                Startup( SystemDefinition *pSystemDefinition );
 		HELIUM_FRAMEWORK_API void                Shutdown();
-		HELIUM_FRAMEWORK_API void                Tick();
 		
 		HELIUM_FRAMEWORK_API TypeId              RegisterType(
 			const Reflect::MetaStruct *_structure, 
@@ -242,7 +252,6 @@ namespace Helium
 	public:
 		virtual                  ~ComponentManager();
 
-		void                     RegisterComponentPtr( ComponentPtrBase &pPtr );
 		inline World*            GetWorld() const;
 		inline const Components::Pool*  GetPool( Components::TypeId typeId );
 
@@ -250,6 +259,20 @@ namespace Helium
 		inline size_t            CountAllocatedComponents( Components::TypeId typeId ) const;
 		size_t                   CountAllocatedComponentsThatImplement( Components::TypeId typeId ) const;
 
+		// Queries registered here are seeded with the collections that already match, then told whenever a collection's
+		// components of a type they query change. Tasks may run queries concurrently, so cached query creation and
+		// registration are locked.
+		void                     RegisterQuery( ComponentQuery &rQuery );
+		void                     UnregisterQuery( ComponentQuery &rQuery );
+		ComponentQuery*          GetCachedQuery( const Components::TypeId *types, size_t typesCount );
+		void                     UpdateQueries( ComponentCollection &rCollection, Components::TypeId typeId );
+
+		// Counts the ParallelQueryComponents calls whose callbacks are running, during which components must not be
+		// allocated or freed. Tasks may run parallel queries on the same world concurrently, so the count is atomic.
+		inline void              BeginParallelQuery();
+		inline void              EndParallelQuery();
+		inline bool              IsParallelQueryActive() const;
+
 		template < class T > T*        Allocate( Components::IHasComponents *pOwner, ComponentCollection &rCollection );
 		template < class T > size_t    CountAllocatedComponents();
 		template < class T > size_t    CountAllocatedComponentsThatImplement();
@@ -260,6 +283,11 @@ namespace Helium
 
 		World *m_World;
 		DynamicArray<Components::Pool *> m_Pools;
+		DynamicArray< DynamicArray<ComponentQuery *> > m_QueriesByType; //< Registered queries interested in each type
+		DynamicArray<ComponentQuery *> m_CachedQueries;                 //< Queries owned by the manager, see GetCachedQuery()
+		Mutex m_CachedQueryLock;                                        //< Guards m_CachedQueries
+		Mutex m_QueryRegistrationLock;                                  //< Guards m_QueriesByType
+		volatile int32_t m_ParallelQueryCount;
 	};
 
 
@@ -348,6 +376,7 @@ namespace Helium
 
 		inline ComponentManager*             GetComponentManager() const;
 		inline ComponentCollection*          GetComponentCollection() const;
+		inline Components::GenerationIndex   GetGeneration() const;
 		inline Components::IHasComponents*   GetOwner() const;
 		inline World*                        GetWorld() const;
 		inline void                          FreeComponent();
@@ -366,7 +395,43 @@ namespace Helium
 	};
 
 	
-	// Code that need not be template aware goes here
+	//! Compact reference to a component: the component's pool id, its index in the pool, and the generation of that
+	//! pool slot when the handle was made. Handles are plain values that are checked in O(1) without registering
+	//! anywhere, so they can be freely copied (into job parameters, for instance). Freeing the component or destroying
+	//! its pool invalidates the handle.
+	class ComponentHandleBase
+	{
+	public:
+		inline ComponentHandleBase();
+		inline explicit ComponentHandleBase( const Component *_component );
+
+		inline Component* Resolve() const;
+		inline bool       IsGood() const;
+		inline void       Reset();
+
+		inline bool operator==( const ComponentHandleBase &_rhs ) const;
+		inline bool operator!=( const ComponentHandleBase &_rhs ) const;
+
+	protected:
+		Components::GenerationIndex m_Generation;
+		uint16_t                    m_PoolId;
+		Components::ComponentIndex  m_Index;
+	};
+
+	template <class T>
+	class ComponentHandle : public Helium::ComponentHandleBase
+	{
+	public:
+		inline ComponentHandle();
+		inline explicit ComponentHandle( const T *_component );
+
+		inline T *Get() const;
+	};
+
+	// Code that need not be template aware goes here. A ComponentPtr holds the component's address along with the
+	// generation of its pool slot, which is 32 bits wide so that it never needs to be swept for wrap-around. Code
+	// that passes references between threads or stores many of them should prefer ComponentHandle, which is half the
+	// size. ComponentPtr::GetHandle() converts from one to the other.
 	class HELIUM_FRAMEWORK_API ComponentPtrBase
 	{
 	public:
@@ -374,16 +439,10 @@ namespace Helium
 		inline bool IsGood() const;
 		inline void Reset(Component *_component = 0);
 
-		ComponentPtrBase *GetNextComponetPtr() { return m_Next; }
-		friend ComponentManager;
-		friend void Helium::Components::Tick();
-
 	protected:
 		inline ComponentPtrBase();
-		inline ~ComponentPtrBase();
 
 		inline void Reset(Component *_component) const;
-		void Unlink() const;
 			
 		// Component we point to. NOTE: This will ALWAYS be a type T component because 
 		// this class never sets m_Component to anything but NULL. Our non-base template
@@ -391,17 +450,8 @@ namespace Helium
 		mutable Component *m_Component; 
 
 	private:
-		// Doubly linked list lets us unsplice ourself easily from list of "allocated" ComponentPtrs
-		mutable ComponentPtrBase *m_Next;
-		mutable ComponentPtrBase *m_Previous;
-			
 		// We set this generation when a component is assigned
 		mutable Components::GenerationIndex m_Generation;
-
-		// If not assigned to Helium::Invalid<uint16_t>(), this node is head of
-		// linked list and is pointed to by g_ComponentPtrRegistry. Destruction of this
-		// Ptr will automatically fix that reference.
-		mutable uint16_t m_ComponentPtrRegistryHeadIndex;
 	};
 
 	// Code that uses T goes here
@@ -411,6 +461,7 @@ namespace Helium
 	public:
 		ComponentPtr();
 		explicit ComponentPtr(T *_component);
+		explicit ComponentPtr(const ComponentHandle<T> &_handle);
 		ComponentPtr( const ComponentPtr& _rhs );
 
 		void operator=(T *_component);
@@ -421,6 +472,8 @@ namespace Helium
 		T *Get();
 		const T *Get() const;
 
+		ComponentHandle<T> GetHandle() const;
+
 		T &operator*();
 		T *operator->();
 
@@ -92,10 +92,25 @@ namespace Helium
 				( static_cast<uintptr_t>( component->m_InlineData.m_OffsetToPoolStart ) * HELIUM_COMPONENT_POOL_ALIGN_SIZE ) );
 		}
 		
+		Pool* Pool::GetPoolById( uint16_t poolId )
+		{
+			return poolId < MAX_COMPONENT_POOL_COUNT ? g_ComponentPoolTable[ poolId ] : NULL;
+		}
+
 		TypeId Pool::GetTypeId() const
 		{
 			return m_TypeId;
 		}
+
+		uint16_t Pool::GetPoolId() const
+		{
+			return m_PoolId;
+		}
+
+		ComponentIndex Pool::GetCapacity() const
+		{
+			return static_cast<ComponentIndex>( m_Roster.GetSize() );
+		}
 		
 		ComponentManager* Helium::Components::Pool::GetComponentManager() const
 		{
@@ -178,7 +193,7 @@ namespace Helium
 
 		GenerationIndex Pool::GetGeneration( ComponentIndex index ) const
 		{
-			return GetComponent( index )->m_InlineData.m_Generation;
+			return m_ParallelData[ index ].m_Generation;
 		}
 		
 		ComponentIndex Pool::GetAllocatedCount() const
@@ -352,6 +367,23 @@ namespace Helium
 		return m_World;
 	}
 
+	void ComponentManager::BeginParallelQuery()
+	{
+		AtomicIncrementAcquire( m_ParallelQueryCount );
+	}
+
+	void ComponentManager::EndParallelQuery()
+	{
+		int32_t parallelQueryCount = AtomicDecrementRelease( m_ParallelQueryCount );
+		HELIUM_ASSERT( parallelQueryCount >= 0 );
+		HELIUM_UNREF( parallelQueryCount );
+	}
+
+	bool ComponentManager::IsParallelQueryActive() const
+	{
+		return ( m_ParallelQueryCount != 0 );
+	}
+
 	template < class T >
 	size_t Helium::ComponentManager::CountAllocatedComponentsThatImplement()
 	{
@@ -474,6 +506,13 @@ namespace Helium
 		return pool->GetComponentCollection( this );
 	}
 
+	Components::GenerationIndex Component::GetGeneration() const
+	{
+		Components::Pool* pool = Components::Pool::GetPool( this );
+		HELIUM_ASSERT( pool );
+		return pool->GetGeneration( pool->GetComponentIndex( this ) );
+	}
+
 	Components::IHasComponents* Component::GetOwner() const
 	{
 		return m_InlineData.m_Owner;
@@ -510,6 +549,83 @@ namespace Helium
 		return GetComponentManager()->Allocate<T>( GetOwner(), *GetComponentCollection() );
 	}
 
+	ComponentHandleBase::ComponentHandleBase()
+		: m_Generation(0)
+		, m_PoolId(Invalid<uint16_t>())
+		, m_Index(Invalid<Components::ComponentIndex>())
+	{
+
+	}
+
+	ComponentHandleBase::ComponentHandleBase( const Component *_component )
+	{
+		if (!_component)
+		{
+			Reset();
+			return;
+		}
+
+		Components::Pool *pool = Components::Pool::GetPool( _component );
+		HELIUM_ASSERT( pool );
+		m_PoolId = pool->GetPoolId();
+		m_Index = pool->GetComponentIndex( _component );
+		m_Generation = pool->GetGeneration( m_Index );
+	}
+
+	Component *ComponentHandleBase::Resolve() const
+	{
+		Components::Pool *pool = Components::Pool::GetPoolById( m_PoolId );
+
+		// The pool id may have been reused by a smaller pool, so check the index before reading the generation
+		if (!pool || m_Index >= pool->GetCapacity() || pool->GetGeneration( m_Index ) != m_Generation)
+		{
+			return NULL;
+		}
+
+		return pool->GetComponent( m_Index );
+	}
+
+	bool ComponentHandleBase::IsGood() const
+	{
+		return (Resolve() != NULL);
+	}
+
+	void ComponentHandleBase::Reset()
+	{
+		m_Generation = 0;
+		m_PoolId = Invalid<uint16_t>();
+		m_Index = Invalid<Components::ComponentIndex>();
+	}
+
+	bool ComponentHandleBase::operator==( const ComponentHandleBase &_rhs ) const
+	{
+		return m_PoolId == _rhs.m_PoolId && m_Index == _rhs.m_Index && m_Generation == _rhs.m_Generation;
+	}
+
+	bool ComponentHandleBase::operator!=( const ComponentHandleBase &_rhs ) const
+	{
+		return !( *this == _rhs );
+	}
+
+	template <class T>
+	ComponentHandle<T>::ComponentHandle()
+	{
+
+	}
+
+	template <class T>
+	ComponentHandle<T>::ComponentHandle( const T *_component )
+		: ComponentHandleBase( _component )
+	{
+
+	}
+
+	template <class T>
+	T *ComponentHandle<T>::Get() const
+	{
+		return static_cast<T *>( Resolve() );
+	}
+
 	void ComponentPtrBase::Check() const
 	{
 		// If no component, we're done
@@ -519,7 +635,7 @@ namespace Helium
 		}
 
 		// If generation doesn't match
-		if (m_Component->m_InlineData.m_Generation != m_Generation)
+		if (m_Component->GetGeneration() != m_Generation)
 		{
 			// Drop the component
 			Reset(NULL);
@@ -540,38 +656,16 @@ namespace Helium
 
 	void ComponentPtrBase::Reset( Component *_component ) const
 	{
-		if (m_Component == _component)
-		{
-			// Is also desired case for assigning null to null ptr
-			return;
-		}
-
-		Unlink();
-		HELIUM_ASSERT(m_ComponentPtrRegistryHeadIndex == Helium::Invalid<uint16_t>());
 		m_Component = _component;
-
-		if (m_Component)
-		{
-			m_Generation = m_Component->m_InlineData.m_Generation;
-			m_Component->GetComponentManager()->RegisterComponentPtr( *const_cast<ComponentPtrBase *>(this) );
-			HELIUM_ASSERT( m_ComponentPtrRegistryHeadIndex != Helium::Invalid<uint16_t>() );
-			HELIUM_ASSERT( !m_Next || m_Next->m_ComponentPtrRegistryHeadIndex == Helium::Invalid<uint16_t>() );
-		}
+		m_Generation = m_Component ? m_Component->GetGeneration() : 0;
 	}
 
 	ComponentPtrBase::ComponentPtrBase() 
-		: m_Next(0)
-		, m_Previous(0)
-		, m_Component(0)
-		, m_ComponentPtrRegistryHeadIndex(Helium::Invalid<uint16_t>())
+		: m_Component(0)
+		, m_Generation(0)
 	{
 
 	}
-
-	ComponentPtrBase::~ComponentPtrBase()
-	{
-		Unlink();
-	}
 		
 	template <class T>
 	ComponentPtr<T>::ComponentPtr()
@@ -585,10 +679,17 @@ namespace Helium
 		Reset(_component);
 	}
 
+	template <class T>
+	ComponentPtr<T>::ComponentPtr( const ComponentHandle<T> &_handle )
+	{
+		Reset(_handle.Get());
+	}
+
 	template <class T>
 	ComponentPtr<T>::ComponentPtr( const ComponentPtr& _rhs )
 	{
-		Reset(_rhs.m_Component);
+		// Check first so that copying a stale ptr does not pick up the generation of whatever reuses its slot
+		Reset(const_cast<T *>(_rhs.Get()));
 	}
 
 	template <class T>
@@ -617,6 +718,12 @@ namespace Helium
 		return UncheckedGet();
 	}
 
+	template <class T>
+	ComponentHandle<T> ComponentPtr<T>::GetHandle() const
+	{
+		return ComponentHandle<T>( Get() );
+	}
+
 	template <class T>
 	T & ComponentPtr<T>::operator*()
 	{
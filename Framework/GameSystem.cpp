@@ -1,7 +1,9 @@
 #include "FrameworkPch.h"
 #include "Framework/GameSystem.h"
 
+#include "Engine/AssetLoader.h"
 #include "Engine/AsyncLoader.h"
+#include "Engine/JobManager.h"
 #include "Engine/FileLocations.h"
 #include "Foundation/FilePath.h"
 #include "Foundation/DirectoryIterator.h"
@@ -38,6 +40,7 @@ GameSystem::GameSystem()
 , m_pRendererInitialization( NULL )
 , m_pWindowManagerInitialization( NULL )
 , m_bStopRunning( false )
+, m_bRecordPrefetchManifests( false )
 {
 }
 
@@ -87,6 +90,7 @@ bool GameSystem::Initialize(
 #endif
 
 	AsyncLoader::Startup();
+	JobManager::Startup();
 	CacheManager::Startup();
 	Reflect::Startup();
 
@@ -181,6 +185,7 @@ void GameSystem::Cleanup()
 	Reflect::Shutdown();
 	AssetType::Shutdown();
 	Asset::Shutdown();
+	JobManager::Shutdown();
 	AsyncLoader::Shutdown();
 
 	Reflect::ObjectRefCountSupport::Shutdown();
@@ -256,6 +261,62 @@ World *GameSystem::LoadScene( SceneDefinition *pSceneDefinition )
 	return pWorldManager->CreateWorld( pSceneDefinition );
 }
 
+/// Load a scene definition and everything it references.
+///
+/// If the scene definition has a prefetch manifest, the manifest is played back, reading all of the recorded cache
+/// entries up front in file offset order before the scene definition load is issued.  Manifests are only recorded in
+/// tools builds (the first time a scene definition is loaded) or when recording is requested with
+/// SetRecordPrefetchManifests(), so shipping builds never write to the caches while loading scenes.
+///
+/// @param[in]  scenePath            Path of the scene definition to load.
+/// @param[out] rspSceneDefinition  Loaded scene definition.
+///
+/// @return  True if the scene definition was loaded successfully, false if not.
+///
+/// @see SetRecordPrefetchManifests()
+bool GameSystem::LoadSceneDefinition( AssetPath scenePath, StrongPtr< SceneDefinition >& rspSceneDefinition )
+{
+	AssetLoader* pAssetLoader = AssetLoader::GetInstance();
+	HELIUM_ASSERT( pAssetLoader );
+
+	CacheManager* pCacheManager = CacheManager::GetInstance();
+	HELIUM_ASSERT( pCacheManager );
+
+	DynamicArray< CacheManager::LoadRecord > loadRecords;
+	bool bPrefetch =
+		( !m_bRecordPrefetchManifests && pCacheManager->LoadPrefetchManifest( scenePath, loadRecords ) );
+#if HELIUM_TOOLS
+	bool bRecord = !bPrefetch;
+#else
+	bool bRecord = m_bRecordPrefetchManifests;
+#endif
+	if( bRecord )
+	{
+		pCacheManager->BeginLoadRecording();
+	}
+	else if( bPrefetch )
+	{
+		pCacheManager->BeginPrefetch( loadRecords );
+	}
+
+	bool bResult = pAssetLoader->LoadObject( scenePath, rspSceneDefinition );
+
+	if( bRecord )
+	{
+		pCacheManager->EndLoadRecording( loadRecords );
+		if( bResult && !loadRecords.IsEmpty() )
+		{
+			pCacheManager->SavePrefetchManifest( scenePath, loadRecords );
+		}
+	}
+	else if( bPrefetch )
+	{
+		pCacheManager->EndPrefetch();
+	}
+
+	return bResult;
+}
+
 void GameSystem::StopRunning()
 {
 	m_bStopRunning = true;
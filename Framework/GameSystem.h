@@ -40,6 +40,13 @@ namespace Helium
 		virtual void Cleanup();
 		
 		World *LoadScene( Helium::SceneDefinition *spSceneDefinition );
+		bool LoadSceneDefinition( AssetPath scenePath, StrongPtr< SceneDefinition >& rspSceneDefinition );
+		//@}
+
+		/// @name Prefetch Manifests
+		//@{
+		inline void SetRecordPrefetchManifests( bool bRecord );
+		inline bool GetRecordPrefetchManifests() const;
 		//@}
 
 		/// @name Application Loop
@@ -70,5 +77,9 @@ namespace Helium
 		AssetAwareThreadSynchronizer m_AssetSyncUtility;
 		TaskSchedule                 m_Schedule;
 		bool                         m_bStopRunning;
+		/// True to always record the cache load order of scene definitions, even if they already have a manifest.
+		bool                         m_bRecordPrefetchManifests;
 	};
 }
+
+#include "Framework/GameSystem.inl"
@@ -0,0 +1,25 @@
+namespace Helium
+{
+	/// Set whether scene definitions loaded with LoadSceneDefinition() should always have their load order recorded.
+	///
+	/// @param[in] bRecord  True to record and save a new prefetch manifest on every scene definition load, false to
+	///                     only record manifests for scene definitions that do not have one yet in tools builds (and
+	///                     never in other builds).
+	///
+	/// @see GetRecordPrefetchManifests(), LoadSceneDefinition()
+	void GameSystem::SetRecordPrefetchManifests( bool bRecord )
+	{
+		m_bRecordPrefetchManifests = bRecord;
+	}
+
+	/// Get whether scene definitions loaded with LoadSceneDefinition() always have their load order recorded.
+	///
+	/// @return  True if prefetch manifests are always recorded, false if they are only recorded when missing in tools
+	///          builds.
+	///
+	/// @see SetRecordPrefetchManifests(), LoadSceneDefinition()
+	bool GameSystem::GetRecordPrefetchManifests() const
+	{
+		return m_bRecordPrefetchManifests;
+	}
+}
@@ -2,6 +2,9 @@
 #include "FrameworkPch.h"
 #include "TaskScheduler.h"
 #include "Foundation/Map.h"
+#include "Platform/Atomic.h"
+#include "Engine/JobManager.h"
+#include "Framework/Components.h"
 
 using namespace Helium;
 
@@ -10,6 +13,7 @@ TaskDefinition *TaskDefinition::s_FirstTaskDefinition = NULL;
 bool TaskScheduler::m_ContractsDefined = false;
 
 bool InsertToTaskList(A_TaskDefinitionPtr &rTaskInfoList, DynamicArray<TaskFunc> &rTaskFuncList, A_TaskDefinitionPtr &rTaskStack, const TaskDefinition *pTask, uint32_t tickType);
+void BuildScheduleGraph(TaskSchedule &rSchedule);
 
 bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 {	
@@ -97,6 +101,7 @@ bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 	}
 	
 	A_TaskDefinitionPtr taskStack;
+	schedule.m_TickType = tickType;
 	
 	const TaskDefinition *task = TaskDefinition::s_FirstTaskDefinition;
 	while (task)
@@ -106,6 +111,7 @@ bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 		{
 			schedule.m_ScheduleInfo.Clear();
 			schedule.m_ScheduleFunc.Clear();
+			schedule.m_ScheduleGraph.Clear();
 			return false;
 		}
 
@@ -205,9 +211,220 @@ bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 	}
 #endif
 
+	BuildScheduleGraph(schedule);
+
 	return true;
 }
 
+typedef Helium::Map<const TaskDefinition *, uint32_t> M_TaskScheduleIndexMap;
+
+// Find the tasks in the schedule that pTask must wait on. Requirements on tasks that were dropped from the schedule
+// (abstract tasks, or tasks that don't run for this tick type) are followed through to their own requirements so
+// that ordering is never lost.
+void CollectScheduledPredecessors(const TaskDefinition *pTask, const M_TaskScheduleIndexMap &rIndexMap, A_TaskDefinitionPtr &rVisited, DynamicArray<uint32_t> &rPredecessors)
+{
+	for (A_TaskDefinitionPtr::ConstIterator prior_task_iter = pTask->m_RequiredTasks.Begin();
+		prior_task_iter != pTask->m_RequiredTasks.End(); ++prior_task_iter)
+	{
+		bool already_visited = false;
+		for (A_TaskDefinitionPtr::Iterator visited_iter = rVisited.Begin(); visited_iter != rVisited.End(); ++visited_iter)
+		{
+			if (*visited_iter == *prior_task_iter)
+			{
+				already_visited = true;
+				break;
+			}
+		}
+
+		if (already_visited)
+		{
+			continue;
+		}
+
+		rVisited.Push(*prior_task_iter);
+
+		M_TaskScheduleIndexMap::ConstIterator index_iter = rIndexMap.Find(*prior_task_iter);
+		if (index_iter != rIndexMap.End())
+		{
+			rPredecessors.Push(index_iter->Second());
+		}
+		else
+		{
+			CollectScheduledPredecessors(*prior_task_iter, rIndexMap, rVisited, rPredecessors);
+		}
+	}
+}
+
+bool ComponentTypesOverlap(const Components::TypeData *pTypeA, const Components::TypeData *pTypeB)
+{
+	if (pTypeA == pTypeB)
+	{
+		return true;
+	}
+
+	// Types that were never registered can only be matched by identity
+	if (pTypeA->m_TypeId == Invalid<Components::TypeId>() || pTypeB->m_TypeId == Invalid<Components::TypeId>())
+	{
+		return false;
+	}
+
+	// Touching a type also touches every type that implements it
+	for (DynamicArray<Components::TypeId>::ConstIterator iter = pTypeA->m_ImplementedTypes.Begin();
+		iter != pTypeA->m_ImplementedTypes.End(); ++iter)
+	{
+		if (*iter == pTypeB->m_TypeId)
+		{
+			return true;
+		}
+	}
+
+	for (DynamicArray<Components::TypeId>::ConstIterator iter = pTypeB->m_ImplementedTypes.Begin();
+		iter != pTypeB->m_ImplementedTypes.End(); ++iter)
+	{
+		if (*iter == pTypeA->m_TypeId)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Returns true if the two contracts can't safely run at the same time. ppConflictType is set to the contested
+// component type, or null if the conflict is because one of the tasks did not declare its access.
+bool ContractsConflict(const TaskContract &rContractA, const TaskContract &rContractB, const Components::TypeData **ppConflictType)
+{
+	*ppConflictType = NULL;
+
+	if (!rContractA.m_AccessDeclared || !rContractB.m_AccessDeclared)
+	{
+		return true;
+	}
+
+	for (DynamicArray<TaskAccess>::ConstIterator access_a = rContractA.m_Accesses.Begin();
+		access_a != rContractA.m_Accesses.End(); ++access_a)
+	{
+		for (DynamicArray<TaskAccess>::ConstIterator access_b = rContractB.m_Accesses.Begin();
+			access_b != rContractB.m_Accesses.End(); ++access_b)
+		{
+			if (access_a->m_Type == TaskAccessTypes::Read && access_b->m_Type == TaskAccessTypes::Read)
+			{
+				continue;
+			}
+
+			if (ComponentTypesOverlap(access_a->m_ComponentType, access_b->m_ComponentType))
+			{
+				*ppConflictType = access_a->m_ComponentType;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Build the dependency graph used by TaskScheduler::ExecuteScheduleParallel. The flat schedule is a valid topological
+// order, so any pair of tasks that is not already ordered by the graph but conflicts is ordered as it appears in the
+// flat schedule. This keeps the results identical to running the flat schedule serially.
+void BuildScheduleGraph(TaskSchedule &rSchedule)
+{
+	const uint32_t taskCount = static_cast<uint32_t>(rSchedule.m_ScheduleInfo.GetSize());
+
+	rSchedule.m_ScheduleGraph.Clear();
+	rSchedule.m_ScheduleGraph.Resize(taskCount);
+
+	M_TaskScheduleIndexMap indexMap;
+	for (uint32_t task_index = 0; task_index < taskCount; ++task_index)
+	{
+		M_TaskScheduleIndexMap::Iterator index_iter;
+		indexMap.Insert(index_iter, M_TaskScheduleIndexMap::ValueType(rSchedule.m_ScheduleInfo[task_index], task_index));
+	}
+
+	// ancestors[i][j] is true if task j is guaranteed to complete before task i starts
+	DynamicArray< DynamicArray<bool> > ancestors;
+	ancestors.Resize(taskCount);
+
+	A_TaskDefinitionPtr visited;
+	DynamicArray<uint32_t> predecessors;
+
+	for (uint32_t task_index = 0; task_index < taskCount; ++task_index)
+	{
+		const TaskDefinition *pTask = rSchedule.m_ScheduleInfo[task_index];
+		TaskScheduleNode &rNode = rSchedule.m_ScheduleGraph[task_index];
+		rNode.m_PredecessorCount = 0;
+		rNode.m_RunOnWorker = pTask->m_Contract.m_AccessDeclared;
+
+		DynamicArray<bool> &rAncestors = ancestors[task_index];
+		rAncestors.Resize(taskCount);
+		for (uint32_t other_index = 0; other_index < taskCount; ++other_index)
+		{
+			rAncestors[other_index] = false;
+		}
+
+		visited.Clear();
+		predecessors.Clear();
+		CollectScheduledPredecessors(pTask, indexMap, visited, predecessors);
+
+		for (DynamicArray<uint32_t>::Iterator predecessor_iter = predecessors.Begin();
+			predecessor_iter != predecessors.End(); ++predecessor_iter)
+		{
+			HELIUM_ASSERT(*predecessor_iter < task_index);
+			if (rAncestors[*predecessor_iter])
+			{
+				continue;
+			}
+
+			rSchedule.m_ScheduleGraph[*predecessor_iter].m_Successors.Push(task_index);
+			++rNode.m_PredecessorCount;
+
+			const DynamicArray<bool> &rPredecessorAncestors = ancestors[*predecessor_iter];
+			for (uint32_t other_index = 0; other_index < *predecessor_iter; ++other_index)
+			{
+				rAncestors[other_index] = rAncestors[other_index] || rPredecessorAncestors[other_index];
+			}
+			rAncestors[*predecessor_iter] = true;
+		}
+
+		// Serialize against any earlier task that could otherwise run at the same time and conflicts with us
+		for (uint32_t other_index = task_index; other_index-- > 0; )
+		{
+			if (rAncestors[other_index])
+			{
+				continue;
+			}
+
+			const TaskDefinition *pOtherTask = rSchedule.m_ScheduleInfo[other_index];
+			const Components::TypeData *pConflictType = NULL;
+			if (!ContractsConflict(pOtherTask->m_Contract, pTask->m_Contract, &pConflictType))
+			{
+				continue;
+			}
+
+#if HELIUM_TOOLS
+			if (pConflictType)
+			{
+				HELIUM_TRACE(
+					TraceLevels::Warning,
+					TXT( "Tasks %s and %s both access component type %s (at least one for writing) without an order requirement between them. They will not run concurrently.\n" ),
+					pOtherTask->m_Name,
+					pTask->m_Name,
+					pConflictType->m_Structure ? pConflictType->m_Structure->m_Name : TXT( "<unregistered>" ) );
+			}
+#endif
+
+			rSchedule.m_ScheduleGraph[other_index].m_Successors.Push(task_index);
+			++rNode.m_PredecessorCount;
+
+			const DynamicArray<bool> &rOtherAncestors = ancestors[other_index];
+			for (uint32_t ancestor_index = 0; ancestor_index < other_index; ++ancestor_index)
+			{
+				rAncestors[ancestor_index] = rAncestors[ancestor_index] || rOtherAncestors[ancestor_index];
+			}
+			rAncestors[other_index] = true;
+		}
+	}
+}
+
 bool InsertToTaskList(A_TaskDefinitionPtr &rTaskInfoList, DynamicArray<TaskFunc> &rTaskFuncList, A_TaskDefinitionPtr &rTaskStack, const TaskDefinition *pTask, uint32_t tickType)
 {
 	// Don't add functions that do not run under the given tick type
@@ -281,6 +498,19 @@ bool InsertToTaskList(A_TaskDefinitionPtr &rTaskInfoList, DynamicArray<TaskFunc>
 }
 
 void TaskScheduler::ExecuteSchedule( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds )
+{
+	JobManager *pJobManager = JobManager::GetInstance();
+	if ( pJobManager && pJobManager->GetWorkerThreadCount() != 0 && schedule.m_ScheduleGraph.GetSize() == schedule.m_ScheduleFunc.GetSize() )
+	{
+		ExecuteScheduleParallel( schedule, rWorlds );
+	}
+	else
+	{
+		ExecuteScheduleSerial( schedule, rWorlds );
+	}
+}
+
+void TaskScheduler::ExecuteScheduleSerial( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds )
 {
 	int i = 0;
 	for (DynamicArray<TaskFunc>::ConstIterator iter = schedule.m_ScheduleFunc.Begin(); iter != schedule.m_ScheduleFunc.End(); ++iter)
@@ -290,6 +520,132 @@ void TaskScheduler::ExecuteSchedule( const TaskSchedule &schedule, DynamicArray<
 	}
 }
 
+struct ParallelScheduleExecution;
+
+struct ScheduledTaskJob
+{
+	ParallelScheduleExecution *m_pExecution;
+	uint32_t m_TaskIndex;
+};
+
+// State shared between the thread executing a schedule and the workers running its tasks
+struct ParallelScheduleExecution
+{
+	const TaskSchedule *m_pSchedule;
+	DynamicArray< WorldPtr > *m_pWorlds;
+	JobManager *m_pJobManager;
+	JobCounter m_Counter;
+
+	// Predecessors left to complete for each task, counted down atomically
+	DynamicArray<int32_t> m_RemainingPredecessors;
+	DynamicArray<ScheduledTaskJob> m_Jobs;
+
+	// Ready tasks that must run on the thread executing the schedule
+	Locker< DynamicArray<uint32_t>, SpinLock > m_MainThreadQueue;
+	volatile int32_t m_CompletedTaskCount;
+};
+
+void DispatchScheduledTask(ParallelScheduleExecution &rExecution, uint32_t taskIndex);
+
+void CompleteScheduledTask(ParallelScheduleExecution &rExecution, uint32_t taskIndex)
+{
+	const TaskScheduleNode &rNode = rExecution.m_pSchedule->m_ScheduleGraph[taskIndex];
+	for (DynamicArray<uint32_t>::ConstIterator successor_iter = rNode.m_Successors.Begin();
+		successor_iter != rNode.m_Successors.End(); ++successor_iter)
+	{
+		if (AtomicDecrementRelease(rExecution.m_RemainingPredecessors[*successor_iter]) == 0)
+		{
+			DispatchScheduledTask(rExecution, *successor_iter);
+		}
+	}
+
+	AtomicIncrementRelease(rExecution.m_CompletedTaskCount);
+}
+
+void RunScheduledTaskJob(void *pData)
+{
+	ScheduledTaskJob *pJob = static_cast<ScheduledTaskJob *>(pData);
+	HELIUM_ASSERT(pJob);
+
+	ParallelScheduleExecution &rExecution = *pJob->m_pExecution;
+	rExecution.m_pSchedule->m_ScheduleFunc[pJob->m_TaskIndex]( *rExecution.m_pWorlds );
+
+	CompleteScheduledTask(rExecution, pJob->m_TaskIndex);
+}
+
+void DispatchScheduledTask(ParallelScheduleExecution &rExecution, uint32_t taskIndex)
+{
+	if (rExecution.m_pSchedule->m_ScheduleGraph[taskIndex].m_RunOnWorker)
+	{
+		rExecution.m_pJobManager->SpawnJob(RunScheduledTaskJob, &rExecution.m_Jobs[taskIndex], &rExecution.m_Counter);
+	}
+	else
+	{
+		Locker< DynamicArray<uint32_t>, SpinLock >::Handle handle ( rExecution.m_MainThreadQueue );
+		handle->Push(taskIndex);
+	}
+}
+
+void TaskScheduler::ExecuteScheduleParallel( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds )
+{
+	const uint32_t taskCount = static_cast<uint32_t>(schedule.m_ScheduleFunc.GetSize());
+	HELIUM_ASSERT(schedule.m_ScheduleGraph.GetSize() == taskCount);
+
+	JobManager *pJobManager = JobManager::GetInstance();
+	HELIUM_ASSERT(pJobManager);
+
+	ParallelScheduleExecution execution;
+	execution.m_pSchedule = &schedule;
+	execution.m_pWorlds = &rWorlds;
+	execution.m_pJobManager = pJobManager;
+	execution.m_CompletedTaskCount = 0;
+
+	execution.m_RemainingPredecessors.Resize(taskCount);
+	execution.m_Jobs.Resize(taskCount);
+	for (uint32_t task_index = 0; task_index < taskCount; ++task_index)
+	{
+		execution.m_RemainingPredecessors[task_index] = static_cast<int32_t>(schedule.m_ScheduleGraph[task_index].m_PredecessorCount);
+		execution.m_Jobs[task_index].m_pExecution = &execution;
+		execution.m_Jobs[task_index].m_TaskIndex = task_index;
+	}
+
+	for (uint32_t task_index = 0; task_index < taskCount; ++task_index)
+	{
+		if (schedule.m_ScheduleGraph[task_index].m_PredecessorCount == 0)
+		{
+			DispatchScheduledTask(execution, task_index);
+		}
+	}
+
+	// Run main thread tasks as they become ready, helping out with worker tasks in between
+	while (execution.m_CompletedTaskCount != static_cast<int32_t>(taskCount))
+	{
+		uint32_t task_index = Invalid<uint32_t>();
+		{
+			Locker< DynamicArray<uint32_t>, SpinLock >::Handle handle ( execution.m_MainThreadQueue );
+			if (!handle->IsEmpty())
+			{
+				task_index = handle->GetElement(0);
+				handle->Remove(0);
+			}
+		}
+
+		if (IsValid(task_index))
+		{
+			HELIUM_ASSERT(schedule.m_ScheduleInfo[task_index]->m_Func == schedule.m_ScheduleFunc[task_index]);
+			schedule.m_ScheduleFunc[task_index]( rWorlds );
+			CompleteScheduledTask(execution, task_index);
+		}
+		else if (!pJobManager->TryRunJob())
+		{
+			Thread::Yield();
+		}
+	}
+
+	// Workers may still be returning from the last jobs; don't let the execution state go out of scope under them
+	pJobManager->WaitForCounter(execution.m_Counter);
+}
+
 void Helium::TaskScheduler::ResetContracts()
 {
 	TaskDefinition *task = TaskDefinition::s_FirstTaskDefinition;
@@ -298,6 +654,8 @@ void Helium::TaskScheduler::ResetContracts()
 		task->m_RequiredTasks.Clear();
 		task->m_Contract.m_ContributedDependencies.Clear();
 		task->m_Contract.m_OrderRequirements.Clear();
+		task->m_Contract.m_Accesses.Clear();
+		task->m_Contract.m_AccessDeclared = false;
 		task = task->m_Next;
 	}
 
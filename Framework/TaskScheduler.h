@@ -38,6 +38,11 @@ namespace Helium
 {	
 	struct TaskDefinition;
 
+	namespace Components
+	{
+		struct TypeData;
+	}
+
 	namespace OrderRequirementTypes
 	{
 		enum OrderRequirementType
@@ -67,17 +72,35 @@ namespace Helium
 	}
 	typedef TickTypes::TickType TickType;
 
+	namespace TaskAccessTypes
+	{
+		enum TaskAccessType
+		{
+			Read,
+			Write,
+		};
+	}
+	typedef TaskAccessTypes::TaskAccessType TaskAccessType;
+
 	struct OrderRequirement
 	{
 		TaskDefinition *m_Dependency;
 		OrderRequirementType m_Type;
 	};
 
+	// Declares how a task touches a component type (and every type that implements it)
+	struct TaskAccess
+	{
+		const Components::TypeData *m_ComponentType;
+		TaskAccessType m_Type;
+	};
+
 	// Defines what the task expects and what it provides
 	struct TaskContract
 	{
 		TaskContract()
 			: m_TickType( TickTypes::Never )
+			, m_AccessDeclared( false )
 		{
 
 		}
@@ -126,13 +149,43 @@ namespace Helium
 			m_TickType = tickType;
 		}
 
+		// Task only reads components of type T. Once a task declares its component access, it may run on a worker
+		// thread concurrently with any other declared task it does not conflict with. Tasks that declare nothing
+		// are assumed to touch anything and always run alone on the thread executing the schedule.
+		template <class T>
+		void ReadsComponents()
+		{
+			DeclareAccess(T::GetStaticComponentTypeData(), TaskAccessTypes::Read);
+		}
+
+		// Task reads and modifies components of type T
+		template <class T>
+		void WritesComponents()
+		{
+			DeclareAccess(T::GetStaticComponentTypeData(), TaskAccessTypes::Write);
+		}
+
+		void DeclareAccess(const Components::TypeData &rComponentType, TaskAccessType accessType)
+		{
+			TaskAccess *access = m_Accesses.New();
+			access->m_ComponentType = &rComponentType;
+			access->m_Type = accessType;
+			m_AccessDeclared = true;
+		}
+
 		// Every requirement to be before or after another dependency goes here
 		DynamicArray<OrderRequirement> m_OrderRequirements;
 
 		// All dependencies we contribute to fulfilling
 		DynamicArray<const TaskDefinition *> m_ContributedDependencies;
 
+		// Component types this task reads or writes
+		DynamicArray<TaskAccess> m_Accesses;
+
 		TickType m_TickType;
+
+		// True if the task has declared all of its component access and is safe to run on a worker thread
+		bool m_AccessDeclared;
 	};
 
 	class World;
@@ -183,10 +236,31 @@ namespace Helium
 	};
 	typedef DynamicArray<const TaskDefinition *> A_TaskDefinitionPtr;
 
+	// A task's place in the dependency graph of a schedule
+	struct TaskScheduleNode
+	{
+		// Number of tasks in the schedule that must complete before this one can start
+		uint32_t m_PredecessorCount;
+
+		// Indices (into the schedule) of tasks that wait on this one
+		DynamicArray<uint32_t> m_Successors;
+
+		// True if this task may run on a worker thread
+		bool m_RunOnWorker;
+	};
+
 	struct TaskSchedule
 	{
+		TaskSchedule()
+			: m_TickType( TickTypes::Never )
+		{
+
+		}
+
+		uint32_t m_TickType; // Tick types the schedule was calculated for
 		A_TaskDefinitionPtr m_ScheduleInfo;
 		DynamicArray<TaskFunc> m_ScheduleFunc; // Compact version of our schedule
+		DynamicArray<TaskScheduleNode> m_ScheduleGraph; // Parallel to m_ScheduleFunc, used to run independent tasks concurrently
 	};
 
 	class HELIUM_FRAMEWORK_API TaskScheduler
@@ -194,6 +268,8 @@ namespace Helium
 	public:
 		static bool CalculateSchedule( uint32_t tickType, TaskSchedule &schedule );
 		static void ExecuteSchedule( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds );
+		static void ExecuteScheduleSerial( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds );
+		static void ExecuteScheduleParallel( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds );
 
 		static void ResetContracts();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Framework/ComponentCommandBuffer.h"
 #include "Framework/ComponentQuery.h"
 #include "Framework/Framework.h"
 
@@ -119,6 +120,62 @@ namespace Helium
 		HELIUM_ASSERT( pComponentManager );
 		QueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleHandler<A, B, C, F> );
 	}
+
+	// ParallelQueryComponents runs F on worker threads. F may only touch the components it is given (and read shared
+	// state). Allocations and frees must go through ComponentCommandBuffer::GetCurrent(), and they are applied before
+	// the query returns.
+	template <class A, void (*F)(A *)>
+	inline void ParallelQueryComponents( World *pWorld )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), ParallelTupleHandler<A, F>, NULL );
+	}
+
+	template <class A, class B, void (*F)(A *, B *)>
+	inline void ParallelQueryComponents( World *pWorld )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), ParallelTupleHandler<A, B, F>, NULL );
+	}
+
+	template <class A, class B, class C, void (*F)(A *, B *, C *)>
+	inline void ParallelQueryComponents( World *pWorld )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>(),
+			Components::GetType<C>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), ParallelTupleHandler<A, B, C, F>, NULL );
+	}
+
+	// Passes rContext (read-only, shared by every worker) to each call of F
+	template <class T, class A, class B, void (*F)(const T &, A *, B *)>
+	inline void ParallelQueryComponents( World *pWorld, const T &rContext )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), ContextTupleHandler<T, A, B, F>, const_cast<T *>( &rContext ) );
+	}
 }
 
 #include "Framework/World.inl"
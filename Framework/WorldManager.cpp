@@ -3,6 +3,7 @@
 #include "Framework/WorldDefinition.h"
 
 #include "Platform/Timer.h"
+#include "Engine/JobManager.h"
 #include "Framework/Slice.h"
 #include "Framework/Entity.h"
 #include "Framework/SceneDefinition.h"
@@ -20,6 +21,7 @@ WorldManager::WorldManager()
 , m_frameDeltaTickCount( 0 )
 , m_frameDeltaSeconds( 0.0f )
 , m_bProcessedFirstFrame( false )
+, m_bParallelWorldUpdate( false )
 {
 }
 
@@ -176,33 +178,32 @@ bool WorldManager::ReleaseWorld( World* pWorld )
 }
 
 /// Update all worlds for the current frame.
+///
+/// @param[in] schedule  Task schedule to run on each world.
+///
+/// @see SetParallelWorldUpdate()
 void WorldManager::Update( TaskSchedule &schedule )
 {
-	// Update the world time.
+	// Update the world time.  This is done once for all worlds so that they advance in lockstep, even when they are
+	// updated in parallel.
 	UpdateTime();
-	
-	Helium::TaskScheduler::ExecuteSchedule( schedule, m_worlds );
-	
-	Components::Tick();
 
-	// TODO: I plan to do a "flag system" - components that are super lightweight.. like bitflags.. that carry no data
-	// but mark an object. This data would be kept parallel with slices/worlds so that they would be far faster to query
-	// than this abomination
-	for ( DynamicArray< WorldPtr >::Iterator worldIter = m_worlds.Begin(); worldIter != m_worlds.End(); ++worldIter )
+	// Parallel world jobs destroy their world's deferred entities themselves.
+	bool bUpdateWorldsInParallel = CanUpdateWorldsInParallel( schedule );
+	if ( bUpdateWorldsInParallel )
 	{
-		for ( size_t sliceIndex = 0; sliceIndex < (*worldIter)->GetSliceCount(); ++sliceIndex )
-		{
-			Slice *pSlice = (*worldIter)->GetSlice( sliceIndex );
-			for ( size_t entityIndex = 0; entityIndex < pSlice->GetEntityCount(); ++entityIndex )
-			{
-				Entity *pEntity = pSlice->GetEntity( entityIndex );
+		UpdateWorldsInParallel( schedule );
+	}
+	else
+	{
+		Helium::TaskScheduler::ExecuteSchedule( schedule, m_worlds );
+	}
 
-				if ( pEntity->IsDeferredDestroySet() )
-				{
-					// TODO: I don't like that strong pointers might be holding these references alive.. need to find a way to fix this
-					pSlice->DestroyEntity( pEntity );
-				}
-			}
+	if ( !bUpdateWorldsInParallel )
+	{
+		for ( DynamicArray< WorldPtr >::Iterator worldIter = m_worlds.Begin(); worldIter != m_worlds.End(); ++worldIter )
+		{
+			DestroyDeferredEntities( *worldIter );
 		}
 	}
 }
@@ -248,6 +249,105 @@ void WorldManager::Shutdown()
 	}
 }
 
+/// Get whether the worlds can be updated in parallel with the given schedule this frame.
+///
+/// @param[in] schedule  Task schedule to run on each world.
+///
+/// @return  True if parallel world updates are enabled and possible, false if worlds should be updated in sequence.
+bool WorldManager::CanUpdateWorldsInParallel( const TaskSchedule &schedule ) const
+{
+	if ( !m_bParallelWorldUpdate || m_worlds.GetSize() < 2 )
+	{
+		return false;
+	}
+
+	// Rendering and client tasks share global state (renderer, windows, input) between worlds.
+	if ( ( schedule.m_TickType & ~static_cast< uint32_t >( TickTypes::HeadlessGame ) ) != 0 )
+	{
+		return false;
+	}
+
+	JobManager* pJobManager = JobManager::GetInstance();
+	return ( pJobManager && pJobManager->GetWorkerThreadCount() != 0 );
+}
+
+/// Per-world parameters for a parallel world update job.
+struct WorldUpdateJobData
+{
+	/// Schedule to run.
+	const TaskSchedule* pSchedule;
+	/// Single world to pass to each task in the schedule.
+	DynamicArray< WorldPtr > worlds;
+};
+
+/// Update each world on its own worker thread and wait for all of them to finish.
+///
+/// @param[in] schedule  Task schedule to run on each world.
+void WorldManager::UpdateWorldsInParallel( TaskSchedule &schedule )
+{
+	JobManager* pJobManager = JobManager::GetInstance();
+	HELIUM_ASSERT( pJobManager );
+
+	size_t worldCount = m_worlds.GetSize();
+
+	DynamicArray< WorldUpdateJobData > jobData;
+	jobData.Resize( worldCount );
+
+	JobCounter counter;
+	for ( size_t worldIndex = 0; worldIndex < worldCount; ++worldIndex )
+	{
+		WorldUpdateJobData& rJobData = jobData[ worldIndex ];
+		rJobData.pSchedule = &schedule;
+		rJobData.worlds.Push( m_worlds[ worldIndex ] );
+
+		pJobManager->SpawnJob( UpdateWorldJob, &rJobData, &counter );
+	}
+
+	pJobManager->WaitForCounter( counter );
+}
+
+/// Job callback for updating a single world.
+///
+/// @param[in] pData  WorldUpdateJobData for the world to update.
+void WorldManager::UpdateWorldJob( void* pData )
+{
+	WorldUpdateJobData* pJobData = static_cast< WorldUpdateJobData* >( pData );
+	HELIUM_ASSERT( pJobData );
+	HELIUM_ASSERT( pJobData->pSchedule );
+	HELIUM_ASSERT( pJobData->worlds.GetSize() == 1 );
+
+	// The worlds themselves are already spread across the workers, so each one runs its schedule in sequence.
+	Helium::TaskScheduler::ExecuteScheduleSerial( *pJobData->pSchedule, pJobData->worlds );
+
+	DestroyDeferredEntities( pJobData->worlds[ 0 ] );
+}
+
+/// Destroy all entities in a world that have been flagged for deferred destruction.
+///
+/// @param[in] pWorld  World to clean up.
+void WorldManager::DestroyDeferredEntities( World* pWorld )
+{
+	HELIUM_ASSERT( pWorld );
+
+	// TODO: I plan to do a "flag system" - components that are super lightweight.. like bitflags.. that carry no data
+	// but mark an object. This data would be kept parallel with slices/worlds so that they would be far faster to query
+	// than this abomination
+	for ( size_t sliceIndex = 0; sliceIndex < pWorld->GetSliceCount(); ++sliceIndex )
+	{
+		Slice *pSlice = pWorld->GetSlice( sliceIndex );
+		for ( size_t entityIndex = 0; entityIndex < pSlice->GetEntityCount(); ++entityIndex )
+		{
+			Entity *pEntity = pSlice->GetEntity( entityIndex );
+
+			if ( pEntity->IsDeferredDestroySet() )
+			{
+				// TODO: I don't like that strong pointers might be holding these references alive.. need to find a way to fix this
+				pSlice->DestroyEntity( pEntity );
+			}
+		}
+	}
+}
+
 /// Update timer information for the current frame.
 void WorldManager::UpdateTime()
 {
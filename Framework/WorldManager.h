@@ -36,6 +36,9 @@ namespace Helium
 		/// @name Updating
 		//@{
 		void Update( TaskSchedule &schedule );
+
+		inline bool GetParallelWorldUpdate() const;
+		inline void SetParallelWorldUpdate( bool bParallelWorldUpdate );
 		//@}
 
 		/// @name Timing
@@ -69,6 +72,8 @@ namespace Helium
 
 		/// True if the first frame has been processed.
 		bool m_bProcessedFirstFrame;
+		/// True if worlds should be updated concurrently on worker threads.
+		bool m_bParallelWorldUpdate;
 
 		/// Singleton instance.
 		static WorldManager* sm_pInstance;
@@ -83,6 +88,14 @@ namespace Helium
 		//@{
 		void UpdateTime();
 		//@}
+
+		/// @name World Updating
+		//@{
+		bool CanUpdateWorldsInParallel( const TaskSchedule &schedule ) const;
+		void UpdateWorldsInParallel( TaskSchedule &schedule );
+		static void UpdateWorldJob( void* pData );
+		static void DestroyDeferredEntities( World* pWorld );
+		//@}
 	};
 }
 
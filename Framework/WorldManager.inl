@@ -35,4 +35,29 @@ namespace Helium
     {
         return m_frameDeltaSeconds;
     }
+
+    /// Get whether worlds are updated concurrently on worker threads.
+    ///
+    /// @return  True if parallel world updates are enabled, false if not.
+    ///
+    /// @see SetParallelWorldUpdate()
+    bool WorldManager::GetParallelWorldUpdate() const
+    {
+        return m_bParallelWorldUpdate;
+    }
+
+    /// Set whether worlds should be updated concurrently on worker threads.
+    ///
+    /// When enabled, each world runs the entire task schedule on its own worker thread, so this should only be turned
+    /// on when worlds share no state (such as a dedicated server hosting one world per match).  Only schedules
+    /// calculated for TickTypes::HeadlessGame are updated in parallel, as rendering and client tasks share the
+    /// renderer, windows and input between worlds.
+    ///
+    /// @param[in] bParallelWorldUpdate  True to enable parallel world updates, false to update worlds in sequence.
+    ///
+    /// @see GetParallelWorldUpdate()
+    void WorldManager::SetParallelWorldUpdate( bool bParallelWorldUpdate )
+    {
+        m_bParallelWorldUpdate = bParallelWorldUpdate;
+    }
 }
\ No newline at end of file
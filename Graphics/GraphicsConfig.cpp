@@ -17,6 +17,7 @@ GraphicsConfig::GraphicsConfig()
 , m_maxAnisotropy( 0 )
 , m_shadowMode( EShadowMode::PCF_DITHERED )
 , m_shadowBufferSize( DEFAULT_SHADOW_BUFFER_SIZE )
+, m_textureStreamingBudget( DEFAULT_TEXTURE_STREAMING_BUDGET )
 , m_bFullscreen( false )
 , m_bVsync( true )
 {
@@ -37,4 +38,5 @@ void GraphicsConfig::PopulateMetaType( Reflect::MetaStruct& comp )
     comp.AddField( &GraphicsConfig::m_maxAnisotropy, TXT( "m_MaxAnisotropy" ) );
     comp.AddField( &GraphicsConfig::m_shadowMode, TXT( "m_ShadowMode" ) );
     comp.AddField( &GraphicsConfig::m_shadowBufferSize, TXT( "m_ShadowBufferSize" ) );
+    comp.AddField( &GraphicsConfig::m_textureStreamingBudget, TXT( "m_TextureStreamingBudget" ) );
 }
@@ -62,6 +62,9 @@ namespace Helium
         /// Default shadow buffer size.
         static const uint32_t DEFAULT_SHADOW_BUFFER_SIZE = 1024;
 
+        /// Default texture streaming budget, in megabytes (zero disables mip streaming).
+        static const uint32_t DEFAULT_TEXTURE_STREAMING_BUDGET = 0;
+
         /// @name Construction/Destruction
         //@{
         GraphicsConfig();
@@ -81,6 +84,8 @@ namespace Helium
         inline EShadowMode GetShadowMode() const;
         inline uint32_t GetShadowBufferSize() const;
 
+        inline uint32_t GetTextureStreamingBudget() const;
+
         inline bool GetFullscreen() const;
         inline bool GetVsync() const;
         //@}
@@ -101,6 +106,9 @@ namespace Helium
         /// Shadow buffer size (width/height, in texels).
         uint32_t m_shadowBufferSize;
 
+        /// Memory budget for streamed texture mip levels, in megabytes (zero to always load full mip chains).
+        uint32_t m_textureStreamingBudget;
+
         /// True to run in fullscreen mode, false to run in windowed mode.
         bool m_bFullscreen;
         /// True to enable vsync.
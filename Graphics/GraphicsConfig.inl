@@ -52,6 +52,14 @@ namespace Helium
         return m_shadowBufferSize;
     }
 
+    /// Get the memory budget for streamed texture mip levels.
+    ///
+    /// @return  Texture streaming budget, in megabytes, or zero if mip streaming is disabled.
+    uint32_t GraphicsConfig::GetTextureStreamingBudget() const
+    {
+        return m_textureStreamingBudget;
+    }
+
     /// Get whether fullscreen mode is enabled.
     ///
     /// @return  True if fullscreen mode is enabled, false if not.
@@ -84,4 +84,25 @@ HELIUM_DEFINE_TASK( GraphicsManagerDrawTask, ForEachWorld< DrawGraphics >, TickT
 void Helium::GraphicsManagerDrawTask::DefineContract( TaskContract &rContract )
 {
 	rContract.ExecutesWithin< Helium::StandardDependencies::Render >();
+}
+
+void UpdateTextureStreaming( DynamicArray< WorldPtr > & )
+{
+	RenderResourceManager* pRenderResourceManager = RenderResourceManager::GetInstance();
+	if ( !pRenderResourceManager )
+	{
+		return;
+	}
+
+	// Update streamed texture residency using the sizes reported while drawing all scenes this frame.
+	pRenderResourceManager->GetTextureStreamingManager().Update();
+}
+
+// Also a render task so that the editor, which draws its scenes on paint, keeps textures streaming.
+HELIUM_DEFINE_TASK( TextureStreamingUpdateTask, UpdateTextureStreaming, TickTypes::Render )
+
+void Helium::TextureStreamingUpdateTask::DefineContract( TaskContract &rContract )
+{
+	rContract.ExecuteAfter< Helium::GraphicsManagerDrawTask >();
+	rContract.ExecutesWithin< Helium::StandardDependencies::Render >();
 }
\ No newline at end of file
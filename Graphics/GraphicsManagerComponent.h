@@ -52,6 +52,13 @@ namespace Helium
 		HELIUM_DECLARE_TASK(GraphicsManagerDrawTask)
 		virtual void DefineContract(TaskContract &rContract);
 	};
+
+	// Updates streamed texture residency once per frame, after every world's graphics scene has been drawn
+	struct HELIUM_GRAPHICS_API TextureStreamingUpdateTask : public TaskDefinition
+	{
+		HELIUM_DECLARE_TASK(TextureStreamingUpdateTask)
+		virtual void DefineContract(TaskContract &rContract);
+	};
 }
 
 #include "Graphics/GraphicsManagerComponent.inl"
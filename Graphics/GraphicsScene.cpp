@@ -37,6 +37,12 @@ HELIUM_DEFINE_COMPONENT( Helium::SceneObjectTransform, 32 );
 static const size_t SCENE_VIEW_BUFFERED_DRAWER_POOL_BLOCK_SIZE = 4;
 #endif // GRAPHICS_SCENE_BUFFERED_DRAWER
 
+/// Minimum number of identical sub-meshes to draw with a single instanced draw call.
+static const size_t INSTANCE_BATCH_COUNT_MIN = 2;
+/// Size of each instance's data in the instance vertex buffer.
+static const uint32_t INSTANCE_VERTEX_STRIDE = static_cast< uint32_t >(
+	UpdateGraphicsSceneObjectBuffersJob::INSTANCE_DATA_FLOAT_COUNT * sizeof( float32_t ) );
+
 namespace Helium
 {
 	HELIUM_DECLARE_RPTR( RRenderCommandProxy );
@@ -56,6 +62,7 @@ GraphicsScene::GraphicsScene()
 	, m_directionalLightDirection( 0.0f, -1.0f, 0.0f )
 	, m_directionalLightColor( 0xffffffff )
 	, m_directionalLightBrightness( 1.0f )
+	, m_instanceVertexBufferCapacity( 0 )
 	, m_activeViewId( Invalid< uint32_t >() )
 	, m_constantBufferSetIndex( 0 )
 {
@@ -129,7 +136,7 @@ void GraphicsScene::Update( World *pWorld )
 	}
 
 	// Update each scene object as necessary.
-	size_t sceneObjectCount = m_sceneObjects.GetSize();
+	//size_t sceneObjectCount = m_sceneObjects.GetSize();
 	//for( size_t objectIndex = 0; objectIndex < sceneObjectCount; ++objectIndex )
 	//{
 	//    if( !m_sceneObjects.IsElementValid( objectIndex ) )
@@ -148,10 +155,6 @@ void GraphicsScene::Update( World *pWorld )
 	// Swap dynamic constant buffers and update their contents.
 	SwapDynamicConstantBuffers();
 
-	// Resize the visible object bit array as necessary.
-	m_visibleSceneObjects.Reserve( sceneObjectCount );
-	m_visibleSceneObjects.Resize( sceneObjectCount );
-
 #if GRAPHICS_SCENE_BUFFERED_DRAWER
 	// Set up the scene's buffered drawer for the current frame.
 	m_sceneBufferedDrawer.BeginDrawing();
@@ -262,7 +265,13 @@ size_t GraphicsScene::AllocateSceneObject()
 	GraphicsSceneObject* pSceneObject = m_sceneObjects.New();
 	HELIUM_ASSERT( pSceneObject );
 
-	return m_sceneObjects.GetElementIndex( pSceneObject );
+	size_t id = m_sceneObjects.GetElementIndex( pSceneObject );
+	if ( id >= m_sceneObjectSubMeshIds.GetSize() )
+	{
+		m_sceneObjectSubMeshIds.Resize( id + 1 );
+	}
+
+	return id;
 }
 
 /// Detach and release a previously allocated scene object.
@@ -275,9 +284,29 @@ void GraphicsScene::ReleaseSceneObject( size_t id )
 	HELIUM_ASSERT( id < m_sceneObjects.GetSize() );
 	HELIUM_ASSERT( m_sceneObjects.IsElementValid( id ) );
 
+	m_cullGrid.RemoveObject( id );
+	m_sceneObjectSubMeshIds[id].Clear();
+
 	m_sceneObjects.Remove( id );
 }
 
+/// Set the world-space bounds of a scene object and update its placement in the culling grid.
+///
+/// Scene objects are only considered for rendering once their bounds have been set through this function.
+///
+/// @param[in] id    ID of the scene object.
+/// @param[in] rBox  World-space axis-aligned bounding box to set.
+///
+/// @see GraphicsSceneObject::SetWorldBounds()
+void GraphicsScene::SetSceneObjectWorldBounds( size_t id, const Simd::AaBox& rBox )
+{
+	HELIUM_ASSERT( id < m_sceneObjects.GetSize() );
+	HELIUM_ASSERT( m_sceneObjects.IsElementValid( id ) );
+
+	m_sceneObjects[id].SetWorldBounds( rBox );
+	m_cullGrid.SetObjectBounds( id, rBox );
+}
+
 /// Allocate new scene object sub-mesh data and add it to the scene.
 ///
 /// @param[in] sceneObjectId  ID of the parent graphics scene object used to control the placement of the sub-mesh
@@ -294,7 +323,10 @@ size_t GraphicsScene::AllocateSceneObjectSubMeshData( size_t sceneObjectId )
 	GraphicsSceneObject::SubMeshData* pSubMeshData = m_sceneObjectSubMeshes.New( sceneObjectId );
 	HELIUM_ASSERT( pSubMeshData );
 
-	return m_sceneObjectSubMeshes.GetElementIndex( pSubMeshData );
+	size_t id = m_sceneObjectSubMeshes.GetElementIndex( pSubMeshData );
+	m_sceneObjectSubMeshIds[sceneObjectId].Push( id );
+
+	return id;
 }
 
 /// Detach and release previously allocated scene object sub-mesh data.
@@ -307,6 +339,20 @@ void GraphicsScene::ReleaseSceneObjectSubMeshData( size_t id )
 	HELIUM_ASSERT( id < m_sceneObjectSubMeshes.GetSize() );
 	HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( id ) );
 
+	// The parent scene object may already have been released, in which case its sub-mesh list was cleared.
+	DynamicArray< size_t >& rSubMeshIds = m_sceneObjectSubMeshIds[m_sceneObjectSubMeshes[id].GetSceneObjectId()];
+	size_t subMeshIdCount = rSubMeshIds.GetSize();
+	for ( size_t subMeshIdIndex = 0; subMeshIdIndex < subMeshIdCount; ++subMeshIdIndex )
+	{
+		if ( rSubMeshIds[subMeshIdIndex] == id )
+		{
+			rSubMeshIds[subMeshIdIndex] = rSubMeshIds.GetLast();
+			rSubMeshIds.Pop();
+
+			break;
+		}
+	}
+
 	m_sceneObjectSubMeshes.Remove( id );
 }
 
@@ -1131,6 +1177,312 @@ void GraphicsScene::SwapDynamicConstantBuffers()
 	}
 }
 
+/// Build the list of sub-meshes belonging to the scene objects that intersect a given frustum.
+///
+/// @param[in]  rFrustum         Frustum to test.
+/// @param[out] rSubMeshIndices  Indices of the visible sub-meshes (unsorted).
+void GraphicsScene::CullSubMeshes( const Simd::Frustum& rFrustum, DynamicArray< size_t >& rSubMeshIndices )
+{
+	m_cullGrid.Cull( rFrustum, m_visibleSceneObjectIds );
+
+	rSubMeshIndices.Resize( 0 );
+
+	size_t visibleObjectCount = m_visibleSceneObjectIds.GetSize();
+	for ( size_t visibleIndex = 0; visibleIndex < visibleObjectCount; ++visibleIndex )
+	{
+		size_t sceneObjectId = m_visibleSceneObjectIds[visibleIndex];
+		HELIUM_ASSERT( m_sceneObjects.IsElementValid( sceneObjectId ) );
+
+		const DynamicArray< size_t >& rSubMeshIds = m_sceneObjectSubMeshIds[sceneObjectId];
+		size_t subMeshIdCount = rSubMeshIds.GetSize();
+		for ( size_t subMeshIdIndex = 0; subMeshIdIndex < subMeshIdCount; ++subMeshIdIndex )
+		{
+			rSubMeshIndices.Push( rSubMeshIds[subMeshIdIndex] );
+		}
+	}
+}
+
+/// Build the sort keys for drawing a list of sub-meshes in front-to-back order along a given direction.
+///
+/// Keys place skinned sub-meshes after all other sub-meshes so that the depth-only vertex shader is switched at most
+/// once, followed by the distance of the sub-mesh's scene object along the given direction.
+///
+/// @param[in] rSubMeshIndices  Indices of the sub-meshes to draw.
+/// @param[in] rDirection       Direction along which sub-meshes should be sorted.
+///
+/// @see BuildMaterialSortKeys(), SortSubMeshKeys()
+void GraphicsScene::BuildFrontToBackSortKeys(
+	const DynamicArray< size_t >& rSubMeshIndices,
+	const Simd::Vector3& rDirection )
+{
+	size_t subMeshIndexCount = rSubMeshIndices.GetSize();
+	m_subMeshSortEntries.Resize( subMeshIndexCount );
+
+	for ( size_t meshIndexIndex = 0; meshIndexIndex < subMeshIndexCount; ++meshIndexIndex )
+	{
+		size_t meshIndex = rSubMeshIndices[meshIndexIndex];
+		HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( meshIndex ) );
+
+		size_t sceneObjectId = m_sceneObjectSubMeshes[meshIndex].GetSceneObjectId();
+		HELIUM_ASSERT( m_sceneObjects.IsElementValid( sceneObjectId ) );
+		const GraphicsSceneObject& rSceneObject = m_sceneObjects[sceneObjectId];
+
+		Simd::Vector3 position = Simd::Vector4ToVector3( rSceneObject.GetTransform().GetRow( 3 ) );
+
+		uint64_t key = GetSortableDepth( position.Dot( rDirection ) );
+		if ( rSceneObject.GetBoneCount() != 0 && rSceneObject.GetBonePalette() )
+		{
+			key |= static_cast< uint64_t >( 1 ) << 63;
+		}
+
+		RadixSortEntry& rEntry = m_subMeshSortEntries[meshIndexIndex];
+		rEntry.key = key;
+		rEntry.value = meshIndex;
+	}
+}
+
+/// Build the sort keys for drawing a list of sub-meshes grouped by shaders and material.
+///
+/// From the most to the least significant bits, keys hold a hash of the vertex shader variant, a hash of the pixel
+/// shader variant, a hash of the material, whether the scene object is skinned, a hash of the scene object's vertex
+/// buffer and a hash of the sub-mesh's index range, so sub-meshes that can be drawn with a single instanced draw call
+/// end up next to each other.  Hash collisions only cost extra state changes or smaller instance batches, never
+/// incorrect rendering.  Sub-meshes without a material sort first, as they are skipped when drawing.
+///
+/// @param[in] rSubMeshIndices  Indices of the sub-meshes to draw.
+///
+/// @see BuildFrontToBackSortKeys(), SortSubMeshKeys()
+void GraphicsScene::BuildMaterialSortKeys( const DynamicArray< size_t >& rSubMeshIndices )
+{
+	size_t subMeshIndexCount = rSubMeshIndices.GetSize();
+	m_subMeshSortEntries.Resize( subMeshIndexCount );
+
+	for ( size_t meshIndexIndex = 0; meshIndexIndex < subMeshIndexCount; ++meshIndexIndex )
+	{
+		size_t meshIndex = rSubMeshIndices[meshIndexIndex];
+		HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( meshIndex ) );
+
+		const GraphicsSceneObject::SubMeshData& rSubMeshData = m_sceneObjectSubMeshes[meshIndex];
+
+		uint64_t key = 0;
+
+		Material* pMaterial = rSubMeshData.GetMaterial();
+		if ( pMaterial )
+		{
+			size_t sceneObjectId = rSubMeshData.GetSceneObjectId();
+			HELIUM_ASSERT( m_sceneObjects.IsElementValid( sceneObjectId ) );
+			const GraphicsSceneObject& rSceneObject = m_sceneObjects[sceneObjectId];
+
+			uint64_t indexRange =
+				( static_cast< uint64_t >( rSubMeshData.GetStartIndex() ) << 32 ) | rSubMeshData.GetPrimitiveCount();
+
+			key = ( GetSortKeyHash( pMaterial->GetShaderVariant( RShader::TYPE_VERTEX ), 13 ) << 51 ) |
+				( GetSortKeyHash( pMaterial->GetShaderVariant( RShader::TYPE_PIXEL ), 13 ) << 38 ) |
+				( GetSortKeyHash( pMaterial, 14 ) << 24 ) |
+				( GetSortKeyHash( rSceneObject.GetVertexBuffer(), 12 ) << 11 ) |
+				GetSortKeyValueHash( indexRange, 11 );
+
+			if ( rSceneObject.GetBoneCount() != 0 && rSceneObject.GetBonePalette() )
+			{
+				key |= static_cast< uint64_t >( 1 ) << 23;
+			}
+
+			// Keep materials clear of the key reserved for sub-meshes that are not drawn.
+			key |= ( key == 0 );
+		}
+
+		RadixSortEntry& rEntry = m_subMeshSortEntries[meshIndexIndex];
+		rEntry.key = key;
+		rEntry.value = meshIndex;
+	}
+}
+
+/// Sort the sub-mesh sort keys built by BuildFrontToBackSortKeys() or BuildMaterialSortKeys().
+///
+/// @see BuildFrontToBackSortKeys(), BuildMaterialSortKeys()
+void GraphicsScene::SortSubMeshKeys()
+{
+	size_t entryCount = m_subMeshSortEntries.GetSize();
+	if ( m_subMeshSortScratch.GetSize() < entryCount )
+	{
+		m_subMeshSortScratch.Resize( entryCount );
+	}
+
+	RadixSortJob job;
+	RadixSortJob::Parameters& rParameters = job.GetParameters();
+	rParameters.pBase = m_subMeshSortEntries.GetData();
+	rParameters.pScratch = m_subMeshSortScratch.GetData();
+	rParameters.count = entryCount;
+	job.Run();
+}
+
+/// Get whether a sub-mesh can be drawn using hardware instancing.
+///
+/// @param[in] subMeshIndex  Index of the sub-mesh.
+///
+/// @return  True if the sub-mesh belongs to a non-skinned static mesh with a material, false if not.
+///
+/// @see CanBatchSubMeshes(), PrepareInstanceBatches()
+bool GraphicsScene::CanInstanceSubMesh( size_t subMeshIndex ) const
+{
+	HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( subMeshIndex ) );
+	const GraphicsSceneObject::SubMeshData& rSubMeshData = m_sceneObjectSubMeshes[subMeshIndex];
+	if ( !rSubMeshData.GetMaterial() )
+	{
+		return false;
+	}
+
+	size_t sceneObjectId = rSubMeshData.GetSceneObjectId();
+	HELIUM_ASSERT( m_sceneObjects.IsElementValid( sceneObjectId ) );
+	const GraphicsSceneObject& rSceneObject = m_sceneObjects[sceneObjectId];
+	if ( rSceneObject.GetBoneCount() != 0 && rSceneObject.GetBonePalette() )
+	{
+		return false;
+	}
+
+	return ( rSceneObject.GetVertexBuffer() && rSceneObject.GetIndexBuffer() &&
+		GetInstancedVertexDescription( rSceneObject.GetVertexDescription() ) );
+}
+
+/// Get whether a sub-mesh can be drawn as an instance in the same instanced draw call as another sub-mesh.
+///
+/// @param[in] firstSubMeshIndex  Index of the first sub-mesh in the batch (CanInstanceSubMesh() must be true for it).
+/// @param[in] subMeshIndex       Index of the sub-mesh to test.
+///
+/// @return  True if both sub-meshes share the same material, geometry buffers and index range, false if not.
+///
+/// @see CanInstanceSubMesh(), PrepareInstanceBatches()
+bool GraphicsScene::CanBatchSubMeshes( size_t firstSubMeshIndex, size_t subMeshIndex ) const
+{
+	HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( firstSubMeshIndex ) );
+	HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( subMeshIndex ) );
+	const GraphicsSceneObject::SubMeshData& rFirstSubMeshData = m_sceneObjectSubMeshes[firstSubMeshIndex];
+	const GraphicsSceneObject::SubMeshData& rSubMeshData = m_sceneObjectSubMeshes[subMeshIndex];
+
+	if ( rSubMeshData.GetMaterial() != rFirstSubMeshData.GetMaterial() ||
+		rSubMeshData.GetPrimitiveType() != rFirstSubMeshData.GetPrimitiveType() ||
+		rSubMeshData.GetPrimitiveCount() != rFirstSubMeshData.GetPrimitiveCount() ||
+		rSubMeshData.GetStartVertex() != rFirstSubMeshData.GetStartVertex() ||
+		rSubMeshData.GetVertexRange() != rFirstSubMeshData.GetVertexRange() ||
+		rSubMeshData.GetStartIndex() != rFirstSubMeshData.GetStartIndex() )
+	{
+		return false;
+	}
+
+	const GraphicsSceneObject& rFirstSceneObject = m_sceneObjects[rFirstSubMeshData.GetSceneObjectId()];
+	const GraphicsSceneObject& rSceneObject = m_sceneObjects[rSubMeshData.GetSceneObjectId()];
+	if ( rSceneObject.GetBoneCount() != 0 && rSceneObject.GetBonePalette() )
+	{
+		return false;
+	}
+
+	return ( rSceneObject.GetVertexBuffer() == rFirstSceneObject.GetVertexBuffer() &&
+		rSceneObject.GetVertexStride() == rFirstSceneObject.GetVertexStride() &&
+		rSceneObject.GetVertexDescription() == rFirstSceneObject.GetVertexDescription() &&
+		rSceneObject.GetIndexBuffer() == rFirstSceneObject.GetIndexBuffer() );
+}
+
+/// Group runs of identical sub-meshes in the sorted sub-mesh list into instanced draw batches and write the transforms
+/// of their scene objects to the instance vertex buffer.
+///
+/// BuildMaterialSortKeys() places sub-meshes sharing the same material, vertex buffer and index range next to each
+/// other, so each run of sub-meshes that can share an instanced draw call is found with a single pass over the sorted
+/// list.
+///
+/// @see CanInstanceSubMesh(), CanBatchSubMeshes()
+void GraphicsScene::PrepareInstanceBatches()
+{
+	m_instanceBatches.Resize( 0 );
+	m_instanceSceneObjectIds.Resize( 0 );
+
+	size_t entryCount = m_subMeshSortEntries.GetSize();
+	size_t entryIndex = 0;
+	while ( entryIndex < entryCount )
+	{
+		size_t firstSubMeshIndex = m_subMeshSortEntries[entryIndex].value;
+
+		size_t batchCount = 1;
+		if ( CanInstanceSubMesh( firstSubMeshIndex ) )
+		{
+			while ( entryIndex + batchCount < entryCount &&
+				CanBatchSubMeshes( firstSubMeshIndex, m_subMeshSortEntries[entryIndex + batchCount].value ) )
+			{
+				++batchCount;
+			}
+		}
+
+		if ( batchCount >= INSTANCE_BATCH_COUNT_MIN )
+		{
+			InstanceBatch* pBatch = m_instanceBatches.New();
+			HELIUM_ASSERT( pBatch );
+			pBatch->sortEntryIndex = entryIndex;
+			pBatch->count = batchCount;
+			pBatch->instanceOffset = m_instanceSceneObjectIds.GetSize();
+
+			for ( size_t batchIndex = 0; batchIndex < batchCount; ++batchIndex )
+			{
+				size_t subMeshIndex = m_subMeshSortEntries[entryIndex + batchIndex].value;
+				m_instanceSceneObjectIds.Push( m_sceneObjectSubMeshes[subMeshIndex].GetSceneObjectId() );
+			}
+		}
+
+		entryIndex += batchCount;
+	}
+
+	size_t instanceCount = m_instanceSceneObjectIds.GetSize();
+	if ( instanceCount == 0 )
+	{
+		return;
+	}
+
+	// Grow the instance vertex buffer as needed.
+	if ( instanceCount > m_instanceVertexBufferCapacity )
+	{
+		Renderer* pRenderer = Renderer::GetInstance();
+		HELIUM_ASSERT( pRenderer );
+
+		size_t capacity = Max( instanceCount, m_instanceVertexBufferCapacity * 2 );
+		m_spInstanceVertexBuffer = pRenderer->CreateVertexBuffer(
+			capacity * INSTANCE_VERTEX_STRIDE,
+			RENDERER_BUFFER_USAGE_DYNAMIC );
+		if ( !m_spInstanceVertexBuffer )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				( TXT( "GraphicsScene::PrepareInstanceBatches(): Instance vertex buffer creation failed (%" ) PRIuSZ
+				TXT( " instances)!\n" ) ),
+				capacity );
+
+			m_instanceVertexBufferCapacity = 0;
+			m_instanceBatches.Resize( 0 );
+
+			return;
+		}
+
+		m_instanceVertexBufferCapacity = capacity;
+	}
+
+	float32_t* pInstanceData = static_cast< float32_t* >(
+		m_spInstanceVertexBuffer->Map( RENDERER_BUFFER_MAP_HINT_DISCARD ) );
+	if ( !pInstanceData )
+	{
+		m_instanceBatches.Resize( 0 );
+
+		return;
+	}
+
+	UpdateGraphicsSceneObjectBuffersJob job;
+	UpdateGraphicsSceneObjectBuffersJob::Parameters& rParameters = job.GetParameters();
+	rParameters.sceneObjectCount = static_cast< uint32_t >( m_sceneObjects.GetSize() );
+	rParameters.pSceneObjects = m_sceneObjects.GetData();
+	rParameters.pInstanceSceneObjectIndices = m_instanceSceneObjectIds.GetData();
+	rParameters.pInstanceData = pInstanceData;
+	rParameters.instanceCount = static_cast< uint32_t >( instanceCount );
+	job.Run();
+
+	m_spInstanceVertexBuffer->Unmap();
+}
+
 /// Render the specified scene view.
 ///
 /// @param[in] viewIndex  Index of the scene view to render (can be an invalid element, but must be less than the size
@@ -1158,41 +1510,8 @@ void GraphicsScene::DrawSceneView( uint_fast32_t viewIndex )
 		return;
 	}
 
-	// Determine which scene objects are visible in the current view.
-	m_visibleSceneObjects.UnsetAll();
-
-	const Simd::Frustum& rViewFrustum = rView.GetFrustum();
-
-	size_t sceneObjectCount = m_sceneObjects.GetSize();
-	for ( size_t sceneObjectIndex = 0; sceneObjectIndex < sceneObjectCount; ++sceneObjectIndex )
-	{
-		if ( m_sceneObjects.IsElementValid( sceneObjectIndex ) )
-		{
-			//const AaBox& rObjectBounds = m_sceneObjects[ sceneObjectIndex ].GetWorldBox();
-			const Simd::Sphere& rObjectBounds = m_sceneObjects[sceneObjectIndex].GetWorldSphere();
-			if ( rViewFrustum.Intersects( rObjectBounds ) )
-			{
-				m_visibleSceneObjects.SetElement( sceneObjectIndex );
-			}
-		}
-	}
-
 	// Build a list of indices for each visible sub-mesh for sorting.
-	m_sceneObjectSubMeshIndices.Resize( 0 );
-
-	size_t subMeshCount = m_sceneObjectSubMeshes.GetSize();
-	for ( size_t subMeshIndex = 0; subMeshIndex < subMeshCount; ++subMeshIndex )
-	{
-		if ( m_sceneObjectSubMeshes.IsElementValid( subMeshIndex ) )
-		{
-			size_t sceneObjectId = m_sceneObjectSubMeshes[subMeshIndex].GetSceneObjectId();
-			HELIUM_ASSERT( sceneObjectId < m_visibleSceneObjects.GetSize() );
-			if ( m_visibleSceneObjects[sceneObjectId] )
-			{
-				m_sceneObjectSubMeshIndices.Push( subMeshIndex );
-			}
-		}
-	}
+	CullSubMeshes( rView.GetFrustum(), m_sceneObjectSubMeshIndices );
 
 	// Get the renderer interface and the main command proxy for the renderer.
 	Renderer* pRenderer = Renderer::GetInstance();
@@ -1355,8 +1674,8 @@ void GraphicsScene::DrawSceneView( uint_fast32_t viewIndex )
 
 /// Draw the shadow depth render pass.
 ///
-/// - The m_sceneObjectSubMeshIndices array should already be prepared with the (unsorted) list of visible sub
-///   meshes.  This function will sort by depth if rendering is performed.
+/// - Shadow casters are culled against the shadow view frustum, so objects outside of the scene view can still cast
+///   shadows into it.
 /// - Default rasterizer and depth states should be already set.
 ///
 /// @param[in] viewIndex  Index of the view for which the shadow depth pass is being rendered.
@@ -1439,23 +1758,18 @@ void GraphicsScene::DrawShadowDepthPass( uint_fast32_t viewIndex )
 	RSurfacePtr spShadowDepthTextureSurface = pShadowDepthTexture->GetSurface( 0 );
 	HELIUM_ASSERT( spShadowDepthTextureSurface );
 
-	// Sort meshes based on distance from front to back in order to reduce overdraw.
-	size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
+	// Gather the sub-meshes of each shadow caster visible to the shadow view.
+	HELIUM_ASSERT( viewIndex < m_shadowViewInverseViewProjectionMatrices.GetSize() );
 
-	{
-		SortJob< size_t, SubMeshFrontToBackCompare > job;
+	Simd::Frustum shadowFrustum;
+	shadowFrustum.Set( m_shadowViewInverseViewProjectionMatrices[viewIndex].GetTranspose() );
+	CullSubMeshes( shadowFrustum, m_shadowSceneObjectSubMeshIndices );
 
-		SortJob< size_t, SubMeshFrontToBackCompare >::Parameters& rParameters = job.GetParameters();
-		rParameters.pBase = m_sceneObjectSubMeshIndices.GetData();
-		rParameters.count = subMeshIndexCount;
-		rParameters.compare = SubMeshFrontToBackCompare(
-			m_directionalLightDirection,
-			m_sceneObjects,
-			m_sceneObjectSubMeshes );
-		rParameters.singleJobCount = 100;
+	// Sort meshes based on distance from front to back in order to reduce overdraw.
+	BuildFrontToBackSortKeys( m_shadowSceneObjectSubMeshIndices, m_directionalLightDirection );
+	SortSubMeshKeys();
 
-		job.Run();
-	}
+	size_t subMeshIndexCount = m_subMeshSortEntries.GetSize();
 
 	// Prepare the shadow depth pass scene for rendering.
 	Renderer* pRenderer = Renderer::GetInstance();
@@ -1488,10 +1802,14 @@ void GraphicsScene::DrawShadowDepthPass( uint_fast32_t viewIndex )
 	spCommandProxy->SetPixelShader( NULL );
 
 	RVertexShader* pPreviousVertexShader = NULL;
+	RVertexBuffer* pPreviousVertexBuffer = NULL;
+	uint32_t previousVertexStride = 0;
+	RIndexBuffer* pPreviousIndexBuffer = NULL;
+	RVertexInputLayout* pPreviousInputLayout = NULL;
 
 	for ( size_t meshIndexIndex = 0; meshIndexIndex < subMeshIndexCount; ++meshIndexIndex )
 	{
-		size_t meshIndex = m_sceneObjectSubMeshIndices[meshIndexIndex];
+		size_t meshIndex = m_subMeshSortEntries[meshIndexIndex].value;
 		HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( meshIndex ) );
 
 		GraphicsSceneObject::SubMeshData& rSubMeshData = m_sceneObjectSubMeshes[meshIndex];
@@ -1566,9 +1884,25 @@ void GraphicsScene::DrawShadowDepthPass( uint_fast32_t viewIndex )
 		}
 
 		spCommandProxy->SetVertexConstantBuffers( 1, 1, &pInstanceVertexGlobalDataBuffer );
-		spCommandProxy->SetVertexBuffers( 0, 1, &pVertexBuffer, &vertexStride, &offset );
-		spCommandProxy->SetIndexBuffer( pIndexBuffer );
-		spCommandProxy->SetVertexInputLayout( pInputLayout );
+
+		if ( pVertexBuffer != pPreviousVertexBuffer || vertexStride != previousVertexStride )
+		{
+			spCommandProxy->SetVertexBuffers( 0, 1, &pVertexBuffer, &vertexStride, &offset );
+			pPreviousVertexBuffer = pVertexBuffer;
+			previousVertexStride = vertexStride;
+		}
+
+		if ( pIndexBuffer != pPreviousIndexBuffer )
+		{
+			spCommandProxy->SetIndexBuffer( pIndexBuffer );
+			pPreviousIndexBuffer = pIndexBuffer;
+		}
+
+		if ( pInputLayout != pPreviousInputLayout )
+		{
+			spCommandProxy->SetVertexInputLayout( pInputLayout );
+			pPreviousInputLayout = pInputLayout;
+		}
 
 		spCommandProxy->DrawIndexed(
 			primitiveType,
@@ -1648,17 +1982,10 @@ void GraphicsScene::DrawDepthPrePass( uint_fast32_t viewIndex )
 	GraphicsSceneView& rView = m_sceneViews[viewIndex];
 	const Simd::Vector3& rViewDirection = rView.GetForward();
 
-	size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
+	BuildFrontToBackSortKeys( m_sceneObjectSubMeshIndices, rViewDirection );
+	SortSubMeshKeys();
 
-	{
-		SortJob< size_t, SubMeshFrontToBackCompare > job;
-		SortJob< size_t, SubMeshFrontToBackCompare >::Parameters& rParameters = job.GetParameters();
-		rParameters.pBase = m_sceneObjectSubMeshIndices.GetData();
-		rParameters.count = subMeshIndexCount;
-		rParameters.compare = SubMeshFrontToBackCompare( rViewDirection, m_sceneObjects, m_sceneObjectSubMeshes );
-		rParameters.singleJobCount = 100;
-		job.Run();
-	}
+	size_t subMeshIndexCount = m_subMeshSortEntries.GetSize();
 
 	// Initialize the blend state and shaders for performing no color writes.
 	Renderer* pRenderer = Renderer::GetInstance();
@@ -1675,10 +2002,14 @@ void GraphicsScene::DrawDepthPrePass( uint_fast32_t viewIndex )
 
 	// Draw each visible mesh instance.
 	RVertexShader* pPreviousVertexShader = NULL;
+	RVertexBuffer* pPreviousVertexBuffer = NULL;
+	uint32_t previousVertexStride = 0;
+	RIndexBuffer* pPreviousIndexBuffer = NULL;
+	RVertexInputLayout* pPreviousInputLayout = NULL;
 
 	for ( size_t meshIndexIndex = 0; meshIndexIndex < subMeshIndexCount; ++meshIndexIndex )
 	{
-		size_t meshIndex = m_sceneObjectSubMeshIndices[meshIndexIndex];
+		size_t meshIndex = m_subMeshSortEntries[meshIndexIndex].value;
 		HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( meshIndex ) );
 
 		GraphicsSceneObject::SubMeshData& rSubMeshData = m_sceneObjectSubMeshes[meshIndex];
@@ -1753,9 +2084,25 @@ void GraphicsScene::DrawDepthPrePass( uint_fast32_t viewIndex )
 		}
 
 		spCommandProxy->SetVertexConstantBuffers( 1, 1, &pInstanceVertexGlobalDataBuffer );
-		spCommandProxy->SetVertexBuffers( 0, 1, &pVertexBuffer, &vertexStride, &offset );
-		spCommandProxy->SetIndexBuffer( pIndexBuffer );
-		spCommandProxy->SetVertexInputLayout( pInputLayout );
+
+		if ( pVertexBuffer != pPreviousVertexBuffer || vertexStride != previousVertexStride )
+		{
+			spCommandProxy->SetVertexBuffers( 0, 1, &pVertexBuffer, &vertexStride, &offset );
+			pPreviousVertexBuffer = pVertexBuffer;
+			previousVertexStride = vertexStride;
+		}
+
+		if ( pIndexBuffer != pPreviousIndexBuffer )
+		{
+			spCommandProxy->SetIndexBuffer( pIndexBuffer );
+			pPreviousIndexBuffer = pIndexBuffer;
+		}
+
+		if ( pInputLayout != pPreviousInputLayout )
+		{
+			spCommandProxy->SetVertexInputLayout( pInputLayout );
+			pPreviousInputLayout = pInputLayout;
+		}
 
 		spCommandProxy->DrawIndexed(
 			primitiveType,
@@ -1776,6 +2123,8 @@ void GraphicsScene::DrawDepthPrePass( uint_fast32_t viewIndex )
 /// - Default rasterizer and depth states should be already set.
 /// - Global per-view constant buffers should be already set (buffers specific to the base pass will be set by this
 ///   function).
+/// - Runs of identical non-skinned sub-meshes are drawn with a single instanced draw call when the material shader
+///   provides an instanced variant.
 ///
 /// @param[in] viewIndex  Index of the view for which the base pass is being rendered.
 ///
@@ -1785,6 +2134,8 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 	HELIUM_ASSERT( viewIndex < m_sceneViews.GetSize() );
 	HELIUM_ASSERT( m_sceneViews.IsElementValid( viewIndex ) );
 
+	const GraphicsSceneView& rView = m_sceneViews[viewIndex];
+
 	// Make sure per-view constant buffers for the base pass exist.
 	RConstantBuffer* pViewVertexBasePassDataBuffer =
 		m_viewVertexBasePassDataBuffers[m_constantBufferSetIndex][viewIndex];
@@ -1829,19 +2180,13 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 
 	systemSelections[0].choice = shadowSelectOptions[shadowMode];
 
-	// Sort meshes based on material in order to reduce shader switches.
-	size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
-
-	{
-		SortJob< size_t, SubMeshMaterialCompare > job;
-		SortJob< size_t, SubMeshMaterialCompare >::Parameters& rParameters = job.GetParameters();
-		rParameters.pBase = m_sceneObjectSubMeshIndices.GetData();
-		rParameters.count = subMeshIndexCount;
-		rParameters.compare = SubMeshMaterialCompare( m_sceneObjectSubMeshes );
-		rParameters.singleJobCount = 100;
+	// Sort meshes based on shaders and material in order to reduce state changes, then group identical static meshes
+	// for instanced drawing.
+	BuildMaterialSortKeys( m_sceneObjectSubMeshIndices );
+	SortSubMeshKeys();
+	PrepareInstanceBatches();
 
-		job.Run();
-	}
+	size_t subMeshIndexCount = m_subMeshSortEntries.GetSize();
 
 	// Set the opaque rendering blend state and per-view constant buffers for this pass.
 	Renderer* pRenderer = Renderer::GetInstance();
@@ -1875,10 +2220,27 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 	RPixelShader* pPreviousPixelShader = NULL;
 	RConstantBuffer* pPreviousMaterialVertexConstantBuffer = NULL;
 	RConstantBuffer* pPreviousMaterialPixelConstantBuffer = NULL;
+	RVertexBuffer* pPreviousVertexBuffer = NULL;
+	uint32_t previousVertexStride = 0;
+	RIndexBuffer* pPreviousIndexBuffer = NULL;
+	RVertexInputLayout* pPreviousInputLayout = NULL;
+
+	Name instancedToggleName = GetInstancedToggleName();
+	size_t instanceBatchCount = m_instanceBatches.GetSize();
+	size_t instanceBatchIndex = 0;
 
 	for ( size_t meshIndexIndex = 0; meshIndexIndex < subMeshIndexCount; ++meshIndexIndex )
 	{
-		size_t meshIndex = m_sceneObjectSubMeshIndices[meshIndexIndex];
+		// Check whether this sub-mesh starts a batch of sub-meshes that can be drawn with a single instanced call.
+		const InstanceBatch* pInstanceBatch = NULL;
+		if ( instanceBatchIndex < instanceBatchCount &&
+			m_instanceBatches[instanceBatchIndex].sortEntryIndex == meshIndexIndex )
+		{
+			pInstanceBatch = &m_instanceBatches[instanceBatchIndex];
+			++instanceBatchIndex;
+		}
+
+		size_t meshIndex = m_subMeshSortEntries[meshIndexIndex].value;
 		HELIUM_ASSERT( m_sceneObjectSubMeshes.IsElementValid( meshIndex ) );
 
 		GraphicsSceneObject::SubMeshData& rSubMeshData = m_sceneObjectSubMeshes[meshIndex];
@@ -1988,6 +2350,43 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 			continue;
 		}
 
+		// Switch to the instanced vertex shader variant for batched sub-meshes.  Shaders that do not support
+		// instancing ignore the toggle, in which case each sub-mesh in the batch is drawn individually.
+		if ( pInstanceBatch )
+		{
+			RVertexShader* pInstancedVertexShader = NULL;
+			RVertexInputLayout* pInstancedInputLayout = NULL;
+
+			size_t instancedVertexShaderIndex = rSystemOptions.GetOptionSetIndex(
+				RShader::TYPE_VERTEX,
+				&instancedToggleName,
+				1,
+				systemSelections,
+				HELIUM_ARRAY_COUNT( systemSelections ) );
+			if ( instancedVertexShaderIndex != vertexShaderIndex )
+			{
+				pInstancedVertexShader = static_cast<RVertexShader*>(
+					pVertexShaderVariant->GetRenderResource( instancedVertexShaderIndex ) );
+			}
+
+			RVertexDescription* pInstancedVertexDescription = GetInstancedVertexDescription( pVertexDescription );
+			if ( pInstancedVertexShader && pInstancedVertexDescription )
+			{
+				pInstancedVertexShader->CacheDescription( pRenderer, pInstancedVertexDescription );
+				pInstancedInputLayout = pInstancedVertexShader->GetCachedInputLayout();
+			}
+
+			if ( pInstancedInputLayout )
+			{
+				pVertexShader = pInstancedVertexShader;
+				pInputLayout = pInstancedInputLayout;
+			}
+			else
+			{
+				pInstanceBatch = NULL;
+			}
+		}
+
 		RConstantBuffer* pMaterialVertexConstantBuffer = pMaterial->GetConstantBuffer(
 			RShader::TYPE_VERTEX );
 		RConstantBuffer* pMaterialPixelConstantBuffer = pMaterial->GetConstantBuffer(
@@ -2016,8 +2415,18 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 			pPreviousMaterialPixelConstantBuffer = pMaterialPixelConstantBuffer;
 		}
 
-		spCommandProxy->SetVertexBuffers( 0, 1, &pVertexBuffer, &vertexStride, &offset );
-		spCommandProxy->SetIndexBuffer( pIndexBuffer );
+		if ( pVertexBuffer != pPreviousVertexBuffer || vertexStride != previousVertexStride )
+		{
+			spCommandProxy->SetVertexBuffers( 0, 1, &pVertexBuffer, &vertexStride, &offset );
+			pPreviousVertexBuffer = pVertexBuffer;
+			previousVertexStride = vertexStride;
+		}
+
+		if ( pIndexBuffer != pPreviousIndexBuffer )
+		{
+			spCommandProxy->SetIndexBuffer( pIndexBuffer );
+			pPreviousIndexBuffer = pIndexBuffer;
+		}
 
 		if ( pVertexShader != pPreviousVertexShader )
 		{
@@ -2031,7 +2440,11 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 			pPreviousPixelShader = pPixelShader;
 		}
 
-		spCommandProxy->SetVertexInputLayout( pInputLayout );
+		if ( pInputLayout != pPreviousInputLayout )
+		{
+			spCommandProxy->SetVertexInputLayout( pInputLayout );
+			pPreviousInputLayout = pInputLayout;
+		}
 
 		const ShaderSamplerInfoSet* pSamplerInfoSet = pPixelShaderVariant->GetSamplerInfoSet( pixelShaderIndex );
 		if ( pSamplerInfoSet )
@@ -2063,6 +2476,18 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 		{
 			size_t materialTextureCount = pMaterial->GetTextureParameterCount();
 
+			// Report the on-screen size of the sub-meshes drawn so that streamed textures keep enough mip levels.
+			float32_t screenSize = GetProjectedSize( rView, rSceneObject );
+			if ( pInstanceBatch )
+			{
+				for ( size_t batchIndex = 1; batchIndex < pInstanceBatch->count; ++batchIndex )
+				{
+					size_t batchMeshIndex = m_subMeshSortEntries[meshIndexIndex + batchIndex].value;
+					size_t batchObjectId = m_sceneObjectSubMeshes[batchMeshIndex].GetSceneObjectId();
+					screenSize = Max( screenSize, GetProjectedSize( rView, m_sceneObjects[batchObjectId] ) );
+				}
+			}
+
 			const DynamicArray< ShaderTextureInfo >& textureInputs = pTextureInfoSet->inputs;
 			size_t textureInputCount = textureInputs.GetSize();
 			for ( size_t inputIndex = 0; inputIndex < textureInputCount; ++inputIndex )
@@ -2089,6 +2514,7 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 							Texture* pTexture = rTextureParameter.value;
 							if ( pTexture )
 							{
+								pTexture->ReportScreenSize( screenSize );
 								pTextureResource = pTexture->GetRenderResource();
 							}
 
@@ -2101,16 +2527,108 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
 			}
 		}
 
-		spCommandProxy->DrawIndexed(
-			primitiveType,
-			startVertex,
-			0,
-			vertexRange,
-			startIndex,
-			primitiveCount );
+		if ( pInstanceBatch )
+		{
+			RVertexBuffer* pInstanceVertexBuffer = m_spInstanceVertexBuffer;
+			uint32_t instanceStride = INSTANCE_VERTEX_STRIDE;
+			uint32_t instanceOffset = static_cast<uint32_t>( pInstanceBatch->instanceOffset * INSTANCE_VERTEX_STRIDE );
+			spCommandProxy->SetVertexBuffers( 1, 1, &pInstanceVertexBuffer, &instanceStride, &instanceOffset );
+
+			spCommandProxy->DrawIndexedInstanced(
+				primitiveType,
+				startVertex,
+				0,
+				vertexRange,
+				startIndex,
+				primitiveCount,
+				static_cast<uint32_t>( pInstanceBatch->count ) );
+
+			// Skip the remaining sub-meshes in the batch.
+			meshIndexIndex += pInstanceBatch->count - 1;
+		}
+		else
+		{
+			spCommandProxy->DrawIndexed(
+				primitiveType,
+				startVertex,
+				0,
+				vertexRange,
+				startIndex,
+				primitiveCount );
+		}
 	}
 }
 
+/// Convert a depth value to an unsigned integer that sorts in the same order as the original floating-point value.
+///
+/// @param[in] depth  Depth value.
+///
+/// @return  Sortable integer representation of the depth.
+uint64_t GraphicsScene::GetSortableDepth( float32_t depth )
+{
+	Float32 depthPacker;
+	depthPacker.value = depth;
+
+	// Flip every bit of negative values (so larger magnitudes sort first) and only the sign bit of positive values.
+	uint32_t packed = depthPacker.packed;
+	packed ^= ( ( packed & 0x80000000 ) ? 0xffffffff : 0x80000000 );
+
+	return packed;
+}
+
+/// Reduce a pointer to a hash of a given number of bits for use in sort keys.
+///
+/// @param[in] pObject   Pointer to hash (can be null).
+/// @param[in] bitCount  Number of bits in the hash (must be between 1 and 63).
+///
+/// @return  Pointer hash.
+uint64_t GraphicsScene::GetSortKeyHash( const void* pObject, uint32_t bitCount )
+{
+	HELIUM_ASSERT( bitCount > 0 && bitCount < 64 );
+
+	// Fibonacci hashing spreads out the upper bits for pointers sharing the same alignment and allocation pool.
+	return GetSortKeyValueHash( static_cast< uint64_t >( reinterpret_cast< uintptr_t >( pObject ) ), bitCount );
+}
+
+/// Reduce a value to a hash of a given number of bits for use in sort keys.
+///
+/// @param[in] value     Value to hash.
+/// @param[in] bitCount  Number of bits in the hash (must be between 1 and 63).
+///
+/// @return  Value hash.
+uint64_t GraphicsScene::GetSortKeyValueHash( uint64_t value, uint32_t bitCount )
+{
+	HELIUM_ASSERT( bitCount > 0 && bitCount < 64 );
+
+	return ( value * 0x9e3779b97f4a7c15ULL ) >> ( 64 - bitCount );
+}
+
+/// Estimate the on-screen size of a scene object.
+///
+/// @param[in] rView         View in which the object is drawn.
+/// @param[in] rSceneObject  Scene object.
+///
+/// @return  Approximate size, in pixels, of the object's world bounds when projected into the view.
+float32_t GraphicsScene::GetProjectedSize( const GraphicsSceneView& rView, const GraphicsSceneObject& rSceneObject )
+{
+	const Simd::AaBox& rBox = rSceneObject.GetWorldBox();
+	float32_t diameter = ( rBox.GetMaximum() - rBox.GetMinimum() ).GetMagnitude();
+
+	const Simd::Matrix44& rProjectionMatrix = rView.GetProjectionMatrix();
+	float32_t size =
+		diameter * Abs( rProjectionMatrix.GetElement( 0 ) ) * static_cast<float32_t>( rView.GetViewportWidth() ) * 0.5f;
+
+	// Perspective projections also scale by the inverse of the distance to the nearest point of the bounds.
+	if ( rProjectionMatrix.GetElement( 11 ) != 0.0f )
+	{
+		Simd::Vector3 position = Simd::Vector4ToVector3( rSceneObject.GetTransform().GetRow( 3 ) );
+		float32_t distance = ( position - rView.GetOrigin() ).GetMagnitude() - diameter * 0.5f;
+		size /= Max( distance, HELIUM_EPSILON );
+	}
+
+	return size;
+}
+
 /// Get a name identifier for "NONE" select options.
 ///
 /// @return  Name for the string "NONE".
@@ -2157,111 +2675,41 @@ Name GraphicsScene::GetSkinningRigidOptionName()
 	return skinningRigidOptionName;
 }
 
-/// Constructor.
-GraphicsScene::SubMeshFrontToBackCompare::SubMeshFrontToBackCompare()
-	: m_cameraDirection( 0.0f )
-	, m_pSceneObjects( NULL )
-	, m_pSubMeshes( NULL )
-{
-}
-
-/// Constructor.
-///
-/// @param[in] rCameraDirection  Camera world direction.
-/// @param[in] rSceneObjects     List of graphics scene objects in the scene.
-/// @param[in] rSubMeshes        List of scene object sub-meshes in the scene.
-GraphicsScene::SubMeshFrontToBackCompare::SubMeshFrontToBackCompare(
-	const Simd::Vector3& rCameraDirection,
-	const SparseArray< GraphicsSceneObject >& rSceneObjects,
-	const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes )
-	: m_cameraDirection( rCameraDirection )
-	, m_pSceneObjects( &rSceneObjects )
-	, m_pSubMeshes( &rSubMeshes )
-{
-}
-
-/// Compare two sub-meshes for sorting.
-///
-/// @param[in] subMeshIndex0  Index of the first sub-mesh to compare.
-/// @param[in] subMeshIndex1  Index of the second sub-mesh to compare.
+/// Get the name of the instancing system toggle for shaders.
 ///
-/// @return  True if the first sub-mesh should be sorted before the second, false if it should be sorted after or if
-///          they share the same sorting priority.
-bool GraphicsScene::SubMeshFrontToBackCompare::operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const
+/// @return  Instancing toggle name.
+Name GraphicsScene::GetInstancedToggleName()
 {
-	const GraphicsSceneObject::SubMeshData& rSubMesh0 = m_pSubMeshes->GetElement( subMeshIndex0 );
-	const GraphicsSceneObject::SubMeshData& rSubMesh1 = m_pSubMeshes->GetElement( subMeshIndex1 );
-
-	size_t sceneObjectIndex0 = rSubMesh0.GetSceneObjectId();
-	HELIUM_ASSERT( m_pSceneObjects->IsElementValid( sceneObjectIndex0 ) );
-	size_t sceneObjectIndex1 = rSubMesh1.GetSceneObjectId();
-	HELIUM_ASSERT( m_pSceneObjects->IsElementValid( sceneObjectIndex1 ) );
-
-	const GraphicsSceneObject& rSceneObject0 = m_pSceneObjects->GetElement( sceneObjectIndex0 );
-	const GraphicsSceneObject& rSceneObject1 = m_pSceneObjects->GetElement( sceneObjectIndex1 );
-
-	Simd::Vector3 object0Pos = Simd::Vector4ToVector3( rSceneObject0.GetTransform().GetRow( 3 ) );
-	Simd::Vector3 object1Pos = Simd::Vector4ToVector3( rSceneObject1.GetTransform().GetRow( 3 ) );
+	static Name instancedToggleName( TXT( "INSTANCED" ) );
 
-	float distance0 = object0Pos.Dot( m_cameraDirection );
-	float distance1 = object1Pos.Dot( m_cameraDirection );
-
-	return ( distance0 < distance1 );
-}
-
-/// Constructor.
-GraphicsScene::SubMeshMaterialCompare::SubMeshMaterialCompare()
-	: m_pSubMeshes( NULL )
-{
+	return instancedToggleName;
 }
 
-/// Constructor.
-///
-/// @param[in] rSubMeshes  List of scene object sub-meshes in the scene.
-GraphicsScene::SubMeshMaterialCompare::SubMeshMaterialCompare(
-	const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes )
-	: m_pSubMeshes( &rSubMeshes )
-{
-}
-
-/// Compare two sub-meshes for sorting.
+/// Get the instanced counterpart of a mesh vertex description.
 ///
-/// @param[in] subMeshIndex0  Index of the first sub-mesh to compare.
-/// @param[in] subMeshIndex1  Index of the second sub-mesh to compare.
+/// @param[in] pVertexDescription  Mesh vertex description.
 ///
-/// @return  True if the first sub-mesh should be sorted before the second, false if it should be sorted after or if
-///          they share the same sorting priority.
-bool GraphicsScene::SubMeshMaterialCompare::operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const
+/// @return  Vertex description with an additional per-instance transform stream, or null if meshes using the given
+///          vertex description cannot be instanced.
+RVertexDescription* GraphicsScene::GetInstancedVertexDescription( RVertexDescription* pVertexDescription )
 {
-	const GraphicsSceneObject::SubMeshData& rSubMesh0 = m_pSubMeshes->GetElement( subMeshIndex0 );
-	const GraphicsSceneObject::SubMeshData& rSubMesh1 = m_pSubMeshes->GetElement( subMeshIndex1 );
-
-	Material* pMaterial0 = rSubMesh0.GetMaterial();
-	Material* pMaterial1 = rSubMesh1.GetMaterial();
-	if ( pMaterial0 == pMaterial1 )
-	{
-		return false;
-	}
-
-	if ( !pMaterial0 )
+	if ( !pVertexDescription )
 	{
-		return true;
+		return NULL;
 	}
 
-	if ( !pMaterial1 )
-	{
-		return false;
-	}
+	RenderResourceManager* pRenderResourceManager = RenderResourceManager::GetInstance();
+	HELIUM_ASSERT( pRenderResourceManager );
 
-	ShaderVariant* pVariant0 = pMaterial0->GetShaderVariant( RShader::TYPE_VERTEX );
-	ShaderVariant* pVariant1 = pMaterial1->GetShaderVariant( RShader::TYPE_VERTEX );
-	if ( pVariant0 != pVariant1 )
+	for ( size_t textureCoordinateSetCount = 1;
+		textureCoordinateSetCount <= RenderResourceManager::MESH_TEXTURE_COORDINATE_SET_COUNT_MAX;
+		++textureCoordinateSetCount )
 	{
-		return ( pVariant0 < pVariant1 );
+		if ( pRenderResourceManager->GetStaticMeshVertexDescription( textureCoordinateSetCount ) == pVertexDescription )
+		{
+			return pRenderResourceManager->GetInstancedStaticMeshVertexDescription( textureCoordinateSetCount );
+		}
 	}
 
-	pVariant0 = pMaterial0->GetShaderVariant( RShader::TYPE_PIXEL );
-	pVariant1 = pMaterial1->GetShaderVariant( RShader::TYPE_PIXEL );
-
-	return ( pVariant0 < pVariant1 );
+	return NULL;
 }
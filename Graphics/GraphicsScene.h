@@ -4,10 +4,11 @@
 //#include "Engine/Asset.h"
 #include "Reflect/Object.h"
 
-#include "Foundation/BitArray.h"
+#include "EngineJobs/EngineJobsTypes.h"
 #include "Rendering/RRenderResource.h"
 #include "GraphicsTypes/GraphicsSceneObject.h"
 #include "GraphicsTypes/GraphicsSceneView.h"
+#include "Graphics/GraphicsSceneCullGrid.h"
 
 #if GRAPHICS_SCENE_BUFFERED_DRAWER
 #include "Foundation/ObjectPool.h"
@@ -17,6 +18,7 @@
 namespace Helium
 {
     HELIUM_DECLARE_RPTR( RConstantBuffer );
+    HELIUM_DECLARE_RPTR( RVertexBuffer );
 
     class HELIUM_GRAPHICS_API SceneObjectTransform : public Helium::Component
     {
@@ -56,6 +58,8 @@ namespace Helium
         size_t AllocateSceneObject();
         void ReleaseSceneObject( size_t id );
         inline GraphicsSceneObject* GetSceneObject( size_t id );
+
+        void SetSceneObjectWorldBounds( size_t id, const Simd::AaBox& rBox );
         //@}
 
         /// @name Scene Asset Sub-mesh Allocation
@@ -96,50 +100,15 @@ namespace Helium
         //@}
 
     private:
-        /// Front-to-back sub-mesh sort comparison function
-        class HELIUM_GRAPHICS_API SubMeshFrontToBackCompare
-        {
-        public:
-            /// @name Construction/Destruction
-            //@{
-            SubMeshFrontToBackCompare();
-            SubMeshFrontToBackCompare(
-                const Simd::Vector3& rCameraDirection, const SparseArray< GraphicsSceneObject >& rSceneObjects,
-                const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes );
-            //@}
-
-            /// @name Overloaded Operators
-            //@{
-            bool operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const;
-            //@}
-
-        private:
-            /// Camera direction.
-            Simd::Vector3 m_cameraDirection;
-            /// Scene object list.
-            const SparseArray< GraphicsSceneObject >* m_pSceneObjects;
-            /// Scene object sub-mesh list.
-            const SparseArray< GraphicsSceneObject::SubMeshData >* m_pSubMeshes;
-        };
-
-        /// Material-based sub-mesh sort comparison function
-        class HELIUM_GRAPHICS_API SubMeshMaterialCompare
+        /// Run of sorted sub-meshes drawn with a single instanced draw call.
+        struct InstanceBatch
         {
-        public:
-            /// @name Construction/Destruction
-            //@{
-            SubMeshMaterialCompare();
-            explicit SubMeshMaterialCompare( const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes );
-            //@}
-
-            /// @name Overloaded Operators
-            //@{
-            bool operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const;
-            //@}
-
-        private:
-            /// Scene object sub-mesh list.
-            const SparseArray< GraphicsSceneObject::SubMeshData >* m_pSubMeshes;
+            /// Index of the first sub-mesh sort entry in the batch.
+            size_t sortEntryIndex;
+            /// Number of sub-meshes in the batch.
+            size_t count;
+            /// Index of the first instance of the batch in the instance vertex buffer.
+            size_t instanceOffset;
         };
 
         /// Scene view list.
@@ -158,10 +127,30 @@ namespace Helium
         DynamicArray< BufferedDrawer* > m_viewBufferedDrawers;
 #endif // GRAPHICS_SCENE_BUFFERED_DRAWER
 
-        /// Visible scene objects for the current view.
-        BitArray<> m_visibleSceneObjects;
+        /// Sub-mesh IDs belonging to each scene object.
+        DynamicArray< DynamicArray< size_t > > m_sceneObjectSubMeshIds;
+        /// Loose grid of scene object bounds used for frustum culling.
+        GraphicsSceneCullGrid m_cullGrid;
+
+        /// IDs of the scene objects visible in the frustum currently being culled.
+        DynamicArray< size_t > m_visibleSceneObjectIds;
         /// Scene object sub-data index list (for sorting during rendering).
         DynamicArray< size_t > m_sceneObjectSubMeshIndices;
+        /// Scene object sub-data index list for shadow casters in the current shadow view.
+        DynamicArray< size_t > m_shadowSceneObjectSubMeshIndices;
+        /// Sort keys and indices of the sub-meshes being drawn by the current pass.
+        DynamicArray< RadixSortEntry > m_subMeshSortEntries;
+        /// Scratch space for sorting sub-mesh keys.
+        DynamicArray< RadixSortEntry > m_subMeshSortScratch;
+
+        /// Instanced draw batches for the sub-meshes being drawn by the current pass, in sort order.
+        DynamicArray< InstanceBatch > m_instanceBatches;
+        /// Scene object ID of each instance written to the instance vertex buffer.
+        DynamicArray< size_t > m_instanceSceneObjectIds;
+        /// Per-instance transform vertex buffer for instanced draws.
+        RVertexBufferPtr m_spInstanceVertexBuffer;
+        /// Number of instances that fit in the instance vertex buffer.
+        size_t m_instanceVertexBufferCapacity;
 
         /// Ambient light top color.
         Color m_ambientLightTopColor;
@@ -223,6 +212,16 @@ namespace Helium
 
         void SwapDynamicConstantBuffers();
 
+        void CullSubMeshes( const Simd::Frustum& rFrustum, DynamicArray< size_t >& rSubMeshIndices );
+
+        void BuildFrontToBackSortKeys( const DynamicArray< size_t >& rSubMeshIndices, const Simd::Vector3& rDirection );
+        void BuildMaterialSortKeys( const DynamicArray< size_t >& rSubMeshIndices );
+        void SortSubMeshKeys();
+
+        bool CanInstanceSubMesh( size_t subMeshIndex ) const;
+        bool CanBatchSubMeshes( size_t firstSubMeshIndex, size_t subMeshIndex ) const;
+        void PrepareInstanceBatches();
+
         void DrawSceneView( uint_fast32_t viewIndex );
 
         void DrawShadowDepthPass( uint_fast32_t viewIndex );
@@ -237,6 +236,15 @@ namespace Helium
         static Name GetSkinningSysSelectName();
         static Name GetSkinningSmoothOptionName();
         static Name GetSkinningRigidOptionName();
+        static Name GetInstancedToggleName();
+
+        static RVertexDescription* GetInstancedVertexDescription( RVertexDescription* pVertexDescription );
+
+        static uint64_t GetSortableDepth( float32_t depth );
+        static uint64_t GetSortKeyHash( const void* pObject, uint32_t bitCount );
+        static uint64_t GetSortKeyValueHash( uint64_t value, uint32_t bitCount );
+
+        static float32_t GetProjectedSize( const GraphicsSceneView& rView, const GraphicsSceneObject& rSceneObject );
         //@}
     };
 }
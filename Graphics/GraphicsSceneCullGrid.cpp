@@ -0,0 +1,378 @@
+#include "GraphicsPch.h"
+#include "Graphics/GraphicsSceneCullGrid.h"
+
+#include "Engine/JobManager.h"
+
+using namespace Helium;
+
+const float32_t GraphicsSceneCullGrid::CELL_SIZE = 32.0f;
+
+/// Bias applied to cell coordinates so that they can be packed into unsigned keys.
+static const int32_t CELL_COORDINATE_BIAS = 1 << 20;
+/// Mask of the bits used by each packed cell coordinate.
+static const uint64_t CELL_COORDINATE_MASK = ( 1 << 21 ) - 1;
+/// Minimum number of scene objects to test in each culling job.
+static const size_t CULL_MIN_OBJECTS_PER_JOB = 512;
+
+/// Constructor.
+GraphicsSceneCullGrid::GraphicsSceneCullGrid()
+{
+	// The first cell holds objects too large to be placed in the grid, so it never moves and is never released.
+	Cell* pOversizedCell = new Cell;
+	HELIUM_ASSERT( pOversizedCell );
+	pOversizedCell->m_x = 0;
+	pOversizedCell->m_y = 0;
+	pOversizedCell->m_z = 0;
+	m_cells.Push( pOversizedCell );
+}
+
+/// Destructor.
+GraphicsSceneCullGrid::~GraphicsSceneCullGrid()
+{
+	size_t cellCount = m_cells.GetSize();
+	for ( size_t cellIndex = 0; cellIndex < cellCount; ++cellIndex )
+	{
+		delete m_cells[cellIndex];
+	}
+}
+
+/// Add a scene object to the grid, or update the bounds of an object already in the grid.
+///
+/// The object is only moved between cells if its bounds have left its current cell, so static objects cost nothing
+/// after they have been placed.
+///
+/// @param[in] sceneObjectId  ID of the scene object.
+/// @param[in] rBox           World-space axis-aligned bounding box of the scene object.
+///
+/// @see RemoveObject()
+void GraphicsSceneCullGrid::SetObjectBounds( size_t sceneObjectId, const Simd::AaBox& rBox )
+{
+	HELIUM_ASSERT( IsValid( sceneObjectId ) );
+
+	const Simd::Vector3& rMinimum = rBox.GetMinimum();
+	const Simd::Vector3& rMaximum = rBox.GetMaximum();
+
+	float32_t center[3];
+	float32_t halfExtent = 0.0f;
+	for ( size_t axis = 0; axis < 3; ++axis )
+	{
+		float32_t minimum = rMinimum.GetElement( axis );
+		float32_t maximum = rMaximum.GetElement( axis );
+		center[axis] = ( minimum + maximum ) * 0.5f;
+		halfExtent = Max( halfExtent, ( maximum - minimum ) * 0.5f );
+	}
+
+	bool bOversized = ( halfExtent > CELL_SIZE * 0.5f );
+	int32_t x = GetCellCoordinate( center[0] );
+	int32_t y = GetCellCoordinate( center[1] );
+	int32_t z = GetCellCoordinate( center[2] );
+
+	Simd::Sphere sphere;
+	sphere.Set( rBox );
+
+	size_t objectCount = m_objectCells.GetSize();
+	if ( sceneObjectId >= objectCount )
+	{
+		m_objectCells.Resize( sceneObjectId + 1 );
+		m_objectSlots.Resize( sceneObjectId + 1 );
+		for ( size_t objectIndex = objectCount; objectIndex <= sceneObjectId; ++objectIndex )
+		{
+			SetInvalid( m_objectCells[objectIndex] );
+			SetInvalid( m_objectSlots[objectIndex] );
+		}
+	}
+
+	// Update the bounds in place if the object is staying in the same cell.
+	uint32_t currentCellIndex = m_objectCells[sceneObjectId];
+	if ( IsValid( currentCellIndex ) )
+	{
+		Cell* pCurrentCell = m_cells[currentCellIndex];
+		bool bSameCell = ( currentCellIndex == 0
+			? bOversized
+			: !bOversized && pCurrentCell->m_x == x && pCurrentCell->m_y == y && pCurrentCell->m_z == z );
+		if ( bSameCell )
+		{
+			pCurrentCell->m_spheres[m_objectSlots[sceneObjectId]] = sphere;
+
+			return;
+		}
+
+		RemoveObject( sceneObjectId );
+	}
+
+	uint32_t cellIndex = ( bOversized ? 0 : FindOrCreateCell( x, y, z ) );
+	Cell* pCell = m_cells[cellIndex];
+
+	m_objectCells[sceneObjectId] = cellIndex;
+	m_objectSlots[sceneObjectId] = static_cast< uint32_t >( pCell->m_objects.GetSize() );
+	pCell->m_objects.Push( sceneObjectId );
+	pCell->m_spheres.Push( sphere );
+}
+
+/// Remove a scene object from the grid.
+///
+/// @param[in] sceneObjectId  ID of the scene object to remove (can be an object that is not in the grid).
+///
+/// @see SetObjectBounds()
+void GraphicsSceneCullGrid::RemoveObject( size_t sceneObjectId )
+{
+	if ( sceneObjectId >= m_objectCells.GetSize() || IsInvalid( m_objectCells[sceneObjectId] ) )
+	{
+		return;
+	}
+
+	uint32_t cellIndex = m_objectCells[sceneObjectId];
+	uint32_t slot = m_objectSlots[sceneObjectId];
+	Cell* pCell = m_cells[cellIndex];
+	HELIUM_ASSERT( pCell->m_objects[slot] == sceneObjectId );
+
+	// Keep the cell's lists packed by moving its last object into the hole.
+	size_t lastSlot = pCell->m_objects.GetSize() - 1;
+	if ( slot != lastSlot )
+	{
+		size_t movedObjectId = pCell->m_objects[lastSlot];
+		pCell->m_objects[slot] = movedObjectId;
+		pCell->m_spheres[slot] = pCell->m_spheres[lastSlot];
+		m_objectSlots[movedObjectId] = slot;
+	}
+
+	pCell->m_objects.Pop();
+	pCell->m_spheres.Pop();
+
+	SetInvalid( m_objectCells[sceneObjectId] );
+	SetInvalid( m_objectSlots[sceneObjectId] );
+
+	if ( cellIndex != 0 && pCell->m_objects.IsEmpty() )
+	{
+		RemoveCell( cellIndex );
+	}
+}
+
+/// Find each scene object whose bounds intersect a given frustum.
+///
+/// Cells are split into ranges holding a roughly even number of objects, which are culled across the job worker
+/// threads if a job manager is available.
+///
+/// @param[in]  rFrustum         Frustum to test.
+/// @param[out] rVisibleObjects  IDs of the scene objects intersecting the frustum.  The existing contents are
+///                              discarded.
+void GraphicsSceneCullGrid::Cull( const Simd::Frustum& rFrustum, DynamicArray< size_t >& rVisibleObjects ) const
+{
+	rVisibleObjects.Resize( 0 );
+
+	size_t cellCount = m_cells.GetSize();
+	size_t objectCount = 0;
+	for ( size_t cellIndex = 0; cellIndex < cellCount; ++cellIndex )
+	{
+		objectCount += m_cells[cellIndex]->m_objects.GetSize();
+	}
+
+	JobManager* pJobManager = JobManager::GetInstance();
+	size_t threadCount = ( pJobManager ? pJobManager->GetWorkerThreadCount() + 1 : 1 );
+	if ( threadCount == 1 || objectCount < CULL_MIN_OBJECTS_PER_JOB * 2 )
+	{
+		CullCells( rFrustum, 0, cellCount, rVisibleObjects );
+
+		return;
+	}
+
+	// Split into about four ranges per thread so that stealing can even out cells that fail the early rejection.
+	size_t objectsPerJob = ( objectCount + threadCount * 4 - 1 ) / ( threadCount * 4 );
+	objectsPerJob = Max( objectsPerJob, CULL_MIN_OBJECTS_PER_JOB );
+
+	DynamicArray< CullJob > jobs;
+	jobs.Reserve( ( objectCount + objectsPerJob - 1 ) / objectsPerJob + 1 );
+
+	size_t jobObjectCount = 0;
+	for ( size_t cellIndex = 0; cellIndex < cellCount; ++cellIndex )
+	{
+		if ( jobs.IsEmpty() || jobObjectCount >= objectsPerJob )
+		{
+			CullJob* pJob = jobs.New();
+			HELIUM_ASSERT( pJob );
+			pJob->m_pGrid = this;
+			pJob->m_pFrustum = &rFrustum;
+			pJob->m_startCellIndex = cellIndex;
+			jobObjectCount = 0;
+		}
+
+		jobs.GetLast().m_endCellIndex = cellIndex + 1;
+		jobObjectCount += m_cells[cellIndex]->m_objects.GetSize();
+	}
+
+	size_t jobCount = jobs.GetSize();
+
+	JobCounter counter;
+	for ( size_t jobIndex = 1; jobIndex < jobCount; ++jobIndex )
+	{
+		pJobManager->SpawnJob( CullJobCallback, &jobs[jobIndex], &counter );
+	}
+
+	CullJobCallback( &jobs[0] );
+	pJobManager->WaitForCounter( counter );
+
+	// Merge in job order so the result does not depend on scheduling.
+	for ( size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+	{
+		const DynamicArray< size_t >& rJobVisibleObjects = jobs[jobIndex].m_visibleObjects;
+		size_t jobVisibleCount = rJobVisibleObjects.GetSize();
+		for ( size_t visibleIndex = 0; visibleIndex < jobVisibleCount; ++visibleIndex )
+		{
+			rVisibleObjects.Push( rJobVisibleObjects[visibleIndex] );
+		}
+	}
+}
+
+/// Get the index of the cell with the given coordinates, creating it if it does not exist.
+///
+/// @param[in] x  Cell X coordinate.
+/// @param[in] y  Cell Y coordinate.
+/// @param[in] z  Cell Z coordinate.
+///
+/// @return  Cell index.
+uint32_t GraphicsSceneCullGrid::FindOrCreateCell( int32_t x, int32_t y, int32_t z )
+{
+	uint64_t key = GetCellKey( x, y, z );
+
+	HashMap< uint64_t, uint32_t >::Iterator cellIterator = m_cellMap.Find( key );
+	if ( cellIterator != m_cellMap.End() )
+	{
+		return cellIterator->Second();
+	}
+
+	Cell* pCell = new Cell;
+	HELIUM_ASSERT( pCell );
+	pCell->m_x = x;
+	pCell->m_y = y;
+	pCell->m_z = z;
+
+	uint32_t cellIndex = static_cast< uint32_t >( m_cells.GetSize() );
+	m_cells.Push( pCell );
+	m_cellMap.Insert( cellIterator, HashMap< uint64_t, uint32_t >::ValueType( key, cellIndex ) );
+
+	return cellIndex;
+}
+
+/// Release an empty grid cell.
+///
+/// @param[in] cellIndex  Index of the cell to release.
+void GraphicsSceneCullGrid::RemoveCell( uint32_t cellIndex )
+{
+	HELIUM_ASSERT( cellIndex != 0 );
+	HELIUM_ASSERT( cellIndex < m_cells.GetSize() );
+
+	Cell* pCell = m_cells[cellIndex];
+	HELIUM_ASSERT( pCell->m_objects.IsEmpty() );
+
+	m_cellMap.Remove( GetCellKey( pCell->m_x, pCell->m_y, pCell->m_z ) );
+
+	// Keep the cell list packed by moving the last cell into the hole.
+	uint32_t lastCellIndex = static_cast< uint32_t >( m_cells.GetSize() - 1 );
+	if ( cellIndex != lastCellIndex )
+	{
+		Cell* pMovedCell = m_cells[lastCellIndex];
+		m_cells[cellIndex] = pMovedCell;
+
+		HashMap< uint64_t, uint32_t >::Iterator cellIterator =
+			m_cellMap.Find( GetCellKey( pMovedCell->m_x, pMovedCell->m_y, pMovedCell->m_z ) );
+		HELIUM_ASSERT( cellIterator != m_cellMap.End() );
+		cellIterator->Second() = cellIndex;
+
+		size_t movedObjectCount = pMovedCell->m_objects.GetSize();
+		for ( size_t objectIndex = 0; objectIndex < movedObjectCount; ++objectIndex )
+		{
+			m_objectCells[pMovedCell->m_objects[objectIndex]] = cellIndex;
+		}
+	}
+
+	m_cells.Pop();
+	delete pCell;
+}
+
+/// Test a range of cells and their objects against a frustum.
+///
+/// @param[in]  rFrustum         Frustum to test.
+/// @param[in]  startCellIndex   Index of the first cell to test.
+/// @param[in]  endCellIndex     One past the index of the last cell to test.
+/// @param[out] rVisibleObjects  List to which the IDs of the visible scene objects are appended.
+void GraphicsSceneCullGrid::CullCells(
+	const Simd::Frustum& rFrustum,
+	size_t startCellIndex,
+	size_t endCellIndex,
+	DynamicArray< size_t >& rVisibleObjects ) const
+{
+	HELIUM_ASSERT( endCellIndex <= m_cells.GetSize() );
+
+	for ( size_t cellIndex = startCellIndex; cellIndex < endCellIndex; ++cellIndex )
+	{
+		const Cell* pCell = m_cells[cellIndex];
+
+		// Reject the entire cell first using its loose bounds.
+		if ( cellIndex != 0 )
+		{
+			float32_t minimumX = static_cast< float32_t >( pCell->m_x ) * CELL_SIZE - CELL_SIZE * 0.5f;
+			float32_t minimumY = static_cast< float32_t >( pCell->m_y ) * CELL_SIZE - CELL_SIZE * 0.5f;
+			float32_t minimumZ = static_cast< float32_t >( pCell->m_z ) * CELL_SIZE - CELL_SIZE * 0.5f;
+			Simd::AaBox cellBox(
+				Simd::Vector3( minimumX, minimumY, minimumZ ),
+				Simd::Vector3( minimumX + CELL_SIZE * 2.0f, minimumY + CELL_SIZE * 2.0f, minimumZ + CELL_SIZE * 2.0f ) );
+
+			Simd::Sphere cellSphere;
+			cellSphere.Set( cellBox );
+			if ( !rFrustum.Intersects( cellSphere ) )
+			{
+				continue;
+			}
+		}
+
+		const size_t* pObjectIds = pCell->m_objects.GetData();
+		const Simd::Sphere* pSpheres = pCell->m_spheres.GetData();
+		size_t objectCount = pCell->m_objects.GetSize();
+		for ( size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+		{
+			if ( rFrustum.Intersects( pSpheres[objectIndex] ) )
+			{
+				rVisibleObjects.Push( pObjectIds[objectIndex] );
+			}
+		}
+	}
+}
+
+/// Get the grid cell coordinate containing a given world-space position along a single axis.
+///
+/// @param[in] position  World-space position.
+///
+/// @return  Cell coordinate.
+int32_t GraphicsSceneCullGrid::GetCellCoordinate( float32_t position )
+{
+	float32_t coordinate = floorf( position / CELL_SIZE );
+	coordinate = Max( coordinate, static_cast< float32_t >( -CELL_COORDINATE_BIAS ) );
+	coordinate = Min( coordinate, static_cast< float32_t >( CELL_COORDINATE_BIAS - 1 ) );
+
+	return static_cast< int32_t >( coordinate );
+}
+
+/// Pack grid cell coordinates into a single key.
+///
+/// @param[in] x  Cell X coordinate.
+/// @param[in] y  Cell Y coordinate.
+/// @param[in] z  Cell Z coordinate.
+///
+/// @return  Cell key.
+uint64_t GraphicsSceneCullGrid::GetCellKey( int32_t x, int32_t y, int32_t z )
+{
+	return ( static_cast< uint64_t >( x + CELL_COORDINATE_BIAS ) & CELL_COORDINATE_MASK ) |
+		( ( static_cast< uint64_t >( y + CELL_COORDINATE_BIAS ) & CELL_COORDINATE_MASK ) << 21 ) |
+		( ( static_cast< uint64_t >( z + CELL_COORDINATE_BIAS ) & CELL_COORDINATE_MASK ) << 42 );
+}
+
+/// Job callback for culling a range of cells.
+///
+/// @param[in] pData  Pointer to the CullJob to run.
+void GraphicsSceneCullGrid::CullJobCallback( void* pData )
+{
+	CullJob* pJob = static_cast< CullJob* >( pData );
+	HELIUM_ASSERT( pJob );
+
+	pJob->m_pGrid->CullCells( *pJob->m_pFrustum, pJob->m_startCellIndex, pJob->m_endCellIndex, pJob->m_visibleObjects );
+}
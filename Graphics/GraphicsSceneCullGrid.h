@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Graphics/Graphics.h"
+
+#include "Foundation/DynamicArray.h"
+#include "Foundation/HashMap.h"
+#include "MathSimd/AaBox.h"
+#include "MathSimd/Frustum.h"
+#include "MathSimd/Sphere.h"
+
+namespace Helium
+{
+	/// Loose grid of graphics scene object bounds, used to cull scene objects against view and shadow frustums.
+	///
+	/// Each object is placed in the cell containing the center of its world bounds.  Cells are tested against a frustum
+	/// using bounds extended by half a cell on each side, so an object no larger than half a cell always lies within
+	/// the bounds of its cell and whole cells can be rejected with a single test.  Larger objects are kept in a separate
+	/// list and are always tested individually.  Cells are only allocated while they contain objects, and each cell is
+	/// culled independently, allowing the work to be split across job worker threads.
+	class HELIUM_GRAPHICS_API GraphicsSceneCullGrid : NonCopyable
+	{
+	public:
+		/// Edge length of each grid cell, in world units.
+		static const float32_t CELL_SIZE;
+
+		/// @name Construction/Destruction
+		//@{
+		GraphicsSceneCullGrid();
+		~GraphicsSceneCullGrid();
+		//@}
+
+		/// @name Object Bounds
+		//@{
+		void SetObjectBounds( size_t sceneObjectId, const Simd::AaBox& rBox );
+		void RemoveObject( size_t sceneObjectId );
+		//@}
+
+		/// @name Culling
+		//@{
+		void Cull( const Simd::Frustum& rFrustum, DynamicArray< size_t >& rVisibleObjects ) const;
+		//@}
+
+	private:
+		/// Grid cell.
+		struct Cell
+		{
+			/// Cell X coordinate.
+			int32_t m_x;
+			/// Cell Y coordinate.
+			int32_t m_y;
+			/// Cell Z coordinate.
+			int32_t m_z;
+
+			/// IDs of the scene objects in this cell.
+			DynamicArray< size_t > m_objects;
+			/// World-space bounding sphere of each scene object in this cell (parallel to m_objects).
+			DynamicArray< Simd::Sphere > m_spheres;
+		};
+
+		/// Range of cells culled by a single job.
+		struct CullJob
+		{
+			/// Grid being culled.
+			const GraphicsSceneCullGrid* m_pGrid;
+			/// Frustum against which to test.
+			const Simd::Frustum* m_pFrustum;
+			/// Index of the first cell to test.
+			size_t m_startCellIndex;
+			/// One past the index of the last cell to test.
+			size_t m_endCellIndex;
+			/// IDs of the scene objects found to be visible.
+			DynamicArray< size_t > m_visibleObjects;
+		};
+
+		/// Grid cells (the first cell holds the objects too large to be placed in the grid).
+		DynamicArray< Cell* > m_cells;
+		/// Map from packed cell coordinates to the cell's index.
+		HashMap< uint64_t, uint32_t > m_cellMap;
+
+		/// Index of the cell holding each scene object (invalid if the object is not in the grid).
+		DynamicArray< uint32_t > m_objectCells;
+		/// Index of each scene object within its cell's object list.
+		DynamicArray< uint32_t > m_objectSlots;
+
+		/// @name Private Utility Functions
+		//@{
+		uint32_t FindOrCreateCell( int32_t x, int32_t y, int32_t z );
+		void RemoveCell( uint32_t cellIndex );
+		void CullCells( const Simd::Frustum& rFrustum, size_t startCellIndex, size_t endCellIndex, DynamicArray< size_t >& rVisibleObjects ) const;
+		//@}
+
+		/// @name Private Static Utility Functions
+		//@{
+		static int32_t GetCellCoordinate( float32_t position );
+		static uint64_t GetCellKey( int32_t x, int32_t y, int32_t z );
+		static void CullJobCallback( void* pData );
+		//@}
+	};
+}
@@ -267,6 +267,12 @@ Name Mesh::GetCacheName() const
     return cacheName;
 }
 
+/// @copydoc Resource::ShouldCompressSubData()
+bool Mesh::ShouldCompressSubData() const
+{
+    return true;
+}
+
 
 /// Get the GPU skinning palette map for a specific mesh section.
 ///
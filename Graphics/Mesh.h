@@ -103,6 +103,7 @@ namespace Helium
         /// @name Resource Caching Support
         //@{
         virtual Name GetCacheName() const override;
+        virtual bool ShouldCompressSubData() const override;
         //@}
 
         /// @name Data Access
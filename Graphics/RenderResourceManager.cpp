@@ -229,6 +229,33 @@ bool RenderResourceManager::Initialize()
 	m_staticMeshVertexDescriptions[1] = pRenderer->CreateVertexDescription( vertexElements, 6 );
 	HELIUM_ASSERT( m_staticMeshVertexDescriptions[1] );
 
+	// Instanced static meshes read the rows of each instance's world transform from the second vertex stream.
+	RVertexDescription::Element instancedVertexElements[6 + 3];
+	for ( size_t descriptionIndex = 0;
+		descriptionIndex < HELIUM_ARRAY_COUNT( m_instancedStaticMeshVertexDescriptions );
+		++descriptionIndex )
+	{
+		size_t meshElementCount = 5 + descriptionIndex;
+		for ( size_t elementIndex = 0; elementIndex < meshElementCount; ++elementIndex )
+		{
+			instancedVertexElements[elementIndex] = vertexElements[elementIndex];
+		}
+
+		for ( size_t rowIndex = 0; rowIndex < 3; ++rowIndex )
+		{
+			RVertexDescription::Element& rElement = instancedVertexElements[meshElementCount + rowIndex];
+			rElement.type = RENDERER_VERTEX_DATA_TYPE_FLOAT32_4;
+			rElement.semantic = RENDERER_VERTEX_SEMANTIC_TEXCOORD;
+			rElement.semanticIndex = static_cast<uint8_t>( 4 + rowIndex );
+			rElement.bufferIndex = 1;
+		}
+
+		m_instancedStaticMeshVertexDescriptions[descriptionIndex] = pRenderer->CreateVertexDescription(
+			instancedVertexElements,
+			meshElementCount + 3 );
+		HELIUM_ASSERT( m_instancedStaticMeshVertexDescriptions[descriptionIndex] );
+	}
+
 	vertexElements[1].type = RENDERER_VERTEX_DATA_TYPE_UINT8_4_NORM;
 	vertexElements[1].semantic = RENDERER_VERTEX_SEMANTIC_BLENDWEIGHT;
 	vertexElements[1].semanticIndex = 0;
@@ -473,6 +500,7 @@ void RenderResourceManager::Cleanup()
 		++descriptionIndex )
 	{
 		m_staticMeshVertexDescriptions[descriptionIndex].Release();
+		m_instancedStaticMeshVertexDescriptions[descriptionIndex].Release();
 	}
 
 	m_spSkinnedMeshVertexDescription.Release();
@@ -583,6 +611,9 @@ void RenderResourceManager::PostConfigUpdate()
 	m_shadowMode = shadowMode;
 	m_shadowDepthTextureUsableSize = shadowBufferUsableSize;
 
+	// Update the texture streaming budget (textures already loaded keep their current streaming mode).
+	m_textureStreamingManager.SetBudget( static_cast< size_t >( spGraphicsConfig->GetTextureStreamingBudget() ) * 1024 * 1024 );
+
 	// Recreate render and depth targets.
 	UpdateMaxViewportSize( spGraphicsConfig->m_width, spGraphicsConfig->m_height );
 
@@ -804,6 +835,26 @@ RVertexDescription* RenderResourceManager::GetSkinnedMeshVertexDescription() con
 	return m_spSkinnedMeshVertexDescription;
 }
 
+/// Get the description for static mesh vertices drawn with hardware instancing.
+///
+/// The first vertex stream holds the same vertex data as the description returned by GetStaticMeshVertexDescription(),
+/// while the second holds the rows of each instance's transposed world transform as three TEXCOORD4-TEXCOORD6 inputs.
+///
+/// @param[in] textureCoordinateSetCount  Number of texture coordinate sets (must be between 1 and
+///                                       MESH_TEXTURE_COORDINATE_SET_COUNT_MAX, inclusive).
+///
+/// @return  Instanced vertex description.
+///
+/// @see GetStaticMeshVertexDescription()
+RVertexDescription* RenderResourceManager::GetInstancedStaticMeshVertexDescription(
+	size_t textureCoordinateSetCount ) const
+{
+	HELIUM_ASSERT( textureCoordinateSetCount >= 1 );
+	HELIUM_ASSERT( textureCoordinateSetCount <= MESH_TEXTURE_COORDINATE_SET_COUNT_MAX );
+
+	return m_instancedStaticMeshVertexDescriptions[textureCoordinateSetCount - 1];
+}
+
 /// Get the texture to which scene color data is written each frame.
 ///
 /// @return  Scene color target texture.
@@ -5,6 +5,7 @@
 #include "Rendering/RendererTypes.h"
 #include "Rendering/RRenderResource.h"
 #include "Graphics/GraphicsConfig.h"
+#include "Graphics/TextureStreamingManager.h"
 
 namespace Helium
 {
@@ -150,6 +151,7 @@ namespace Helium
 		RVertexDescription* GetProjectedVertexDescription() const;
 		RVertexDescription* GetStaticMeshVertexDescription( size_t textureCoordinateSetCount ) const;
 		RVertexDescription* GetSkinnedMeshVertexDescription() const;
+		RVertexDescription* GetInstancedStaticMeshVertexDescription( size_t textureCoordinateSetCount ) const;
 		//@}
 
 		/// @name Resource Access
@@ -171,6 +173,8 @@ namespace Helium
 
 		inline GraphicsConfig::EShadowMode GetShadowMode() const;
 		inline uint32_t GetShadowDepthTextureUsableSize() const;
+
+		inline TextureStreamingManager& GetTextureStreamingManager();
 		//@}
 
 		/// @name Static Access
@@ -202,6 +206,8 @@ namespace Helium
 		RVertexDescriptionPtr m_staticMeshVertexDescriptions[MESH_TEXTURE_COORDINATE_SET_COUNT_MAX];
 		/// Skinned mesh vertex description.
 		RVertexDescriptionPtr m_spSkinnedMeshVertexDescription;
+		/// Static mesh vertex descriptions with a per-instance transform stream.
+		RVertexDescriptionPtr m_instancedStaticMeshVertexDescriptions[MESH_TEXTURE_COORDINATE_SET_COUNT_MAX];
 
 		/// Scene render texture.
 		RTexture2dPtr m_spSceneTexture;
@@ -240,6 +246,9 @@ namespace Helium
 		/// Shadow depth texture usable size (cached from graphics config object value).
 		uint32_t m_shadowDepthTextureUsableSize;
 
+		/// Streamed texture mip level manager.
+		TextureStreamingManager m_textureStreamingManager;
+
 		/// Singleton instance.
 		static RenderResourceManager* sm_pInstance;
 
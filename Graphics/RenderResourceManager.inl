@@ -18,4 +18,12 @@ namespace Helium
     {
         return m_shadowDepthTextureUsableSize;
     }
+
+    /// Get the manager for the resident mip levels of streamed textures.
+    ///
+    /// @return  Texture streaming manager.
+    TextureStreamingManager& RenderResourceManager::GetTextureStreamingManager()
+    {
+        return m_textureStreamingManager;
+    }
 }
@@ -49,6 +49,14 @@ RTexture2d* Texture::GetRenderResource2d() const
     return NULL;
 }
 
+/// Report the size at which this texture is about to be drawn, so that streamed textures can keep enough mip
+/// levels resident.  This should be called each frame the texture is drawn.
+///
+/// @param[in] screenSize  Approximate size, in pixels, of the largest on-screen dimension of the texture.
+void Texture::ReportScreenSize( float32_t /*screenSize*/ )
+{
+}
+
 /// @copydoc Resource::GetCacheName()
 Name Texture::GetCacheName() const
 {
@@ -56,3 +64,9 @@ Name Texture::GetCacheName() const
 
     return cacheName;
 }
+
+/// @copydoc Resource::ShouldCompressSubData()
+bool Texture::ShouldCompressSubData() const
+{
+    return true;
+}
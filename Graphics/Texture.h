@@ -82,6 +82,12 @@ namespace Helium
         /// @name Resource Caching Support
         //@{
         virtual Name GetCacheName() const override;
+        virtual bool ShouldCompressSubData() const override;
+        //@}
+
+        /// @name Mip Streaming
+        //@{
+        virtual void ReportScreenSize( float32_t screenSize );
         //@}
 
         /// @name Static Utility Functions
@@ -4,6 +4,7 @@
 #include "Rendering/RendererUtil.h"
 #include "Rendering/Renderer.h"
 #include "Rendering/RTexture2d.h"
+#include "Graphics/RenderResourceManager.h"
 #include "Reflect/TranslatorDeduction.h"
 
 HELIUM_IMPLEMENT_ASSET( Helium::Texture2d, Graphics, AssetType::FLAG_NO_TEMPLATE );
@@ -31,12 +32,28 @@ void Texture2d::PersistentResourceData::PopulateMetaType( Reflect::MetaStruct& c
 
 /// Constructor.
 Texture2d::Texture2d()
+: m_residentMipLevel( 0 )
+, m_minResidentMipLevel( 0 )
+, m_streamingMipLevel( 0 )
+, m_requestedMipLevel( Invalid< uint32_t >() )
+, m_lastRequestedMipLevel( Invalid< uint32_t >() )
+, m_updatesSinceRequested( Invalid< uint32_t >() )
+, m_bStreaming( false )
 {
 }
 
 /// Destructor.
 Texture2d::~Texture2d()
 {
+    HELIUM_ASSERT( !m_bStreaming );
+}
+
+/// @copydoc Asset::RefCountPreDestroy()
+void Texture2d::RefCountPreDestroy()
+{
+    StopMipStreaming();
+
+    Base::RefCountPreDestroy();
 }
 
 /// @copydoc Asset::NeedsPrecacheResourceData()
@@ -49,6 +66,7 @@ bool Texture2d::NeedsPrecacheResourceData() const
 bool Texture2d::BeginPrecacheResourceData()
 {
     HELIUM_ASSERT( m_renderResourceLoadIds.IsEmpty() );
+    HELIUM_ASSERT( !m_bStreaming );
 
     Renderer* pRenderer = Renderer::GetInstance();
     if ( !pRenderer )
@@ -56,15 +74,234 @@ bool Texture2d::BeginPrecacheResourceData()
         return true;
     }
 
-    const uint32_t baseLevelWidth = m_persistentResourceData.m_baseLevelWidth;
-    const uint32_t baseLevelHeight = m_persistentResourceData.m_baseLevelHeight;
+    // When mip streaming is enabled, only the smallest mip levels are loaded up front.  The texture manager will
+    // bring in more detailed levels once the texture is drawn.
+    const uint32_t mipCount = m_persistentResourceData.m_mipCount;
+    uint32_t baseLevelSize = Max( m_persistentResourceData.m_baseLevelWidth, m_persistentResourceData.m_baseLevelHeight );
+
+    m_minResidentMipLevel = 0;
+
+    RenderResourceManager* pRenderResourceManager = RenderResourceManager::GetInstance();
+    if ( pRenderResourceManager && pRenderResourceManager->GetTextureStreamingManager().IsEnabled() )
+    {
+        while ( m_minResidentMipLevel + 1 < mipCount &&
+            ( baseLevelSize >> m_minResidentMipLevel ) > STREAMING_RESIDENT_SIZE_MIN )
+        {
+            ++m_minResidentMipLevel;
+        }
+    }
+
+    RTexture2d* pTexture2d = BeginLoadMipLevels( m_minResidentMipLevel, m_renderResourceLoadIds );
+    if ( !pTexture2d )
+    {
+        return false;
+    }
+
+    m_spTexture = pTexture2d;
+    m_residentMipLevel = m_minResidentMipLevel;
+
+    return true;
+}
+
+/// @copydoc Asset::TryFinishPrecacheResourceData()
+bool Texture2d::TryFinishPrecacheResourceData()
+{
+    // Check all pending load requests.
+    if( m_renderResourceLoadIds.IsEmpty() )
+    {
+        return true;
+    }
+
+    RTexture2d* pTexture2d = static_cast< RTexture2d* >( m_spTexture.Get() );
+    HELIUM_ASSERT( pTexture2d );
+
+    if( !TryFinishLoadMipLevels( pTexture2d, m_renderResourceLoadIds ) )
+    {
+        return false;
+    }
+
+    m_renderResourceLoadIds.Clear();
+
+    // Hand textures loaded with only part of their mip chain over to the streaming manager.
+    if( m_minResidentMipLevel != 0 )
+    {
+        RenderResourceManager* pRenderResourceManager = RenderResourceManager::GetInstance();
+        if( pRenderResourceManager )
+        {
+            const uint32_t mipCount = m_persistentResourceData.m_mipCount;
+            m_mipChainSizes.Resize( mipCount + 1 );
+            m_mipChainSizes[ mipCount ] = 0;
+            for( uint32_t mipIndex = mipCount; mipIndex != 0; --mipIndex )
+            {
+                m_mipChainSizes[ mipIndex - 1 ] = m_mipChainSizes[ mipIndex ] + GetSubDataSize( mipIndex - 1 );
+            }
+
+            m_bStreaming = true;
+            pRenderResourceManager->GetTextureStreamingManager().RegisterTexture( this );
+        }
+    }
+
+    return true;
+}
+
+bool Texture2d::LoadPersistentResourceObject( Reflect::ObjectPtr& _object )
+{
+    StopMipStreaming();
+    m_spTexture.Release();
+
+    HELIUM_ASSERT(_object.ReferencesObject());
+    if (!_object.ReferencesObject())
+    {
+        return false;
+    }
+
+    _object->CopyTo(&m_persistentResourceData);
+
+    return true;
+}
+
+/// @copydoc Texture::GetRenderResource2d()
+RTexture2d* Texture2d::GetRenderResource2d() const
+{
+    return static_cast< RTexture2d* >( m_spTexture.Get() );
+}
+
+/// @copydoc Texture::ReportScreenSize()
+void Texture2d::ReportScreenSize( float32_t screenSize )
+{
+    if( !m_bStreaming )
+    {
+        return;
+    }
+
+    // Find the smallest mip level that still covers the on-screen size.
+    uint32_t baseLevelSize = Max( m_persistentResourceData.m_baseLevelWidth, m_persistentResourceData.m_baseLevelHeight );
+
+    uint32_t mipLevel = 0;
+    while( mipLevel < m_minResidentMipLevel &&
+        static_cast< float32_t >( baseLevelSize >> ( mipLevel + 1 ) ) >= screenSize )
+    {
+        ++mipLevel;
+    }
+
+    if( mipLevel < m_requestedMipLevel )
+    {
+        m_requestedMipLevel = mipLevel;
+    }
+}
+
+/// Get the most detailed mip level this texture should have resident, and reset the requests gathered for the next
+/// streaming update.
+///
+/// @param[in] evictionDelay  Number of updates for which the mip levels needed when the texture was last drawn
+///                           should be kept once it stops being drawn.
+///
+/// @return  Most detailed mip level needed, ignoring the streaming budget.
+uint32_t Texture2d::UpdateRequestedMipLevel( uint32_t evictionDelay )
+{
+    HELIUM_ASSERT( m_bStreaming );
+
+    if( IsValid( m_requestedMipLevel ) )
+    {
+        m_lastRequestedMipLevel = m_requestedMipLevel;
+        SetInvalid( m_requestedMipLevel );
+        m_updatesSinceRequested = 0;
+    }
+    else if( m_updatesSinceRequested < evictionDelay )
+    {
+        ++m_updatesSinceRequested;
+    }
+
+    if( m_updatesSinceRequested >= evictionDelay )
+    {
+        return m_minResidentMipLevel;
+    }
+
+    return Min( m_lastRequestedMipLevel, m_minResidentMipLevel );
+}
+
+/// Begin changing the resident mip levels of this texture.
+///
+/// The renderer has no support for partially resident textures, so a new texture is created with the requested mip
+/// chain and all of its levels are loaded from the cache.  The current texture remains in use until the load has
+/// finished (see TryFinishMipStreaming()).
+///
+/// @param[in] topMipLevel  Most detailed mip level to make resident.
+///
+/// @return  True if loading was started successfully, false if not.
+bool Texture2d::BeginMipStreaming( uint32_t topMipLevel )
+{
+    HELIUM_ASSERT( m_bStreaming );
+    HELIUM_ASSERT( !IsMipStreamingPending() );
+    HELIUM_ASSERT( topMipLevel <= m_minResidentMipLevel );
+
+    RTexture2d* pTexture2d = BeginLoadMipLevels( topMipLevel, m_streamingLoadIds );
+    if( !pTexture2d )
+    {
+        return false;
+    }
+
+    m_spStreamingTexture = pTexture2d;
+    m_streamingMipLevel = topMipLevel;
+
+    return true;
+}
+
+/// Test for completion of a change in the resident mip levels of this texture, swapping in the new texture once it
+/// has finished loading.
+///
+/// @return  True if no change is still pending, false if the new mip levels are still loading.
+///
+/// @see BeginMipStreaming()
+bool Texture2d::TryFinishMipStreaming()
+{
+    RTexture2d* pTexture2d = m_spStreamingTexture;
+    if( !pTexture2d )
+    {
+        return true;
+    }
+
+    if( !TryFinishLoadMipLevels( pTexture2d, m_streamingLoadIds ) )
+    {
+        return false;
+    }
+
+    m_streamingLoadIds.Clear();
+
+    m_spTexture = pTexture2d;
+    m_residentMipLevel = m_streamingMipLevel;
+    m_spStreamingTexture.Release();
+
+    return true;
+}
+
+/// Create a texture render resource for part of the mip chain of this texture and begin loading its mip levels.
+///
+/// @param[in]  topMipLevel  Most detailed mip level to load.
+/// @param[out] rLoadIds     Async load IDs for each mip level of the created texture.
+///
+/// @return  Created texture, or null if creation failed.
+///
+/// @see TryFinishLoadMipLevels()
+RTexture2d* Texture2d::BeginLoadMipLevels( uint32_t topMipLevel, DynamicArray< size_t >& rLoadIds )
+{
+    HELIUM_ASSERT( rLoadIds.IsEmpty() );
+
+    Renderer* pRenderer = Renderer::GetInstance();
+    HELIUM_ASSERT( pRenderer );
+
     const uint32_t mipCount = m_persistentResourceData.m_mipCount;
+    HELIUM_ASSERT( topMipLevel < mipCount || ( topMipLevel == 0 && mipCount == 0 ) );
+
+    const uint32_t width = Max< uint32_t >( m_persistentResourceData.m_baseLevelWidth >> topMipLevel, 1 );
+    const uint32_t height = Max< uint32_t >( m_persistentResourceData.m_baseLevelHeight >> topMipLevel, 1 );
+    const uint32_t loadMipCount = mipCount - topMipLevel;
     const int32_t pixelFormatIndex = m_persistentResourceData.m_pixelFormatIndex;
 
     RTexture2d* pTexture2d = pRenderer->CreateTexture2d(
-        baseLevelWidth,
-        baseLevelHeight,
-        mipCount,
+        width,
+        height,
+        loadMipCount,
         static_cast< ERendererPixelFormat >( pixelFormatIndex ),
         RENDERER_BUFFER_USAGE_STATIC );
 
@@ -72,44 +309,44 @@ bool Texture2d::BeginPrecacheResourceData()
     {
         HELIUM_TRACE(
             TraceLevels::Error,
-            ( TXT( "Texture2d::BeginPrecacheResourceData(): Failed to create texture render " )
+            ( TXT( "Texture2d::BeginLoadMipLevels(): Failed to create texture render " )
             TXT( "resource (width: %" ) PRIu32 TXT( "; height: %" ) PRIu32 TXT( "; mip count: %" )
             PRIu32 TXT( "; pixel format index: %" ) PRId32 TXT( ").\n" ) ),
-            baseLevelWidth,
-            baseLevelHeight,
-            mipCount,
+            width,
+            height,
+            loadMipCount,
             pixelFormatIndex );
 
-        return false;
+        return NULL;
     }
 
-    m_spTexture = pTexture2d;
-
-    m_renderResourceLoadIds.Reserve( mipCount );
-    m_renderResourceLoadIds.Resize( mipCount );
-    m_renderResourceLoadIds.Trim();
+    rLoadIds.Reserve( loadMipCount );
+    rLoadIds.Resize( loadMipCount );
+    rLoadIds.Trim();
 
     const ERendererPixelFormat format = static_cast< ERendererPixelFormat >( pixelFormatIndex );
     HELIUM_ASSERT( static_cast< size_t >( format ) < static_cast< size_t >( RENDERER_PIXEL_FORMAT_MAX ) );
 
-    for ( uint32_t mipIndex = 0; mipIndex < mipCount; ++mipIndex )
+    for ( uint32_t loadMipIndex = 0; loadMipIndex < loadMipCount; ++loadMipIndex )
     {
-        SetInvalid( m_renderResourceLoadIds[ mipIndex ] );
+        SetInvalid( rLoadIds[ loadMipIndex ] );
+
+        uint32_t mipIndex = topMipLevel + loadMipIndex;
 
         size_t pitch;
-        void* pMipData = pTexture2d->Map( mipIndex, pitch );
+        void* pMipData = pTexture2d->Map( loadMipIndex, pitch );
         HELIUM_ASSERT( pMipData );
         if ( !pMipData )
         {
             HELIUM_TRACE(
                 TraceLevels::Error,
-                TXT( "Texture2d::BeginPrecacheResourceData(): Failed to lock mip level %" ) PRIu32 TXT( ".\n" ),
+                TXT( "Texture2d::BeginLoadMipLevels(): Failed to lock mip level %" ) PRIu32 TXT( ".\n" ),
                 mipIndex );
 
             continue;
         }
 
-        uint32_t mipLevelHeight = pTexture2d->GetHeight( mipIndex );
+        uint32_t mipLevelHeight = pTexture2d->GetHeight( loadMipIndex );
         size_t rowCount = RendererUtil::PixelToBlockRowCount( mipLevelHeight, format );
         size_t mipLevelSize = pitch * rowCount;
 
@@ -121,40 +358,39 @@ bool Texture2d::BeginPrecacheResourceData()
         {
             HELIUM_TRACE(
                 TraceLevels::Error,
-                ( TXT( "Texture2d::BeginPrecacheResourceData(): Failed to begin loading of cached data for mip " )
+                ( TXT( "Texture2d::BeginLoadMipLevels(): Failed to begin loading of cached data for mip " )
                 TXT( "level %" ) PRIu32 TXT( ".\n" ) ),
                 mipIndex );
 
-            pTexture2d->Unmap( mipIndex );
+            pTexture2d->Unmap( loadMipIndex );
 
             continue;
         }
 
-        m_renderResourceLoadIds[ mipIndex ] = loadId;
+        rLoadIds[ loadMipIndex ] = loadId;
     }
 
-    return true;
+    return pTexture2d;
 }
 
-/// @copydoc Asset::TryFinishPrecacheResourceData()
-bool Texture2d::TryFinishPrecacheResourceData()
+/// Test for completion of the mip level loads started by BeginLoadMipLevels(), unmapping each level as it finishes.
+///
+/// @param[in] pTexture2d  Texture being loaded.
+/// @param[in] rLoadIds    Async load IDs for each mip level of the texture.
+///
+/// @return  True if all mip levels have finished loading, false if not.
+bool Texture2d::TryFinishLoadMipLevels( RTexture2d* pTexture2d, DynamicArray< size_t >& rLoadIds )
 {
-    // Check all pending load requests.
-    size_t loadRequestCount = m_renderResourceLoadIds.GetSize();
-    if( loadRequestCount == 0 )
-    {
-        return true;
-    }
-
-    RTexture2d* pTexture2d = static_cast< RTexture2d* >( m_spTexture.Get() );
     HELIUM_ASSERT( pTexture2d );
+
+    size_t loadRequestCount = rLoadIds.GetSize();
     HELIUM_ASSERT( loadRequestCount == pTexture2d->GetMipCount() );
 
     bool bHaveUnfinishedLoad = false;
 
     for( size_t loadRequestIndex = 0; loadRequestIndex < loadRequestCount; ++loadRequestIndex )
     {
-        size_t loadId = m_renderResourceLoadIds[ loadRequestIndex ];
+        size_t loadId = rLoadIds[ loadRequestIndex ];
         if( IsInvalid( loadId ) )
         {
             continue;
@@ -167,37 +403,52 @@ bool Texture2d::TryFinishPrecacheResourceData()
             continue;
         }
 
-        SetInvalid( m_renderResourceLoadIds[ loadRequestIndex ] );
+        SetInvalid( rLoadIds[ loadRequestIndex ] );
         pTexture2d->Unmap( static_cast< uint32_t >( loadRequestIndex ) );
     }
 
-    if( bHaveUnfinishedLoad )
-    {
-        return false;
-    }
-
-    m_renderResourceLoadIds.Clear();
-
-    return true;
+    return !bHaveUnfinishedLoad;
 }
 
-bool Texture2d::LoadPersistentResourceObject( Reflect::ObjectPtr& _object )
+/// Unregister this texture from the streaming manager and discard any pending change in its resident mip levels.
+void Texture2d::StopMipStreaming()
 {
-    m_spTexture.Release();
+    if( !m_bStreaming )
+    {
+        return;
+    }
 
-    HELIUM_ASSERT(_object.ReferencesObject());
-    if (!_object.ReferencesObject())
+    RenderResourceManager* pRenderResourceManager = RenderResourceManager::GetInstance();
+    if( pRenderResourceManager )
     {
-        return false;
+        pRenderResourceManager->GetTextureStreamingManager().UnregisterTexture( this );
     }
 
-    _object->CopyTo(&m_persistentResourceData);
+    m_bStreaming = false;
 
-    return true;
-}
+    RTexture2d* pTexture2d = m_spStreamingTexture;
+    if( pTexture2d )
+    {
+        // The loads write directly into the mapped texture data, so they must finish before it is released.
+        size_t loadRequestCount = m_streamingLoadIds.GetSize();
+        for( size_t loadRequestIndex = 0; loadRequestIndex < loadRequestCount; ++loadRequestIndex )
+        {
+            size_t loadId = m_streamingLoadIds[ loadRequestIndex ];
+            if( IsValid( loadId ) )
+            {
+                FinishLoadSubData( loadId );
+                pTexture2d->Unmap( static_cast< uint32_t >( loadRequestIndex ) );
+            }
+        }
 
-/// @copydoc Texture::GetRenderResource2d()
-RTexture2d* Texture2d::GetRenderResource2d() const
-{
-    return static_cast< RTexture2d* >( m_spTexture.Get() );
+        m_streamingLoadIds.Clear();
+        m_spStreamingTexture.Release();
+    }
+
+    m_mipChainSizes.Clear();
+    m_residentMipLevel = 0;
+    m_minResidentMipLevel = 0;
+    SetInvalid( m_requestedMipLevel );
+    SetInvalid( m_lastRequestedMipLevel );
+    SetInvalid( m_updatesSinceRequested );
 }
@@ -4,6 +4,8 @@
 
 namespace Helium
 {
+	HELIUM_DECLARE_RPTR( RTexture2d );
+
 	class Texture2d;
 	typedef Helium::StrongPtr< Texture2d > Texture2dPtr;
 	typedef Helium::StrongPtr< const Texture2d > ConstTexture2dPtr;
@@ -14,6 +16,9 @@ namespace Helium
 		HELIUM_DECLARE_ASSET( Texture2d, Texture );
 
 	public:
+		/// Largest dimension, in texels, of the smallest mip levels kept resident for streamed textures.
+		static const uint32_t STREAMING_RESIDENT_SIZE_MIN = 64;
+
 		/// @name Construction/Destruction
 		//@{
 		Texture2d();
@@ -36,6 +41,11 @@ namespace Helium
 		/// Persistent texture resource data.
 		PersistentResourceData m_persistentResourceData;
 
+		/// @name Asset Interface
+		//@{
+		virtual void RefCountPreDestroy() override;
+		//@}
+
 		/// @name Serialization
 		//@{
 		virtual bool NeedsPrecacheResourceData() const override;
@@ -56,9 +66,52 @@ namespace Helium
 		virtual RTexture2d* GetRenderResource2d() const override;
 		//@}
 
+		/// @name Mip Streaming
+		//@{
+		virtual void ReportScreenSize( float32_t screenSize ) override;
+
+		inline uint32_t GetResidentMipLevel() const;
+		inline uint32_t GetMinResidentMipLevel() const;
+		inline size_t GetMipChainSize( uint32_t topMipLevel ) const;
+
+		uint32_t UpdateRequestedMipLevel( uint32_t evictionDelay );
+		bool BeginMipStreaming( uint32_t topMipLevel );
+		bool TryFinishMipStreaming();
+		inline bool IsMipStreamingPending() const;
+		//@}
+
 	private:
 		/// Async load IDs for cached texture data.
 		DynamicArray< size_t > m_renderResourceLoadIds;
+
+		/// Texture being loaded for a pending change in the resident mip levels.
+		RTexture2dPtr m_spStreamingTexture;
+		/// Async load IDs for the mip levels of the pending streaming texture.
+		DynamicArray< size_t > m_streamingLoadIds;
+		/// Total size of the mip levels from each level to the end of the mip chain (with a trailing zero entry).
+		DynamicArray< size_t > m_mipChainSizes;
+
+		/// Most detailed mip level currently resident.
+		uint32_t m_residentMipLevel;
+		/// Most detailed mip level that is always kept resident while streaming.
+		uint32_t m_minResidentMipLevel;
+		/// Most detailed mip level of the pending streaming texture.
+		uint32_t m_streamingMipLevel;
+		/// Most detailed mip level needed for drawing since the last streaming update (invalid if not drawn).
+		uint32_t m_requestedMipLevel;
+		/// Most detailed mip level needed during the last streaming update in which the texture was drawn.
+		uint32_t m_lastRequestedMipLevel;
+		/// Number of streaming updates since the texture was last drawn (invalid if never drawn).
+		uint32_t m_updatesSinceRequested;
+		/// True if registered with the texture streaming manager.
+		bool m_bStreaming;
+
+		/// @name Private Utility Functions
+		//@{
+		RTexture2d* BeginLoadMipLevels( uint32_t topMipLevel, DynamicArray< size_t >& rLoadIds );
+		bool TryFinishLoadMipLevels( RTexture2d* pTexture2d, DynamicArray< size_t >& rLoadIds );
+		void StopMipStreaming();
+		//@}
 	};
 }
 
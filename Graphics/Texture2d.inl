@@ -10,4 +10,48 @@ namespace Helium
 	{
 		return m_persistentResourceData.m_baseLevelHeight;
 	}
+
+	/// Get the most detailed mip level currently resident.
+	///
+	/// @return  Index of the top resident mip level (zero unless the texture is streamed).
+	///
+	/// @see GetMinResidentMipLevel()
+	uint32_t Helium::Texture2d::GetResidentMipLevel() const
+	{
+		return m_residentMipLevel;
+	}
+
+	/// Get the most detailed mip level that is always kept resident while this texture is streamed.
+	///
+	/// @return  Index of the top mip level of the smallest resident mip chain.
+	///
+	/// @see GetResidentMipLevel()
+	uint32_t Helium::Texture2d::GetMinResidentMipLevel() const
+	{
+		return m_minResidentMipLevel;
+	}
+
+	/// Get the size of the render resource data for a partial mip chain of this texture.
+	///
+	/// This is only available while the texture is streamed.
+	///
+	/// @param[in] topMipLevel  Most detailed mip level in the chain (the mip count for an empty chain).
+	///
+	/// @return  Total size of the mip levels from the given level to the end of the mip chain, in bytes.
+	size_t Helium::Texture2d::GetMipChainSize( uint32_t topMipLevel ) const
+	{
+		HELIUM_ASSERT( topMipLevel < m_mipChainSizes.GetSize() );
+
+		return m_mipChainSizes[ topMipLevel ];
+	}
+
+	/// Get whether a change in the resident mip levels of this texture is still loading.
+	///
+	/// @return  True if a streaming texture is still being loaded, false if not.
+	///
+	/// @see BeginMipStreaming(), TryFinishMipStreaming()
+	bool Helium::Texture2d::IsMipStreamingPending() const
+	{
+		return m_spStreamingTexture.Get() != NULL;
+	}
 }
@@ -0,0 +1,147 @@
+#include "GraphicsPch.h"
+#include "Graphics/TextureStreamingManager.h"
+
+#include "Graphics/Texture2d.h"
+
+using namespace Helium;
+
+/// Constructor.
+TextureStreamingManager::TextureStreamingManager()
+	: m_budget( 0 )
+	, m_residentSize( 0 )
+{
+}
+
+/// Destructor.
+TextureStreamingManager::~TextureStreamingManager()
+{
+}
+
+/// Register a texture whose resident mip levels should be managed.
+///
+/// @param[in] pTexture  Streamed texture.
+///
+/// @see UnregisterTexture()
+void TextureStreamingManager::RegisterTexture( Texture2d* pTexture )
+{
+	HELIUM_ASSERT( pTexture );
+
+	MutexScopeLock scopeLock( m_textureLock );
+
+	m_textures.Push( pTexture );
+}
+
+/// Unregister a streamed texture.
+///
+/// @param[in] pTexture  Texture previously registered using RegisterTexture().
+///
+/// @see RegisterTexture()
+void TextureStreamingManager::UnregisterTexture( Texture2d* pTexture )
+{
+	HELIUM_ASSERT( pTexture );
+
+	MutexScopeLock scopeLock( m_textureLock );
+
+	size_t textureCount = m_textures.GetSize();
+	for( size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex )
+	{
+		if( m_textures[ textureIndex ] == pTexture )
+		{
+			m_textures[ textureIndex ] = m_textures[ textureCount - 1 ];
+			m_textures.Pop();
+
+			return;
+		}
+	}
+
+	HELIUM_ASSERT_MSG_FALSE( TXT( "TextureStreamingManager::UnregisterTexture(): Texture not registered." ) );
+}
+
+/// Update the resident mip levels of all streamed textures.
+///
+/// This should be called once per frame, after all scene views have been drawn.
+void TextureStreamingManager::Update()
+{
+	MutexScopeLock scopeLock( m_textureLock );
+
+	size_t textureCount = m_textures.GetSize();
+	m_targetMipLevels.Resize( textureCount );
+
+	// Swap in any textures that have finished loading and determine the mip levels each texture needs.
+	size_t targetSize = 0;
+	for( size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex )
+	{
+		Texture2d* pTexture = m_textures[ textureIndex ];
+		HELIUM_ASSERT( pTexture );
+
+		pTexture->TryFinishMipStreaming();
+
+		uint32_t targetMipLevel = pTexture->UpdateRequestedMipLevel( EVICTION_DELAY_UPDATE_COUNT );
+		m_targetMipLevels[ textureIndex ] = targetMipLevel;
+		targetSize += pTexture->GetMipChainSize( targetMipLevel );
+	}
+
+	// While over budget, drop the largest top mip level remaining.
+	while( targetSize > m_budget )
+	{
+		size_t dropTextureIndex = Invalid< size_t >();
+		size_t dropSize = 0;
+
+		for( size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex )
+		{
+			Texture2d* pTexture = m_textures[ textureIndex ];
+			uint32_t targetMipLevel = m_targetMipLevels[ textureIndex ];
+			if( targetMipLevel >= pTexture->GetMinResidentMipLevel() )
+			{
+				continue;
+			}
+
+			size_t mipLevelSize =
+				pTexture->GetMipChainSize( targetMipLevel ) - pTexture->GetMipChainSize( targetMipLevel + 1 );
+			if( mipLevelSize > dropSize )
+			{
+				dropTextureIndex = textureIndex;
+				dropSize = mipLevelSize;
+			}
+		}
+
+		if( IsInvalid( dropTextureIndex ) )
+		{
+			break;
+		}
+
+		++m_targetMipLevels[ dropTextureIndex ];
+		targetSize -= dropSize;
+	}
+
+	// Start moving textures towards their target residency.
+	size_t residentSize = 0;
+	size_t upgradeCount = 0;
+	for( size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex )
+	{
+		Texture2d* pTexture = m_textures[ textureIndex ];
+
+		uint32_t residentMipLevel = pTexture->GetResidentMipLevel();
+		residentSize += pTexture->GetMipChainSize( residentMipLevel );
+
+		uint32_t targetMipLevel = m_targetMipLevels[ textureIndex ];
+		if( targetMipLevel == residentMipLevel || pTexture->IsMipStreamingPending() )
+		{
+			continue;
+		}
+
+		if( targetMipLevel < residentMipLevel )
+		{
+			if( upgradeCount >= UPGRADE_COUNT_MAX_PER_UPDATE )
+			{
+				continue;
+			}
+
+			++upgradeCount;
+		}
+
+		pTexture->BeginMipStreaming( targetMipLevel );
+	}
+
+	m_residentSize = residentSize;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Graphics/Graphics.h"
+
+#include "Foundation/DynamicArray.h"
+#include "Platform/Locks.h"
+
+namespace Helium
+{
+	class Texture2d;
+
+	/// Manager for the resident mip levels of streamed 2D textures.
+	///
+	/// Streamed textures initially load only their smallest mip levels and register with this manager once loaded.
+	/// Each update, the mip level needed by each texture is determined from the on-screen sizes reported while it was
+	/// drawn (see Texture::ReportScreenSize()).  Textures no longer drawn fall back to their smallest mip levels after
+	/// a delay, and when the total size of the needed mip levels exceeds the memory budget, the most detailed mip level
+	/// of the largest textures is dropped until everything fits.  Textures are then moved towards their target
+	/// residency, with the number of textures gaining mip levels each update being limited to spread out the load.
+	class HELIUM_GRAPHICS_API TextureStreamingManager : NonCopyable
+	{
+	public:
+		/// Number of updates a texture keeps the mip levels it needed after it was last drawn.
+		static const uint32_t EVICTION_DELAY_UPDATE_COUNT = 60;
+		/// Maximum number of textures that can begin loading more detailed mip levels in a single update.
+		static const size_t UPGRADE_COUNT_MAX_PER_UPDATE = 8;
+
+		/// @name Construction/Destruction
+		//@{
+		TextureStreamingManager();
+		~TextureStreamingManager();
+		//@}
+
+		/// @name Budget
+		//@{
+		inline void SetBudget( size_t budget );
+		inline size_t GetBudget() const;
+		inline bool IsEnabled() const;
+
+		inline size_t GetResidentSize() const;
+		//@}
+
+		/// @name Texture Registration
+		//@{
+		void RegisterTexture( Texture2d* pTexture );
+		void UnregisterTexture( Texture2d* pTexture );
+		//@}
+
+		/// @name Updating
+		//@{
+		void Update();
+		//@}
+
+	private:
+		/// Registered textures.
+		DynamicArray< Texture2d* > m_textures;
+		/// Target top mip level for each registered texture (parallel to m_textures, rebuilt each update).
+		DynamicArray< uint32_t > m_targetMipLevels;
+		/// Mutex synchronizing access to the registered textures.
+		Mutex m_textureLock;
+
+		/// Memory budget for the mip levels of registered textures, in bytes (zero if streaming is disabled).
+		size_t m_budget;
+		/// Size of the mip levels currently resident for registered textures, in bytes.
+		size_t m_residentSize;
+	};
+}
+
+#include "Graphics/TextureStreamingManager.inl"
@@ -0,0 +1,40 @@
+namespace Helium
+{
+    /// Set the memory budget for streamed texture mip levels.
+    ///
+    /// @param[in] budget  Memory budget, in bytes, or zero to disable mip streaming for textures loaded afterwards.
+    ///
+    /// @see GetBudget(), IsEnabled()
+    void TextureStreamingManager::SetBudget( size_t budget )
+    {
+        m_budget = budget;
+    }
+
+    /// Get the memory budget for streamed texture mip levels.
+    ///
+    /// @return  Memory budget, in bytes, or zero if mip streaming is disabled.
+    ///
+    /// @see SetBudget(), IsEnabled()
+    size_t TextureStreamingManager::GetBudget() const
+    {
+        return m_budget;
+    }
+
+    /// Get whether textures should be loaded with streamed mip levels.
+    ///
+    /// @return  True if mip streaming is enabled, false if textures should load their full mip chains.
+    ///
+    /// @see GetBudget()
+    bool TextureStreamingManager::IsEnabled() const
+    {
+        return m_budget != 0;
+    }
+
+    /// Get the size of the mip levels currently resident for streamed textures.
+    ///
+    /// @return  Resident mip level size, in bytes, as of the last update.
+    size_t TextureStreamingManager::GetResidentSize() const
+    {
+        return m_residentSize;
+    }
+}
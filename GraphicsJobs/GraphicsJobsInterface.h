@@ -157,6 +157,14 @@ public:
         const GraphicsSceneObject* pSceneObjects;
         /// [out] Array of buffers in which to store the constant buffer data for each scene object.
         float32_t* const* ppConstantBufferData;
+        /// [in] Indices of the scene objects whose transforms should be written to the instance data buffer (one per
+        ///      instance, may be repeated), or null if the constant buffer data should be updated instead.
+        const size_t* pInstanceSceneObjectIndices;
+        /// [out] Instance data buffer in which to store the transform of each instance contiguously, or null if the
+        ///       constant buffer data should be updated instead.
+        float32_t* pInstanceData;
+        /// [in] Number of instances to write to the instance data buffer.
+        uint32_t instanceCount;
 
         /// @name Construction/Destruction
         //@{
@@ -164,6 +172,9 @@ public:
         //@}
     };
 
+    /// Number of floats written to the instance data buffer for each instance.
+    static const size_t INSTANCE_DATA_FLOAT_COUNT = 12;
+
     /// @name Construction/Destruction
     //@{
     inline UpdateGraphicsSceneObjectBuffersJob();
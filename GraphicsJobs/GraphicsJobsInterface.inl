@@ -218,6 +218,9 @@ namespace Helium
 
 	/// Constructor.
 	UpdateGraphicsSceneObjectBuffersJob::Parameters::Parameters()
+		: pInstanceSceneObjectIndices( NULL )
+		, pInstanceData( NULL )
+		, instanceCount( 0 )
 	{
 	}
 
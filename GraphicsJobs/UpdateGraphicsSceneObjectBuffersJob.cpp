@@ -5,14 +5,57 @@
 
 namespace Helium
 {
+    /// Store the transposed 3x4 portion of a scene object transform in a constant or instance buffer.
+    ///
+    /// @param[out] pBuffer     Buffer in which to store the transform.
+    /// @param[in]  rTransform  Scene object transform.
+    static void StoreTransform( float32_t* pBuffer, const Simd::Matrix44& rTransform )
+    {
+        // Transpose the matrix when loading into the buffer for proper interpretation by the shader.
+        *( pBuffer++ ) = rTransform.GetElement( 0 );
+        *( pBuffer++ ) = rTransform.GetElement( 4 );
+        *( pBuffer++ ) = rTransform.GetElement( 8 );
+        *( pBuffer++ ) = rTransform.GetElement( 12 );
+        *( pBuffer++ ) = rTransform.GetElement( 1 );
+        *( pBuffer++ ) = rTransform.GetElement( 5 );
+        *( pBuffer++ ) = rTransform.GetElement( 9 );
+        *( pBuffer++ ) = rTransform.GetElement( 13 );
+        *( pBuffer++ ) = rTransform.GetElement( 2 );
+        *( pBuffer++ ) = rTransform.GetElement( 6 );
+        *( pBuffer++ ) = rTransform.GetElement( 10 );
+        *pBuffer       = rTransform.GetElement( 14 );
+    }
+
     /// Update the instance buffer data for a set of graphics scene objects.
     ///
+    /// If an instance data buffer is provided, the transforms of the listed scene objects are written to it
+    /// contiguously for use as a per-instance vertex stream, and the constant buffers are left untouched.
+    ///
     /// @param[in] pContext  Context in which this job is running.
     void UpdateGraphicsSceneObjectBuffersJob::Run()
     {
         const GraphicsSceneObject* pSceneObjects = m_parameters.pSceneObjects;
         HELIUM_ASSERT( pSceneObjects );
 
+        float32_t* pInstanceData = m_parameters.pInstanceData;
+        if( pInstanceData )
+        {
+            const size_t* pInstanceSceneObjectIndices = m_parameters.pInstanceSceneObjectIndices;
+            HELIUM_ASSERT( pInstanceSceneObjectIndices );
+
+            uint_fast32_t instanceCount = m_parameters.instanceCount;
+            for( uint_fast32_t instanceIndex = 0; instanceIndex < instanceCount; ++instanceIndex )
+            {
+                size_t sceneObjectIndex = pInstanceSceneObjectIndices[ instanceIndex ];
+                HELIUM_ASSERT( sceneObjectIndex < m_parameters.sceneObjectCount );
+
+                StoreTransform( pInstanceData, pSceneObjects[ sceneObjectIndex ].GetTransform() );
+                pInstanceData += INSTANCE_DATA_FLOAT_COUNT;
+            }
+
+            return;
+        }
+
         float32_t* const* ppConstantBufferData = m_parameters.ppConstantBufferData;
         HELIUM_ASSERT( ppConstantBufferData );
 
@@ -27,23 +70,7 @@ namespace Helium
                 continue;
             }
 
-            const GraphicsSceneObject& rSceneObject = *pSceneObjects;
-
-            const Simd::Matrix44& rTransform = rSceneObject.GetTransform();
-
-            // Transpose the matrix when loading into the constant buffer for proper interpretation by the shader.
-            *( pConstantBuffer++ ) = rTransform.GetElement( 0 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 4 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 8 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 12 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 1 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 5 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 9 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 13 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 2 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 6 );
-            *( pConstantBuffer++ ) = rTransform.GetElement( 10 );
-            *pConstantBuffer       = rTransform.GetElement( 14 );
+            StoreTransform( pConstantBuffer, pSceneObjects->GetTransform() );
         }
     }
 }
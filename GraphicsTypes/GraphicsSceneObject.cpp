@@ -34,6 +34,9 @@ void GraphicsSceneObject::SetTransform( const Simd::Matrix44& rTransform )
 
 /// Set the world-space axis-aligned bounding box for this instance.
 ///
+/// Objects belonging to a GraphicsScene should have their bounds set through
+/// GraphicsScene::SetSceneObjectWorldBounds() instead so that the scene's culling grid is kept up to date.
+///
 /// @param[in] rBox  World-space axis-aligned bounding box to set.
 ///
 /// @see GetWorldBox(), GetWorldSphere()
@@ -1,6 +1,7 @@
 #include "PcSupportPch.h"
 #include "AssetPreprocessor.h"
 
+#include "Platform/Atomic.h"
 #include "Platform/File.h"
 #include "Foundation/FilePath.h"
 #include "Foundation/FileStream.h"
@@ -9,19 +10,128 @@
 #include "Engine/FileLocations.h"
 #include "Engine/CacheManager.h"
 #include "Engine/AssetLoader.h"
+#include "Engine/AsyncLoader.h"
 #include "Engine/Resource.h"
 #include "Engine/Config.h"
 #include "PcSupport/PlatformPreprocessor.h"
 #include "PcSupport/ResourceHandler.h"
 #include "Engine/PackageLoader.h"
+#include "Engine/Package.h"
 
 using namespace Helium;
 
 static uint32_t g_InitCount = 0;
 AssetPreprocessor* AssetPreprocessor::sm_pInstance = NULL;
 
+#if HELIUM_TOOLS
+/// Prime by which source content hashes are multiplied for each byte (64-bit FNV-1a prime).
+static const uint64_t SOURCE_HASH_PRIME = 0x100000001b3ULL;
+/// Size of the buffer used for reading files when hashing their contents.
+static const size_t FILE_HASH_BUFFER_SIZE = 64 * 1024;
+
+/// Add a block of data to a source content hash.
+///
+/// Hashes start from SOURCE_HASH_OFFSET_BASIS and are built up by hashing each block of source content in turn.
+///
+/// @param[in] hash   Current hash value.
+/// @param[in] pData  Data to hash.
+/// @param[in] size   Number of bytes to hash.
+///
+/// @return  Updated hash value.
+///
+/// @see ComputeSourceHash()
+uint64_t AssetPreprocessor::HashSourceData( uint64_t hash, const void* pData, size_t size )
+{
+	HELIUM_ASSERT( pData || size == 0 );
+
+	const uint8_t* pBytes = static_cast< const uint8_t* >( pData );
+	for( size_t byteIndex = 0; byteIndex < size; ++byteIndex )
+	{
+		hash = ( hash ^ pBytes[ byteIndex ] ) * SOURCE_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+/// Object caching job data.
+struct CacheObjectJob
+{
+	/// Preprocessor caching the object.
+	AssetPreprocessor* pPreprocessor;
+	/// Object path.
+	AssetPath path;
+	/// Object to cache.
+	AssetPtr spObject;
+	/// Object timestamp.
+	int64_t timestamp;
+	/// True to evict the preprocessed resource data after caching.
+	bool bEvictPlatformPreprocessedResourceData;
+};
+
+/// Load progress of the assets being cooked by AssetPreprocessor::CookPackages().
+struct CookLoadState
+{
+	/// Number of assets still loading.
+	size_t pendingLoadCount;
+	/// Loaded assets, kept referenced until the cook has finished so that they are never destroyed by caching jobs.
+	DynamicArray< AssetPtr > loadedAssets;
+	/// True if any assets failed to load.
+	bool bFailure;
+};
+
+/// Load continuation tracking the assets loaded by AssetPreprocessor::CookPackages().
+///
+/// @param[in] pUserData  CookLoadState to update.
+/// @param[in] rspObject  Loaded asset, or null if the asset failed to load.
+static void CookLoadContinuation( void* pUserData, const AssetPtr& rspObject )
+{
+	CookLoadState* pState = static_cast< CookLoadState* >( pUserData );
+	HELIUM_ASSERT( pState );
+	HELIUM_ASSERT( pState->pendingLoadCount != 0 );
+
+	--pState->pendingLoadCount;
+
+	if( rspObject )
+	{
+		pState->loadedAssets.Push( rspObject );
+	}
+	else
+	{
+		pState->bFailure = true;
+	}
+}
+
+/// Worker thread asset loader ticking state used by AssetPreprocessor::CookPackages().
+struct CookTickState
+{
+	/// Asset loader to tick.
+	AssetLoader* pAssetLoader;
+	/// Set to non-zero by the tick jobs if they ticked any load requests.
+	volatile int32_t bTickedRequests;
+};
+
+/// Job callback linking and preparing all ready asset load requests for precaching from a job worker thread.
+///
+/// @param[in] pData  CookTickState to update.
+static void TickAssetLoaderJobCallback( void* pData )
+{
+	CookTickState* pState = static_cast< CookTickState* >( pData );
+	HELIUM_ASSERT( pState );
+	HELIUM_ASSERT( pState->pAssetLoader );
+
+	if( pState->pAssetLoader->TickWorker() != 0 )
+	{
+		AtomicExchangeRelease( pState->bTickedRequests, 1 );
+	}
+}
+#endif  // HELIUM_TOOLS
+
 /// Constructor.
 AssetPreprocessor::AssetPreprocessor()
+#if HELIUM_TOOLS
+	: m_batchFailureCount( 0 )
+	, m_bBatchCaching( false )
+#endif
 {
 	MemoryZero( m_pPlatformPreprocessors, sizeof( m_pPlatformPreprocessors ) );
 }
@@ -29,6 +139,11 @@ AssetPreprocessor::AssetPreprocessor()
 /// Destructor.
 AssetPreprocessor::~AssetPreprocessor()
 {
+#if HELIUM_TOOLS
+	HELIUM_ASSERT( !m_bBatchCaching );
+	HELIUM_ASSERT( m_cacheWriteQueues.IsEmpty() );
+#endif
+
 	for( size_t platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
 	{
 		delete m_pPlatformPreprocessors[ platformIndex ];
@@ -53,6 +168,10 @@ void AssetPreprocessor::SetPlatformPreprocessor( Cache::EPlatform platform, Plat
 
 /// Cache an object for all registered platforms.
 ///
+/// Platforms for which the object has already been cached from the same source content (see ComputeSourceHash()) are
+/// skipped.  While batch caching (see CookPackages()), the object is serialized in a job and its cache entries are queued to be
+/// written out with those of other objects, so this only returns whether the object was queued for caching.
+///
 /// @param[in] pObject                                 Asset to cache.
 /// @param[in] timestamp                               Asset timestamp.
 /// @param[in] bEvictPlatformPreprocessedResourceData  If the object being cached is a Resource-based object,
@@ -74,6 +193,376 @@ bool AssetPreprocessor::CacheObject(
 
 	HELIUM_ASSERT( pObject );
 
+	JobManager* pJobManager = JobManager::GetInstance();
+	if( m_bBatchCaching && pJobManager )
+	{
+		CacheObjectJob* pJob = new CacheObjectJob;
+		HELIUM_ASSERT( pJob );
+		pJob->pPreprocessor = this;
+		pJob->path = objectPath;
+		pJob->spObject = pObject;
+		pJob->timestamp = timestamp;
+		pJob->bEvictPlatformPreprocessedResourceData = bEvictPlatformPreprocessedResourceData;
+
+		pJobManager->SpawnJob( CacheObjectJobCallback, pJob, &m_cacheObjectCounter );
+
+		return true;
+	}
+
+	return WriteObjectCacheData( objectPath, pObject, timestamp, bEvictPlatformPreprocessedResourceData );
+
+#else  // HELIUM_TOOLS
+
+	HELIUM_UNREF( pObject );
+	HELIUM_UNREF( timestamp );
+	HELIUM_UNREF( bEvictPlatformPreprocessedResourceData );
+
+	return false;
+
+#endif  // HELIUM_TOOLS
+}
+
+/// Compute a hash of the source content from which the cached data of an object is built.
+///
+/// The hash covers the object type, the contents of the asset file defining the object, the source file contents
+/// and resource handler version of resources, and the source hashes of the object template and owner.  Cached data is
+/// rebuilt when this hash changes rather than when file timestamps change, so touching files without changing them
+/// does not cause a recook, while a change to any object the data depends on does.
+///
+/// @param[in] objectPath  Path of the object.
+/// @param[in] pObject     Object for which to compute the hash.
+///
+/// @return  Source content hash.
+uint64_t AssetPreprocessor::ComputeSourceHash( const AssetPath &objectPath, Asset* pObject )
+{
+#if HELIUM_TOOLS
+
+	HELIUM_ASSERT( pObject );
+
+	const AssetType* pType = pObject->GetAssetType();
+	HELIUM_ASSERT( pType );
+
+	const char* pTypeName = *pType->GetName();
+	uint64_t hash = HashSourceData( SOURCE_HASH_OFFSET_BASIS, pTypeName, StringLength( pTypeName ) );
+
+	if( pObject->IsDefaultTemplate() )
+	{
+		return hash;
+	}
+
+	const FilePath* pAssetFilePath = pObject->GetAssetFileSystemPath();
+	if( pAssetFilePath )
+	{
+		uint64_t assetFileHash = GetFileHash( *pAssetFilePath );
+		hash = HashSourceData( hash, &assetFileHash, sizeof( assetFileHash ) );
+	}
+
+	Resource* pResource = Reflect::SafeCast< Resource >( pObject );
+	if( pResource )
+	{
+		FilePath sourceFilePath;
+		if( GetResourceSourceFilePath( objectPath, pResource, sourceFilePath ) )
+		{
+			uint64_t sourceFileHash = GetFileHash( sourceFilePath );
+			hash = HashSourceData( hash, &sourceFileHash, sizeof( sourceFileHash ) );
+		}
+
+		ResourceHandler* pResourceHandler = ResourceHandler::FindResourceHandlerForType( pType );
+		uint32_t handlerVersion = ( pResourceHandler ? pResourceHandler->GetVersion() : 0 );
+		hash = HashSourceData( hash, &handlerVersion, sizeof( handlerVersion ) );
+	}
+
+	Asset* pTemplate = Reflect::SafeCast< Asset >( pObject->GetTemplate() );
+	if( pTemplate && !pTemplate->IsDefaultTemplate() )
+	{
+		uint64_t templateHash = ComputeSourceHash( pTemplate->GetPath(), pTemplate );
+		hash = HashSourceData( hash, &templateHash, sizeof( templateHash ) );
+	}
+
+	Asset* pOwner = pObject->GetOwner();
+	if( pOwner && !pOwner->IsPackage() )
+	{
+		uint64_t ownerHash = ComputeSourceHash( pOwner->GetPath(), pOwner );
+		hash = HashSourceData( hash, &ownerHash, sizeof( ownerHash ) );
+	}
+
+	return hash;
+
+#else  // HELIUM_TOOLS
+
+	HELIUM_UNREF( objectPath );
+	HELIUM_UNREF( pObject );
+
+	return 0;
+
+#endif  // HELIUM_TOOLS
+}
+
+/// Load and cache every asset in a set of packages for all registered platforms.
+///
+/// Child packages are cooked along with their parents.  All assets are loaded at once, with their linking and resource
+/// preprocessing spread across the job worker threads if a JobManager has been started, and the objects are cached in
+/// a single batch (see CacheObject()).  Assets that are already loaded when this is called are not recached.
+///
+/// @param[in] pPackagePaths  Paths of the packages to cook.
+/// @param[in] packageCount   Number of packages to cook.
+///
+/// @return  True if every asset was loaded and cached successfully, false if any errors occurred.
+bool AssetPreprocessor::CookPackages( const AssetPath* pPackagePaths, size_t packageCount )
+{
+#if HELIUM_TOOLS
+
+	HELIUM_ASSERT( pPackagePaths || packageCount == 0 );
+
+	AssetLoader* pAssetLoader = AssetLoader::GetInstance();
+	HELIUM_ASSERT( pAssetLoader );
+
+	JobManager* pJobManager = JobManager::GetInstance();
+	int32_t workerThreadCount = ( pJobManager ? static_cast< int32_t >( pJobManager->GetWorkerThreadCount() ) : 0 );
+
+	BeginCacheBatch();
+
+	CookLoadState loadState;
+	loadState.pendingLoadCount = 0;
+	loadState.bFailure = false;
+
+	DynamicArray< AssetPath > packagePaths;
+	packagePaths.Reserve( packageCount );
+	for( size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex )
+	{
+		packagePaths.Push( pPackagePaths[ packageIndex ] );
+	}
+
+	// Load each package and begin loading its assets, adding child packages to the list of packages to cook.
+	DynamicArray< AssetPath > childPaths;
+	for( size_t packageIndex = 0; packageIndex < packagePaths.GetSize(); ++packageIndex )
+	{
+		AssetPath packagePath = packagePaths[ packageIndex ];
+
+		AssetPtr spPackage;
+		pAssetLoader->LoadObject( packagePath, spPackage );
+
+		Package* pPackage = Reflect::SafeCast< Package >( spPackage.Get() );
+		PackageLoader* pPackageLoader = ( pPackage ? pPackage->GetLoader() : NULL );
+		if( !pPackageLoader )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				TXT( "AssetPreprocessor::CookPackages(): Failed to load package \"%s\".\n" ),
+				*packagePath.ToString() );
+
+			loadState.bFailure = true;
+
+			continue;
+		}
+
+		childPaths.Resize( 0 );
+		pPackageLoader->EnumerateChildren( childPaths );
+
+		size_t childCount = childPaths.GetSize();
+		for( size_t childIndex = 0; childIndex < childCount; ++childIndex )
+		{
+			const AssetPath& rChildPath = childPaths[ childIndex ];
+			if( rChildPath.IsPackage() )
+			{
+				packagePaths.Push( rChildPath );
+
+				continue;
+			}
+
+			size_t loadId = pAssetLoader->BeginLoadObject( rChildPath );
+			HELIUM_ASSERT( IsValid( loadId ) );
+
+			++loadState.pendingLoadCount;
+			pAssetLoader->AddContinuation( loadId, CookLoadContinuation, &loadState );
+		}
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "AssetPreprocessor::CookPackages(): Cooking %" ) PRIuSZ TXT( " assets from %" ) PRIuSZ TXT( " packages.\n" ),
+		loadState.pendingLoadCount,
+		packagePaths.GetSize() );
+
+	// Tick loading until every asset has been loaded and handed off for caching.  Each update, a job is queued for each
+	// worker thread to link ready load requests and preprocess their resources, while resource precaching is left to
+	// Tick() on this thread.
+	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
+	HELIUM_ASSERT( pAsyncLoader );
+
+	CookTickState tickState;
+	tickState.pAssetLoader = pAssetLoader;
+	tickState.bTickedRequests = 0;
+
+	while( loadState.pendingLoadCount != 0 )
+	{
+		size_t previousPendingLoadCount = loadState.pendingLoadCount;
+
+		pAssetLoader->Tick();
+		FlushCacheWrites( false );
+
+		tickState.bTickedRequests = 0;
+		if( workerThreadCount != 0 )
+		{
+			// Jobs are also run from this thread while waiting.
+			JobCounter tickJobCounter;
+			for( int32_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+			{
+				pJobManager->SpawnJob( TickAssetLoaderJobCallback, &tickState, &tickJobCounter );
+			}
+
+			pJobManager->WaitForCounter( tickJobCounter );
+		}
+
+		// If nothing advanced, sleep until an async file read completes instead of spinning.  If no reads are pending,
+		// run any job (such as package parsing) that the remaining loads may be waiting on.
+		if( loadState.pendingLoadCount == previousPendingLoadCount && !tickState.bTickedRequests &&
+			!pAsyncLoader->WaitForCompletion() && pJobManager )
+		{
+			pJobManager->TryRunJob();
+		}
+	}
+
+	bool bCacheSuccess = EndCacheBatch();
+
+	return ( bCacheSuccess && !loadState.bFailure );
+
+#else  // HELIUM_TOOLS
+
+	HELIUM_UNREF( pPackagePaths );
+	HELIUM_UNREF( packageCount );
+
+	return false;
+
+#endif  // HELIUM_TOOLS
+}
+
+/// Load data for the specified resource into memory, preprocessing it from source data if it is out-of-date.
+///
+/// Cached resource data is considered up-to-date if it was built from source content with the same hash (see
+/// ComputeSourceHash()).
+///
+/// @param[in] resourcePath  Path of the resource.
+/// @param[in] pResource     Resource to load.
+void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resource* pResource )
+{
+#if HELIUM_TOOLS
+
+	HELIUM_ASSERT( pResource );
+
+	FilePath sourceFilePath;
+	if( !GetResourceSourceFilePath( resourcePath, pResource, sourceFilePath ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "AssetPreprocessor::LoadResourceData(): Could not retrieve data directory.\n" ) );
+
+		return;
+	}
+
+	uint64_t sourceHash = ComputeSourceHash( resourcePath, pResource );
+
+	// Check if data is loaded for each supported platform, attempting to load the data from the cache if it exists
+	// and is up-to-date.
+	size_t platformIndex;
+	for( platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
+	{
+		// Skip platforms for which we don't have preprocessing support.
+		PlatformPreprocessor* pPreprocessor = m_pPlatformPreprocessors[ platformIndex ];
+		if( !pPreprocessor )
+		{
+			continue;
+		}
+
+		// Check if we already have loaded resource data.
+		const Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData(
+			static_cast< Cache::EPlatform >( platformIndex ) );
+		if( rPreprocessedData.bLoaded )
+		{
+			continue;
+		}
+
+		// Retrieve the source hash of the cached data using the object cache.
+		AssetLoader* pAssetLoader = AssetLoader::GetInstance();
+		HELIUM_ASSERT( pAssetLoader );
+
+		CacheManager* pCacheManager = CacheManager::GetInstance();
+		HELIUM_ASSERT( pCacheManager );
+
+		Cache* pCache = pCacheManager->GetCache(
+			Name( HELIUM_ASSET_CACHE_NAME ),
+			static_cast< Cache::EPlatform >( platformIndex ) );
+		HELIUM_ASSERT( pCache );
+		pCache->EnforceTocLoad();
+
+		const Cache::Entry* pCacheEntry = pCache->FindEntry( resourcePath, 0 );
+		if( !pCacheEntry || pCacheEntry->sourceHash != sourceHash )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Info,
+				( TXT( "AssetPreprocessor::LoadResourceData(): Cached resource data not found or is out-of-date " )
+				TXT( "for resource \"%s\".  Resource will be preprocessed.\n" ) ),
+				*resourcePath.ToString() );
+
+			break;
+		}
+
+		// Cached data should be up-to-date, so attempt to load the data from the cache.
+		if( !LoadCachedResourceData( resourcePath, pResource, static_cast< Cache::EPlatform >( platformIndex ) ) )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Warning,
+				( TXT( "AssetPreprocessor::LoadResourceData(): Failed to load cached resource data for " )
+				TXT( "\"%s\".  Resource will be preprocessed again.\n" ) ),
+				*resourcePath.ToString() );
+
+			break;
+		}
+	}
+
+	if( platformIndex >= HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ) )
+	{
+		// All supported platforms loaded successfully, so nothing else needs to be done.
+		return;
+	}
+
+	// Preprocess all resources for each supported platform.
+	if( !PreprocessResource( resourcePath, pResource, String( sourceFilePath.Data() ) ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "AssetPreprocessor::LoadResourceData(): Preprocessing of resource \"%s\" failed.\n" ),
+			*resourcePath.ToString() );
+	}
+
+#else  // HELIUM_TOOLS
+
+	HELIUM_UNREF( pResource );
+
+#endif  // HELIUM_TOOLS
+}
+
+
+#if HELIUM_TOOLS
+/// Serialize an object for all registered platforms and write its cache entries.
+///
+/// @param[in] objectPath                              Path of the object to cache.
+/// @param[in] pObject                                 Asset to cache.
+/// @param[in] timestamp                               Asset timestamp.
+/// @param[in] bEvictPlatformPreprocessedResourceData  True to free the preprocessed resource data of a Resource-based
+///                                                    object after caching.
+///
+/// @return  True if object caching was successful, false if not.
+///
+/// @see CacheObject()
+bool AssetPreprocessor::WriteObjectCacheData(
+	const AssetPath &objectPath,
+	Asset* pObject,
+	int64_t timestamp,
+	bool bEvictPlatformPreprocessedResourceData )
+{
+	HELIUM_ASSERT( pObject );
+
 	bool bCacheFailure = false;
 
 	DynamicArray< uint8_t > objectStreamBuffer;
@@ -108,8 +597,14 @@ bool AssetPreprocessor::CacheObject(
 		objectCacheName = Name( HELIUM_ASSET_CACHE_NAME );
 	}
 
+	uint64_t sourceHash = ComputeSourceHash( objectPath, pObject );
+
 	bool bUpdatedAnyCache = false;
 
+	// The object property data is the same for every platform, so it is only serialized once.
+	DynamicArray< uint8_t > data_buffer;
+	bool bSerializedObject = false;
+
 	for( size_t platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
 	{
 		// Don't cache on platforms for which we don't have a preprocessor.
@@ -124,9 +619,9 @@ bool AssetPreprocessor::CacheObject(
 		HELIUM_ASSERT( pCache );
 		pCache->EnforceTocLoad();
 
-		// Don't recache the object if an up-to-date cache entry already exists for it.
+		// Don't recache the object if a cache entry built from the same source content already exists for it.
 		const Cache::Entry* pEntry = pCache->FindEntry( objectPath, 0 );
-		if( pEntry && pEntry->timestamp == timestamp )
+		if( pEntry && pEntry->sourceHash == sourceHash )
 		{
 			continue;
 		}
@@ -146,8 +641,11 @@ bool AssetPreprocessor::CacheObject(
 		Stream& rObjectStream =
 			( bSwapBytes ? static_cast< Stream& >( byteSwappingStream ) : static_cast< Stream& >( directStream ) );
 		
-		DynamicArray<uint8_t> data_buffer;
-		Cache::WriteCacheObjectToBuffer( pObject, data_buffer);
+		if( !bSerializedObject )
+		{
+			Cache::WriteCacheObjectToBuffer( pObject, data_buffer );
+			bSerializedObject = true;
+		}
 
 		if (!data_buffer.IsEmpty())
 		{
@@ -174,7 +672,7 @@ bool AssetPreprocessor::CacheObject(
 			{
 				HELIUM_TRACE(
 					TraceLevels::Warning,
-					( TXT( "AssetPreprocessor::CacheObject(): Cannot cache resource data for \"%s\" for " )
+					( TXT( "AssetPreprocessor::WriteObjectCacheData(): Cannot cache resource data for \"%s\" for " )
 					TXT( "platform index %" ) PRIuSZ TXT( " as the resource data is not in memory.  Make sure " )
 					TXT( "AssetPreprocessor::LoadResourceData() has been called on the object prior to " )
 					TXT( "caching.\n" ) ),
@@ -209,12 +707,16 @@ bool AssetPreprocessor::CacheObject(
 		size_t objectDataSize = objectStreamBuffer.GetSize();
 		HELIUM_ASSERT( objectDataSize <= UINT32_MAX );
 
-		bool bCacheResult = pCache->CacheEntry(
-			objectPath,
-			0,
-			objectStreamBuffer.GetData(),
-			timestamp,
-			static_cast< uint32_t >( objectDataSize ) );
+		Cache::EntryWrite objectWrite;
+		objectWrite.path = objectPath;
+		objectWrite.subDataIndex = 0;
+		objectWrite.pData = objectStreamBuffer.GetData();
+		objectWrite.timestamp = timestamp;
+		objectWrite.sourceHash = sourceHash;
+		objectWrite.size = static_cast< uint32_t >( objectDataSize );
+		objectWrite.bCompress = false;
+
+		bool bCacheResult = WriteCacheEntries( pCache, &objectWrite, 1 );
 		if( !bCacheResult )
 		{
 			HELIUM_TRACE(
@@ -246,29 +748,37 @@ bool AssetPreprocessor::CacheObject(
 					HELIUM_ASSERT( pResourceCache );
 					pResourceCache->EnforceTocLoad();
 
+					// Cache all of the sub-data in a single batch.
+					bool bCompressSubData = pResource->ShouldCompressSubData();
+
+					DynamicArray< Cache::EntryWrite > subDataWrites;
+					subDataWrites.Reserve( subDataBufferCount );
 					for( size_t subDataBufferIndex = 0;
 						subDataBufferIndex < subDataBufferCount;
 						++subDataBufferIndex )
 					{
 						const DynamicArray< uint8_t >& rSubData = rSubDataBuffers[ subDataBufferIndex ];
 
-						bCacheResult = pResourceCache->CacheEntry(
-							objectPath,
-							static_cast< uint32_t >( subDataBufferIndex ),
-							rSubData.GetData(),
-							timestamp,
-							static_cast< uint32_t >( rSubData.GetSize() ) );
-						if( !bCacheResult )
-						{
-							HELIUM_TRACE(
-								TraceLevels::Error,
-								( TXT( "AssetPreprocessor: Failed to cache resource sub-data %" ) PRIuSZ
-								TXT( " for resource \"%s\".\n" ) ),
-								subDataBufferIndex,
-								*objectPath.ToString() );
-
-							bCacheFailure = true;
-						}
+						Cache::EntryWrite* pWrite = subDataWrites.New();
+						HELIUM_ASSERT( pWrite );
+						pWrite->path = objectPath;
+						pWrite->subDataIndex = static_cast< uint32_t >( subDataBufferIndex );
+						pWrite->pData = rSubData.GetData();
+						pWrite->timestamp = timestamp;
+						pWrite->sourceHash = sourceHash;
+						pWrite->size = static_cast< uint32_t >( rSubData.GetSize() );
+						pWrite->bCompress = bCompressSubData;
+					}
+
+					bCacheResult = WriteCacheEntries( pResourceCache, subDataWrites.GetData(), subDataBufferCount );
+					if( !bCacheResult )
+					{
+						HELIUM_TRACE(
+							TraceLevels::Error,
+							TXT( "AssetPreprocessor: Failed to cache resource sub-data for resource \"%s\".\n" ),
+							*objectPath.ToString() );
+
+						bCacheFailure = true;
 					}
 				}
 
@@ -291,32 +801,220 @@ bool AssetPreprocessor::CacheObject(
 	}
 
 	return !bCacheFailure;
+}
 
-#else  // HELIUM_TOOLS
+/// Write a set of entries to a cache, or queue them to be written out later while batch caching.
+///
+/// @param[in] pCache      Cache to update.
+/// @param[in] pWrites     Entries to cache.  While batch caching, the entry data is copied, so it does not need to
+///                        remain valid after this returns.
+/// @param[in] writeCount  Number of entries to cache.
+///
+/// @return  True if the entries were cached or queued successfully, false if not.
+bool AssetPreprocessor::WriteCacheEntries( Cache* pCache, const Cache::EntryWrite* pWrites, size_t writeCount )
+{
+	HELIUM_ASSERT( pCache );
+	HELIUM_ASSERT( pWrites || writeCount == 0 );
 
-	HELIUM_UNREF( pObject );
-	HELIUM_UNREF( timestamp );
-	HELIUM_UNREF( bEvictPlatformPreprocessedResourceData );
+	if( !m_bBatchCaching )
+	{
+		return pCache->CacheEntries( pWrites, writeCount );
+	}
 
-	return false;
+	CacheWriteQueue* pQueue = GetCacheWriteQueue( pCache );
+	HELIUM_ASSERT( pQueue );
 
-#endif  // HELIUM_TOOLS
+	MutexScopeLock scopeLock( pQueue->lock );
+
+	for( size_t writeIndex = 0; writeIndex < writeCount; ++writeIndex )
+	{
+		const Cache::EntryWrite& rWrite = pWrites[ writeIndex ];
+
+		size_t dataOffset = pQueue->data.GetSize();
+		pQueue->data.Resize( dataOffset + rWrite.size );
+		MemoryCopy( pQueue->data.GetData() + dataOffset, rWrite.pData, rWrite.size );
+
+		Cache::EntryWrite queuedWrite = rWrite;
+		queuedWrite.pData = NULL;
+		pQueue->writes.Push( queuedWrite );
+		pQueue->dataOffsets.Push( dataOffset );
+	}
+
+	return true;
 }
 
-/// Load data for the specified resource into memory, preprocessing it from source data if it is out-of-date.
+/// Begin queuing the objects passed to CacheObject() for caching in a single batch.
 ///
-/// @param[in] pResource        Resource to load.
-/// @param[in] objectTimestamp  Timestamp of the object data stored on disk.  This will be combined with the source
-///                             asset timestamp to get the timestamp value with which to compare against the cached
-///                             data.
-void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resource* pResource )
+/// @see EndCacheBatch()
+void AssetPreprocessor::BeginCacheBatch()
 {
-#if HELIUM_TOOLS
+	HELIUM_ASSERT( !m_bBatchCaching );
+
+	m_batchFailureCount = 0;
+	m_bBatchCaching = true;
+}
+
+/// Finish batch caching, waiting for all object caching jobs to complete and writing out all queued cache entries.
+///
+/// @return  True if every object in the batch was cached successfully, false if any errors occurred.
+///
+/// @see BeginCacheBatch()
+bool AssetPreprocessor::EndCacheBatch()
+{
+	HELIUM_ASSERT( m_bBatchCaching );
+
+	JobManager* pJobManager = JobManager::GetInstance();
+	if( pJobManager )
+	{
+		pJobManager->WaitForCounter( m_cacheObjectCounter );
+	}
+
+	FlushCacheWrites( true );
+
+	bool bSuccess = ( m_batchFailureCount == 0 );
+
+	size_t queueCount = m_cacheWriteQueues.GetSize();
+	for( size_t queueIndex = 0; queueIndex < queueCount; ++queueIndex )
+	{
+		CacheWriteQueue* pQueue = m_cacheWriteQueues[ queueIndex ];
+		HELIUM_ASSERT( pQueue );
+		HELIUM_ASSERT( pQueue->writes.IsEmpty() );
 
+		if( pQueue->bWriteFailed )
+		{
+			bSuccess = false;
+		}
+
+		delete pQueue;
+	}
+
+	m_cacheWriteQueues.Clear();
+	m_bBatchCaching = false;
+
+	return bSuccess;
+}
+
+/// Get the batch write queue for a cache, creating it if it does not exist yet.
+///
+/// @param[in] pCache  Cache to which the queued entries will be written.
+///
+/// @return  Write queue for the cache.
+AssetPreprocessor::CacheWriteQueue* AssetPreprocessor::GetCacheWriteQueue( Cache* pCache )
+{
+	HELIUM_ASSERT( pCache );
+
+	MutexScopeLock scopeLock( m_cacheWriteQueueLock );
+
+	size_t queueCount = m_cacheWriteQueues.GetSize();
+	for( size_t queueIndex = 0; queueIndex < queueCount; ++queueIndex )
+	{
+		CacheWriteQueue* pQueue = m_cacheWriteQueues[ queueIndex ];
+		HELIUM_ASSERT( pQueue );
+		if( pQueue->pCache == pCache )
+		{
+			return pQueue;
+		}
+	}
+
+	CacheWriteQueue* pQueue = new CacheWriteQueue;
+	HELIUM_ASSERT( pQueue );
+	pQueue->pCache = pCache;
+	pQueue->bWriteFailed = false;
+
+	m_cacheWriteQueues.Push( pQueue );
+
+	return pQueue;
+}
+
+/// Start writing out the entries queued while batch caching.
+///
+/// Each cache is only written by one job at a time, so the entries of a cache that is still being written remain
+/// queued until its writer has finished.
+///
+/// @param[in] bFinal  True to write out every queued entry and wait for all writes to complete, false to only start
+///                    writing the caches with at least CACHE_WRITE_BATCH_SIZE bytes of queued data.
+void AssetPreprocessor::FlushCacheWrites( bool bFinal )
+{
+	JobManager* pJobManager = JobManager::GetInstance();
+
+	// Writer jobs may be run while waiting below, so the queue list is copied instead of being kept locked.
+	DynamicArray< CacheWriteQueue* > queues;
+	{
+		MutexScopeLock scopeLock( m_cacheWriteQueueLock );
+		queues = m_cacheWriteQueues;
+	}
+
+	size_t queueCount = queues.GetSize();
+	for( size_t queueIndex = 0; queueIndex < queueCount; ++queueIndex )
+	{
+		CacheWriteQueue* pQueue = queues[ queueIndex ];
+		HELIUM_ASSERT( pQueue );
+
+		if( !pQueue->writeCounter.IsDone() )
+		{
+			if( !bFinal )
+			{
+				continue;
+			}
+
+			HELIUM_ASSERT( pJobManager );
+			pJobManager->WaitForCounter( pQueue->writeCounter );
+		}
+
+		{
+			MutexScopeLock scopeLock( pQueue->lock );
+
+			if( pQueue->writes.IsEmpty() || ( !bFinal && pQueue->data.GetSize() < CACHE_WRITE_BATCH_SIZE ) )
+			{
+				continue;
+			}
+
+			// Hand the queued entries to the writer, reusing the buffers from its previous batch for new entries.
+			pQueue->flushWrites.Swap( pQueue->writes );
+			pQueue->flushDataOffsets.Swap( pQueue->dataOffsets );
+			pQueue->flushData.Swap( pQueue->data );
+
+			pQueue->writes.Resize( 0 );
+			pQueue->dataOffsets.Resize( 0 );
+			pQueue->data.Resize( 0 );
+		}
+
+		if( pJobManager )
+		{
+			pJobManager->SpawnJob( WriteCacheQueueJobCallback, pQueue, &pQueue->writeCounter );
+		}
+		else
+		{
+			WriteCacheQueueJobCallback( pQueue );
+		}
+	}
+
+	if( bFinal && pJobManager )
+	{
+		for( size_t queueIndex = 0; queueIndex < queueCount; ++queueIndex )
+		{
+			pJobManager->WaitForCounter( queues[ queueIndex ]->writeCounter );
+		}
+	}
+}
+
+/// Get the path of the source file from which a resource is preprocessed.
+///
+/// The source file belongs to the first resource in the template chain of the given resource that extends a default
+/// template object (i.e. test.png, which would have Helium::Texture2D as its template).
+///
+/// @param[in]  resourcePath     Path of the resource.
+/// @param[in]  pResource        Resource.
+/// @param[out] rSourceFilePath  Source file path.
+///
+/// @return  True if the source file path was determined, false if the data directory could not be retrieved.
+bool AssetPreprocessor::GetResourceSourceFilePath(
+	const AssetPath &resourcePath,
+	Resource* pResource,
+	FilePath& rSourceFilePath )
+{
 	HELIUM_ASSERT( pResource );
 
-	// Locate the source asset file of the source template resource and combine its timestamp with the object timestamp.
-	// This will be the asset that extends the default asset (i.e. test.png, which would have Helium::Texture2D as template)
 	Resource* pSourceResource = pResource;
 	Asset* pTestTemplate = Reflect::AssertCast< Asset >( pResource->GetTemplate() );
 	while( pTestTemplate && !pTestTemplate->IsDefaultTemplate() )
@@ -333,109 +1031,92 @@ void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resourc
 		parentPath = parentPath.GetParent();
 	} while( !parentPath.IsEmpty() && !parentPath.IsPackage() );
 
-	FilePath sourceFilePath;
-	if ( !FileLocations::GetDataDirectory( sourceFilePath ) )
+	if( !FileLocations::GetDataDirectory( rSourceFilePath ) )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			TXT( "AssetPreprocessor::LoadResourceData(): Could not retrieve data directory.\n" ) );
-
-		return;
+		return false;
 	}
 
-	sourceFilePath += baseResourcePath.ToFilePathString().GetData();
+	rSourceFilePath += baseResourcePath.ToFilePathString().GetData();
 
-	Helium::Status stat;
-	stat.Read( sourceFilePath.Data() );
+	return true;
+}
 
-	int64_t sourceFileTimestamp = stat.m_ModifiedTime;
-	int64_t assetFileTimestamp = AssetLoader::GetAssetFileTimestamp( baseResourcePath );
+/// Get a hash of the contents of a file.
+///
+/// Hashes are remembered along with the size and modification time of each file, so a file is only read again once
+/// either of them changes.
+///
+/// @param[in] rFilePath  File to hash.
+///
+/// @return  Hash of the file contents, or zero if the file could not be read.
+uint64_t AssetPreprocessor::GetFileHash( const FilePath& rFilePath )
+{
+	Status status;
+	if( !status.Read( rFilePath.Data() ) )
+	{
+		return 0;
+	}
 
-	int64_t timestamp = Max( assetFileTimestamp, sourceFileTimestamp );
+	Name fileName( rFilePath.Data() );
 
-	// Check if data is loaded for each supported platform, attempting to load the data from the cache if it exists
-	// and is up-to-date.
-	size_t platformIndex;
-	for( platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
 	{
-		// Skip platforms for which we don't have preprocessing support.
-		PlatformPreprocessor* pPreprocessor = m_pPlatformPreprocessors[ platformIndex ];
-		if( !pPreprocessor )
-		{
-			continue;
-		}
+		MutexScopeLock scopeLock( m_fileHashLock );
 
-		// Check if we already have loaded resource data.
-		const Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData(
-			static_cast< Cache::EPlatform >( platformIndex ) );
-		if( rPreprocessedData.bLoaded )
+		HashMap< Name, FileHash >::Iterator fileHashIterator = m_fileHashes.Find( fileName );
+		if( fileHashIterator != m_fileHashes.End() )
 		{
-			continue;
+			const FileHash& rFileHash = fileHashIterator->Second();
+			if( rFileHash.modifiedTime == status.m_ModifiedTime && rFileHash.size == status.m_Size )
+			{
+				return rFileHash.hash;
+			}
 		}
+	}
 
-		// Retrieve the timestamp of the cached data using the object cache.
-		AssetLoader* pAssetLoader = AssetLoader::GetInstance();
-		HELIUM_ASSERT( pAssetLoader );
+	FileStream* pFileStream = FileStream::OpenFileStream( rFilePath.Data(), FileStream::MODE_READ );
+	if( !pFileStream )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "AssetPreprocessor::GetFileHash(): Failed to open \"%s\" for hashing.\n" ),
+			rFilePath.Data() );
 
-		CacheManager* pCacheManager = CacheManager::GetInstance();
-		HELIUM_ASSERT( pCacheManager );
+		return 0;
+	}
 
-		Cache* pCache = pCacheManager->GetCache(
-			Name( HELIUM_ASSET_CACHE_NAME ),
-			static_cast< Cache::EPlatform >( platformIndex ) );
-		HELIUM_ASSERT( pCache );
-		pCache->EnforceTocLoad();
+	DynamicArray< uint8_t > buffer;
+	buffer.Resize( FILE_HASH_BUFFER_SIZE );
 
-		const Cache::Entry* pCacheEntry = pCache->FindEntry( resourcePath, 0 );
-		if( !pCacheEntry || pCacheEntry->timestamp != timestamp )
+	uint64_t hash = SOURCE_HASH_OFFSET_BASIS;
+	for( ;; )
+	{
+		size_t bytesRead = pFileStream->Read( buffer.GetData(), 1, FILE_HASH_BUFFER_SIZE );
+		if( bytesRead == 0 )
 		{
-			HELIUM_TRACE(
-				TraceLevels::Info,
-				( TXT( "AssetPreprocessor::LoadResourceData(): Cached resource data not found or is out-of-date " )
-				TXT( "for resource \"%s\".  Resource will be preprocessed.\n" ) ),
-				*resourcePath.ToString() );
-
 			break;
 		}
 
-		// Cached data should be up-to-date, so attempt to load the data from the cache.
-		if( !LoadCachedResourceData( resourcePath, pResource, static_cast< Cache::EPlatform >( platformIndex ) ) )
-		{
-			HELIUM_TRACE(
-				TraceLevels::Warning,
-				( TXT( "AssetPreprocessor::LoadResourceData(): Failed to load cached resource data for " )
-				TXT( "\"%s\".  Resource will be preprocessed again.\n" ) ),
-				*resourcePath.ToString() );
-
-			break;
-		}
+		hash = HashSourceData( hash, buffer.GetData(), bytesRead );
 	}
 
-	if( platformIndex >= HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ) )
-	{
-		// All supported platforms loaded successfully, so nothing else needs to be done.
-		return;
-	}
+	delete pFileStream;
 
-	// Preprocess all resources for each supported platform.
-	if( !PreprocessResource( resourcePath, pResource, String( sourceFilePath.Data() ) ) )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			TXT( "AssetPreprocessor::LoadResourceData(): Preprocessing of resource \"%s\" failed.\n" ),
-			*resourcePath.ToString() );
-	}
+	FileHash fileHash;
+	fileHash.modifiedTime = status.m_ModifiedTime;
+	fileHash.size = status.m_Size;
+	fileHash.hash = hash;
 
-#else  // HELIUM_TOOLS
+	MutexScopeLock scopeLock( m_fileHashLock );
 
-	HELIUM_UNREF( pResource );
+	HashMap< Name, FileHash >::Iterator fileHashIterator;
+	if( !m_fileHashes.Insert( fileHashIterator, HashMap< Name, FileHash >::ValueType( fileName, fileHash ) ) )
+	{
+		fileHashIterator->Second() = fileHash;
+	}
 
-#endif  // HELIUM_TOOLS
+	return hash;
 }
 
-
-#if HELIUM_TOOLS
-
 /// Load the persistent resource data for the specified resource from the object cache.
 ///
 /// @param[in]  resourcePath           FilePath of the resource object.
@@ -762,6 +1443,8 @@ bool AssetPreprocessor::LoadCachedResourceData( const AssetPath &path, Resource*
 		rSubDataBuffers.Reserve( subDataCount );
 		rSubDataBuffers.Resize( subDataCount );
 
+		DynamicArray< uint8_t > compressedData;
+
 		for( uint32_t subDataIndex = 0; subDataIndex < subDataCount; ++subDataIndex )
 		{
 			const Cache::Entry* pResourceCacheEntry = pResourceCache->FindEntry( path, subDataIndex );
@@ -798,13 +1481,32 @@ bool AssetPreprocessor::LoadCachedResourceData( const AssetPath &path, Resource*
 			}
 
 			uint32_t subDataSize = pResourceCacheEntry->size;
+			uint32_t storedSize = pResourceCacheEntry->storedSize;
 
 			DynamicArray< uint8_t >& rSubData = rSubDataBuffers[ subDataIndex ];
 			rSubData.Reserve( subDataSize );
 			rSubData.Resize( subDataSize );
 			rSubData.Trim();
 
-			size_t bytesRead = pFileStream->Read( rSubData.GetData(), 1, subDataSize );
+			size_t bytesRead;
+			if( storedSize < subDataSize )
+			{
+				compressedData.Resize( storedSize );
+				bytesRead = pFileStream->Read( compressedData.GetData(), 1, storedSize );
+				if( bytesRead == storedSize )
+				{
+					bytesRead = Cache::DecompressEntryData(
+						compressedData.GetData(),
+						storedSize,
+						rSubData.GetData(),
+						subDataSize );
+				}
+			}
+			else
+			{
+				bytesRead = pFileStream->Read( rSubData.GetData(), 1, subDataSize );
+			}
+
 			if( bytesRead != subDataSize )
 			{
 				HELIUM_TRACE(
@@ -911,4 +1613,65 @@ bool AssetPreprocessor::PreprocessResource( const AssetPath &path, Resource* pRe
 
 	return true;
 }
+
+/// Job callback caching an object queued by CacheObject() while batch caching.
+///
+/// @param[in] pData  CacheObjectJob describing the object to cache.  This is deleted once the object is cached.
+void AssetPreprocessor::CacheObjectJobCallback( void* pData )
+{
+	CacheObjectJob* pJob = static_cast< CacheObjectJob* >( pData );
+	HELIUM_ASSERT( pJob );
+
+	AssetPreprocessor* pPreprocessor = pJob->pPreprocessor;
+	HELIUM_ASSERT( pPreprocessor );
+
+	bool bSuccess = pPreprocessor->WriteObjectCacheData(
+		pJob->path,
+		pJob->spObject,
+		pJob->timestamp,
+		pJob->bEvictPlatformPreprocessedResourceData );
+	if( !bSuccess )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "AssetPreprocessor: Failed to cache object \"%s\".\n" ),
+			*pJob->path.ToString() );
+
+		AtomicIncrementRelease( pPreprocessor->m_batchFailureCount );
+	}
+
+	delete pJob;
+}
+
+/// Job callback writing the entries handed off to the writer of a batch cache write queue.
+///
+/// @param[in] pData  CacheWriteQueue to write.
+void AssetPreprocessor::WriteCacheQueueJobCallback( void* pData )
+{
+	CacheWriteQueue* pQueue = static_cast< CacheWriteQueue* >( pData );
+	HELIUM_ASSERT( pQueue );
+
+	Cache* pCache = pQueue->pCache;
+	HELIUM_ASSERT( pCache );
+
+	Cache::EntryWrite* pWrites = pQueue->flushWrites.GetData();
+	size_t writeCount = pQueue->flushWrites.GetSize();
+
+	const uint8_t* pData = pQueue->flushData.GetData();
+	for( size_t writeIndex = 0; writeIndex < writeCount; ++writeIndex )
+	{
+		pWrites[ writeIndex ].pData = pData + pQueue->flushDataOffsets[ writeIndex ];
+	}
+
+	if( !pCache->CacheEntries( pWrites, writeCount ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "AssetPreprocessor: Failed to write %" ) PRIuSZ TXT( " queued entries to cache \"%s\".\n" ),
+			writeCount,
+			*pCache->GetName() );
+
+		pQueue->bWriteFailed = true;
+	}
+}
 #endif  // HELIUM_TOOLS
@@ -2,18 +2,31 @@
 
 #include "PcSupport/PcSupport.h"
 
+#include "Platform/Locks.h"
+#include "Foundation/HashMap.h"
 #include "Engine/Cache.h"
+#include "Engine/JobManager.h"
 
 namespace Helium
 {
     class Asset;
+    class FilePath;
     class Resource;
     class PlatformPreprocessor;
 
     /// Asset caching and resource preprocessing interface.
+    ///
+    /// Packages can be cooked in a batch using CookPackages().  While batch caching, resource preprocessing runs on the
+    /// job worker threads as part of asset loading, each cached object is serialized in its own job, and the resulting
+    /// cache entries are queued per cache and written out in large batches by at most one writer job per cache.
     class HELIUM_PC_SUPPORT_API AssetPreprocessor : NonCopyable
     {
     public:
+        /// Size of the entry data queued for a cache at which it is written out while batch caching, in bytes.
+        static const size_t CACHE_WRITE_BATCH_SIZE = 16 * 1024 * 1024;
+        /// Initial value of source content hashes (64-bit FNV-1a offset basis).
+        static const uint64_t SOURCE_HASH_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+
         /// @name Platform Preprocessor Registration
         //@{
         void SetPlatformPreprocessor( Cache::EPlatform platform, PlatformPreprocessor* pPreprocessor );
@@ -23,6 +36,10 @@ namespace Helium
         /// @name Asset Caching
         //@{
         bool CacheObject( const AssetPath &objectPath, Asset* pObject, int64_t timestamp, bool bEvictPlatformPreprocessedResourceData = true );
+        bool CookPackages( const AssetPath* pPackagePaths, size_t packageCount );
+
+        uint64_t ComputeSourceHash( const AssetPath &objectPath, Asset* pObject );
+        static uint64_t HashSourceData( uint64_t hash, const void* pData, size_t size );
         //@}
 
         /// @name Resource Preprocessing
@@ -38,9 +55,67 @@ namespace Helium
        //@}
 
     private:
+#if HELIUM_TOOLS
+        /// Cache entries queued for writing while batch caching.
+        struct CacheWriteQueue
+        {
+            /// Cache to which the entries are written.
+            Cache* pCache;
+
+            /// Queued entries (data pointers are filled in from the data offsets when written).
+            DynamicArray< Cache::EntryWrite > writes;
+            /// Offset of the data of each queued entry in the data buffer.
+            DynamicArray< size_t > dataOffsets;
+            /// Data of all queued entries.
+            DynamicArray< uint8_t > data;
+            /// Mutex synchronizing access to the queued entries.
+            Mutex lock;
+
+            /// Entries being written by the writer job.
+            DynamicArray< Cache::EntryWrite > flushWrites;
+            /// Data offsets of the entries being written.
+            DynamicArray< size_t > flushDataOffsets;
+            /// Data of the entries being written.
+            DynamicArray< uint8_t > flushData;
+            /// Counter for the writer job of this cache (at most one is running at a time).
+            JobCounter writeCounter;
+            /// True if any writes have failed.
+            bool bWriteFailed;
+        };
+
+        /// Content hash of a source file.
+        struct FileHash
+        {
+            /// File modification time when hashed.
+            int64_t modifiedTime;
+            /// File size when hashed.
+            int64_t size;
+            /// Hash of the file contents.
+            uint64_t hash;
+        };
+#endif
+
         /// Platform-specific preprocessing support.
         PlatformPreprocessor* m_pPlatformPreprocessors[ Cache::PLATFORM_MAX ];
 
+#if HELIUM_TOOLS
+        /// Write queue for each cache written while batch caching.
+        DynamicArray< CacheWriteQueue* > m_cacheWriteQueues;
+        /// Mutex synchronizing access to the write queue list.
+        Mutex m_cacheWriteQueueLock;
+        /// Counter for the object caching jobs spawned while batch caching.
+        JobCounter m_cacheObjectCounter;
+        /// Number of objects that failed to cache while batch caching.
+        volatile int32_t m_batchFailureCount;
+        /// True while batch caching.
+        bool m_bBatchCaching;
+
+        /// Content hashes of source files, by file name.
+        HashMap< Name, FileHash > m_fileHashes;
+        /// Mutex synchronizing access to the file content hashes.
+        Mutex m_fileHashLock;
+#endif
+
         /// Singleton instance.
         static AssetPreprocessor* sm_pInstance;
 
@@ -53,11 +128,26 @@ namespace Helium
         /// @name Private Utility Functions
         //@{
 #if HELIUM_TOOLS
+        bool WriteObjectCacheData(
+            const AssetPath &objectPath, Asset* pObject, int64_t timestamp, bool bEvictPlatformPreprocessedResourceData );
+        bool WriteCacheEntries( Cache* pCache, const Cache::EntryWrite* pWrites, size_t writeCount );
+
+        void BeginCacheBatch();
+        bool EndCacheBatch();
+        CacheWriteQueue* GetCacheWriteQueue( Cache* pCache );
+        void FlushCacheWrites( bool bFinal );
+
+        bool GetResourceSourceFilePath( const AssetPath &resourcePath, Resource* pResource, FilePath& rSourceFilePath );
+        uint64_t GetFileHash( const FilePath& rFilePath );
+
         bool LoadCachedResourceData( const AssetPath &path, Resource* pResource, Cache::EPlatform platform );
         bool PreprocessResource( const AssetPath &path, Resource* pResource, const String& rSourceFilePath );
 
         uint32_t LoadPersistentResourceData(
             AssetPath resourcePath, Cache::EPlatform platform, DynamicArray< uint8_t >& rPersistentDataBuffer );
+
+        static void CacheObjectJobCallback( void* pData );
+        static void WriteCacheQueueJobCallback( void* pData );
 #endif
         //@}
     };
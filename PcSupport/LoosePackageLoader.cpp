@@ -20,6 +20,175 @@
 
 using namespace Helium;
 
+/// rapidjson input stream reading a file in fixed-size chunks, so that parsing can start as soon as the first chunk
+/// has been read and can stop without reading the rest of the file.
+class ChunkedFileReadStream
+{
+public:
+	typedef char Ch;
+
+	/// Constructor.
+	///
+	/// @param[in] pStream     Stream from which to read.
+	/// @param[in] pBuffer     Buffer in which to read each chunk.
+	/// @param[in] bufferSize  Size of the chunk buffer, in bytes.
+	ChunkedFileReadStream( Stream* pStream, char* pBuffer, size_t bufferSize )
+		: m_pStream( pStream )
+		, m_pBuffer( pBuffer )
+		, m_bufferSize( bufferSize )
+		, m_pBufferLast( NULL )
+		, m_pCurrent( pBuffer )
+		, m_readSize( 0 )
+		, m_readCount( 0 )
+		, m_bEndOfFile( false )
+	{
+		HELIUM_ASSERT( pStream );
+		HELIUM_ASSERT( pBuffer );
+		HELIUM_ASSERT( bufferSize > 1 );
+
+		ReadChunk();
+	}
+
+	Ch Peek() const { return *m_pCurrent; }
+	Ch Take() { Ch character = *m_pCurrent; Advance(); return character; }
+	size_t Tell() const { return m_readCount + static_cast< size_t >( m_pCurrent - m_pBuffer ); }
+
+	// Writing is not supported.
+	Ch* PutBegin() { HELIUM_ASSERT( false ); return NULL; }
+	void Put( Ch ) { HELIUM_ASSERT( false ); }
+	void Flush() { HELIUM_ASSERT( false ); }
+	size_t PutEnd( Ch* ) { HELIUM_ASSERT( false ); return 0; }
+
+private:
+	/// Source stream.
+	Stream* m_pStream;
+	/// Chunk buffer.
+	char* m_pBuffer;
+	/// Size of the chunk buffer.
+	size_t m_bufferSize;
+	/// Last valid character in the chunk buffer.
+	char* m_pBufferLast;
+	/// Current character.
+	char* m_pCurrent;
+	/// Number of bytes in the current chunk.
+	size_t m_readSize;
+	/// Number of bytes in all previous chunks.
+	size_t m_readCount;
+	/// True once the end of the file has been reached.
+	bool m_bEndOfFile;
+
+	/// Move to the next character, reading the next chunk if the current one has been consumed.
+	void Advance()
+	{
+		if( m_pCurrent < m_pBufferLast )
+		{
+			++m_pCurrent;
+		}
+		else if( !m_bEndOfFile )
+		{
+			m_readCount += m_readSize;
+			ReadChunk();
+		}
+	}
+
+	/// Read the next chunk, terminating the data with a null character once the end of the file is reached.
+	void ReadChunk()
+	{
+		m_readSize = m_pStream->Read( m_pBuffer, 1, m_bufferSize );
+		m_pBufferLast = m_pBuffer + m_readSize - 1;
+		m_pCurrent = m_pBuffer;
+
+		if( m_readSize < m_bufferSize )
+		{
+			m_pBuffer[ m_readSize ] = '\0';
+			++m_pBufferLast;
+			m_bEndOfFile = true;
+		}
+	}
+};
+
+/// rapidjson handler reading the type name and template path of an object from the start of its file.
+///
+/// Object files are arrays holding a single object keyed by its type name.  The base Asset properties (including the
+/// template, if any) are normally written before those of derived types, so parsing is stopped as soon as the template
+/// has been read.  Files whose template is not the first property are still handled, as the properties of the object
+/// are scanned until the template or the end of the object is reached.
+struct PreliminaryObjectHandler : rapidjson::BaseReaderHandler<>
+{
+	Helium::Name typeName;
+	Helium::String templatePath;
+	uint32_t objectDepth;
+	bool templateIsNext;
+	bool bComplete;
+
+	PreliminaryObjectHandler()
+		: typeName( ENullName() )
+		, templatePath( "" )
+		, objectDepth( 0 )
+		, templateIsNext( false )
+		, bComplete( false )
+	{
+	}
+
+	bool StartObject()
+	{
+		// Only a string or null value is a template path.
+		templateIsNext = false;
+		++objectDepth;
+		return true;
+	}
+
+	bool StartArray()
+	{
+		templateIsNext = false;
+		return true;
+	}
+
+	bool EndObject( rapidjson::SizeType /*memberCount*/ )
+	{
+		// An object whose properties do not include a template has none.
+		bComplete = ( objectDepth == 2 );
+		--objectDepth;
+		return !bComplete;
+	}
+
+	bool Key( const Ch* chars, rapidjson::SizeType length, bool /*copy*/ )
+	{
+		if ( objectDepth == 1 && typeName.IsEmpty() )
+		{
+			typeName.Set( Helium::String( chars, length ) );
+			return true;
+		}
+
+		if ( objectDepth == 2 )
+		{
+			templateIsNext = ( Helium::String( chars, length ) == "m_spTemplate" );
+		}
+
+		return true;
+	}
+
+	bool Null()
+	{
+		// A null template means the object has no template.
+		bComplete = templateIsNext;
+		templateIsNext = false;
+		return !bComplete;
+	}
+
+	bool String( const Ch* chars, rapidjson::SizeType length, bool /*copy*/ )
+	{
+		if ( templateIsNext )
+		{
+			templatePath = Helium::String( chars, length );
+			bComplete = true;
+			return false;
+		}
+
+		return true;
+	}
+};
+
 /// Constructor.
 LoosePackageLoader::LoosePackageLoader()
 	: m_startPreloadCounter( 0 )
@@ -220,9 +389,6 @@ bool LoosePackageLoader::BeginPreload()
 		}
 	}
 
-	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
-	HELIUM_ASSERT( pAsyncLoader );
-
 	if ( !m_packageDirPath.Exists() )
 	{
 		HELIUM_TRACE(
@@ -241,7 +407,7 @@ bool LoosePackageLoader::BeginPreload()
 	{
 		DirectoryIterator packageDirectory( m_packageDirPath );
 
-		HELIUM_TRACE( TraceLevels::Info, TXT( " LoosePackageLoader::BeginPreload - Issuing read requests for all files in %s\n" ), m_packageDirPath.Data() );
+		HELIUM_TRACE( TraceLevels::Info, TXT( " LoosePackageLoader::BeginPreload - Parsing all files in %s\n" ), m_packageDirPath.Data() );
 
 		for ( ; !packageDirectory.IsDone(); packageDirectory.Next() )
 		{
@@ -265,21 +431,9 @@ bool LoosePackageLoader::BeginPreload()
 					HELIUM_TRACE( TraceLevels::Info, TXT( "- Reading file [%s]\n" ), item.m_Path.Data() );
 
 					FileReadRequest *request = m_fileReadRequests.New();
-					request->expectedSize = item.m_Size;
-
-					HELIUM_ASSERT( item.m_Size < UINT32_MAX );
-
-					// Create a buffer for the file to be read into temporarily
-					request->pLoadBuffer = DefaultAllocator().Allocate( static_cast<size_t> ( item.m_Size ) + 1 );
-					static_cast<char*>( request->pLoadBuffer )[static_cast<size_t> ( item.m_Size )] = '\0'; // for efficiency parsing text files
-					HELIUM_ASSERT( request->pLoadBuffer );
-
-					// Queue up the read
-					request->asyncLoadId = pAsyncLoader->QueueRequest( request->pLoadBuffer, String( item.m_Path.Data() ), 0, static_cast<size_t>( item.m_Size ) );
-					HELIUM_ASSERT( IsValid( request->asyncLoadId ) );
-
 					request->filePath = item.m_Path;
 					request->fileTimestamp = item.m_ModTime;
+					request->bParsed = false;
 				}
 				else
 				{
@@ -288,11 +442,56 @@ bool LoosePackageLoader::BeginPreload()
 		}
 	}
 
+	BeginPreloadParse();
+
 	AtomicExchangeRelease( m_startPreloadCounter, 1 );
 
 	return true;
 }
 
+/// Start parsing the preliminary data of each object file found when the preload began.
+///
+/// The files are split into batches of PRELOAD_PARSE_BATCH_SIZE that are parsed in parallel on the job worker threads,
+/// or parsed immediately if the job manager has not been started.
+///
+/// @see TickPreload()
+void LoosePackageLoader::BeginPreloadParse()
+{
+	HELIUM_ASSERT( m_preloadParseJobs.IsEmpty() );
+	HELIUM_ASSERT( m_preloadParseCounter.IsDone() );
+
+	size_t requestCount = m_fileReadRequests.GetSize();
+	m_preloadParseJobs.Reserve( ( requestCount + PRELOAD_PARSE_BATCH_SIZE - 1 ) / PRELOAD_PARSE_BATCH_SIZE );
+
+	for ( size_t startIndex = 0; startIndex < requestCount; startIndex += PRELOAD_PARSE_BATCH_SIZE )
+	{
+		PreloadParseJob* pJob = m_preloadParseJobs.New();
+		HELIUM_ASSERT( pJob );
+		pJob->pLoader = this;
+		pJob->startIndex = startIndex;
+		pJob->count = requestCount - startIndex;
+		if ( pJob->count > PRELOAD_PARSE_BATCH_SIZE )
+		{
+			pJob->count = PRELOAD_PARSE_BATCH_SIZE;
+		}
+	}
+
+	JobManager* pJobManager = JobManager::GetInstance();
+
+	size_t jobCount = m_preloadParseJobs.GetSize();
+	for ( size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+	{
+		if ( pJobManager )
+		{
+			pJobManager->SpawnJob( PreloadParseJobCallback, &m_preloadParseJobs[ jobIndex ], &m_preloadParseCounter );
+		}
+		else
+		{
+			PreloadParseJobCallback( &m_preloadParseJobs[ jobIndex ] );
+		}
+	}
+}
+
 /// @copydoc PackageLoader::TryFinishPreload()
 bool LoosePackageLoader::TryFinishPreload()
 {
@@ -673,144 +872,36 @@ void LoosePackageLoader::TickPreload()
 	HELIUM_ASSERT( m_startPreloadCounter != 0 );
 	HELIUM_ASSERT( m_preloadedCounter == 0 );
 
-	AsyncLoader* pAsyncLoader = AsyncLoader::GetInstance();
-	HELIUM_ASSERT( pAsyncLoader );
-
-	bool bAllFileRequestsDone = true;
-
-	// Walk through every load request
-	for ( size_t i = 0; i < m_fileReadRequests.GetSize(); )
+	// Once every object file has been parsed, register the objects whose preliminary data was read successfully.
+	bool bAllFileRequestsDone = m_preloadParseCounter.IsDone();
+	if ( bAllFileRequestsDone && !m_fileReadRequests.IsEmpty() )
 	{
-		FileReadRequest &rRequest = m_fileReadRequests[i];
-		HELIUM_ASSERT( rRequest.asyncLoadId );
-		HELIUM_ASSERT( rRequest.pLoadBuffer );
-
-		size_t bytes_read = 0;
-		if ( !pAsyncLoader->TrySyncRequest( rRequest.asyncLoadId, bytes_read ) )
-		{
-			// Havn't finished reading yet, move on to next entry
-			bAllFileRequestsDone = false;
-			++i;
-			continue;
-		}
+		size_t requestCount = m_fileReadRequests.GetSize();
+		m_objects.Reserve( m_objects.GetSize() + requestCount );
 
-		HELIUM_ASSERT( bytes_read == rRequest.expectedSize );
-		if ( IsInvalid( bytes_read ) )
-		{
-			HELIUM_TRACE(
-				TraceLevels::Error,
-				TXT( "LoosePackageLoader: Failed to read the contents of async load request \"%d\".\n" ),
-				rRequest.asyncLoadId );
-		}
-		else if ( bytes_read != rRequest.expectedSize )
-		{
-			HELIUM_TRACE(
-				TraceLevels::Warning,
-				( TXT( "LoosePackageLoader: Attempted to read %" ) PRIuSZ TXT( " bytes from package file \"%s\", " )
-				TXT( "but only %" ) PRIuSZ TXT( " bytes were read.\n" ) ),
-				rRequest.expectedSize,
-				bytes_read );
-		}
-		else
+		for ( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
 		{
-			HELIUM_ASSERT( rRequest.expectedSize < ~static_cast<size_t>( 0 ) );
-
-			// the name is deduced from the file name (bad idea to store it in the file)
-			Name name( m_fileReadRequests[i].filePath.Basename().c_str() );
-
-			// read some preliminary data from the json
-			struct PreliminaryObjectHandler : rapidjson::BaseReaderHandler<>
+			const FileReadRequest &rRequest = m_fileReadRequests[ requestIndex ];
+			if ( !rRequest.bParsed )
 			{
-				Helium::Name typeName;
-				Helium::String templatePath;
-				bool templateIsNext;
-
-				PreliminaryObjectHandler()
-					: typeName( ENullName() )
-					, templatePath( "" )
-				{
-					templateIsNext = false;
-				}
-
-				bool Key( const Ch* chars, rapidjson::SizeType length, bool copy )
-				{
-					if ( typeName.IsEmpty() )
-					{
-						typeName.Set( Helium::String( chars, length ) );
-						return true;
-					}
-
-					if ( templatePath.IsEmpty() )
-					{
-						Helium::String str( chars, length );
-
-						if ( str == "m_spTemplate" )
-						{
-							templateIsNext = true;
-							return true;
-						}
-					}
-
-					return true;
-				}
-
-				bool String( const Ch* chars, rapidjson::SizeType length, bool copy )
-				{
-					if ( templatePath.IsEmpty() )
-					{
-						Helium::String str( chars, length );
-
-						if ( templateIsNext )
-						{
-							templatePath = str;
-							templateIsNext = false;
-							return true;
-						}
-					}
-
-					return true;
-				}
-			} handler;
-
-			// non destructive in-place stream helper
-			rapidjson::StringStream stream( static_cast<char*>( rRequest.pLoadBuffer ) );
+				continue;
+			}
 
-			// the main reader object
-			rapidjson::Reader reader;
-			if ( reader.Parse< rapidjson::kParseDefaultFlags >( stream, handler ) )
-			{
-				SerializedObjectData* pObjectData = m_objects.New();
-				HELIUM_ASSERT( pObjectData );
-				HELIUM_VERIFY( pObjectData->objectPath.Set( name, false, m_packagePath ) );
-				pObjectData->templatePath.Set( handler.templatePath );
-				pObjectData->typeName = handler.typeName;
-				pObjectData->filePath = rRequest.filePath;
-				pObjectData->fileTimeStamp = rRequest.fileTimestamp;
-				pObjectData->bMetadataGood = true;
+			// the name is deduced from the file name (bad idea to store it in the file)
+			Name name( rRequest.filePath.Basename().c_str() );
 
-				HELIUM_TRACE(
-					TraceLevels::Debug,
-					TXT( "LoosePackageLoader: Success reading preliminary data for object '%s' from file '%s'.\n" ),
-					*name,
-					rRequest.filePath.Data() );
-			}
-			else
-			{
-				HELIUM_TRACE(
-					TraceLevels::Error,
-					TXT( "LoosePackageLoader: Failure reading preliminary data for object '%s' from file '%s': Error parsing JSON (%d): %s\n" ),
-					*name,
-					rRequest.filePath.Data(),
-					reader.GetErrorOffset(),
-					rapidjson::GetParseError_En( reader.GetParseErrorCode() ) );
-			}
+			SerializedObjectData* pObjectData = m_objects.New();
+			HELIUM_ASSERT( pObjectData );
+			HELIUM_VERIFY( pObjectData->objectPath.Set( name, false, m_packagePath ) );
+			pObjectData->templatePath.Set( rRequest.templatePath );
+			pObjectData->typeName = rRequest.typeName;
+			pObjectData->filePath = rRequest.filePath;
+			pObjectData->fileTimeStamp = rRequest.fileTimestamp;
+			pObjectData->bMetadataGood = true;
 		}
 
-		// We're finished with this load, so deallocate memory and get rid of the request
-		DefaultAllocator().Free( rRequest.pLoadBuffer );
-		rRequest.pLoadBuffer = NULL;
-		SetInvalid( rRequest.asyncLoadId );
-		m_fileReadRequests.RemoveSwap( i );
+		m_fileReadRequests.Clear();
+		m_preloadParseJobs.Clear();
 	}
 
 	// Wait for the parent package to finish loading.
@@ -938,11 +1029,93 @@ void LoosePackageLoader::TickPreload()
 	AtomicExchangeRelease( m_preloadedCounter, 1 );
 
 	LooseAssetLoader::OnPackagePreloaded( this );
+
+	// The preliminary data was parsed on job worker threads rather than read through the async loader, so the asset
+	// loader must be told that requests waiting on this preload can continue.
+	AssetLoader* pAssetLoader = AssetLoader::GetInstance();
+	HELIUM_ASSERT( pAssetLoader );
+	pAssetLoader->NotifyPackageLoaderProgress();
+}
+
+/// Parse the type name and template path of an object from the start of its file.
+///
+/// The file is read in chunks of PARSE_CHUNK_SIZE bytes while it is parsed, and reading stops as soon as the
+/// preliminary data has been found.
+///
+/// @param[in,out] rRequest  Object file read request.  The parsed data is stored in the request, and bParsed is set if
+///                          parsing succeeded.
+void LoosePackageLoader::ParsePreliminaryData( FileReadRequest& rRequest )
+{
+	rRequest.bParsed = false;
+
+	FileStream* pFileStream = FileStream::OpenFileStream( rRequest.filePath.Data(), FileStream::MODE_READ );
+	if ( !pFileStream )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "LoosePackageLoader: Failed to open object file '%s' for reading.\n" ),
+			rRequest.filePath.Data() );
+
+		return;
+	}
+
+	char chunkBuffer[ PARSE_CHUNK_SIZE ];
+	ChunkedFileReadStream stream( pFileStream, chunkBuffer, PARSE_CHUNK_SIZE );
+
+	PreliminaryObjectHandler handler;
+	rapidjson::Reader reader;
+	bool bParseResult = reader.Parse< rapidjson::kParseDefaultFlags >( stream, handler );
+
+	delete pFileStream;
+
+	// Parsing is terminated by the handler once it has what it needs.
+	if ( bParseResult || handler.bComplete )
+	{
+		rRequest.typeName = handler.typeName;
+		rRequest.templatePath = handler.templatePath;
+		rRequest.bParsed = true;
+
+		HELIUM_TRACE(
+			TraceLevels::Debug,
+			TXT( "LoosePackageLoader: Success reading preliminary data from file '%s'.\n" ),
+			rRequest.filePath.Data() );
+	}
+	else
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "LoosePackageLoader: Failure reading preliminary data from file '%s': Error parsing JSON (%d): %s\n" ),
+			rRequest.filePath.Data(),
+			reader.GetErrorOffset(),
+			rapidjson::GetParseError_En( reader.GetParseErrorCode() ) );
+	}
+}
+
+/// Job callback for parsing the preliminary data of a batch of object files.
+///
+/// @param[in] pData  Batch to parse (PreloadParseJob instance).
+///
+/// @see BeginPreloadParse()
+void LoosePackageLoader::PreloadParseJobCallback( void* pData )
+{
+	PreloadParseJob* pJob = static_cast< PreloadParseJob* >( pData );
+	HELIUM_ASSERT( pJob );
+
+	LoosePackageLoader* pLoader = pJob->pLoader;
+	HELIUM_ASSERT( pLoader );
+	HELIUM_ASSERT( pJob->startIndex + pJob->count <= pLoader->m_fileReadRequests.GetSize() );
+
+	for ( size_t requestIndex = 0; requestIndex < pJob->count; ++requestIndex )
+	{
+		ParsePreliminaryData( pLoader->m_fileReadRequests[ pJob->startIndex + requestIndex ] );
+	}
 }
 
 /// Update load processing of object load requests.
 void LoosePackageLoader::TickLoadRequests()
 {
+	bool bProgress = false;
+
 	size_t loadRequestCount = m_loadRequests.GetSize();
 	for ( size_t loadRequestIndex = 0; loadRequestIndex < loadRequestCount; ++loadRequestIndex )
 	{
@@ -960,6 +1133,8 @@ void LoosePackageLoader::TickLoadRequests()
 			{
 				continue;
 			}
+
+			bProgress = true;
 		}
 
 		//TODO: Investigate removing need to preload properties first. Probably need to have the
@@ -972,8 +1147,19 @@ void LoosePackageLoader::TickLoadRequests()
 			{
 				continue;
 			}
+
+			bProgress = true;
 		}
 	}
+
+	// Deserialization can finish without any async file read completing (such as once a template has loaded), so
+	// make sure the asset loader checks on the requests waiting for it.
+	if ( bProgress )
+	{
+		AssetLoader* pAssetLoader = AssetLoader::GetInstance();
+		HELIUM_ASSERT( pAssetLoader );
+		pAssetLoader->NotifyPackageLoaderProgress();
+	}
 }
 
 size_t LoosePackageLoader::FindObjectByPath( const AssetPath &path ) const
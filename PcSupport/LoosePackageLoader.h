@@ -3,6 +3,7 @@
 #include "Engine/Engine.h"
 #include "Engine/Asset.h"
 #include "Engine/PackageLoader.h"
+#include "Engine/JobManager.h"
 
 #include "Foundation/FilePath.h"
 
@@ -18,6 +19,8 @@ namespace Helium
 
 		/// Maximum number of bytes to parse at a time.
 		static const size_t PARSE_CHUNK_SIZE = 4 * 1024;
+		/// Number of object files whose preliminary data is parsed by each preload job.
+		static const size_t PRELOAD_PARSE_BATCH_SIZE = 32;
 
 		/// Serialized object data.
 		struct SerializedObjectData
@@ -162,15 +165,38 @@ namespace Helium
 		/// Package file path name.
 		FilePath m_packageDirPath;
 		
+		/// Object file whose preliminary data is parsed during the preload.
 		struct FileReadRequest
 		{
+			/// Object file path.
 			Helium::FilePath filePath;
-			void* pLoadBuffer;
-			size_t asyncLoadId;
-			uint64_t expectedSize;
+			/// Object file time stamp.
 			uint64_t fileTimestamp;
+			/// Type name parsed from the file.
+			Name typeName;
+			/// Template path parsed from the file (empty if the object has no template).
+			String templatePath;
+			/// True if the preliminary data was parsed successfully.
+			bool bParsed;
+		};
+
+		/// Preload job parsing the preliminary data of a batch of object files.
+		struct PreloadParseJob
+		{
+			/// Loader performing the preload.
+			LoosePackageLoader* pLoader;
+			/// Index of the first file read request in the batch.
+			size_t startIndex;
+			/// Number of file read requests in the batch.
+			size_t count;
 		};
-		DynamicArray<FileReadRequest> m_fileReadRequests;
+
+		/// Object files whose preliminary data is parsed during the preload.
+		DynamicArray< FileReadRequest > m_fileReadRequests;
+		/// Preload parse jobs.
+		DynamicArray< PreloadParseJob > m_preloadParseJobs;
+		/// Counter tracking the completion of the preload parse jobs.
+		JobCounter m_preloadParseCounter;
 
 		/// Parent package load request ID.
 		size_t m_parentPackageLoadId;
@@ -180,6 +206,7 @@ namespace Helium
 
 		/// @name Private Utility Functions
 		//@{
+		void BeginPreloadParse();
 		void TickPreload();
 
 		void TickLoadRequests();
@@ -189,5 +216,11 @@ namespace Helium
 
 		size_t FindObjectByPath( const AssetPath &path ) const;
 		size_t FindObjectByName( const Name &name ) const;
+
+		/// @name Private Static Utility Functions
+		//@{
+		static void ParsePreliminaryData( FileReadRequest& rRequest );
+		static void PreloadParseJobCallback( void* pData );
+		//@}
 	};
 }
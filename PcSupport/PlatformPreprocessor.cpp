@@ -20,6 +20,26 @@ PlatformPreprocessor::~PlatformPreprocessor()
 ///
 /// @see CompileShader()
 
+/// @fn bool PlatformPreprocessor::PreprocessShader( const FilePath& rShaderPath, size_t profileIndex, RShader::EType type, const void* pShaderCode, size_t shaderCodeSize, const ShaderToken* pTokens, size_t tokenCount, DynamicArray< uint8_t >& rPreprocessedCode )
+/// Run a shader through the preprocessor without compiling it.
+///
+/// The preprocessed code has all includes and preprocessor tokens resolved exactly as CompileShader() would resolve
+/// them for the same arguments, so shader permutations that preprocess to the same code compile to the same result.
+///
+/// @param[in]  rShaderPath        FilePath to the shader file being preprocessed.
+/// @param[in]  profileIndex       Index of the target shader profile (must be a value less than that returned by
+///                                GetShaderProfileCount()).
+/// @param[in]  type               Shader type.
+/// @param[in]  pShaderCode        Pointer to the loaded shader code to preprocess.
+/// @param[in]  shaderCodeSize     Size of the shader code, in bytes.
+/// @param[in]  pTokens            Array of shader preprocessor tokens.
+/// @param[in]  tokenCount         Number of shader preprocessor tokens in the given array.
+/// @param[out] rPreprocessedCode  Buffer in which the preprocessed shader code will be stored.
+///
+/// @return  True if the shader was preprocessed successfully, false if not (or if preprocessing is not supported).
+///
+/// @see CompileShader()
+
 /// @fn bool PlatformPreprocessor::CompileShader( size_t profileIndex, RShader::EType type, const void* pShaderCode, size_t shaderCodeSize, const ShaderToken* pTokens, size_t tokenCount, DynamicArray< uint8_t >& rMicrocode, DynamicArray< String >* pErrorMessages )
 /// Compile a shader for the target platform.
 ///
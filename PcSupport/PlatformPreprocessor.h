@@ -60,6 +60,10 @@ namespace Helium
         /// @name Shader Compiling
         //@{
         virtual size_t GetShaderProfileCount() const = 0;
+        virtual bool PreprocessShader(
+            const FilePath& rShaderPath, size_t profileIndex, RShader::EType type, const void* pShaderCode,
+            size_t shaderCodeSize, const ShaderToken* pTokens, size_t tokenCount,
+            DynamicArray< uint8_t >& rPreprocessedCode ) = 0;
         virtual bool CompileShader(
             const FilePath& rShaderPath, size_t profileIndex, RShader::EType type, const void* pShaderCode,
             size_t shaderCodeSize, const ShaderToken* pTokens, size_t tokenCount, DynamicArray< uint8_t >& rCompiledCode,
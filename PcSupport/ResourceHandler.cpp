@@ -48,6 +48,18 @@ bool ResourceHandler::CacheResource(
 {
     return false;
 }
+
+/// Get the version of the resource data produced by this handler.
+///
+/// The version is included in the source hash of each resource (see AssetPreprocessor::ComputeSourceHash()), so
+/// handlers should increment it whenever a change to their preprocessing would produce different data from the same
+/// source content.
+///
+/// @return  Resource data version.
+uint32_t ResourceHandler::GetVersion() const
+{
+    return 0;
+}
 #endif  // HELIUM_TOOLS
 
 
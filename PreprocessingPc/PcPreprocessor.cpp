@@ -170,73 +170,43 @@ HRESULT D3DIncludeHandler::Close( LPCVOID pData )
     return S_OK;
 }
 
-#endif // HELIUM_DIRECT3D
-
-/// Constructor.
-PcPreprocessor::PcPreprocessor()
-{
-}
-
-/// Destructor.
-PcPreprocessor::~PcPreprocessor()
-{
-}
-
-/// @copydoc PlatformPreprocessor::GetByteOrder()
-PlatformPreprocessor::EByteOrder PcPreprocessor::GetByteOrder() const
-{
-	return BYTE_ORDER_LITTLE;
-}
-
-/// @copydoc PlatformPreprocessor::GetShaderProfileCount()
-size_t PcPreprocessor::GetShaderProfileCount() const
-{
-	return static_cast< size_t >( ShaderProfile::PC_MAX );
-}
-
-/// @copydoc PlatformPreprocessor::CompileShader()
-bool PcPreprocessor::CompileShader(
-								   const FilePath& rShaderPath,
-								   size_t profileIndex,
-								   RShader::EType type,
-								   const void* pShaderCode,
-								   size_t shaderCodeSize,
-								   const ShaderToken* pTokens,
-								   size_t tokenCount,
-								   DynamicArray< uint8_t >& rCompiledCode,
-								   DynamicArray< String >* pErrorMessages )
+/// Build the Direct3D preprocessor macro list and compile target for a shader.
+///
+/// @param[in]  profileIndex  Index of the target shader profile.
+/// @param[in]  type          Shader type.
+/// @param[in]  pTokens       Array of shader preprocessor tokens.
+/// @param[in]  tokenCount    Number of shader preprocessor tokens in the given array.
+/// @param[in]  rStackHeap    Heap from which to allocate the macro strings (must outlive the use of the macro list).
+/// @param[out] rDefines      Null-terminated macro list.
+/// @param[out] rpProfile     Compile target for the shader profile and type.
+///
+/// @return  True if the macro list was built successfully, false if the profile or type is invalid.
+static bool BuildShaderDefines(
+	size_t profileIndex,
+	RShader::EType type,
+	const PlatformPreprocessor::ShaderToken* pTokens,
+	size_t tokenCount,
+	StackMemoryHeap<>& rStackHeap,
+	DynamicArray< D3D10_SHADER_MACRO >& rDefines,
+	const char*& rpProfile )
 {
-	HELIUM_ASSERT( profileIndex < static_cast< size_t >( ShaderProfile::PC_MAX ) );
-	HELIUM_ASSERT( static_cast< size_t >( type ) < static_cast< size_t >( RShader::TYPE_MAX ) );
-	HELIUM_ASSERT( pShaderCode );
 	HELIUM_ASSERT( pTokens || tokenCount == 0 );
 
-	rCompiledCode.Resize( 0 );
-	if( pErrorMessages )
-	{
-		pErrorMessages->Resize( 0 );
-	}
-
-#if HELIUM_DIRECT3D
-
-	DynamicArray< D3D10_SHADER_MACRO > defines;
 	D3D10_SHADER_MACRO macro;
 
-	const char* pProfile;
-
 	switch( static_cast< ShaderProfile::EPc >( profileIndex ) )
 	{
 	case ShaderProfile::PC_SM2b:
 		{
 			macro.Name = "HELIUM_PROFILE_PC_SM2b";
 			macro.Definition = "1";
-			defines.Push( macro );
+			rDefines.Push( macro );
 
 			// Also define HELIUM_PROFILE_PC_SM2 for consistency and legacy support.
 			macro.Name = "HELIUM_PROFILE_PC_SM2";
-			defines.Push( macro );
+			rDefines.Push( macro );
 
-			pProfile = ( type == RShader::TYPE_VERTEX ? "vs_2_0" : "ps_2_b" );
+			rpProfile = ( type == RShader::TYPE_VERTEX ? "vs_2_0" : "ps_2_b" );
 
 			break;
 		}
@@ -245,9 +215,9 @@ bool PcPreprocessor::CompileShader(
 		{
 			macro.Name = "HELIUM_PROFILE_PC_SM3";
 			macro.Definition = "1";
-			defines.Push( macro );
+			rDefines.Push( macro );
 
-			pProfile = ( type == RShader::TYPE_VERTEX ? "vs_3_0" : "ps_3_0" );
+			rpProfile = ( type == RShader::TYPE_VERTEX ? "vs_3_0" : "ps_3_0" );
 
 			break;
 		}
@@ -256,16 +226,16 @@ bool PcPreprocessor::CompileShader(
 		{
 			macro.Name = "HELIUM_PROFILE_PC_SM4";
 			macro.Definition = "1";
-			defines.Push( macro );
+			rDefines.Push( macro );
 
-			pProfile = ( type == RShader::TYPE_VERTEX ? "vs_4_0" : "ps_4_0" );
+			rpProfile = ( type == RShader::TYPE_VERTEX ? "vs_4_0" : "ps_4_0" );
 
 			break;
 		}
 
 	default:
 		{
-			HELIUM_BREAK_MSG( TXT( "PcPreprocessor::CompileShader(): Invalid shader profile index.\n" ) );
+			HELIUM_BREAK_MSG( TXT( "BuildShaderDefines(): Invalid shader profile index.\n" ) );
 
 			return false;
 		}
@@ -277,7 +247,7 @@ bool PcPreprocessor::CompileShader(
 		{
 			macro.Name = "HELIUM_TYPE_VERTEX";
 			macro.Definition = "1";
-			defines.Push( macro );
+			rDefines.Push( macro );
 
 			break;
 		}
@@ -286,25 +256,22 @@ bool PcPreprocessor::CompileShader(
 		{
 			macro.Name = "HELIUM_TYPE_PIXEL";
 			macro.Definition = "1";
-			defines.Push( macro );
+			rDefines.Push( macro );
 
 			break;
 		}
 
 	default:
 		{
-			HELIUM_BREAK_MSG( TXT( "PcPreprocessor::CompileShader(): Invalid shader type.\n" ) );
+			HELIUM_BREAK_MSG( TXT( "BuildShaderDefines(): Invalid shader type.\n" ) );
 
 			return false;
 		}
 	}
 
-	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
-	StackMemoryHeap<>::Marker stackMarker( rStackHeap );
-
 	for( size_t tokenIndex = 0; tokenIndex < tokenCount; ++tokenIndex )
 	{
-		const ShaderToken& rToken = pTokens[ tokenIndex ];
+		const PlatformPreprocessor::ShaderToken& rToken = pTokens[ tokenIndex ];
 
 		size_t nameBufferSize = rToken.name.GetSize() + 1;
 		char* pNameBuffer = static_cast< char* >( rStackHeap.Allocate( nameBufferSize ) );
@@ -320,18 +287,158 @@ bool PcPreprocessor::CompileShader(
 		
 		HELIUM_TRACE(
 			TraceLevels::Debug,
-			( TXT( "PcPreprocessor::CompileShader(): Defining option %s = %s" )
+			( TXT( "BuildShaderDefines(): Defining option %s = %s" )
 			TXT( "(profile index: %" ) PRIuSZ TXT( ").\n" ) ),
 			macro.Name,
 			macro.Definition,
 			profileIndex );
 
-		defines.Push( macro );
+		rDefines.Push( macro );
 	}
 
 	macro.Name = NULL;
 	macro.Definition = NULL;
-	defines.Push( macro );
+	rDefines.Push( macro );
+
+	return true;
+}
+
+#endif // HELIUM_DIRECT3D
+
+/// Constructor.
+PcPreprocessor::PcPreprocessor()
+{
+}
+
+/// Destructor.
+PcPreprocessor::~PcPreprocessor()
+{
+}
+
+/// @copydoc PlatformPreprocessor::GetByteOrder()
+PlatformPreprocessor::EByteOrder PcPreprocessor::GetByteOrder() const
+{
+	return BYTE_ORDER_LITTLE;
+}
+
+/// @copydoc PlatformPreprocessor::GetShaderProfileCount()
+size_t PcPreprocessor::GetShaderProfileCount() const
+{
+	return static_cast< size_t >( ShaderProfile::PC_MAX );
+}
+
+/// @copydoc PlatformPreprocessor::PreprocessShader()
+bool PcPreprocessor::PreprocessShader(
+	const FilePath& rShaderPath,
+	size_t profileIndex,
+	RShader::EType type,
+	const void* pShaderCode,
+	size_t shaderCodeSize,
+	const ShaderToken* pTokens,
+	size_t tokenCount,
+	DynamicArray< uint8_t >& rPreprocessedCode )
+{
+	HELIUM_ASSERT( profileIndex < static_cast< size_t >( ShaderProfile::PC_MAX ) );
+	HELIUM_ASSERT( static_cast< size_t >( type ) < static_cast< size_t >( RShader::TYPE_MAX ) );
+	HELIUM_ASSERT( pShaderCode );
+	HELIUM_ASSERT( pTokens || tokenCount == 0 );
+
+	rPreprocessedCode.Resize( 0 );
+
+#if HELIUM_DIRECT3D
+
+	DynamicArray< D3D10_SHADER_MACRO > defines;
+	const char* pProfile;
+
+	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
+	StackMemoryHeap<>::Marker stackMarker( rStackHeap );
+
+	if( !BuildShaderDefines( profileIndex, type, pTokens, tokenCount, rStackHeap, defines, pProfile ) )
+	{
+		return false;
+	}
+
+	D3DIncludeHandler includeHandler( rShaderPath );
+	ID3D10Blob* pPreprocessedCodeBlob = NULL;
+	HRESULT hResult = D3DPreprocess(
+		pShaderCode,
+		shaderCodeSize,
+		NULL,
+		defines.GetData(),
+		&includeHandler,
+		&pPreprocessedCodeBlob,
+		NULL );
+
+	stackMarker.Pop();
+
+	if( FAILED( hResult ) )
+	{
+		if( pPreprocessedCodeBlob )
+		{
+			pPreprocessedCodeBlob->Release();
+		}
+
+		return false;
+	}
+
+	HELIUM_ASSERT( pPreprocessedCodeBlob );
+
+	const uint8_t* pPreprocessedData = static_cast< const uint8_t* >( pPreprocessedCodeBlob->GetBufferPointer() );
+	size_t preprocessedSize = pPreprocessedCodeBlob->GetBufferSize();
+	HELIUM_ASSERT( pPreprocessedData || preprocessedSize == 0 );
+
+	rPreprocessedCode.Reserve( preprocessedSize );
+	rPreprocessedCode.AddArray( pPreprocessedData, preprocessedSize );
+
+	pPreprocessedCodeBlob->Release();
+
+	return true;
+
+#else // HELIUM_OPENGL
+
+	HELIUM_UNREF( rShaderPath );
+	HELIUM_UNREF( shaderCodeSize );
+
+	return false;
+
+#endif // HELIUM_OPENGL
+}
+
+/// @copydoc PlatformPreprocessor::CompileShader()
+bool PcPreprocessor::CompileShader(
+								   const FilePath& rShaderPath,
+								   size_t profileIndex,
+								   RShader::EType type,
+								   const void* pShaderCode,
+								   size_t shaderCodeSize,
+								   const ShaderToken* pTokens,
+								   size_t tokenCount,
+								   DynamicArray< uint8_t >& rCompiledCode,
+								   DynamicArray< String >* pErrorMessages )
+{
+	HELIUM_ASSERT( profileIndex < static_cast< size_t >( ShaderProfile::PC_MAX ) );
+	HELIUM_ASSERT( static_cast< size_t >( type ) < static_cast< size_t >( RShader::TYPE_MAX ) );
+	HELIUM_ASSERT( pShaderCode );
+	HELIUM_ASSERT( pTokens || tokenCount == 0 );
+
+	rCompiledCode.Resize( 0 );
+	if( pErrorMessages )
+	{
+		pErrorMessages->Resize( 0 );
+	}
+
+#if HELIUM_DIRECT3D
+
+	DynamicArray< D3D10_SHADER_MACRO > defines;
+	const char* pProfile;
+
+	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
+	StackMemoryHeap<>::Marker stackMarker( rStackHeap );
+
+	if( !BuildShaderDefines( profileIndex, type, pTokens, tokenCount, rStackHeap, defines, pProfile ) )
+	{
+		return false;
+	}
 
 	D3DIncludeHandler includeHandler( rShaderPath );
 	ID3D10Blob* pCompiledCodeBlob = NULL;
@@ -23,6 +23,10 @@ namespace Helium
         /// @name Shader Compiling
         //@{
         virtual size_t GetShaderProfileCount() const;
+        virtual bool PreprocessShader(
+            const FilePath& rShaderPath, size_t profileIndex, RShader::EType type, const void* pShaderCode,
+            size_t shaderCodeSize, const ShaderToken* pTokens, size_t tokenCount,
+            DynamicArray< uint8_t >& rPreprocessedCode );
         virtual bool CompileShader(
             const FilePath& rShaderPath, size_t profileIndex, RShader::EType type, const void* pShaderCode,
             size_t shaderCodeSize, const ShaderToken* pTokens, size_t tokenCount, DynamicArray< uint8_t >& rCompiledCode,
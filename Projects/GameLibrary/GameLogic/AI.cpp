@@ -34,9 +34,9 @@ void AIComponentChasePlayerDefinition::PopulateMetaType( Helium::Reflect::MetaSt
 // TaskProcessAI
 
 typedef DynamicArray< Pair< PlayerComponent *, Simd::Vector3 > > PlayerList;
-static PlayerList g_PlayerList;
 
-void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControllerComponent *pController )
+// The player list is passed in rather than kept in a global so that worlds can be processed in parallel
+void UpdateAI_ChasePlayer( const PlayerList &playerList, AIComponentChasePlayer *pAiComponent, AvatarControllerComponent *pController )
 {
 	PlayerComponent *pTarget = NULL;
 	float pTargetDistanceSquared = NumericLimits<float>::Maximum;
@@ -48,7 +48,7 @@ void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControlle
 	if ( pTransform )
 	{
 		myPosition = pTransform->GetPosition();
-		for (PlayerList::Iterator iter = g_PlayerList.Begin(); iter != g_PlayerList.End(); ++iter)
+		for (PlayerList::ConstIterator iter = playerList.Begin(); iter != playerList.End(); ++iter)
 		{
 			float d = (iter->Second() - myPosition).GetMagnitudeSquared();
 			if ( d < pTargetDistanceSquared )
@@ -79,7 +79,7 @@ void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControlle
 
 void ProcessAI( World *pWorld )
 {
-	g_PlayerList.Clear();
+	PlayerList playerList;
 
 	for ( ImplementingComponentIterator<PlayerComponent> iterator( *pWorld->GetComponentManager() ); iterator.GetBaseComponent(); iterator.Advance() )
 	{
@@ -89,12 +89,13 @@ void ProcessAI( World *pWorld )
 
 			if ( pTransform )
 			{
-				g_PlayerList.New( *iterator, pTransform->GetPosition() );
+				playerList.New( *iterator, pTransform->GetPosition() );
 			}
 		}
 	}
 
-	QueryComponents< AIComponentChasePlayer, AvatarControllerComponent, UpdateAI_ChasePlayer >( pWorld );
+	// Each AI only writes its own controller, so they can all be updated in parallel
+	ParallelQueryComponents< PlayerList, AIComponentChasePlayer, AvatarControllerComponent, UpdateAI_ChasePlayer >( pWorld, playerList );
 }
 
 HELIUM_DEFINE_TASK( TaskProcessAI, ( ForEachWorld< ProcessAI > ), TickTypes::Gameplay )
@@ -103,4 +104,9 @@ void TaskProcessAI::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecuteAfter<Helium::StandardDependencies::ReceiveInput>();
 	rContract.ExecuteBefore<Helium::StandardDependencies::ProcessPhysics>();
+
+	rContract.ReadsComponents<PlayerComponent>();
+	rContract.ReadsComponents<TransformComponent>();
+	rContract.ReadsComponents<AIComponentChasePlayer>();
+	rContract.WritesComponents<AvatarControllerComponent>();
 }
@@ -82,6 +82,9 @@ void GameLibrary::SpriteComponent::Render( Helium::BufferedDrawer &rBufferedDraw
 	Helium::Simd::Matrix44 composite =
 		scaling * matrix;
 
+	// Sprites are drawn at their texel size, so keep the full texture resident when mip streaming is enabled.
+	m_Texture->ReportScreenSize( static_cast<float32_t>( Max( m_Texture->GetWidth(), m_Texture->GetHeight() ) ) );
+
 	rBufferedDrawer.DrawTexturedQuad(
 		m_Texture->GetRenderResource2d(),
 		composite,
@@ -182,4 +185,9 @@ HELIUM_DEFINE_TASK( DrawSpritesTask, (ForEachWorld< DrawSprites >), TickTypes::R
 void GameLibrary::DrawSpritesTask::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecutesWithin<Helium::StandardDependencies::Render>();
+
+	// Rendering a sprite updates its cached UVs, and g_pBufferedDrawer points into the graphics manager's drawer.
+	rContract.WritesComponents<SpriteComponent>();
+	rContract.ReadsComponents<Helium::TransformComponent>();
+	rContract.WritesComponents<Helium::GraphicsManagerComponent>();
 }
@@ -89,11 +89,10 @@ int main( int argc, const char* argv[] )
 			World *pWorld = NULL; 
 
 			{
-				AssetLoader *pAssetLoader = AssetLoader::GetInstance();
 				SceneDefinitionPtr spSceneDefinition;
 
 				AssetPath scenePath( TXT( "/Scenes/TestScene:SceneDefinition" ) );
-				pAssetLoader->LoadObject(scenePath, spSceneDefinition );
+				pGameSystem->LoadSceneDefinition( scenePath, spSceneDefinition );
 
 				HELIUM_ASSERT( !spSceneDefinition->GetAllFlagsSet( Asset::FLAG_BROKEN ) );
 
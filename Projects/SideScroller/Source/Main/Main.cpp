@@ -78,11 +78,10 @@ int main( int argc, const char* argv[] )
 			);
 		
 		{
-			Helium::AssetLoader *pAssetLoader = AssetLoader::GetInstance();
 			Helium::SceneDefinitionPtr spSceneDefinition;
 
 			AssetPath scenePath( TXT( "/Scenes/TestScene:SceneDefinition" ) );
-			pAssetLoader->LoadObject(scenePath, spSceneDefinition );
+			pGameSystem->LoadSceneDefinition( scenePath, spSceneDefinition );
 
 			HELIUM_ASSERT( !spSceneDefinition->GetAllFlagsSet( Asset::FLAG_BROKEN ) );
 
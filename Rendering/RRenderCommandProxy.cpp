@@ -168,7 +168,24 @@ RRenderCommandProxy::~RRenderCommandProxy()
 /// @param[in] startIndex       Offset of the first index within the index buffer to use for rendering.
 /// @param[in] primitiveCount   Number of primitives to render.
 ///
-/// @see DrawUnindexed()
+/// @see DrawIndexedInstanced(), DrawUnindexed()
+
+/// @fn void RRenderCommandProxy::DrawIndexedInstanced( ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t minIndex, uint32_t usedVertexCount, uint32_t startIndex, uint32_t primitiveCount, uint32_t instanceCount )
+/// Draw multiple instances of primitives based on a list of indexed vertices.
+///
+/// Vertex buffer 0 provides the per-vertex data addressed by the index buffer, while all other bound vertex buffers
+/// provide per-instance data, advancing by one element for each instance drawn.
+///
+/// @param[in] primitiveType    Type of primitive to render.
+/// @param[in] baseVertexIndex  Vertex offset of the first vertex to use from the start of the per-vertex stream.
+/// @param[in] minIndex         Minimum vertex index value.
+/// @param[in] usedVertexCount  Range of vertices used during this call, starting from the vertex addressed by the
+///                             minimum vertex index value.
+/// @param[in] startIndex       Offset of the first index within the index buffer to use for rendering.
+/// @param[in] primitiveCount   Number of primitives to render for each instance.
+/// @param[in] instanceCount    Number of instances to render.
+///
+/// @see DrawIndexed()
 
 /// @fn void RRenderCommandProxy::DrawUnindexed( ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t primitiveCount )
 /// Draw primitives based on an unindexed list of vertices.
@@ -546,6 +546,53 @@ private:
     uint32_t m_primitiveCount;
 };
 
+class D3D9DrawIndexedInstancedCommand : public D3D9RenderCommand
+{
+public:
+    D3D9DrawIndexedInstancedCommand(
+        ERendererPrimitiveType primitiveType,
+        uint32_t baseVertexIndex,
+        uint32_t minIndex,
+        uint32_t usedVertexCount,
+        uint32_t startIndex,
+        uint32_t primitiveCount,
+        uint32_t instanceCount )
+        : m_primitiveType( primitiveType )
+        , m_baseVertexIndex( baseVertexIndex )
+        , m_minIndex( minIndex )
+        , m_usedVertexCount( usedVertexCount )
+        , m_startIndex( startIndex )
+        , m_primitiveCount( primitiveCount )
+        , m_instanceCount( instanceCount )
+    {
+    }
+
+    ~D3D9DrawIndexedInstancedCommand()
+    {
+    }
+
+    void Execute( D3D9ImmediateCommandProxy* pCommandProxy )
+    {
+        pCommandProxy->DrawIndexedInstanced(
+            m_primitiveType,
+            m_baseVertexIndex,
+            m_minIndex,
+            m_usedVertexCount,
+            m_startIndex,
+            m_primitiveCount,
+            m_instanceCount );
+    }
+
+private:
+    ERendererPrimitiveType m_primitiveType;
+    uint32_t m_baseVertexIndex;
+    uint32_t m_minIndex;
+    uint32_t m_usedVertexCount;
+    uint32_t m_startIndex;
+    uint32_t m_primitiveCount;
+    uint32_t m_instanceCount;
+};
+
 class D3D9DrawUnindexedCommand : public D3D9RenderCommand
 {
 public:
@@ -743,6 +790,12 @@ HELIUM_DEFERRED_COMMAND_PROXY_METHOD(
       uint32_t startIndex, uint32_t primitiveCount ),
     ( primitiveType, baseVertexIndex, minIndex, usedVertexCount, startIndex, primitiveCount ) )
 
+HELIUM_DEFERRED_COMMAND_PROXY_METHOD(
+    DrawIndexedInstanced,
+    ( ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t minIndex, uint32_t usedVertexCount,
+      uint32_t startIndex, uint32_t primitiveCount, uint32_t instanceCount ),
+    ( primitiveType, baseVertexIndex, minIndex, usedVertexCount, startIndex, primitiveCount, instanceCount ) )
+
 HELIUM_DEFERRED_COMMAND_PROXY_METHOD(
     DrawUnindexed,
     ( ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t primitiveCount ),
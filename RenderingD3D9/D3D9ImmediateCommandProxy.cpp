@@ -25,6 +25,7 @@ using namespace Helium;
 D3D9ImmediateCommandProxy::D3D9ImmediateCommandProxy( IDirect3DDevice9* pD3DDevice )
 : m_pDevice( pD3DDevice )
 , m_srgbTextureFlags( 0 )
+, m_streamSourceCount( 0 )
 {
     HELIUM_ASSERT( pD3DDevice );
     pD3DDevice->AddRef();
@@ -512,6 +513,8 @@ void D3D9ImmediateCommandProxy::SetVertexBuffers(
         {
             pD3DBuffer = static_cast< D3D9VertexBuffer* >( pBuffer )->GetD3DBuffer();
             HELIUM_ASSERT( pD3DBuffer );
+
+            m_streamSourceCount = Max( m_streamSourceCount, static_cast< uint32_t >( bufferIndex + 1 ) );
         }
 
         HELIUM_D3D9_VERIFY( m_pDevice->SetStreamSource(
@@ -790,6 +793,62 @@ void D3D9ImmediateCommandProxy::DrawIndexed(
         primitiveCount ) );
 }
 
+/// @copydoc RRenderCommandProxy::DrawIndexedInstanced()
+void D3D9ImmediateCommandProxy::DrawIndexedInstanced(
+    ERendererPrimitiveType primitiveType,
+    uint32_t baseVertexIndex,
+    uint32_t minIndex,
+    uint32_t usedVertexCount,
+    uint32_t startIndex,
+    uint32_t primitiveCount,
+    uint32_t instanceCount )
+{
+    HELIUM_ASSERT( static_cast< size_t >( primitiveType ) < static_cast< size_t >( RENDERER_PRIMITIVE_TYPE_MAX ) );
+    HELIUM_ASSERT( instanceCount != 0 );
+
+    static const D3DPRIMITIVETYPE d3dPrimitiveTypes[] =
+    {
+        // RENDERER_PRIMITIVE_TYPE_POINT_LIST
+        D3DPT_POINTLIST,
+        // RENDERER_PRIMITIVE_TYPE_LINE_LIST
+        D3DPT_LINELIST,
+        // RENDERER_PRIMITIVE_TYPE_LINE_STRIP
+        D3DPT_LINESTRIP,
+        // RENDERER_PRIMITIVE_TYPE_TRIANGLE_LIST
+        D3DPT_TRIANGLELIST,
+        // RENDERER_PRIMITIVE_TYPE_TRIANGLE_STRIP
+        D3DPT_TRIANGLESTRIP,
+        // RENDERER_PRIMITIVE_TYPE_TRIANGLE_FAN
+        D3DPT_TRIANGLEFAN,
+    };
+
+    HELIUM_COMPILE_ASSERT( HELIUM_ARRAY_COUNT( d3dPrimitiveTypes ) == RENDERER_PRIMITIVE_TYPE_MAX );
+
+    m_vertexConstantManager.Push( m_pDevice );
+    m_pixelConstantManager.Push( m_pDevice );
+
+    // Stream 0 is repeated for each instance, while the remaining streams advance once per instance.
+    DWORD streamSourceCount = static_cast< DWORD >( Max< uint32_t >( m_streamSourceCount, 1 ) );
+    HELIUM_D3D9_VERIFY( m_pDevice->SetStreamSourceFreq( 0, D3DSTREAMSOURCE_INDEXEDDATA | instanceCount ) );
+    for( DWORD streamSourceIndex = 1; streamSourceIndex < streamSourceCount; ++streamSourceIndex )
+    {
+        HELIUM_D3D9_VERIFY( m_pDevice->SetStreamSourceFreq( streamSourceIndex, D3DSTREAMSOURCE_INSTANCEDATA | 1 ) );
+    }
+
+    HELIUM_D3D9_VERIFY( m_pDevice->DrawIndexedPrimitive(
+        d3dPrimitiveTypes[ primitiveType ],
+        baseVertexIndex,
+        minIndex,
+        usedVertexCount,
+        startIndex,
+        primitiveCount ) );
+
+    for( DWORD streamSourceIndex = 0; streamSourceIndex < streamSourceCount; ++streamSourceIndex )
+    {
+        HELIUM_D3D9_VERIFY( m_pDevice->SetStreamSourceFreq( streamSourceIndex, 1 ) );
+    }
+}
+
 /// @copydoc RRenderCommandProxy::DrawUnindexed()
 void D3D9ImmediateCommandProxy::DrawUnindexed(
     ERendererPrimitiveType primitiveType,
@@ -859,6 +918,8 @@ void D3D9ImmediateCommandProxy::UnbindResources()
         HELIUM_D3D9_VERIFY( m_pDevice->SetStreamSource( streamSourceIndex, NULL, 0, 0 ) );
     }
 
+    m_streamSourceCount = 0;
+
     for( size_t constantBufferIndex = 0; constantBufferIndex < CONSTANT_BUFFER_SLOT_COUNT; ++constantBufferIndex )
     {
         m_vertexConstantManager.SetBuffer( constantBufferIndex, NULL, Invalid< size_t >() );
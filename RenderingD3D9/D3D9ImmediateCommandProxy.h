@@ -81,6 +81,9 @@ namespace Helium
         void DrawIndexed(
             ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t minIndex, uint32_t usedVertexCount,
             uint32_t startIndex, uint32_t primitiveCount );
+        void DrawIndexedInstanced(
+            ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t minIndex, uint32_t usedVertexCount,
+            uint32_t startIndex, uint32_t primitiveCount, uint32_t instanceCount );
         void DrawUnindexed( ERendererPrimitiveType primitiveType, uint32_t baseVertexIndex, uint32_t primitiveCount );
         //@}
 
@@ -186,6 +189,9 @@ namespace Helium
         /// Bit flags specifying which bound textures are in sRGB space.
         uint32_t m_srgbTextureFlags;
 
+        /// One past the highest stream source index to which a vertex buffer has been bound.
+        uint32_t m_streamSourceCount;
+
         /// @name Construction/Destruction
         //@{
         ~D3D9ImmediateCommandProxy();
@@ -71,6 +71,11 @@ namespace Helium
             T* NewCommand(
                 const P0& rParam0, const P1& rParam1, const P2& rParam2, const P3& rParam3, const P4& rParam4,
                 const P5& rParam5 );
+        template<
+            typename T, typename P0, typename P1, typename P2, typename P3, typename P4, typename P5, typename P6 >
+            T* NewCommand(
+                const P0& rParam0, const P1& rParam1, const P2& rParam2, const P3& rParam3, const P4& rParam4,
+                const P5& rParam5, const P6& rParam6 );
         //@}
 
         /// @name Command Iteration
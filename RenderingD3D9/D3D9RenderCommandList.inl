@@ -122,6 +122,34 @@ namespace Helium
         return new( pAddress ) T( rParam0, rParam1, rParam2, rParam3, rParam4, rParam5 );
     }
 
+    /// Allocate a new command with seven parameters.
+    ///
+    /// @param[in] rParam0  Command parameter.
+    /// @param[in] rParam1  Command parameter.
+    /// @param[in] rParam2  Command parameter.
+    /// @param[in] rParam3  Command parameter.
+    /// @param[in] rParam4  Command parameter.
+    /// @param[in] rParam5  Command parameter.
+    /// @param[in] rParam6  Command parameter.
+    ///
+    /// @return  New command.
+    template<
+        typename T, typename P0, typename P1, typename P2, typename P3, typename P4, typename P5, typename P6 >
+    T* D3D9RenderCommandList::NewCommand(
+        const P0& rParam0,
+        const P1& rParam1,
+        const P2& rParam2,
+        const P3& rParam3,
+        const P4& rParam4,
+        const P5& rParam5,
+        const P6& rParam6 )
+    {
+        void* pAddress = AllocateCommandSpace< T >();
+        HELIUM_ASSERT( pAddress );
+
+        return new( pAddress ) T( rParam0, rParam1, rParam2, rParam3, rParam4, rParam5, rParam6 );
+    }
+
     /// Allocate space in this command buffer for a command of the template type.
     ///
     /// @return  Allocated address if allocated successfully, null if there is not enough space in this command buffer.
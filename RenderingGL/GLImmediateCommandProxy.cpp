@@ -333,6 +333,19 @@ void GLImmediateCommandProxy::DrawIndexed(
 	HELIUM_BREAK();
 }
 
+/// @copydoc RRenderCommandProxy::DrawIndexedInstanced()
+void GLImmediateCommandProxy::DrawIndexedInstanced(
+	ERendererPrimitiveType primitiveType,
+	uint32_t baseVertexIndex,
+	uint32_t minIndex,
+	uint32_t usedVertexCount,
+	uint32_t startIndex,
+	uint32_t primitiveCount,
+	uint32_t instanceCount )
+{
+	HELIUM_BREAK();
+}
+
 /// @copydoc RRenderCommandProxy::DrawUnindexed()
 void GLImmediateCommandProxy::DrawUnindexed(
 	ERendererPrimitiveType primitiveType,
@@ -12,6 +12,11 @@ project( prefix .. "Engine" )
 		"Engine/*",
 	}
 
+	includedirs
+	{
+		"Dependencies/zlib",
+	}
+
 	configuration "SharedLib"
 		links
 		{
@@ -22,6 +27,8 @@ project( prefix .. "Engine" )
 			prefix .. "Persist",
 			prefix .. "Math",
 			prefix .. "MathSimd",
+
+			"zlib",
 		}
 
 project( prefix .. "EngineJobs" )
@@ -558,6 +565,7 @@ project( prefix .. "GameLibrary" )
 
 			"ois",
 			"mongo-c",
+			"zlib",
 		}
 
 Helium.DoGameMainProjectSettings( "PhysicsDemo" )
@@ -258,6 +258,7 @@ project( prefix .. "Editor" )
 		"bullet",
 		"mongo-c",
 		"ois",
+		"zlib",
 	}
 
 	configuration "linux"